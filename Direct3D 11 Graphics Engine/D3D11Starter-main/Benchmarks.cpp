@@ -0,0 +1,518 @@
+#include "Benchmarks.h"
+#include "JobSystem.h"
+#include "Transform.h"
+#include "Graphics.h"
+#include "PathHelpers.h"
+#include "SimpleShader.h"
+#include "ShaderStructs.h"
+#include "RenderQueue.h"
+#include "SpatialIndex.h"
+#include "Culling.h"
+#include "FrameAllocator.h"
+#include "CommandStream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+
+#include "ImGui/imgui.h"
+
+// --------------------------------------------------------
+// In-engine micro benchmarks
+//
+// These run on demand from the Inspector window, so they
+// measure the real build with the real thread count rather
+// than a separate test executable.
+// --------------------------------------------------------
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	std::vector<Benchmarks::Result> jobScalingResults;
+	std::vector<Benchmarks::Result> shaderSetResults;
+	std::vector<Benchmarks::Result> shaderLoadResults;
+	std::vector<Benchmarks::Result> renderQueueResults;
+	std::vector<Benchmarks::Result> spatialResults;
+	std::vector<Benchmarks::Result> commandResults;
+
+	// Times func() a few times and keeps the fastest run
+	template<typename Func>
+	double BestOf(int runs, Func&& func)
+	{
+		double best = 1e30;
+		for (int r = 0; r < runs; r++)
+		{
+			auto start = std::chrono::high_resolution_clock::now();
+			func();
+			auto end = std::chrono::high_resolution_clock::now();
+
+			double ms = std::chrono::duration<double, std::milli>(end - start).count();
+			if (ms < best) best = ms;
+		}
+		return best;
+	}
+
+	void DrawResults(const char* tableName, const std::vector<Benchmarks::Result>& results)
+	{
+		if (results.empty())
+			return;
+
+		if (ImGui::BeginTable(tableName, 3, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Run");
+			ImGui::TableSetupColumn("Time (ms)");
+			ImGui::TableSetupColumn("Speedup");
+			ImGui::TableHeadersRow();
+
+			for (auto& r : results)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::Text("%s", r.Label.c_str());
+				ImGui::TableNextColumn(); ImGui::Text("%.3f", r.Milliseconds);
+				ImGui::TableNextColumn(); ImGui::Text("%.2fx", r.Speedup);
+			}
+			ImGui::EndTable();
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Job system scaling
+//
+// Rebuilds the world matrices of 200k transforms (the same
+// work entity updates do), split into exactly N jobs for
+// N = 1, 2, 4 ... thread count.  With N jobs at most N
+// threads can be busy, so the speedup column shows how well
+// the job system scales across cores.
+// --------------------------------------------------------
+void Benchmarks::JobScaling(std::vector<Result>& results)
+{
+	const uint32_t transformCount = 200000;
+	std::vector<Transform> transforms(transformCount);
+	std::vector<XMFLOAT4X4> worlds(transformCount);
+
+	auto work = [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+		{
+			transforms[i].Rotate(0.01f, 0.02f, 0.03f);
+			worlds[i] = transforms[i].GetWorldMatrix();
+		}
+	};
+
+	results.clear();
+	unsigned int threads = JobSystem::ThreadCount();
+	for (unsigned int jobs = 1; ; jobs *= 2)
+	{
+		if (jobs > threads) jobs = threads;
+
+		double ms = BestOf(5, [&]()
+		{
+			JobSystem::Counter group;
+			uint32_t perJob = (transformCount + jobs - 1) / jobs;
+			for (uint32_t begin = 0; begin < transformCount; begin += perJob)
+			{
+				JobSystem::Job job = {};
+				job.Function = [](void* data, uint32_t b, uint32_t e) { (*static_cast<decltype(work)*>(data))(b, e); };
+				job.Data = &work;
+				job.Begin = begin;
+				job.End = begin + perJob < transformCount ? begin + perJob : transformCount;
+				JobSystem::Run(job, &group);
+			}
+			JobSystem::Wait(&group);
+		});
+
+		char label[32];
+		snprintf(label, sizeof(label), "%u job(s)", jobs);
+		results.push_back({ label, ms, results.empty() ? 1.0 : results[0].Milliseconds / ms });
+
+		if (jobs == threads)
+			break;
+	}
+}
+
+// --------------------------------------------------------
+// Shader variable set-call throughput
+//
+// Sets the per-object matrices (world & worldInvTransp -
+// view & projection are in the shared PerPass buffer) for
+// 100k simulated draws, four ways: by string, by compile-time hashed name,
+// through handles resolved once up front, and as one generated
+// struct (see ShaderStructs.h).  Only the CPU side is timed -
+// nothing is copied to the GPU.  Each draw is translated by
+// its index, so no set is skipped as unchanged.
+// --------------------------------------------------------
+void Benchmarks::ShaderSetCalls(std::vector<Result>& results)
+{
+	const int drawCount = 100000;
+
+	// A private instance, so the render thread's copy of this shader is never touched
+	SimpleVertexShader vs(Graphics::Device, Graphics::Context, FixPath(L"VertexShader.cso").c_str());
+	results.clear();
+	if (!vs.IsShaderValid())
+		return;
+
+	XMFLOAT4X4 matrix;
+	XMStoreFloat4x4(&matrix, XMMatrixIdentity());
+
+	double stringMs = BestOf(5, [&]()
+	{
+		for (int i = 0; i < drawCount; i++)
+		{
+			matrix._41 = (float)i;
+			vs.SetMatrix4x4("world", matrix);
+			vs.SetMatrix4x4("worldInvTransp", matrix);
+		}
+	});
+
+	constexpr SimpleShaderName world("world");
+	constexpr SimpleShaderName worldInvTransp("worldInvTransp");
+	double hashedMs = BestOf(5, [&]()
+	{
+		for (int i = 0; i < drawCount; i++)
+		{
+			matrix._41 = (float)i;
+			vs.SetMatrix4x4(vs.GetVariableHandle(world), matrix);
+			vs.SetMatrix4x4(vs.GetVariableHandle(worldInvTransp), matrix);
+		}
+	});
+
+	SimpleVariableHandle handles[2] =
+	{
+		vs.GetVariableHandle(world),
+		vs.GetVariableHandle(worldInvTransp)
+	};
+	double handleMs = BestOf(5, [&]()
+	{
+		for (int i = 0; i < drawCount; i++)
+		{
+			matrix._41 = (float)i;
+			vs.SetMatrix4x4(handles[0], matrix);
+			vs.SetMatrix4x4(handles[1], matrix);
+		}
+	});
+
+	ShaderStructs::VertexShader::PerObject perObject = {};
+	perObject.world = matrix;
+	perObject.worldInvTransp = matrix;
+	double structMs = BestOf(5, [&]()
+	{
+		for (int i = 0; i < drawCount; i++)
+		{
+			perObject.world._41 = (float)i;
+			perObject.worldInvTransp._41 = (float)i;
+			vs.Set(perObject);
+		}
+	});
+
+	results.push_back({ "String lookup", stringMs, 1.0 });
+	results.push_back({ "Hashed name lookup", hashedMs, stringMs / hashedMs });
+	results.push_back({ "Pre-resolved handle", handleMs, stringMs / handleMs });
+	results.push_back({ "Generated struct", structMs, stringMs / structMs });
+}
+
+// --------------------------------------------------------
+// Shader load time, with & without the reflection cache
+//
+// Loads every shader the game uses 10 times over, first
+// reflecting each one and then reading the cache files
+// (which are written before timing, so every load hits).
+// Both include creating the device shader objects.
+// --------------------------------------------------------
+void Benchmarks::ShaderLoading(std::vector<Result>& results)
+{
+	const int repeats = 10;
+	const wchar_t* vertexShaders[] = { L"VertexShader.cso", L"SkyVS.cso", L"ShadowMapVS.cso", L"FullscrTriangleVS.cso" };
+	const wchar_t* pixelShaders[] = { L"PixelShader.cso", L"SkyPS.cso", L"BoxBlurPS.cso", L"GaussianBlurPS.cso", L"BloomPS_Extract.cso", L"BloomPS_Combine.cso" };
+
+	// Private instances, so the game's own shaders are never touched
+	auto loadAll = [&]()
+	{
+		for (const wchar_t* file : vertexShaders)
+			SimpleVertexShader vs(Graphics::Device, Graphics::Context, FixPath(file).c_str());
+		for (const wchar_t* file : pixelShaders)
+			SimplePixelShader ps(Graphics::Device, Graphics::Context, FixPath(file).c_str());
+	};
+
+	bool useCache = ISimpleShader::UseReflectionCache;
+
+	ISimpleShader::UseReflectionCache = false;
+	double reflectMs = BestOf(3, [&]() { for (int i = 0; i < repeats; i++) loadAll(); });
+
+	ISimpleShader::UseReflectionCache = true;
+	loadAll();
+	double cachedMs = BestOf(3, [&]() { for (int i = 0; i < repeats; i++) loadAll(); });
+
+	ISimpleShader::UseReflectionCache = useCache;
+
+	results.clear();
+	results.push_back({ "D3DReflect", reflectMs, 1.0 });
+	results.push_back({ "Reflection cache", cachedMs, reflectMs / cachedMs });
+}
+
+// --------------------------------------------------------
+// Render queue sorting
+//
+// Sorts 100k draw keys spread over 8 shaders, 256 materials,
+// 64 meshes & random depths - a frame's worth of a large
+// scene - with std::sort and with the queue's radix sort.
+// Both times include copying the unsorted keys back in
+// first (about 1.5 MB).
+// --------------------------------------------------------
+void Benchmarks::RenderQueueSort(std::vector<Result>& results)
+{
+	const uint32_t drawCount = 100000;
+	std::vector<RenderQueueEntry> unsorted(drawCount);
+	std::vector<RenderQueueEntry> entries(drawCount);
+	std::vector<RenderQueueEntry> scratch(drawCount);
+
+	uint32_t seed = 12345;
+	auto random = [&]() { seed = seed * 1664525u + 1013904223u; return seed >> 8; };
+	for (uint32_t i = 0; i < drawCount; i++)
+	{
+		float depth = (random() & 0xFFFF) / 65535.0f;
+		unsorted[i] = { RenderQueue::MakeKey(RenderQueue::Opaque, random() % 8, random() % 256, random() % 64, depth), i };
+	}
+
+	double stdMs = BestOf(5, [&]()
+	{
+		entries = unsorted;
+		std::sort(entries.begin(), entries.end(),
+			[](const RenderQueueEntry& a, const RenderQueueEntry& b) { return a.Key < b.Key; });
+	});
+
+	double radixMs = BestOf(5, [&]()
+	{
+		entries = unsorted;
+		RenderQueue::Sort(entries, scratch);
+	});
+
+	results.clear();
+	results.push_back({ "std::sort", stdMs, 1.0 });
+	results.push_back({ "Radix sort", radixMs, stdMs / radixMs });
+}
+
+// --------------------------------------------------------
+// Scene index at 1M entities
+//
+// Random boxes (0.5 to 2 units across) scattered through a
+// 1000 unit cube.  Each query is timed as a linear scan over
+// every box and through the tree; those rows' speedups are
+// the tree's over the scan above them.
+// - Update moves every box a little (staying in its fat box)
+//   and 1% of them a long way, against building from scratch
+// - Frustum: 90 degrees, 200 units deep, from the middle
+// - Sphere: 100 queries of radius 10 at random points
+// - Nearest: the 8 closest boxes to 100 random points
+// --------------------------------------------------------
+void Benchmarks::SpatialQueries(std::vector<Result>& results)
+{
+	const uint32_t entityCount = 1000000;
+	const uint32_t sphereQueries = 100;
+	const uint32_t nearestQueries = 100;
+	const uint32_t k = 8;
+
+	uint32_t seed = 12345;
+	auto random = [&]() { seed = seed * 1664525u + 1013904223u; return (seed >> 8) / 16777216.0f; };
+	auto randomPoint = [&]() { return XMFLOAT3(random() * 1000 - 500, random() * 1000 - 500, random() * 1000 - 500); };
+
+	std::vector<Aabb> boxes(entityCount);
+	for (Aabb& box : boxes)
+	{
+		XMFLOAT3 center = randomPoint();
+		float half = 0.25f + random() * 0.75f;
+		box = { { center.x - half, center.y - half, center.z - half }, { center.x + half, center.y + half, center.z + half } };
+	}
+
+	// Build & update
+	DynamicAabbTree tree;
+	std::vector<uint32_t> proxies(entityCount);
+	double buildMs = BestOf(1, [&]()
+	{
+		tree.Clear();
+		for (uint32_t i = 0; i < entityCount; i++)
+			proxies[i] = tree.Insert(boxes[i], i);
+	});
+
+	std::vector<Aabb> moved(boxes);
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		float offset = (i % 100 == 0) ? random() * 50.0f : random() * 0.05f;
+		moved[i].Min.x += offset;
+		moved[i].Max.x += offset;
+	}
+	uint32_t reinserted = 0;
+	double updateMs = BestOf(1, [&]()
+	{
+		for (uint32_t i = 0; i < entityCount; i++)
+			reinserted += tree.Move(proxies[i], moved[i]) ? 1 : 0;
+	});
+	boxes = moved;
+
+	// Frustum
+	XMMATRIX view = XMMatrixLookToLH(XMVectorZero(), XMVectorSet(0, 0, 1, 0), XMVectorSet(0, 1, 0, 0));
+	Frustum frustum = Culling::FrustumFromMatrix(view * XMMatrixPerspectiveFovLH(XM_PIDIV2, 1.0f, 0.1f, 200.0f));
+
+	FrameAllocator allocator(entityCount * sizeof(float) * 6 + 1024);
+	BoundsSoA bounds = Culling::AllocateBounds(allocator, entityCount);
+	for (uint32_t i = 0; i < entityCount; i++)
+	{
+		const Aabb& box = boxes[i];
+		bounds.Set(i,
+			XMFLOAT3((box.Min.x + box.Max.x) * 0.5f, (box.Min.y + box.Max.y) * 0.5f, (box.Min.z + box.Max.z) * 0.5f),
+			XMFLOAT3((box.Max.x - box.Min.x) * 0.5f, (box.Max.y - box.Min.y) * 0.5f, (box.Max.z - box.Min.z) * 0.5f));
+	}
+	std::vector<uint8_t> visible(entityCount);
+	double frustumLinearMs = BestOf(3, [&]() { Culling::CullBoxes(frustum, bounds, visible.data()); });
+
+	uint32_t found = 0;
+	double frustumTreeMs = BestOf(3, [&]() { found = 0; tree.QueryFrustum(frustum, [&](uint32_t) { found++; }); });
+
+	// Spheres
+	std::vector<XMFLOAT3> points(sphereQueries);
+	for (XMFLOAT3& point : points)
+		point = randomPoint();
+	const float radius = 10.0f;
+
+	double sphereLinearMs = BestOf(1, [&]()
+	{
+		found = 0;
+		for (const XMFLOAT3& point : points)
+			for (const Aabb& box : boxes)
+				found += DynamicAabbTree::DistanceSquared(box, point) <= radius * radius ? 1 : 0;
+	});
+	double sphereTreeMs = BestOf(3, [&]()
+	{
+		found = 0;
+		for (const XMFLOAT3& point : points)
+			tree.QuerySphere(point, radius, [&](uint32_t) { found++; });
+	});
+
+	// Nearest
+	std::vector<float> distances(entityCount);
+	double nearestLinearMs = BestOf(1, [&]()
+	{
+		for (uint32_t q = 0; q < nearestQueries; q++)
+		{
+			for (uint32_t i = 0; i < entityCount; i++)
+				distances[i] = DynamicAabbTree::DistanceSquared(boxes[i], points[q]);
+			std::nth_element(distances.begin(), distances.begin() + k, distances.end());
+		}
+	});
+
+	std::vector<DynamicAabbTree::Neighbor> nearest;
+	double nearestTreeMs = BestOf(3, [&]()
+	{
+		for (uint32_t q = 0; q < nearestQueries; q++)
+			tree.QueryNearest(points[q], k, nearest);
+	});
+
+	char updateLabel[64];
+	snprintf(updateLabel, sizeof(updateLabel), "Update 1M (%u reinserted)", reinserted);
+
+	results.clear();
+	results.push_back({ "Build 1M", buildMs, 1.0 });
+	results.push_back({ updateLabel, updateMs, buildMs / updateMs });
+	results.push_back({ "Frustum: linear (SIMD, jobs)", frustumLinearMs, 1.0 });
+	results.push_back({ "Frustum: tree", frustumTreeMs, frustumLinearMs / frustumTreeMs });
+	results.push_back({ "100 spheres: linear", sphereLinearMs, 1.0 });
+	results.push_back({ "100 spheres: tree", sphereTreeMs, sphereLinearMs / sphereTreeMs });
+	results.push_back({ "100 x 8-nearest: linear", nearestLinearMs, 1.0 });
+	results.push_back({ "100 x 8-nearest: tree", nearestTreeMs, nearestLinearMs / nearestTreeMs });
+}
+
+// --------------------------------------------------------
+// Command stream recording throughput
+//
+// Records 100k draws the way the main pass does (a pipeline
+// & material change every 16 draws, then each draw's
+// per-object constants & the draw itself) split into N
+// ranges, one stream each, for N = 1, 2, 4 ... thread count.
+// The label shows draws recorded per millisecond per thread,
+// which stays flat if recording scales with cores.
+// - Nothing is replayed, so the packets point at nothing
+// --------------------------------------------------------
+void Benchmarks::CommandRecording(std::vector<Result>& results)
+{
+	const uint32_t drawCount = 100000;
+	std::vector<XMFLOAT4X4> worlds(drawCount);
+	for (uint32_t i = 0; i < drawCount; i++)
+		XMStoreFloat4x4(&worlds[i], XMMatrixTranslation((float)(i % 100), (float)(i / 100 % 100), (float)(i / 10000)));
+
+	unsigned int threads = JobSystem::ThreadCount();
+	std::vector<CommandStream> streams(threads);
+
+	results.clear();
+	for (unsigned int jobs = 1; ; jobs *= 2)
+	{
+		if (jobs > threads) jobs = threads;
+
+		double ms = BestOf(5, [&]()
+		{
+			uint32_t perJob = (drawCount + jobs - 1) / jobs;
+			JobSystem::ParallelFor(jobs, 1, [&](uint32_t first, uint32_t last)
+			{
+				for (uint32_t job = first; job < last; job++)
+				{
+					CommandStream& stream = streams[job];
+					stream.Clear();
+
+					uint32_t end = (job + 1) * perJob < drawCount ? (job + 1) * perJob : drawCount;
+					ShaderStructs::VertexShader::PerObject perObject = {};
+					for (uint32_t i = job * perJob; i < end; i++)
+					{
+						if (i % 16 == 0 || i == job * perJob)
+						{
+							stream.SetPipeline(0);
+							stream.SetMaterial(0, 0);
+						}
+
+						perObject.world = worlds[i];
+						perObject.worldInvTransp = worlds[i];
+						stream.SetConstants(0, perObject);
+						stream.Draw(0, 0, 0, 0);
+					}
+				}
+			});
+		});
+
+		char label[64];
+		snprintf(label, sizeof(label), "%u thread(s): %.0f draws/ms each", jobs, drawCount / ms / jobs);
+		results.push_back({ label, ms, results.empty() ? 1.0 : results[0].Milliseconds / ms });
+
+		if (jobs == threads)
+			break;
+	}
+}
+
+void Benchmarks::BuildUI()
+{
+	ImGui::Text("Job threads: %u (including main)", JobSystem::ThreadCount());
+
+	if (ImGui::Button("Run Job Scaling"))
+		JobScaling(jobScalingResults);
+	DrawResults("Job Scaling", jobScalingResults);
+
+	if (ImGui::Button("Run Shader Set Calls"))
+		ShaderSetCalls(shaderSetResults);
+	DrawResults("Shader Set Calls", shaderSetResults);
+
+	if (ImGui::Button("Run Shader Loading"))
+		ShaderLoading(shaderLoadResults);
+	DrawResults("Shader Loading", shaderLoadResults);
+
+	if (ImGui::Button("Run Render Queue Sort"))
+		RenderQueueSort(renderQueueResults);
+	DrawResults("Render Queue Sort", renderQueueResults);
+
+	if (ImGui::Button("Run Spatial Queries (1M entities)"))
+		SpatialQueries(spatialResults);
+	DrawResults("Spatial Queries", spatialResults);
+
+	if (ImGui::Button("Run Command Recording"))
+		CommandRecording(commandResults);
+	DrawResults("Command Recording", commandResults);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+// See Benchmarks.cpp for details on each benchmark
+
+namespace Benchmarks
+{
+	// One row of a benchmark's results table
+	struct Result
+	{
+		std::string Label;
+		double Milliseconds; // Best of several runs
+		double Speedup; // Relative to the first row
+	};
+
+	// Individual benchmarks - each replaces the contents of results
+	void JobScaling(std::vector<Result>& results);
+	void ShaderSetCalls(std::vector<Result>& results);
+	void ShaderLoading(std::vector<Result>& results);
+	void RenderQueueSort(std::vector<Result>& results);
+	void SpatialQueries(std::vector<Result>& results);
+	void CommandRecording(std::vector<Result>& results);
+
+	// Draws "Run" buttons and the latest results into the current ImGui window
+	void BuildUI();
+}
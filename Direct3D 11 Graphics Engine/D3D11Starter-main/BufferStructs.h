@@ -1,9 +1,47 @@
 #pragma once
 
-struct VertexShaderData 
+#include "ShaderStructs.h"
+
+// Max # of lights in the PerFrame buffer (MAX_LIGHTS in ShaderInclude.hlsli)
+constexpr int MaxLights = 6;
+
+// --------------------------------------------------------
+// C++ copies of the shared cbuffers in ShaderInclude.hlsli
+// - Generated from the compiled shaders (see ShaderStructs.h),
+//   so their layout can't drift from the HLSL
+// - Filled once per pass/frame and uploaded whole
+// --------------------------------------------------------
+using PerPassData = ShaderStructs::PerPass;
+using PerFrameData = ShaderStructs::PerFrame;
+
+static_assert(sizeof(PerFrameData::lights) / sizeof(PerFrameData::lights[0]) == MaxLights, "MaxLights must match MAX_LIGHTS");
+
+// --------------------------------------------------------
+// One object in the per-frame transform buffer (Objects &
+// ObjectTransform in ShaderInclude.hlsli) - read by the
+// INSTANCED variants at the index from vertex buffer slot 1
+//
+// - Each matrix is 3x4: the transposed matrix's top three
+//   rows (so each row is one output component), since the
+//   last is always 0,0,0,1 for the world matrix & never
+//   used for the inverse transpose
+// --------------------------------------------------------
+struct ObjectTransform
 {
-	DirectX::XMFLOAT4 tint; // *NOTE: Watch that 16-byte boundary!*
-	DirectX::XMFLOAT4X4 world; //DirectX::XMFLOAT3 offset;
-	DirectX::XMFLOAT4X4 view;
-	DirectX::XMFLOAT4X4 projection;
-};
\ No newline at end of file
+	DirectX::XMFLOAT4 World[3];
+	DirectX::XMFLOAT4 WorldInverseTranspose[3];
+
+	void Set(const DirectX::XMFLOAT4X4& world, const DirectX::XMFLOAT4X4& worldInverseTranspose)
+	{
+		for (int i = 0; i < 3; i++)
+		{
+			World[i] = { world.m[0][i], world.m[1][i], world.m[2][i], world.m[3][i] };
+			WorldInverseTranspose[i] = { worldInverseTranspose.m[0][i], worldInverseTranspose.m[1][i], worldInverseTranspose.m[2][i], worldInverseTranspose.m[3][i] };
+		}
+	}
+};
+
+static_assert(sizeof(ObjectTransform) == 96, "ObjectTransform must match the HLSL struct");
+
+// Vertex shader register (t#) the Objects buffer is bound to
+constexpr unsigned int ObjectTransformsRegister = 0;
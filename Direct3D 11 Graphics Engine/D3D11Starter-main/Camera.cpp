@@ -88,3 +88,9 @@ void Camera::UpdateProjectionMatrix(float aspectRatio)
 DirectX::XMFLOAT4X4 Camera::GetView() { return viewMatrix; }
 DirectX::XMFLOAT4X4 Camera::GetProjection() { return projMatrix; }
 std::shared_ptr<Transform> Camera::GetTransform() { return transform; }
+float Camera::GetFarClip() { return farClipDist; }
+
+Frustum Camera::GetFrustum()
+{
+	return Culling::FrustumFromMatrix(XMLoadFloat4x4(&viewMatrix) * XMLoadFloat4x4(&projMatrix));
+}
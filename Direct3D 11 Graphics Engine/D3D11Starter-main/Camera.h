@@ -2,6 +2,7 @@
 
 #include "Input.h"
 #include "Transform.h"
+#include "Culling.h"
 #include <DirectXMath.h>
 #include <memory>
 
@@ -22,6 +23,8 @@ public:
 	DirectX::XMFLOAT4X4 GetView();
 	DirectX::XMFLOAT4X4 GetProjection();
 	std::shared_ptr<Transform> GetTransform();
+	float GetFarClip();
+	Frustum GetFrustum(); // From the current view & projection
 
 private:
 	std::shared_ptr<Transform> transform;
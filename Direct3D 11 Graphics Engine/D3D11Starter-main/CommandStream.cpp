@@ -0,0 +1,125 @@
+#include "CommandStream.h"
+#include "RenderBackend.h"
+
+#include <cstring>
+
+// Annonymous namespace to hold variables/helpers
+// only accessible in this file
+namespace
+{
+	// Packets are padded so the next header (and any pointers in
+	// the packet after it) stay aligned
+	constexpr uint32_t PacketAlignment = 8;
+
+	template<typename T>
+	const T& Read(const uint8_t* arguments)
+	{
+		return *reinterpret_cast<const T*>(arguments);
+	}
+}
+
+template<typename T>
+uint8_t* CommandStream::Write(Command type, const T& packet, uint32_t extra)
+{
+	static_assert(std::is_trivially_copyable_v<T>, "Packets are copied as raw bytes");
+	static_assert(alignof(T) <= PacketAlignment, "Packets can't need more alignment than the stream keeps");
+
+	uint32_t size = (uint32_t)(sizeof(Header) + sizeof(T) + extra + PacketAlignment - 1) & ~(PacketAlignment - 1);
+	size_t offset = bytes.size();
+	bytes.resize(offset + size);
+
+	uint8_t* at = bytes.data() + offset;
+	Header header = { type, size };
+	memcpy(at, &header, sizeof(Header));
+	memcpy(at + sizeof(Header), &packet, sizeof(T));
+
+	commandCount++;
+	return at + sizeof(Header) + sizeof(T);
+}
+
+void CommandStream::Clear()
+{
+	bytes.clear();
+	commandCount = 0;
+	drawCount = 0;
+}
+
+void CommandStream::SetPipeline(const PipelineState* pipeline)
+{
+	Write(Command::SetPipeline, SetPipelinePacket{ pipeline });
+}
+
+void CommandStream::SetShadowMap(SimplePixelShader* ps, ID3D11ShaderResourceView* shadowMap, ID3D11SamplerState* sampler)
+{
+	Write(Command::SetShadowMap, SetShadowMapPacket{ ps, shadowMap, sampler });
+}
+
+void CommandStream::SetMaterial(Material* material, SimplePixelShader* ps)
+{
+	Write(Command::SetMaterial, SetMaterialPacket{ material, ps });
+}
+
+void CommandStream::SetConstants(ISimpleShader* shader, uint32_t bufferRegister, const void* data, uint32_t size)
+{
+	uint8_t* constants = Write(Command::SetConstants, SetConstantsPacket{ shader, bufferRegister, size }, size);
+	memcpy(constants, data, size);
+}
+
+void CommandStream::Draw(Mesh* mesh, Material* material, SimpleVertexShader* vs, SimplePixelShader* ps)
+{
+	Write(Command::Draw, DrawPacket{ mesh, material, vs, ps, 0, 0 });
+	drawCount++;
+}
+
+void CommandStream::DrawInstanced(Mesh* mesh, Material* material, SimplePixelShader* ps, uint32_t instanceCount, uint32_t startInstance)
+{
+	Write(Command::Draw, DrawPacket{ mesh, material, 0, ps, instanceCount, startInstance });
+	drawCount++;
+}
+
+// --------------------------------------------------------
+// Hands each packet to the backend, in recorded order
+// --------------------------------------------------------
+void CommandStream::Execute(RenderBackend& backend) const
+{
+	backend.BeginStream();
+
+	const uint8_t* at = bytes.data();
+	const uint8_t* end = at + bytes.size();
+	while (at < end)
+	{
+		const Header& header = Read<Header>(at);
+		const uint8_t* arguments = at + sizeof(Header);
+
+		switch (header.Type)
+		{
+		case Command::SetPipeline:
+			backend.SetPipeline(Read<SetPipelinePacket>(arguments));
+			break;
+
+		case Command::SetShadowMap:
+			backend.SetShadowMap(Read<SetShadowMapPacket>(arguments));
+			break;
+
+		case Command::SetMaterial:
+			backend.SetMaterial(Read<SetMaterialPacket>(arguments));
+			break;
+
+		case Command::SetConstants:
+			backend.SetConstants(Read<SetConstantsPacket>(arguments), arguments + sizeof(SetConstantsPacket));
+			break;
+
+		case Command::Draw:
+			backend.Draw(Read<DrawPacket>(arguments));
+			break;
+		}
+
+		at += header.Size;
+	}
+}
+
+void CommandStreams::Execute(std::span<const CommandStream> streams, RenderBackend& backend)
+{
+	for (const CommandStream& stream : streams)
+		stream.Execute(backend);
+}
@@ -0,0 +1,169 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+#include "JobSystem.h"
+#include "RenderQueue.h"
+
+class Mesh;
+class Material;
+class ISimpleShader;
+class SimpleVertexShader;
+class SimplePixelShader;
+struct PipelineState;
+struct ID3D11ShaderResourceView;
+struct ID3D11SamplerState;
+class RenderBackend;
+
+// --------------------------------------------------------
+// A recorded list of draw commands, replayed later into a
+// RenderBackend
+//
+// - Each command is a small POD packet (a header, then its
+//   arguments) packed into one byte array, so recording is
+//   only appends & never touches D3D
+// - Any thread may record into its own stream, so a pass's
+//   draws can be split into ranges recorded in parallel,
+//   then replayed in range order by the rendering thread
+// - Replaying hands each command to a RenderBackend, so
+//   nothing here depends on D3D (see RenderBackend.h)
+// - A stream assumes nothing is bound when it starts; the
+//   binds that repeat across streams are filtered out by
+//   PipelineStates & TrackedContext when replayed
+// - Everything a command points at must outlive the replay
+// --------------------------------------------------------
+class CommandStream
+{
+public:
+	enum class Command : uint32_t
+	{
+		SetPipeline,	// Shaders, input layout & render states
+		SetShadowMap,	// A pixel shader's shadow map & comparison sampler
+		SetMaterial,	// A material's textures & samplers (its tables)
+		SetConstants,	// One of a shader's constant buffers, set whole
+		Draw,			// Uploads constants, then draws a mesh (maybe instanced)
+	};
+
+	// Every packet starts with one of these, and is padded to its alignment
+	struct Header
+	{
+		Command Type;
+		uint32_t Size; // Of the whole packet, header included
+	};
+
+	struct SetPipelinePacket
+	{
+		const PipelineState* Pipeline;
+	};
+
+	struct SetShadowMapPacket
+	{
+		SimplePixelShader* PixelShader;
+		ID3D11ShaderResourceView* ShadowMap;
+		ID3D11SamplerState* Sampler;
+	};
+
+	struct SetMaterialPacket
+	{
+		Material* RenderMaterial;
+		SimplePixelShader* PixelShader;
+	};
+
+	// Followed by Size bytes of constants
+	struct SetConstantsPacket
+	{
+		ISimpleShader* Shader;
+		uint32_t Register;
+		uint32_t Size;
+	};
+
+	// Any of the material & shaders may be null; an InstanceCount of
+	// 0 is a plain indexed draw
+	struct DrawPacket
+	{
+		Mesh* RenderMesh;
+		Material* RenderMaterial;
+		SimpleVertexShader* VertexShader;
+		SimplePixelShader* PixelShader;
+		uint32_t InstanceCount;
+		uint32_t StartInstance;
+	};
+
+	// Recording
+	void Clear();
+	void SetPipeline(const PipelineState* pipeline);
+	void SetShadowMap(SimplePixelShader* ps, ID3D11ShaderResourceView* shadowMap, ID3D11SamplerState* sampler);
+	void SetMaterial(Material* material, SimplePixelShader* ps);
+	void SetConstants(ISimpleShader* shader, uint32_t bufferRegister, const void* data, uint32_t size);
+	void Draw(Mesh* mesh, Material* material, SimpleVertexShader* vs, SimplePixelShader* ps);
+	void DrawInstanced(Mesh* mesh, Material* material, SimplePixelShader* ps, uint32_t instanceCount, uint32_t startInstance);
+
+	// A whole buffer from its generated struct (see ShaderStructs.h)
+	template<typename T>
+	void SetConstants(ISimpleShader* shader, const T& data) { SetConstants(shader, T::Register, &data, sizeof(T)); }
+
+	// Replays every command in order
+	void Execute(RenderBackend& backend) const;
+
+	// Stats
+	size_t Bytes() const { return bytes.size(); }
+	uint32_t CommandCount() const { return commandCount; }
+	uint32_t DrawCount() const { return drawCount; }
+
+private:
+	std::vector<uint8_t> bytes;
+	uint32_t commandCount = 0;
+	uint32_t drawCount = 0;
+
+	// Appends a packet with extra bytes after it & returns where they go
+	template<typename T>
+	uint8_t* Write(Command type, const T& packet, uint32_t extra = 0);
+};
+
+namespace CommandStreams
+{
+	// Queue entries per recorded range - fewer aren't worth a job
+	constexpr uint32_t MinRecordRange = 64;
+
+	// Streams are replayed in order, as if recorded into one
+	void Execute(std::span<const CommandStream> streams, RenderBackend& backend);
+
+	// --------------------------------------------------------
+	// Splits a queue into ranges recorded on the job threads,
+	// each into its own stream, for replaying in range order
+	// - sameRun(a, b) says queue entries a & b are one draw
+	// - record(stream, begin, end) records the runs that start
+	//   in [begin, end), finishing the last even past end
+	// - So a range starting partway through a run (one
+	//   instanced draw) skips ahead to the next run
+	// --------------------------------------------------------
+	template<typename SameRun, typename Record>
+	void RecordInRanges(std::span<const RenderQueueEntry> queue, std::vector<CommandStream>& streams, SameRun&& sameRun, Record&& record)
+	{
+		uint32_t count = (uint32_t)queue.size();
+		uint32_t rangeCount = (count + MinRecordRange - 1) / MinRecordRange;
+		uint32_t maxRanges = JobSystem::ThreadCount() * 2;
+		if (rangeCount > maxRanges) rangeCount = maxRanges;
+		if (rangeCount == 0) rangeCount = 1;
+
+		streams.resize(rangeCount);
+		uint32_t rangeSize = (count + rangeCount - 1) / rangeCount;
+		JobSystem::ParallelFor(rangeCount, 1, [&](uint32_t first, uint32_t last)
+		{
+			for (uint32_t range = first; range < last; range++)
+			{
+				CommandStream& stream = streams[range];
+				stream.Clear();
+
+				size_t begin = (size_t)range * rangeSize;
+				size_t end = begin + rangeSize < count ? begin + rangeSize : count;
+				while (begin > 0 && begin < end && sameRun(begin - 1, begin))
+					begin++;
+				if (begin < end)
+					record(stream, begin, end);
+			}
+		});
+	}
+}
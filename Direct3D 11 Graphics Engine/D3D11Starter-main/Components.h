@@ -0,0 +1,47 @@
+#pragma once
+
+#include "ResourceHandles.h"
+
+// --------------------------------------------------------
+// Components stored in the scene Registry (see ECS.h)
+//
+// Keep these small and pointer-light: they live in dense
+// arrays that systems stream through every frame.
+// Transform (Transform.h) is also used directly as a component.
+// --------------------------------------------------------
+
+// What an entity looks like - both live in the Resources pools
+struct MeshRenderer
+{
+	MeshHandle RenderMesh;
+	MaterialHandle RenderMaterial;
+};
+
+// An entity's leaf in the scene's spatial index (see SpatialIndex.h)
+// - Refit whenever the entity's transform changes
+struct SpatialProxy
+{
+	uint32_t Proxy;
+};
+
+// Marks an entity whose mesh is drawn into the occlusion buffer
+// (see Occlusion.h) - best kept to a few big, solid meshes
+struct Occluder
+{
+};
+
+// Simple scripted motion applied in Game::Update
+enum class AnimationType
+{
+	Bob,			// Move up & down
+	Orbit,			// Move in a clockwise circle
+	Twist,			// Spin like a screw
+	Gyroscope,		// Rotate along the x & z-axis
+	Pulse,			// Bouncy uniform scaling
+	SquashStretch	// Squash & stretch along the y-axis
+};
+
+struct Animation
+{
+	AnimationType Type;
+};
@@ -0,0 +1,247 @@
+#include "Culling.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold variables/helpers
+// only accessible in this file
+namespace
+{
+	// Boxes [begin, end) - begin is a multiple of Lanes, and end may
+	// run into the padding (those results are dropped)
+	uint32_t TestBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint32_t begin, uint32_t end, uint8_t* visible)
+	{
+		// Each plane's components & their absolute values, splatted across the lanes
+		XMVECTOR planeX[6], planeY[6], planeZ[6], planeW[6];
+		XMVECTOR absX[6], absY[6], absZ[6];
+		for (int p = 0; p < 6; p++)
+		{
+			XMVECTOR plane = XMLoadFloat4(&frustum.Planes[p]);
+			planeX[p] = XMVectorSplatX(plane);
+			planeY[p] = XMVectorSplatY(plane);
+			planeZ[p] = XMVectorSplatZ(plane);
+			planeW[p] = XMVectorSplatW(plane);
+			absX[p] = XMVectorAbs(planeX[p]);
+			absY[p] = XMVectorAbs(planeY[p]);
+			absZ[p] = XMVectorAbs(planeZ[p]);
+		}
+
+		uint32_t visibleCount = 0;
+		XMVECTOR zero = XMVectorZero();
+		for (uint32_t i = begin; i < end; i += Culling::Lanes)
+		{
+			XMVECTOR cx = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(bounds.CenterX + i));
+			XMVECTOR cy = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(bounds.CenterY + i));
+			XMVECTOR cz = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(bounds.CenterZ + i));
+			XMVECTOR ex = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(bounds.ExtentX + i));
+			XMVECTOR ey = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(bounds.ExtentY + i));
+			XMVECTOR ez = XMLoadFloat4A(reinterpret_cast<const XMFLOAT4A*>(bounds.ExtentZ + i));
+
+			// Outside if the center is further behind a plane than the
+			// box reaches towards it: n.c + d + |n|.e < 0
+			XMVECTOR outside = XMVectorFalseInt();
+			for (int p = 0; p < 6; p++)
+			{
+				XMVECTOR distance = XMVectorMultiplyAdd(cx, planeX[p], XMVectorMultiplyAdd(cy, planeY[p], XMVectorMultiplyAdd(cz, planeZ[p], planeW[p])));
+				XMVECTOR reach = XMVectorMultiplyAdd(ex, absX[p], XMVectorMultiplyAdd(ey, absY[p], XMVectorMultiply(ez, absZ[p])));
+				outside = XMVectorOrInt(outside, XMVectorLess(XMVectorAdd(distance, reach), zero));
+			}
+
+			uint32_t lanes[4];
+			XMStoreInt4(lanes, outside);
+			for (uint32_t lane = 0; lane < Culling::Lanes && i + lane < bounds.Count; lane++)
+			{
+				visible[i + lane] = lanes[lane] ? 0 : 1;
+				visibleCount += visible[i + lane];
+			}
+		}
+
+		return visibleCount;
+	}
+}
+
+void BoundsSoA::Set(uint32_t index, const XMFLOAT3& center, const XMFLOAT3& extents)
+{
+	CenterX[index] = center.x;
+	CenterY[index] = center.y;
+	CenterZ[index] = center.z;
+	ExtentX[index] = extents.x;
+	ExtentY[index] = extents.y;
+	ExtentZ[index] = extents.z;
+}
+
+BoundingVolume Culling::ComputeBounds(const XMFLOAT3* positions, uint32_t count, uint32_t stride)
+{
+	BoundingVolume bounds = {};
+	if (count == 0)
+		return bounds;
+
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(positions);
+	XMVECTOR minimum = XMLoadFloat3(positions);
+	XMVECTOR maximum = minimum;
+	for (uint32_t i = 1; i < count; i++)
+	{
+		XMVECTOR position = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(bytes + (size_t)i * stride));
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
+	}
+
+	XMVECTOR center = (minimum + maximum) * 0.5f;
+	XMStoreFloat3(&bounds.Center, center);
+	XMStoreFloat3(&bounds.Extents, (maximum - minimum) * 0.5f);
+
+	// Sphere around the box's center, just big enough for the furthest point
+	float radiusSquared = 0.0f;
+	for (uint32_t i = 0; i < count; i++)
+	{
+		XMVECTOR position = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(bytes + (size_t)i * stride));
+		float distanceSquared = XMVectorGetX(XMVector3LengthSq(position - center));
+		if (distanceSquared > radiusSquared)
+			radiusSquared = distanceSquared;
+	}
+	bounds.Radius = sqrtf(radiusSquared);
+
+	return bounds;
+}
+
+// --------------------------------------------------------
+// Gribb & Hartmann: with row vectors, clip = v * M, so each
+// plane is a sum or difference of M's columns
+// --------------------------------------------------------
+Frustum Culling::FrustumFromMatrix(FXMMATRIX viewProjection)
+{
+	// Rows of the transpose are the columns
+	XMMATRIX columns = XMMatrixTranspose(viewProjection);
+
+	XMVECTOR planes[6] = {
+		columns.r[3] + columns.r[0],	// Left:   -w <= x
+		columns.r[3] - columns.r[0],	// Right:   x <= w
+		columns.r[3] + columns.r[1],	// Bottom: -w <= y
+		columns.r[3] - columns.r[1],	// Top:     y <= w
+		columns.r[2],					// Near:    0 <= z
+		columns.r[3] - columns.r[2],	// Far:     z <= w
+	};
+
+	Frustum frustum = {};
+	for (int p = 0; p < 6; p++)
+		XMStoreFloat4(&frustum.Planes[p], XMPlaneNormalize(planes[p]));
+	return frustum;
+}
+
+// --------------------------------------------------------
+// Works in the light's view space, where the shadow map is a
+// box & light travels along +z:
+// - Receivers are whatever the camera can see, bounded by
+//   the box around its frustum's corners
+// - Casters must be within both that box & the shadow map's
+//   sideways, and no further from the light than the last
+//   receiver (or the map's far plane)
+// - Anything nearer the light can still shade a receiver, so
+//   there's no near plane - it's left as one nothing is ever
+//   behind
+// --------------------------------------------------------
+bool Culling::ShadowCasterFrustum(FXMMATRIX lightView, CXMMATRIX lightProjection, CXMMATRIX cameraViewProjection, Frustum& casters)
+{
+	// The shadow map's box, undoing the orthographic projection
+	// (clip = light * scale + offset, to -1..1 sideways & 0..1 deep)
+	XMFLOAT4X4 projection;
+	XMStoreFloat4x4(&projection, lightProjection);
+	float mapMinX = (-1.0f - projection._41) / projection._11, mapMaxX = (1.0f - projection._41) / projection._11;
+	float mapMinY = (-1.0f - projection._42) / projection._22, mapMaxY = (1.0f - projection._42) / projection._22;
+	float mapMinZ = (0.0f - projection._43) / projection._33, mapMaxZ = (1.0f - projection._43) / projection._33;
+
+	// The camera frustum's corners, from clip space to the light's view space
+	XMMATRIX clipToLight = XMMatrixInverse(0, cameraViewProjection) * lightView;
+	XMVECTOR minimum = XMVectorReplicate(FLT_MAX);
+	XMVECTOR maximum = XMVectorReplicate(-FLT_MAX);
+	for (int corner = 0; corner < 8; corner++)
+	{
+		XMVECTOR clip = XMVectorSet(
+			(corner & 1) ? 1.0f : -1.0f,
+			(corner & 2) ? 1.0f : -1.0f,
+			(corner & 4) ? 1.0f : 0.0f,
+			1.0f);
+		XMVECTOR position = XMVector3TransformCoord(clip, clipToLight);
+		minimum = XMVectorMin(minimum, position);
+		maximum = XMVectorMax(maximum, position);
+	}
+	XMFLOAT3 receiversMin;
+	XMFLOAT3 receiversMax;
+	XMStoreFloat3(&receiversMin, minimum);
+	XMStoreFloat3(&receiversMax, maximum);
+
+	float minX = receiversMin.x > mapMinX ? receiversMin.x : mapMinX;
+	float maxX = receiversMax.x < mapMaxX ? receiversMax.x : mapMaxX;
+	float minY = receiversMin.y > mapMinY ? receiversMin.y : mapMinY;
+	float maxY = receiversMax.y < mapMaxY ? receiversMax.y : mapMaxY;
+	float maxZ = receiversMax.z < mapMaxZ ? receiversMax.z : mapMaxZ;
+	if (minX > maxX || minY > maxY || maxZ < mapMinZ || receiversMin.z > mapMaxZ)
+		return false;
+
+	// Light space planes (a, b, c, d) go to world space through the
+	// light's view: n.(p * V) + d = p.(V * n) + d
+	XMVECTOR planes[6] = {
+		XMVectorSet(1, 0, 0, -minX),	// Left:   minX <= x
+		XMVectorSet(-1, 0, 0, maxX),	// Right:     x <= maxX
+		XMVectorSet(0, 1, 0, -minY),	// Bottom: minY <= y
+		XMVectorSet(0, -1, 0, maxY),	// Top:       y <= maxY
+		XMVectorSet(0, 0, 0, 1),		// Near:   none (always in front)
+		XMVectorSet(0, 0, -1, maxZ),	// Far:       z <= maxZ
+	};
+
+	XMMATRIX toWorld = XMMatrixTranspose(lightView);
+	for (int p = 0; p < 6; p++)
+	{
+		XMVECTOR plane = XMVector4Transform(planes[p], toWorld);
+		XMStoreFloat4(&casters.Planes[p], p == 4 ? plane : XMPlaneNormalize(plane));
+	}
+	return true;
+}
+
+// --------------------------------------------------------
+// Arvo's method: the center moves with the matrix, and the
+// extents go through the absolute value of its rotation &
+// scale, so every axis only ever grows the box
+// --------------------------------------------------------
+void Culling::TransformBounds(const BoundingVolume& local, const XMFLOAT4X4& world, XMFLOAT3& center, XMFLOAT3& extents)
+{
+	XMMATRIX matrix = XMLoadFloat4x4(&world);
+	XMStoreFloat3(&center, XMVector3Transform(XMLoadFloat3(&local.Center), matrix));
+
+	XMMATRIX absolute;
+	absolute.r[0] = XMVectorAbs(matrix.r[0]);
+	absolute.r[1] = XMVectorAbs(matrix.r[1]);
+	absolute.r[2] = XMVectorAbs(matrix.r[2]);
+	absolute.r[3] = XMVectorZero();
+	XMStoreFloat3(&extents, XMVector3TransformNormal(XMLoadFloat3(&local.Extents), absolute));
+}
+
+BoundsSoA Culling::AllocateBounds(FrameAllocator& allocator, uint32_t count)
+{
+	uint32_t padded = (count + Lanes - 1) / Lanes * Lanes;
+	float* components[6];
+	for (float*& component : components)
+	{
+		component = static_cast<float*>(allocator.Allocate(sizeof(float) * padded, 16));
+		memset(component + count, 0, sizeof(float) * (padded - count));
+	}
+
+	return { components[0], components[1], components[2], components[3], components[4], components[5], count };
+}
+
+uint32_t Culling::CullBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint8_t* visible)
+{
+	// Batches are whole groups of Lanes boxes
+	uint32_t groups = (bounds.Count + Lanes - 1) / Lanes;
+	std::atomic<uint32_t> visibleCount = 0;
+	JobSystem::ParallelFor(groups, 256, [&](uint32_t begin, uint32_t end)
+	{
+		visibleCount += TestBoxes(frustum, bounds, begin * Lanes, end * Lanes, visible);
+	});
+	return visibleCount;
+}
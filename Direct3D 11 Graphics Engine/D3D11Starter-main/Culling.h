@@ -0,0 +1,76 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include "FrameAllocator.h"
+
+// --------------------------------------------------------
+// Bounding volumes & view frustum culling
+//
+// - Meshes keep local bounds (see Mesh::GetBounds()); each
+//   frame those are moved into world space as axis aligned
+//   boxes, stored one array per component so Lanes boxes
+//   are tested at once with DirectXMath's SIMD vectors
+// - Frustum planes point inward, so a box is outside as
+//   soon as it's fully behind any one of them
+// --------------------------------------------------------
+
+// A mesh's bounds in its own space
+struct BoundingVolume
+{
+	DirectX::XMFLOAT3 Center;	// Of both the box & the sphere
+	DirectX::XMFLOAT3 Extents;	// Half the box's size on each axis
+	float Radius;				// Sphere around Center
+};
+
+// Left, right, bottom, top, near & far - (a, b, c, d) with
+// normalized, inward facing normals
+struct Frustum
+{
+	DirectX::XMFLOAT4 Planes[6];
+};
+
+// World space boxes, one array per component
+// - Each array is padded to a multiple of Culling::Lanes &
+//   16 byte aligned; padding boxes are empty & never reported
+struct BoundsSoA
+{
+	float* CenterX;
+	float* CenterY;
+	float* CenterZ;
+	float* ExtentX;
+	float* ExtentY;
+	float* ExtentZ;
+	uint32_t Count;
+
+	void Set(uint32_t index, const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents);
+};
+
+namespace Culling
+{
+	constexpr uint32_t Lanes = 4; // Boxes per SIMD test
+
+	// Bounds of a set of points (a mesh's vertex positions), in their own space
+	BoundingVolume ComputeBounds(const DirectX::XMFLOAT3* positions, uint32_t count, uint32_t stride);
+
+	// Planes of a (row vector) view-projection matrix with D3D's 0-1 depth
+	Frustum FrustumFromMatrix(DirectX::FXMMATRIX viewProjection);
+
+	// Volume holding every object that can cast a shadow onto something
+	// the camera sees, for an orthographic (directional) shadow view
+	// - Returns false if the camera sees nothing the shadow map covers,
+	//   in which case there are no casters at all
+	bool ShadowCasterFrustum(DirectX::FXMMATRIX lightView, DirectX::CXMMATRIX lightProjection, DirectX::CXMMATRIX cameraViewProjection, Frustum& casters);
+
+	// World space box that contains local bounds under a world matrix
+	void TransformBounds(const BoundingVolume& local, const DirectX::XMFLOAT4X4& world, DirectX::XMFLOAT3& center, DirectX::XMFLOAT3& extents);
+
+	// Room for count boxes in a frame's arena
+	BoundsSoA AllocateBounds(FrameAllocator& allocator, uint32_t count);
+
+	// Sets visible[i] to 1 for each box that intersects the frustum &
+	// 0 for the rest, Lanes boxes at a time, split across the job system
+	// - Call from the main thread or a job
+	// - Returns how many are visible
+	uint32_t CullBoxes(const Frustum& frustum, const BoundsSoA& bounds, uint8_t* visible);
+}
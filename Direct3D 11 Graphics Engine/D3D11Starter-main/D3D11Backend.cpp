@@ -0,0 +1,165 @@
+#include "RenderBackend.h"
+#include "Graphics.h"
+#include "Mesh.h"
+#include "Material.h"
+#include "SimpleShader.h"
+#include "PipelineState.h"
+#include "TrackedContext.h"
+#include "UploadRing.h"
+#include "Vertex.h"
+
+#include "ImGui/imgui_impl_dx11.h"
+
+// Annonymous namespace to hold variables/helpers
+// only accessible in this file
+namespace
+{
+	constexpr SimpleShaderName ShadowMapName("ShadowMap");
+	constexpr SimpleShaderName ShadowSamplerName("ShadowSampler");
+}
+
+// --------------------------------------------------------
+// Each command makes the same calls the draw loops used to
+// make directly, so a replayed stream draws exactly what
+// the loop would have
+// --------------------------------------------------------
+void D3D11Backend::SetPipeline(const CommandStream::SetPipelinePacket& packet)
+{
+	PipelineStates::Apply(packet.Pipeline);
+}
+
+void D3D11Backend::SetShadowMap(const CommandStream::SetShadowMapPacket& packet)
+{
+	packet.PixelShader->SetShaderResourceView(packet.PixelShader->GetShaderResourceViewHandle(ShadowMapName), packet.ShadowMap);
+	packet.PixelShader->SetSamplerState(packet.PixelShader->GetSamplerHandle(ShadowSamplerName), packet.Sampler);
+}
+
+void D3D11Backend::SetMaterial(const CommandStream::SetMaterialPacket& packet)
+{
+	packet.RenderMaterial->BindResources(packet.PixelShader, Graphics::Context.Get());
+}
+
+void D3D11Backend::SetConstants(const CommandStream::SetConstantsPacket& packet, const void* data)
+{
+	packet.Shader->SetBufferData(packet.Register, data, packet.Size);
+}
+
+void D3D11Backend::Draw(const CommandStream::DrawPacket& packet)
+{
+	if (packet.RenderMaterial)
+		packet.RenderMaterial->BindParameters(Graphics::Context.Get());
+	if (packet.VertexShader)
+		packet.VertexShader->CopyAllBufferData();
+	if (packet.PixelShader)
+		packet.PixelShader->CopyAllBufferData();
+
+	if (packet.InstanceCount > 0)
+		packet.RenderMesh->SetAndDrawInstanced(packet.InstanceCount, packet.StartInstance);
+	else
+		packet.RenderMesh->SetAndDrawBuffers();
+}
+
+// --------------------------------------------------------
+// Frame level calls, as the renderer used to make them on
+// Graphics::Context (through TrackedContext where it filters)
+// --------------------------------------------------------
+void D3D11Backend::BeginFrame()
+{
+	// Nothing is known to be bound yet (ImGui & others use the context too)
+	PipelineStates::BeginFrame();
+	TrackedContext::BeginFrame();
+
+	// Reclaim ring space from frames the GPU has finished
+	if (uploadRing)
+		uploadRing->BeginFrame();
+}
+
+void D3D11Backend::EndFrame()
+{
+	// Fence this frame's ring allocations
+	if (uploadRing)
+		uploadRing->EndFrame();
+}
+
+void D3D11Backend::ClearTarget(ID3D11RenderTargetView* target, const float color[4])
+{
+	Graphics::Context->ClearRenderTargetView(target, color);
+}
+
+void D3D11Backend::ClearDepth(ID3D11DepthStencilView* depth)
+{
+	Graphics::Context->ClearDepthStencilView(depth, D3D11_CLEAR_DEPTH, 1.0f, 0);
+}
+
+void D3D11Backend::SetTargets(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depth)
+{
+	TrackedContext::SetRenderTargets(target ? 1 : 0, target ? &target : 0, depth);
+}
+
+void D3D11Backend::SetViewport(float width, float height)
+{
+	D3D11_VIEWPORT viewport = {};
+	viewport.Width = width;
+	viewport.Height = height;
+	viewport.MaxDepth = 1.0f;
+	Graphics::Context->RSSetViewports(1, &viewport);
+}
+
+void D3D11Backend::UpdateBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size)
+{
+	Graphics::Context->UpdateSubresource(buffer, 0, 0, data, 0, 0);
+}
+
+void* D3D11Backend::MapBuffer(ID3D11Buffer* buffer, uint32_t size)
+{
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(Graphics::Context->Map(buffer, 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		return 0;
+	return mapped.pData;
+}
+
+void D3D11Backend::UnmapBuffer(ID3D11Buffer* buffer)
+{
+	Graphics::Context->Unmap(buffer, 0);
+}
+
+void D3D11Backend::SetInstanceData(ID3D11Buffer* indices, uint32_t indexStride, ID3D11ShaderResourceView* transforms, uint32_t transformsRegister)
+{
+	TrackedContext::SetVertexBuffer(1, indices, indexStride, 0);
+	TrackedContext::SetShaderResources(TrackedContext::Vertex, transformsRegister, 1, &transforms);
+}
+
+void D3D11Backend::SetTexture(SimplePixelShader* ps, const char* textureName, ID3D11ShaderResourceView* texture, const char* samplerName, ID3D11SamplerState* sampler)
+{
+	ps->SetShaderResourceView(textureName, texture);
+	ps->SetSamplerState(samplerName, sampler);
+}
+
+void D3D11Backend::UnbindTextures()
+{
+	ID3D11ShaderResourceView* nullSRVs[128] = {};
+	TrackedContext::SetShaderResources(TrackedContext::Pixel, 0, 128, nullSRVs);
+}
+
+void D3D11Backend::DrawFullscreen(SimplePixelShader* ps)
+{
+	// Turn off the normal vertex & index buffers - the vertex
+	// shader makes the triangle from the vertex ids
+	TrackedContext::SetIndexBuffer(0, DXGI_FORMAT_R32_UINT, 0);
+	TrackedContext::SetVertexBuffer(0, 0, sizeof(Vertex), 0);
+
+	ps->CopyAllBufferData();
+	Graphics::Context->Draw(3, 0);
+}
+
+void D3D11Backend::DrawUI(ImDrawData* drawData)
+{
+	ImGui_ImplDX11_RenderDrawData(drawData);
+}
+
+void D3D11Backend::Present(bool vsync)
+{
+	Graphics::SwapChain->Present(
+		vsync ? 1 : 0,
+		vsync ? 0 : DXGI_PRESENT_ALLOW_TEARING);
+}
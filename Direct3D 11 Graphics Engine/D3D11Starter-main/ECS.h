@@ -0,0 +1,234 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <cstdint>
+#include <utility>
+#include <tuple>
+
+// --------------------------------------------------------
+// A small sparse-set entity-component store
+//
+// - Entities are 32-bit indices paired with a generation,
+//   so a stale handle to a destroyed entity is detected
+//   instead of silently aliasing whatever reused the slot
+// - Each component type lives in its own dense array, so
+//   iterating a component touches contiguous memory only
+// - Queries walk the dense array of the first component
+//   type and use the sparse index for the others
+// --------------------------------------------------------
+
+// Handle to an entity in a Registry
+struct Entity
+{
+	uint32_t Index = UINT32_MAX;
+	uint32_t Generation = 0;
+
+	bool IsNull() const { return Index == UINT32_MAX; }
+	bool operator==(const Entity& other) const { return Index == other.Index && Generation == other.Generation; }
+	bool operator!=(const Entity& other) const { return !(*this == other); }
+};
+
+// --------------------------------------------------------
+// Type-erased base so the registry can clean up every
+// pool when an entity is destroyed
+// --------------------------------------------------------
+class IComponentPool
+{
+public:
+	virtual ~IComponentPool() = default;
+	virtual void Remove(uint32_t entityIndex) = 0;
+	virtual bool Contains(uint32_t entityIndex) const = 0;
+	virtual size_t Size() const = 0;
+};
+
+// --------------------------------------------------------
+// Dense storage for one component type
+//
+// sparse[entityIndex] -> position in the dense arrays
+// dense entities[i] and data[i] always line up
+// --------------------------------------------------------
+template<typename T>
+class ComponentPool : public IComponentPool
+{
+public:
+	static constexpr uint32_t Invalid = UINT32_MAX;
+
+	template<typename... Args>
+	T& Add(Entity e, Args&&... args)
+	{
+		if (e.Index >= sparse.size())
+			sparse.resize(e.Index + 1, Invalid);
+
+		// Replace the existing component if there is one
+		if (sparse[e.Index] != Invalid)
+		{
+			data[sparse[e.Index]] = T(std::forward<Args>(args)...);
+			return data[sparse[e.Index]];
+		}
+
+		sparse[e.Index] = (uint32_t)data.size();
+		entities.push_back(e);
+		data.emplace_back(std::forward<Args>(args)...);
+		return data.back();
+	}
+
+	// Swap-and-pop so the dense arrays never have holes
+	void Remove(uint32_t entityIndex) override
+	{
+		if (!Contains(entityIndex))
+			return;
+
+		uint32_t slot = sparse[entityIndex];
+		uint32_t last = (uint32_t)data.size() - 1;
+		if (slot != last)
+		{
+			data[slot] = std::move(data[last]);
+			entities[slot] = entities[last];
+			sparse[entities[slot].Index] = slot;
+		}
+
+		data.pop_back();
+		entities.pop_back();
+		sparse[entityIndex] = Invalid;
+	}
+
+	bool Contains(uint32_t entityIndex) const override
+	{
+		return entityIndex < sparse.size() && sparse[entityIndex] != Invalid;
+	}
+
+	size_t Size() const override { return data.size(); }
+
+	T* TryGet(uint32_t entityIndex) { return Contains(entityIndex) ? &data[sparse[entityIndex]] : 0; }
+	T& Get(uint32_t entityIndex) { return data[sparse[entityIndex]]; }
+
+	// Raw dense access for systems that want to batch or split work
+	T* Data() { return data.data(); }
+	const Entity* Entities() const { return entities.data(); }
+
+	void Reserve(size_t count)
+	{
+		data.reserve(count);
+		entities.reserve(count);
+	}
+
+private:
+	std::vector<uint32_t> sparse;
+	std::vector<Entity> entities;
+	std::vector<T> data;
+};
+
+// --------------------------------------------------------
+// Owns all entities and component pools
+// --------------------------------------------------------
+class Registry
+{
+public:
+	Entity Create()
+	{
+		Entity e;
+		if (!freeList.empty())
+		{
+			e.Index = freeList.back();
+			freeList.pop_back();
+		}
+		else
+		{
+			e.Index = (uint32_t)generations.size();
+			generations.push_back(0);
+		}
+
+		e.Generation = generations[e.Index];
+		aliveCount++;
+		return e;
+	}
+
+	void Destroy(Entity e)
+	{
+		if (!IsAlive(e))
+			return;
+
+		for (auto& p : pools)
+		{
+			if (p) p->Remove(e.Index);
+		}
+
+		// Bumping the generation invalidates any handle still held elsewhere
+		generations[e.Index]++;
+		freeList.push_back(e.Index);
+		aliveCount--;
+	}
+
+	bool IsAlive(Entity e) const
+	{
+		return e.Index < generations.size() && generations[e.Index] == e.Generation;
+	}
+
+	size_t AliveCount() const { return aliveCount; }
+	size_t Capacity() const { return generations.size(); } // Highest entity index ever used + 1
+
+	template<typename T, typename... Args>
+	T& Add(Entity e, Args&&... args) { return Pool<T>().Add(e, std::forward<Args>(args)...); }
+
+	template<typename T>
+	void Remove(Entity e) { if (IsAlive(e)) Pool<T>().Remove(e.Index); }
+
+	template<typename T>
+	bool Has(Entity e) { return IsAlive(e) && Pool<T>().Contains(e.Index); }
+
+	// Returns null for dead entities or missing components
+	template<typename T>
+	T* TryGet(Entity e) { return IsAlive(e) ? Pool<T>().TryGet(e.Index) : 0; }
+
+	// Caller guarantees the component exists
+	template<typename T>
+	T& Get(Entity e) { return Pool<T>().Get(e.Index); }
+
+	template<typename T>
+	ComponentPool<T>& Pool()
+	{
+		uint32_t id = TypeId<T>();
+		if (id >= pools.size())
+			pools.resize(id + 1);
+		if (!pools[id])
+			pools[id] = std::make_unique<ComponentPool<T>>();
+		return *static_cast<ComponentPool<T>*>(pools[id].get());
+	}
+
+	// --------------------------------------------------------
+	// Calls func(Entity, First&, Rest&...) for every entity
+	// that has all of the listed components.  Iteration order
+	// is the dense order of the first component type, so put
+	// the most selective (or most touched) component first.
+	// --------------------------------------------------------
+	template<typename First, typename... Rest, typename Func>
+	void Each(Func&& func)
+	{
+		ComponentPool<First>& first = Pool<First>();
+		std::tuple<ComponentPool<Rest>&...> rest(Pool<Rest>()...);
+
+		size_t count = first.Size();
+		First* data = first.Data();
+		const Entity* ents = first.Entities();
+		for (size_t i = 0; i < count; i++)
+		{
+			uint32_t index = ents[i].Index;
+			if (!(std::get<ComponentPool<Rest>&>(rest).Contains(index) && ...))
+				continue;
+
+			func(ents[i], data[i], std::get<ComponentPool<Rest>&>(rest).Get(index)...);
+		}
+	}
+
+private:
+	std::vector<uint32_t> generations;
+	std::vector<uint32_t> freeList;
+	std::vector<std::unique_ptr<IComponentPool>> pools;
+	size_t aliveCount = 0;
+
+	// Sequential ids per component type, assigned on first use
+	static uint32_t NextTypeId() { static uint32_t next = 0; return next++; }
+	template<typename T>
+	static uint32_t TypeId() { static uint32_t id = NextTypeId(); return id; }
+};
@@ -0,0 +1,87 @@
+#include "FrameAllocator.h"
+
+FrameAllocator::FrameAllocator(size_t blockSize) :
+	blockSize(blockSize)
+{
+}
+
+FrameAllocator::~FrameAllocator()
+{
+	FreeBlocks();
+}
+
+// --------------------------------------------------------
+// Returns size bytes aligned to alignment (a power of 2)
+// - Spills into the next block (allocating one only if
+//   needed) when the current block is full
+// --------------------------------------------------------
+void* FrameAllocator::Allocate(size_t size, size_t alignment)
+{
+	while (true)
+	{
+		if (currentBlock < blocks.size())
+		{
+			Block& block = blocks[currentBlock];
+			uintptr_t base = (uintptr_t)block.Memory;
+			uintptr_t aligned = (base + offset + alignment - 1) & ~(uintptr_t)(alignment - 1);
+			size_t end = (size_t)(aligned - base) + size;
+
+			if (end <= block.Size)
+			{
+				bytesUsed += end - offset;
+				offset = end;
+				return (void*)aligned;
+			}
+
+			// Doesn't fit - move on to the next block
+			currentBlock++;
+			offset = 0;
+			continue;
+		}
+
+		AddBlock(size + alignment);
+	}
+}
+
+// --------------------------------------------------------
+// Rewinds the arena
+// - If last frame needed more than one block, they're
+//   merged into one, so every later frame is a single
+//   contiguous block
+// --------------------------------------------------------
+void FrameAllocator::Reset()
+{
+	if (blocks.size() > 1)
+	{
+		size_t total = Capacity();
+		FreeBlocks();
+		AddBlock(total);
+	}
+
+	currentBlock = 0;
+	offset = 0;
+	bytesUsed = 0;
+}
+
+size_t FrameAllocator::Capacity() const
+{
+	size_t total = 0;
+	for (const Block& b : blocks)
+		total += b.Size;
+	return total;
+}
+
+void FrameAllocator::AddBlock(size_t minimumSize)
+{
+	Block block;
+	block.Size = minimumSize > blockSize ? minimumSize : blockSize;
+	block.Memory = new unsigned char[block.Size];
+	blocks.push_back(block);
+}
+
+void FrameAllocator::FreeBlocks()
+{
+	for (Block& b : blocks)
+		delete[] b.Memory;
+	blocks.clear();
+}
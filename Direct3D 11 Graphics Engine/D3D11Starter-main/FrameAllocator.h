@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+// --------------------------------------------------------
+// Linear (bump) allocator for data that only lives for a
+// single frame
+//
+// - Allocate() just bumps an offset; nothing is freed
+//   individually and no destructors are run
+// - Reset() rewinds to the start but keeps the memory, so
+//   once the arena has grown to fit a frame it never
+//   touches the heap again
+// - Not thread safe - give each owner its own arena
+// --------------------------------------------------------
+class FrameAllocator
+{
+public:
+	explicit FrameAllocator(size_t blockSize = 64 * 1024);
+	~FrameAllocator();
+	FrameAllocator(const FrameAllocator&) = delete;
+	FrameAllocator& operator=(const FrameAllocator&) = delete;
+
+	void* Allocate(size_t size, size_t alignment = alignof(std::max_align_t));
+
+	// Uninitialized storage for count Ts
+	// - Only for types that don't need destructing
+	template<typename T>
+	std::span<T> AllocateArray(size_t count)
+	{
+		static_assert(std::is_trivially_destructible_v<T>, "FrameAllocator never runs destructors");
+		return std::span<T>(static_cast<T*>(Allocate(sizeof(T) * count, alignof(T))), count);
+	}
+
+	// Invalidates everything allocated since the last reset
+	void Reset();
+
+	size_t BytesUsed() const { return bytesUsed; }
+	size_t Capacity() const;
+
+private:
+	struct Block
+	{
+		unsigned char* Memory;
+		size_t Size;
+	};
+
+	std::vector<Block> blocks;
+	size_t blockSize;
+	size_t currentBlock = 0;
+	size_t offset = 0;
+	size_t bytesUsed = 0;
+
+	void AddBlock(size_t minimumSize);
+	void FreeBlocks();
+};
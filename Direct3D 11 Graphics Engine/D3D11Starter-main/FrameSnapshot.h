@@ -0,0 +1,150 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <span>
+#include "ResourceHandles.h"
+#include "Lights.h"
+#include "FrameAllocator.h"
+#include "RenderQueue.h"
+#include "CommandStream.h"
+#include "ShaderStructs.h"
+
+#include "ImGui/imgui.h"
+
+// --------------------------------------------------------
+// Immutable per-frame render data
+//
+// The game thread fills one of these at the end of Update,
+// then hands it to whoever renders (the render thread, or
+// Game::Draw directly when running single-threaded).  The
+// renderer only reads from the snapshot, never from live
+// game state, so the next frame can be simulated meanwhile.
+// --------------------------------------------------------
+
+// How many snapshots rotate between the game & render threads
+// - 2 lets the game thread run one frame ahead, 3 smooths out spikes
+constexpr int FrameSnapshotCount = 3;
+
+// One entity's worth of draw data
+struct DrawItem
+{
+	MeshHandle Mesh;
+	MaterialHandle Material;
+	DirectX::XMFLOAT4X4 World;
+	DirectX::XMFLOAT4X4 WorldInverseTranspose;
+};
+
+// A material's parameters as they were when the snapshot was built
+// - Only materials changed since the last snapshot are copied
+struct MaterialParameters
+{
+	Material* Target;
+	ShaderStructs::PixelShader::PerMaterial Data;
+};
+
+// Deep copy of ImGui's draw data, since ImGui reuses its
+// own draw lists as soon as the next NewFrame() starts
+// - The copies are kept & overwritten each frame, so once
+//   their buffers are big enough this doesn't allocate
+class ImGuiDrawSnapshot
+{
+public:
+	ImGuiDrawSnapshot() = default;
+	ImGuiDrawSnapshot(const ImGuiDrawSnapshot&) = delete;
+	ImGuiDrawSnapshot& operator=(const ImGuiDrawSnapshot&) = delete;
+
+	~ImGuiDrawSnapshot()
+	{
+		for (int i = 0; i < lists.Size; i++)
+			IM_DELETE(lists[i]);
+	}
+
+	void Capture(const ImDrawData* source)
+	{
+		// Grow the pool of copies if this frame has more windows
+		while (lists.Size < source->CmdListsCount)
+			lists.push_back(IM_NEW(ImDrawList)(source->CmdLists[lists.Size]->_Data));
+
+		for (int i = 0; i < source->CmdListsCount; i++)
+		{
+			const ImDrawList* src = source->CmdLists[i];
+			ImDrawList* dst = lists[i];
+			CopyVector(dst->CmdBuffer, src->CmdBuffer);
+			CopyVector(dst->IdxBuffer, src->IdxBuffer);
+			CopyVector(dst->VtxBuffer, src->VtxBuffer);
+			dst->Flags = src->Flags;
+		}
+
+		// Field by field, since ImVector's operator= frees & reallocates
+		drawData.Valid = source->Valid;
+		drawData.CmdListsCount = source->CmdListsCount;
+		drawData.TotalIdxCount = source->TotalIdxCount;
+		drawData.TotalVtxCount = source->TotalVtxCount;
+		drawData.DisplayPos = source->DisplayPos;
+		drawData.DisplaySize = source->DisplaySize;
+		drawData.FramebufferScale = source->FramebufferScale;
+		drawData.OwnerViewport = source->OwnerViewport;
+		drawData.CmdLists.resize(source->CmdListsCount);
+		for (int i = 0; i < source->CmdListsCount; i++)
+			drawData.CmdLists[i] = lists[i];
+	}
+
+	ImDrawData* GetDrawData() { return &drawData; }
+
+private:
+	ImDrawData drawData;
+	ImVector<ImDrawList*> lists;
+
+	// resize() only reallocates when growing past the capacity
+	template<typename T>
+	static void CopyVector(ImVector<T>& dst, const ImVector<T>& src)
+	{
+		dst.resize(src.Size);
+		if (src.Size > 0)
+			memcpy(dst.Data, src.Data, (size_t)src.Size * sizeof(T));
+	}
+};
+
+struct FrameSnapshot
+{
+	float TotalTime;
+	float ClearColor[4];
+	unsigned int Width;		// Of the back buffer (the window's size when built)
+	unsigned int Height;
+
+	// Camera
+	DirectX::XMFLOAT4X4 View;
+	DirectX::XMFLOAT4X4 Projection;
+	DirectX::XMFLOAT3 CameraPosition;
+
+	// Lights & shadows
+	std::span<Light> Lights;
+	DirectX::XMFLOAT4X4 LightView;
+	DirectX::XMFLOAT4X4 LightProjection;
+	int ShadowMapResolution; // Of the map that was current when built
+
+	// Shader variant to draw with (see ShaderLibrary.h)
+	uint32_t Permutation;
+	bool Instancing;
+
+	// Materials to upload before drawing
+	std::span<MaterialParameters> MaterialUpdates;
+
+	// Everything to draw this frame, and the order to submit it in
+	// (sorted by state then depth - see RenderQueue.h)
+	std::span<DrawItem> DrawItems;
+	std::span<RenderQueueEntry> Queue;	// What the camera can see
+	std::span<RenderQueueEntry> ShadowQueue; // What can shadow that (may be the same span as Queue)
+
+	// Both queues' draws, recorded in ranges - replayed in order
+	std::vector<CommandStream> SceneCommands;
+	std::vector<CommandStream> ShadowCommands;
+	RenderBackend* Backend; // What they (and the rest of the frame) are rendered through
+
+	// Post processing & UI
+	int BlurRadius;
+	ImGuiDrawSnapshot UI;
+
+	// Backs the spans above - reset when the slot is rebuilt
+	FrameAllocator Allocator;
+};
@@ -5,14 +5,22 @@
 #include "PathHelpers.h"
 #include "Window.h"
 #include "Transform.h"
-#include "GameEntity.h"
 #include "Camera.h"
 #include "SimpleShader.h"
 #include "Material.h"
 #include "Lights.h"
+#include "Resources.h"
+#include "ShaderLibrary.h"
+#include "PipelineState.h"
+#include "TrackedContext.h"
+#include "JobSystem.h"
+#include "Culling.h"
+#include "Benchmarks.h"
+#include "MemoryTracker.h"
 
 #include <DirectXMath.h>
 #include <memory> // Smart Pointers
+#include <cstring>
 
 // Needed for a helper function to load pre-compiled shader files
 #pragma comment(lib, "d3dcompiler.lib")
@@ -29,22 +37,111 @@
 // For the DirectX Math library
 using namespace DirectX;
 
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// World space box around a mesh under a world matrix
+	Aabb WorldBounds(MeshHandle meshHandle, const XMFLOAT4X4& world)
+	{
+		Mesh* mesh = Resources::Meshes.Get(meshHandle);
+		XMFLOAT3 center;
+		XMFLOAT3 extents;
+		Culling::TransformBounds(mesh ? mesh->GetBounds() : BoundingVolume{}, world, center, extents);
+		return {
+			{ center.x - extents.x, center.y - extents.y, center.z - extents.z },
+			{ center.x + extents.x, center.y + extents.y, center.z + extents.z } };
+	}
+
+	// Where the shadow queue's objects start in the transform buffer
+	// - Nothing was culled, so the two queues are one & share theirs
+	size_t ShadowObjectBase(const FrameSnapshot& frame)
+	{
+		return frame.ShadowQueue.data() == frame.Queue.data() ? 0 : frame.Queue.size();
+	}
+
+	// Applies an entity's scripted motion for this frame
+	void Animate(Transform& transform, const Animation& animation, float deltaTime, float totalTime)
+	{
+		switch (animation.Type)
+		{
+		case AnimationType::Bob:
+			transform.SetPosition(-8.5f, sin(totalTime) * 2 + 1, 0);
+			break;
+
+		case AnimationType::Orbit:
+			transform.SetPosition(-5 + sin(totalTime), 1.5f, cos(totalTime));
+			break;
+
+		case AnimationType::Twist:
+			transform.Rotate(0, deltaTime, 0);
+			break;
+
+		case AnimationType::Gyroscope:
+			transform.Rotate(deltaTime, 0, deltaTime);
+			break;
+
+		case AnimationType::Pulse:
+			transform.SetScale(abs(cos(totalTime)) + 0.1f, abs(cos(totalTime)) + 0.1f, abs(cos(totalTime)) + 0.1f);
+			break;
+
+		case AnimationType::SquashStretch:
+			transform.SetScale(1, abs(sin(totalTime)) + 0.2f, 1);
+			break;
+		}
+	}
+}
+
 // --------------------------------------------------------
 // Called once per program, after the window and graphics API
 // are initialized but before the game loop begins
 // --------------------------------------------------------
 void Game::Initialize()
 {
+	// Start the worker threads first so loading can use them
+	JobSystem::Initialize();
+
+	// Every frame snapshot starts out free for the game thread to fill
+	for (int i = 0; i < FrameSnapshotCount; i++)
+		freeQueue.Push(i);
+
 	// Initialize ImGui itself & platform/renderer backends
 	IMGUI_CHECKVERSION();
 	ImGui::CreateContext();
-	ImGui_ImplWin32_Init(Window::Handle());
-	ImGui_ImplDX11_Init(Graphics::Device.Get(), Graphics::Context.Get());
+	if (Graphics::IsHeadless())
+	{
+		// No window or context for the backends, but the UI is still
+		// built every frame, which needs the font atlas
+		ImGui::GetIO().Fonts->Build();
+	}
+	else
+	{
+		ImGui_ImplWin32_Init(Window::Handle());
+		ImGui_ImplDX11_Init(Graphics::Device.Get(), Graphics::Context.Get());
+	}
 	// Pick a style (uncomment one of these 3)
 	//ImGui::StyleColorsDark();
 	//ImGui::StyleColorsLight();
 	ImGui::StyleColorsClassic();
 	
+	// Shared constant buffers have to exist before any shader
+	// loads, or the shaders would create their own copies
+	CreateSharedConstantBuffers();
+
+	// Filters redundant binds on the immediate context
+	// - Headless runs have none (every frame goes to the null backend)
+	if (!Graphics::IsHeadless())
+		TrackedContext::Initialize(Graphics::Context.Get());
+
+	// Per-draw constants go through one big ring buffer where the
+	// driver supports binding offsets; otherwise each shader keeps
+	// updating its own buffers
+	if (!Graphics::IsHeadless() && uploadRing.Initialize(Graphics::Device, Graphics::Context, 8 * 1024 * 1024))
+	{
+		ISimpleShader::SetUploadRing(&uploadRing);
+		d3d11Backend.SetUploadRing(&uploadRing);
+	}
+
 	// Helper methods for loading shaders, creating some basic
 	// geometry to draw and some simple camera matrices.
 	//  - You'll be expanding and/or replacing these later
@@ -55,10 +152,8 @@ void Game::Initialize()
 	//  - Some of these, like the primitive topology & input layout, probably won't change
 	//  - Others, like setting shaders, will need to be moved elsewhere later
 	{
-		// Tell the input assembler (IA) stage of the pipeline what kind of
-		// geometric primitives (points, lines or triangles) we want to draw.  
-		// Essentially: "What kind of shape should the GPU draw with our vertices?"
-		Graphics::Context->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST); // (..._POINTLIST) (..._LINELIST) (..._LINESTRIP) (..._TRIANGLESTRIP) (..._TRIANGLEFAN)
+		// The kind of geometric primitives (points, lines or triangles) we
+		// draw is part of each PipelineState now (see PipelineState.h)
 
 		// Create the different cameras
 		frontCamera = std::make_shared<Camera>(XMFLOAT3(0.0f, 0.5f, -10.0f), // Initial starting position
@@ -153,10 +248,30 @@ void Game::Initialize()
 // --------------------------------------------------------
 Game::~Game()
 {
+	// Finish any queued frames before tearing anything down
+	StopRenderThread();
+
 	// ImGui clean up
-	ImGui_ImplDX11_Shutdown();
-	ImGui_ImplWin32_Shutdown();
+	if (!Graphics::IsHeadless())
+	{
+		ImGui_ImplDX11_Shutdown();
+		ImGui_ImplWin32_Shutdown();
+	}
 	ImGui::DestroyContext();
+
+	// Meshes, materials, shaders & textures are owned by the
+	// resource pools, so release them while the device still exists
+	Resources::ReleaseAll();
+	ShaderLibrary::Clear();
+	PipelineStates::Clear();
+	ISimpleShader::SetSharedConstantBuffer(PerPassData::Name, 0);
+	ISimpleShader::SetSharedConstantBuffer(PerFrameData::Name, 0);
+	ISimpleShader::SetSharedConstantBuffer(ShaderStructs::PixelShader::PerMaterial::Name, 0);
+	ISimpleShader::SetUploadRing(0);
+	uploadRing.ShutDown();
+	TrackedContext::ShutDown();
+
+	JobSystem::ShutDown();
 }
 
 // --------------------------------------------------------
@@ -164,11 +279,9 @@ Game::~Game()
 // --------------------------------------------------------
 void Game::CreateGeometry()
 {
-	// Load the SimpleShader objects
-	std::shared_ptr<SimpleVertexShader> vertexShader = std::make_shared<SimpleVertexShader>(
-		Graphics::Device, Graphics::Context, FixPath(L"VertexShader.cso").c_str());
-	std::shared_ptr<SimplePixelShader> pixelShader = std::make_shared<SimplePixelShader>(
-		Graphics::Device, Graphics::Context, FixPath(L"PixelShader.cso").c_str());
+	// Load the SimpleShader objects (shared with anything else that asks for them)
+	VertexShaderHandle vertexShader = ShaderLibrary::GetVertexShader(L"VertexShader");
+	PixelShaderHandle pixelShader = ShaderLibrary::GetPixelShader(L"PixelShader");
 
 	// UVs Pixel Shader
 	//std::shared_ptr<SimplePixelShader> uvsPS = std::make_shared<SimplePixelShader>(
@@ -184,14 +297,11 @@ void Game::CreateGeometry()
 	//	Graphics::Device, Graphics::Context, FixPath(L"CombinePS.cso").c_str());
 
 	// Sky box shaders
-	std::shared_ptr<SimpleVertexShader> skyVS = std::make_shared<SimpleVertexShader>(
-		Graphics::Device, Graphics::Context, FixPath(L"SkyVS.cso").c_str());
-	std::shared_ptr<SimplePixelShader> skyPS = std::make_shared<SimplePixelShader>(
-		Graphics::Device, Graphics::Context, FixPath(L"SkyPS.cso").c_str());
+	VertexShaderHandle skyVS = ShaderLibrary::GetVertexShader(L"SkyVS");
+	PixelShaderHandle skyPS = ShaderLibrary::GetPixelShader(L"SkyPS");
 
 	// Shadows Vertex Shader
-	shadowsVS = std::make_shared<SimpleVertexShader>(
-		Graphics::Device, Graphics::Context, FixPath(L"ShadowMapVS.cso").c_str());
+	shadowsVS = ShaderLibrary::GetVertexShader(L"ShadowMapVS");
 
 	// Create some temporary variables to represent colors
 	// - Not necessary, just makes things more readable
@@ -258,14 +368,25 @@ void Game::CreateGeometry()
 	entities.push_back(anotherHeart);
 	*/
 
-	// Initialize pointers to each 3D mesh
-	cubeMesh = std::make_shared<Mesh>("Cube", FixPath("../../Assets/Models/cube.obj").c_str());
-	cylinderMesh = std::make_shared<Mesh>("Cylinder", FixPath("../../Assets/Models/cylinder.obj").c_str());
-	helixMesh = std::make_shared<Mesh>("Helix", FixPath("../../Assets/Models/helix.obj").c_str());
-	quadMesh = std::make_shared<Mesh>("Quad", FixPath("../../Assets/Models/quad.obj").c_str());
-	doubleSidedQuadMesh = std::make_shared<Mesh>("Double-Sided Quad", FixPath("../../Assets/Models/quad_double_sided.obj").c_str());
-	sphereMesh = std::make_shared<Mesh>("Sphere", FixPath("../../Assets/Models/sphere.obj").c_str());
-	torusMesh = std::make_shared<Mesh>("Torus", FixPath("../../Assets/Models/torus.obj").c_str());
+	// Load each 3D mesh into the resource pool
+	// - OBJ parsing & buffer creation only touch the device, which is
+	//   free-threaded, so every mesh loads on its own job
+	struct { MeshHandle* handle; const char* name; const char* file; } meshLoads[] =
+	{
+		{ &cubeMesh, "Cube", "../../Assets/Models/cube.obj" },
+		{ &cylinderMesh, "Cylinder", "../../Assets/Models/cylinder.obj" },
+		{ &helixMesh, "Helix", "../../Assets/Models/helix.obj" },
+		{ &quadMesh, "Quad", "../../Assets/Models/quad.obj" },
+		{ &doubleSidedQuadMesh, "Double-Sided Quad", "../../Assets/Models/quad_double_sided.obj" },
+		{ &sphereMesh, "Sphere", "../../Assets/Models/sphere.obj" },
+		{ &torusMesh, "Torus", "../../Assets/Models/torus.obj" },
+	};
+
+	JobSystem::ParallelFor((uint32_t)ARRAYSIZE(meshLoads), 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t i = begin; i < end; i++)
+			*meshLoads[i].handle = Resources::LoadMesh(meshLoads[i].name, meshLoads[i].file);
+	});
 
 	// Add each mesh to the list
 	meshes.push_back(cubeMesh);
@@ -280,45 +401,12 @@ void Game::CreateGeometry()
 	//Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> arcadeFloorSRV;
 	//Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> arcadeFloorNormalSRV;
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blackTealMarbleSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blackTealMarbleNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blackTealMarbleRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blackTealMarbleMetalness;
-
 	//Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blueTravertineSRV;
 	//Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> blueTravertineNormalSRV;
 
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodDiagArrowsSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodDiagArrowsNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodDiagArrowsRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> woodDiagArrowsMetalness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> smoothedRockSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> smoothedRockNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> smoothedRockRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> smoothedRockMetalness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> turquoiseRustedMetalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> turquoiseRustedMetalNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> turquoiseRustedMetalRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> turquoiseRustedMetalMetalness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalTilesSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalTilesNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalTilesRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> metalTilesMetalness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> rustedPaintSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> rustedPaintNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> rustedPaintRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> rustedPaintMetalness;
-
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeNormalSRV;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeRoughness;
-	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> bronzeMetalness;
-
 	// Repeat for EACH texture to load from file (PNG preferable, but JPG also works)
+	// - These stay on the main thread: passing the context auto-generates
+	//   mips, and the immediate context isn't thread-safe
 	// Arcade floor texture
 	/*CreateWICTextureFromFile(Graphics::Device.Get(), // Graphics device
 		Graphics::Context.Get(), // The context for auto MOP
@@ -333,29 +421,13 @@ void Game::CreateGeometry()
 		arcadeFloorNormalSRV.GetAddressOf());*/
 
 	// Black & teal marble texture
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Marble009_1K-PNG_Color.png").c_str(), 
-		0, 
-		blackTealMarbleSRV.GetAddressOf());
+	TextureHandle blackTealMarbleSRV = Resources::LoadTexture(L"../../Assets/Textures/Marble009_1K-PNG_Color.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Marble009_1K-PNG_NormalDX.png").c_str(),
-		0,
-		blackTealMarbleNormalSRV.GetAddressOf());
+	TextureHandle blackTealMarbleNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/Marble009_1K-PNG_NormalDX.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Marble009_1K-PNG_Roughness.png").c_str(),
-		0,
-		blackTealMarbleRoughness.GetAddressOf());
+	TextureHandle blackTealMarbleRoughness = Resources::LoadTexture(L"../../Assets/Textures/Marble009_1K-PNG_Roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Marble009_1K-PNG_Metalness.png").c_str(),
-		0,
-		blackTealMarbleMetalness.GetAddressOf());
+	TextureHandle blackTealMarbleMetalness = Resources::LoadTexture(L"../../Assets/Textures/Marble009_1K-PNG_Metalness.png");
 
 	// Light blue travertine texture
 	/*CreateWICTextureFromFile(Graphics::Device.Get(),
@@ -371,157 +443,60 @@ void Game::CreateGeometry()
 		blueTravertineNormalSRV.GetAddressOf());*/
 
 	/* Wood floor(Diagonal arrows pattern) texture */
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/WoodFloor058_1K-PNG_Color.png").c_str(),
-		0,
-		woodDiagArrowsSRV.GetAddressOf());
+	TextureHandle woodDiagArrowsSRV = Resources::LoadTexture(L"../../Assets/Textures/WoodFloor058_1K-PNG_Color.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/WoodFloor058_1K-PNG_NormalDX.png").c_str(),
-		0,
-		woodDiagArrowsNormalSRV.GetAddressOf());
+	TextureHandle woodDiagArrowsNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/WoodFloor058_1K-PNG_NormalDX.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/WoodFloor058_1K-PNG_Roughness.png").c_str(),
-		0,
-		woodDiagArrowsRoughness.GetAddressOf());
+	TextureHandle woodDiagArrowsRoughness = Resources::LoadTexture(L"../../Assets/Textures/WoodFloor058_1K-PNG_Roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/WoodFloor058_1K-PNG_Metalness.png").c_str(),
-		0,
-		woodDiagArrowsMetalness.GetAddressOf());
+	TextureHandle woodDiagArrowsMetalness = Resources::LoadTexture(L"../../Assets/Textures/WoodFloor058_1K-PNG_Metalness.png");
 
 	/* Smoothed rock cliff texture */
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Rock015_1K-PNG_Color.png").c_str(),
-		0,
-		smoothedRockSRV.GetAddressOf());
+	TextureHandle smoothedRockSRV = Resources::LoadTexture(L"../../Assets/Textures/Rock015_1K-PNG_Color.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Rock015_1K-PNG_NormalDX.png").c_str(),
-		0,
-		smoothedRockNormalSRV.GetAddressOf());
+	TextureHandle smoothedRockNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/Rock015_1K-PNG_NormalDX.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Rock015_1K-PNG_Roughness.png").c_str(),
-		0,
-		smoothedRockRoughness.GetAddressOf());
+	TextureHandle smoothedRockRoughness = Resources::LoadTexture(L"../../Assets/Textures/Rock015_1K-PNG_Roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Rock015_1K-PNG_Metalness.png").c_str(),
-		0,
-		smoothedRockMetalness.GetAddressOf());
+	TextureHandle smoothedRockMetalness = Resources::LoadTexture(L"../../Assets/Textures/Rock015_1K-PNG_Metalness.png");
 
 	/* Metal with turquoise rust texture */
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Metal058C_1K-PNG_Color.png").c_str(),
-		0,
-		turquoiseRustedMetalSRV.GetAddressOf());
+	TextureHandle turquoiseRustedMetalSRV = Resources::LoadTexture(L"../../Assets/Textures/Metal058C_1K-PNG_Color.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Metal058C_1K-PNG_NormalDX.png").c_str(),
-		0,
-		turquoiseRustedMetalNormalSRV.GetAddressOf());
+	TextureHandle turquoiseRustedMetalNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/Metal058C_1K-PNG_NormalDX.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Metal058C_1K-PNG_Roughness.png").c_str(),
-		0,
-		turquoiseRustedMetalRoughness.GetAddressOf());
+	TextureHandle turquoiseRustedMetalRoughness = Resources::LoadTexture(L"../../Assets/Textures/Metal058C_1K-PNG_Roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/Metal058C_1K-PNG_Metalness.png").c_str(),
-		0,
-		turquoiseRustedMetalMetalness.GetAddressOf());
+	TextureHandle turquoiseRustedMetalMetalness = Resources::LoadTexture(L"../../Assets/Textures/Metal058C_1K-PNG_Metalness.png");
 
 	/* Offset metal tiles texture */
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/MetalPlates008_1K-PNG_Color.png").c_str(),
-		0,
-		metalTilesSRV.GetAddressOf());
+	TextureHandle metalTilesSRV = Resources::LoadTexture(L"../../Assets/Textures/MetalPlates008_1K-PNG_Color.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/MetalPlates008_1K-PNG_NormalDX.png").c_str(),
-		0,
-		metalTilesNormalSRV.GetAddressOf());
+	TextureHandle metalTilesNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/MetalPlates008_1K-PNG_NormalDX.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/MetalPlates008_1K-PNG_Roughness.png").c_str(),
-		0,
-		metalTilesRoughness.GetAddressOf());
+	TextureHandle metalTilesRoughness = Resources::LoadTexture(L"../../Assets/Textures/MetalPlates008_1K-PNG_Roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/MetalPlates008_1K-PNG_Metalness.png").c_str(),
-		0,
-		metalTilesMetalness.GetAddressOf());
+	TextureHandle metalTilesMetalness = Resources::LoadTexture(L"../../Assets/Textures/MetalPlates008_1K-PNG_Metalness.png");
 
 	/* Teal-painted metal with rust spots texture */
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/PaintedMetal006_1K-PNG_Color.png").c_str(),
-		0,
-		rustedPaintSRV.GetAddressOf());
+	TextureHandle rustedPaintSRV = Resources::LoadTexture(L"../../Assets/Textures/PaintedMetal006_1K-PNG_Color.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/PaintedMetal006_1K-PNG_NormalDX.png").c_str(),
-		0,
-		rustedPaintNormalSRV.GetAddressOf());
+	TextureHandle rustedPaintNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/PaintedMetal006_1K-PNG_NormalDX.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/PaintedMetal006_1K-PNG_Roughness.png").c_str(),
-		0,
-		rustedPaintRoughness.GetAddressOf());
+	TextureHandle rustedPaintRoughness = Resources::LoadTexture(L"../../Assets/Textures/PaintedMetal006_1K-PNG_Roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/PaintedMetal006_1K-PNG_Metalness.png").c_str(),
-		0,
-		rustedPaintMetalness.GetAddressOf());
+	TextureHandle rustedPaintMetalness = Resources::LoadTexture(L"../../Assets/Textures/PaintedMetal006_1K-PNG_Metalness.png");
 
 	/* Bronze texture */
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_albedo.png").c_str(),
-		0,
-		bronzeSRV.GetAddressOf());
+	TextureHandle bronzeSRV = Resources::LoadTexture(L"../../Assets/Textures/bronze_albedo.png");
 	// Normal map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_normals.png").c_str(),
-		0,
-		bronzeNormalSRV.GetAddressOf());
+	TextureHandle bronzeNormalSRV = Resources::LoadTexture(L"../../Assets/Textures/bronze_normals.png");
 	// Roughness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_roughness.png").c_str(),
-		0,
-		bronzeRoughness.GetAddressOf());
+	TextureHandle bronzeRoughness = Resources::LoadTexture(L"../../Assets/Textures/bronze_roughness.png");
 	// Metalness map
-	CreateWICTextureFromFile(Graphics::Device.Get(),
-		Graphics::Context.Get(),
-		FixPath(L"../../Assets/Textures/bronze_metal.png").c_str(),
-		0,
-		bronzeMetalness.GetAddressOf());
+	TextureHandle bronzeMetalness = Resources::LoadTexture(L"../../Assets/Textures/bronze_metal.png");
 		
 	// Create a sampler
-	Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler;
 	D3D11_SAMPLER_DESC sampleDescr{};
 	sampleDescr.AddressU = D3D11_TEXTURE_ADDRESS_WRAP; // Handle addresses outside 0-1 UV range
 	sampleDescr.AddressV = D3D11_TEXTURE_ADDRESS_WRAP;
@@ -529,7 +504,7 @@ void Game::CreateGeometry()
 	sampleDescr.Filter = D3D11_FILTER_ANISOTROPIC; // Handle sampling btw pixels //D3D11_FILTER_MIN_MAG_MIP_LINEAR; D3D11_FILTER_MIN_MAG_MIP_POINT
 	sampleDescr.MaxAnisotropy = 16;
 	sampleDescr.MaxLOD = D3D11_FLOAT32_MAX; // Mipmapping
-	Graphics::Device->CreateSamplerState(&sampleDescr, sampler.GetAddressOf());
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler = PipelineStates::GetSampler(sampleDescr);
 
 	// Create pointers to each different material
 	//cyanMaterial = std::make_shared<Material>(XMFLOAT4(0, 1, 1, 1), vertexShader, pixelShader, "Cyan"); 
@@ -545,12 +520,13 @@ void Game::CreateGeometry()
 	arcadeFloorMaterial->AddTextureSRV("SurfaceTexture", arcadeFloorSRV);
 	arcadeFloorMaterial->AddTextureSRV("NormalMap", arcadeFloorNormalSRV);*/
 
-	blackTealMarbleMaterial = std::make_shared<Material>("Black & Teal Marble", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	blackTealMarbleMaterial->AddSampler("BasicSampler", sampler);
-	blackTealMarbleMaterial->AddTextureSRV("SurfaceTexture", blackTealMarbleSRV);
-	blackTealMarbleMaterial->AddTextureSRV("NormalMap", blackTealMarbleNormalSRV);
-	blackTealMarbleMaterial->AddTextureSRV("RoughnessMap", blackTealMarbleRoughness);
-	blackTealMarbleMaterial->AddTextureSRV("MetalnessMap", blackTealMarbleMetalness);
+	blackTealMarbleMaterial = Resources::Materials.Create("Black & Teal Marble", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* blackTealMarble = Resources::Materials.Get(blackTealMarbleMaterial);
+	blackTealMarble->AddSampler("BasicSampler", sampler);
+	blackTealMarble->AddTextureSRV("SurfaceTexture", blackTealMarbleSRV);
+	blackTealMarble->AddTextureSRV("NormalMap", blackTealMarbleNormalSRV);
+	blackTealMarble->AddTextureSRV("RoughnessMap", blackTealMarbleRoughness);
+	blackTealMarble->AddTextureSRV("MetalnessMap", blackTealMarbleMetalness);
 
 	/*blueTravertineMaterial = std::make_shared<Material>("Light Blue Travertine", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader, XMFLOAT2(0.5f, 0.5f));
 	blueTravertineMaterial->AddSampler("BasicSampler", sampler);
@@ -562,19 +538,21 @@ void Game::CreateGeometry()
 	deepBlueTravertineMaterial->AddTextureSRV("SurfaceTexture", blueTravertineSRV);
 	deepBlueTravertineMaterial->AddTextureSRV("NormalMap", blueTravertineNormalSRV);*/
 
-	woodDiagArrowsMaterial = std::make_shared<Material>("Diagonal Arrows Wood Pattern", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	woodDiagArrowsMaterial->AddSampler("BasicSampler", sampler);
-	woodDiagArrowsMaterial->AddTextureSRV("SurfaceTexture", woodDiagArrowsSRV);
-	woodDiagArrowsMaterial->AddTextureSRV("NormalMap", woodDiagArrowsNormalSRV);
-	woodDiagArrowsMaterial->AddTextureSRV("RoughnessMap", woodDiagArrowsRoughness);
-	woodDiagArrowsMaterial->AddTextureSRV("MetalnessMap", woodDiagArrowsMetalness);
+	woodDiagArrowsMaterial = Resources::Materials.Create("Diagonal Arrows Wood Pattern", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* woodDiagArrows = Resources::Materials.Get(woodDiagArrowsMaterial);
+	woodDiagArrows->AddSampler("BasicSampler", sampler);
+	woodDiagArrows->AddTextureSRV("SurfaceTexture", woodDiagArrowsSRV);
+	woodDiagArrows->AddTextureSRV("NormalMap", woodDiagArrowsNormalSRV);
+	woodDiagArrows->AddTextureSRV("RoughnessMap", woodDiagArrowsRoughness);
+	woodDiagArrows->AddTextureSRV("MetalnessMap", woodDiagArrowsMetalness);
 	
-	smoothedRockMaterial = std::make_shared<Material>("Smoothed Rock Cliff", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	smoothedRockMaterial->AddSampler("BasicSampler", sampler);
-	smoothedRockMaterial->AddTextureSRV("SurfaceTexture", smoothedRockSRV);
-	smoothedRockMaterial->AddTextureSRV("NormalMap", smoothedRockNormalSRV);
-	smoothedRockMaterial->AddTextureSRV("RoughnessMap", smoothedRockRoughness);
-	smoothedRockMaterial->AddTextureSRV("MetalnessMap", smoothedRockMetalness);
+	smoothedRockMaterial = Resources::Materials.Create("Smoothed Rock Cliff", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* smoothedRock = Resources::Materials.Get(smoothedRockMaterial);
+	smoothedRock->AddSampler("BasicSampler", sampler);
+	smoothedRock->AddTextureSRV("SurfaceTexture", smoothedRockSRV);
+	smoothedRock->AddTextureSRV("NormalMap", smoothedRockNormalSRV);
+	smoothedRock->AddTextureSRV("RoughnessMap", smoothedRockRoughness);
+	smoothedRock->AddTextureSRV("MetalnessMap", smoothedRockMetalness);
 	
 	// *NOTE: Currently NOT affected by lights & has NO normal map*
 	/*comboMaterial = std::make_shared<Material>("Combination", XMFLOAT4(1, 1, 1, 1), vertexShader, combinePS);
@@ -582,33 +560,37 @@ void Game::CreateGeometry()
 	comboMaterial->AddTextureSRV("InitialTexture", blueTravertineSRV);
 	comboMaterial->AddTextureSRV("CombineTexture", arcadeFloorSRV);*/
 
-	turquoiseRustedMetalMaterial = std::make_shared<Material>("Metal With Turquoise Rust", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	turquoiseRustedMetalMaterial->AddSampler("BasicSampler", sampler);
-	turquoiseRustedMetalMaterial->AddTextureSRV("SurfaceTexture", turquoiseRustedMetalSRV);
-	turquoiseRustedMetalMaterial->AddTextureSRV("NormalMap", turquoiseRustedMetalNormalSRV);
-	turquoiseRustedMetalMaterial->AddTextureSRV("RoughnessMap", turquoiseRustedMetalRoughness);
-	turquoiseRustedMetalMaterial->AddTextureSRV("MetalnessMap", turquoiseRustedMetalMetalness);
-
-	metalTilesMaterial = std::make_shared<Material>("Offset Metal Tiles", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	metalTilesMaterial->AddSampler("BasicSampler", sampler);
-	metalTilesMaterial->AddTextureSRV("SurfaceTexture", metalTilesSRV);
-	metalTilesMaterial->AddTextureSRV("NormalMap", metalTilesNormalSRV);
-	metalTilesMaterial->AddTextureSRV("RoughnessMap", metalTilesRoughness);
-	metalTilesMaterial->AddTextureSRV("MetalnessMap", metalTilesMetalness);
-
-	rustedPaintMaterial = std::make_shared<Material>("Offset Metal Tiles", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	rustedPaintMaterial->AddSampler("BasicSampler", sampler);
-	rustedPaintMaterial->AddTextureSRV("SurfaceTexture", rustedPaintSRV);
-	rustedPaintMaterial->AddTextureSRV("NormalMap", rustedPaintNormalSRV);
-	rustedPaintMaterial->AddTextureSRV("RoughnessMap", rustedPaintRoughness);
-	rustedPaintMaterial->AddTextureSRV("MetalnessMap", rustedPaintMetalness);
-
-	bronzeMaterial = std::make_shared<Material>("Bronze", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
-	bronzeMaterial->AddSampler("BasicSampler", sampler);
-	bronzeMaterial->AddTextureSRV("SurfaceTexture", bronzeSRV);
-	bronzeMaterial->AddTextureSRV("NormalMap", bronzeNormalSRV);
-	bronzeMaterial->AddTextureSRV("RoughnessMap", bronzeRoughness);
-	bronzeMaterial->AddTextureSRV("MetalnessMap", bronzeMetalness);
+	turquoiseRustedMetalMaterial = Resources::Materials.Create("Metal With Turquoise Rust", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* turquoiseRustedMetal = Resources::Materials.Get(turquoiseRustedMetalMaterial);
+	turquoiseRustedMetal->AddSampler("BasicSampler", sampler);
+	turquoiseRustedMetal->AddTextureSRV("SurfaceTexture", turquoiseRustedMetalSRV);
+	turquoiseRustedMetal->AddTextureSRV("NormalMap", turquoiseRustedMetalNormalSRV);
+	turquoiseRustedMetal->AddTextureSRV("RoughnessMap", turquoiseRustedMetalRoughness);
+	turquoiseRustedMetal->AddTextureSRV("MetalnessMap", turquoiseRustedMetalMetalness);
+
+	metalTilesMaterial = Resources::Materials.Create("Offset Metal Tiles", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* metalTiles = Resources::Materials.Get(metalTilesMaterial);
+	metalTiles->AddSampler("BasicSampler", sampler);
+	metalTiles->AddTextureSRV("SurfaceTexture", metalTilesSRV);
+	metalTiles->AddTextureSRV("NormalMap", metalTilesNormalSRV);
+	metalTiles->AddTextureSRV("RoughnessMap", metalTilesRoughness);
+	metalTiles->AddTextureSRV("MetalnessMap", metalTilesMetalness);
+
+	rustedPaintMaterial = Resources::Materials.Create("Offset Metal Tiles", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* rustedPaint = Resources::Materials.Get(rustedPaintMaterial);
+	rustedPaint->AddSampler("BasicSampler", sampler);
+	rustedPaint->AddTextureSRV("SurfaceTexture", rustedPaintSRV);
+	rustedPaint->AddTextureSRV("NormalMap", rustedPaintNormalSRV);
+	rustedPaint->AddTextureSRV("RoughnessMap", rustedPaintRoughness);
+	rustedPaint->AddTextureSRV("MetalnessMap", rustedPaintMetalness);
+
+	bronzeMaterial = Resources::Materials.Create("Bronze", XMFLOAT4(1, 1, 1, 1), vertexShader, pixelShader);
+	Material* bronze = Resources::Materials.Get(bronzeMaterial);
+	bronze->AddSampler("BasicSampler", sampler);
+	bronze->AddTextureSRV("SurfaceTexture", bronzeSRV);
+	bronze->AddTextureSRV("NormalMap", bronzeNormalSRV);
+	bronze->AddTextureSRV("RoughnessMap", bronzeRoughness);
+	bronze->AddTextureSRV("MetalnessMap", bronzeMetalness);
 
 	// Put all the materials in a list
 	/*materials.push_back(cyanMaterial);
@@ -629,24 +611,43 @@ void Game::CreateGeometry()
 	materials.push_back(rustedPaintMaterial);
 	materials.push_back(bronzeMaterial);
 
-	// Create pointers to each 3D entity & add to the list for drawing
-	entities.push_back(std::make_shared<GameEntity>(quadMesh, woodDiagArrowsMaterial));
-	entities.push_back(std::make_shared<GameEntity>(cubeMesh, smoothedRockMaterial));
-	entities.push_back(std::make_shared<GameEntity>(cylinderMesh, blackTealMarbleMaterial));
-	entities.push_back(std::make_shared<GameEntity>(helixMesh, rustedPaintMaterial));
-	entities.push_back(std::make_shared<GameEntity>(doubleSidedQuadMesh, turquoiseRustedMetalMaterial));
-	entities.push_back(std::make_shared<GameEntity>(sphereMesh, metalTilesMaterial));
-	entities.push_back(std::make_shared<GameEntity>(torusMesh, bronzeMaterial));
+	// Create the floor entity - a resized quadMesh
+	Entity floor = scene.Create();
+	scene.Add<Transform>(floor).SetScale(12.0f, 1.0f, 12.0f);
+	scene.Add<MeshRenderer>(floor, MeshRenderer{ quadMesh, woodDiagArrowsMaterial });
+	scene.Add<Occluder>(floor);
 
-	// Resize the quadMesh "floor"
-	entities[0]->GetTransform()->SetScale(12.0f, 1.0f, 12.0f);
+	// Create each animated 3D entity
+	struct { MeshHandle mesh; MaterialHandle material; AnimationType animation; } animated[] =
+	{
+		{ cubeMesh, smoothedRockMaterial, AnimationType::Bob },
+		{ cylinderMesh, blackTealMarbleMaterial, AnimationType::Orbit },
+		{ helixMesh, rustedPaintMaterial, AnimationType::Twist },
+		{ doubleSidedQuadMesh, turquoiseRustedMetalMaterial, AnimationType::Gyroscope },
+		{ sphereMesh, metalTilesMaterial, AnimationType::Pulse },
+		{ torusMesh, bronzeMaterial, AnimationType::SquashStretch },
+	};
 
-	// Adjust the meshes' transforms to spread them out 
-	for (int i = 1; i < entities.size(); i++)
+	for (int i = 0; i < ARRAYSIZE(animated); i++)
 	{
-		entities[i]->GetTransform()->MoveAbsolute(float(-12 + 3.5 * i), 1.5f, 0); // Cast to a float to remove warning
+		Entity e = scene.Create();
+
+		// Adjust the meshes' transforms to spread them out 
+		scene.Add<Transform>(e).MoveAbsolute(float(-12 + 3.5 * (i + 1)), 1.5f, 0); // Cast to a float to remove warning
+		scene.Add<MeshRenderer>(e, MeshRenderer{ animated[i].mesh, animated[i].material });
+		scene.Add<Animation>(e, Animation{ animated[i].animation });
+
+		// The cube is solid, so it can hide what's behind it
+		if (animated[i].mesh == cubeMesh)
+			scene.Add<Occluder>(e);
 	}
 
+	// Everything drawn goes in the scene index
+	std::vector<Entity> drawn;
+	scene.Each<MeshRenderer, Transform>([&](Entity e, MeshRenderer&, Transform&) { drawn.push_back(e); });
+	for (Entity e : drawn)
+		InsertIntoSceneIndex(e);
+
 	// Lighting
 	//ambientTerm = XMFLOAT3(0.43f, 0.40f, 0.43f); // A bit darker than the background
 
@@ -665,14 +666,14 @@ void Game::CreateGeometry()
 		);
 
 	// Post process shaders
-	ppFullscrTriVS = std::make_shared<SimpleVertexShader>(Graphics::Device, Graphics::Context, FixPath(L"FullscrTriangleVS.cso").c_str());
+	ppFullscrTriVS = ShaderLibrary::GetVertexShader(L"FullscrTriangleVS");
 
-	ppBoxBlurPS = std::make_shared<SimplePixelShader>(Graphics::Device, Graphics::Context, FixPath(L"BoxBlurPS.cso").c_str());
+	ppBoxBlurPS = ShaderLibrary::GetPixelShader(L"BoxBlurPS");
 	
-	gaussianBlurPS = std::make_shared<SimplePixelShader>(Graphics::Device, Graphics::Context, FixPath(L"GaussianBlurPS.cso").c_str());
+	gaussianBlurPS = ShaderLibrary::GetPixelShader(L"GaussianBlurPS");
 
-	bloomExtractPS = std::make_shared<SimplePixelShader>(Graphics::Device, Graphics::Context, FixPath(L"BloomPS_Extract.cso").c_str());
-	bloomCombinePS = std::make_shared<SimplePixelShader>(Graphics::Device, Graphics::Context, FixPath(L"BloomPS_Combine.cso").c_str());
+	bloomExtractPS = ShaderLibrary::GetPixelShader(L"BloomPS_Extract");
+	bloomCombinePS = ShaderLibrary::GetPixelShader(L"BloomPS_Combine");
 
 	// Create render targets (resizable if window changes)
 	ResizePPResources();
@@ -684,7 +685,75 @@ void Game::CreateGeometry()
 	ppSampDesc.AddressW = D3D11_TEXTURE_ADDRESS_CLAMP;
 	ppSampDesc.Filter = D3D11_FILTER_MIN_MAG_MIP_LINEAR;
 	ppSampDesc.MaxLOD = D3D11_FLOAT32_MAX;
-	Graphics::Device->CreateSamplerState(&ppSampDesc, postProcSampler.GetAddressOf());
+	postProcSampler = PipelineStates::GetSampler(ppSampDesc);
+
+	// Default states, just the post process shaders
+	PipelineStateDesc ppDesc;
+	ppDesc.VertexShader = ppFullscrTriVS;
+	ppDesc.PixelShader = ppBoxBlurPS;
+	postProcessPipeline = PipelineStates::Get(ppDesc);
+}
+
+// --------------------------------------------------------
+// Creates the PerPass & PerFrame constant buffers and
+// registers them with SimpleShader, so every shader that
+// declares them binds these instead of its own copies
+// --------------------------------------------------------
+void Game::CreateSharedConstantBuffers()
+{
+	D3D11_BUFFER_DESC cbDesc = {};
+	cbDesc.Usage = D3D11_USAGE_DEFAULT;
+	cbDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+
+	cbDesc.ByteWidth = sizeof(PerPassData);
+	Graphics::Device->CreateBuffer(&cbDesc, 0, perPassBuffer.GetAddressOf());
+	ISimpleShader::SetSharedConstantBuffer(PerPassData::Name, perPassBuffer);
+
+	cbDesc.ByteWidth = sizeof(PerFrameData);
+	Graphics::Device->CreateBuffer(&cbDesc, 0, perFrameBuffer.GetAddressOf());
+	ISimpleShader::SetSharedConstantBuffer(PerFrameData::Name, perFrameBuffer);
+
+	// PerMaterial lives in each Material (see Material::BindParameters()),
+	// so shaders never own or upload it - this default just keeps the
+	// slot valid for anything drawn without a material
+	ShaderStructs::PixelShader::PerMaterial defaultMaterial = {};
+	defaultMaterial.colorTint = XMFLOAT4(1, 1, 1, 1);
+	defaultMaterial.uvScale = XMFLOAT2(1, 1);
+	D3D11_SUBRESOURCE_DATA initialData = {};
+	initialData.pSysMem = &defaultMaterial;
+
+	cbDesc.ByteWidth = sizeof(defaultMaterial);
+	Graphics::Device->CreateBuffer(&cbDesc, &initialData, defaultMaterialBuffer.GetAddressOf());
+	ISimpleShader::SetSharedConstantBuffer(ShaderStructs::PixelShader::PerMaterial::Name, defaultMaterialBuffer);
+}
+
+// --------------------------------------------------------
+// Uploads the camera for a render pass - once for every
+// draw in the pass, whichever shaders they use
+// --------------------------------------------------------
+void Game::SetPassConstants(RenderBackend& backend, const XMFLOAT4X4& view, const XMFLOAT4X4& projection, const XMFLOAT3& cameraPosition)
+{
+	PerPassData data = {};
+	data.view = view;
+	data.projection = projection;
+	data.currentCamPos = cameraPosition;
+	backend.UpdateBuffer(perPassBuffer.Get(), &data, sizeof(data));
+}
+
+// --------------------------------------------------------
+// Uploads the lights, light matrices & time - once a frame
+// --------------------------------------------------------
+void Game::SetFrameConstants(const FrameSnapshot& frame)
+{
+	PerFrameData data = {};
+	data.lightView = frame.LightView;
+	data.lightProj = frame.LightProjection;
+	data.time = frame.TotalTime;
+
+	size_t lightCount = frame.Lights.size() < MaxLights ? frame.Lights.size() : MaxLights;
+	memcpy(data.lights, frame.Lights.data(), sizeof(Light) * lightCount);
+
+	frame.Backend->UpdateBuffer(perFrameBuffer.Get(), &data, sizeof(data));
 }
 
 // --------------------------------------------------------
@@ -696,7 +765,6 @@ void Game::CreateShadowMap()
 	shadowDSV.Reset();
 	shadowSRV.Reset();
 	shadowSampler.Reset();
-	shadowRasterizer.Reset();
 
 	// Create the actual texture that will be the shadow map
 	D3D11_TEXTURE2D_DESC shadowDesc = {};
@@ -735,14 +803,17 @@ void Game::CreateShadowMap()
 		&srvDesc,
 		shadowSRV.GetAddressOf());
 
-	// Create a rasterizer state for depth biasing
-	D3D11_RASTERIZER_DESC shadowRastDesc = {};
-	shadowRastDesc.FillMode = D3D11_FILL_SOLID;
-	shadowRastDesc.CullMode = D3D11_CULL_BACK;
-	shadowRastDesc.DepthClipEnable = true;
-	shadowRastDesc.DepthBias = 1000; // Min. precision units, not world units!
-	shadowRastDesc.SlopeScaledDepthBias = 1.0f; // Bias more based on slope
-	Graphics::Device->CreateRasterizerState(&shadowRastDesc, &shadowRasterizer);
+	// Shadow vertex shader, no pixel shader & a rasterizer state for depth biasing
+	PipelineStateDesc shadowPipelineDesc;
+	shadowPipelineDesc.VertexShader = shadowsVS;
+	shadowPipelineDesc.Rasterizer.DepthBias = 1000; // Min. precision units, not world units!
+	shadowPipelineDesc.Rasterizer.SlopeScaledDepthBias = 1.0f; // Bias more based on slope
+	shadowPipeline = PipelineStates::Get(shadowPipelineDesc);
+
+	// Again with the instanced variant (if it can't be compiled this is
+	// the plain shader, which RenderShadowMap() checks for)
+	shadowPipelineDesc.VertexShader = ShaderLibrary::SelectVariant(shadowsVS, ShaderPermutation::Instanced);
+	shadowInstancedPipeline = PipelineStates::Get(shadowPipelineDesc);
 
 	// Comparison sampler
 	D3D11_SAMPLER_DESC shadowSampDesc = {};
@@ -752,7 +823,7 @@ void Game::CreateShadowMap()
 	shadowSampDesc.AddressV = D3D11_TEXTURE_ADDRESS_BORDER;
 	shadowSampDesc.AddressW = D3D11_TEXTURE_ADDRESS_BORDER;
 	shadowSampDesc.BorderColor[0] = 1.0f; // Only need the first component
-	Graphics::Device->CreateSamplerState(&shadowSampDesc, &shadowSampler);
+	shadowSampler = PipelineStates::GetSampler(shadowSampDesc);
 
 	// View & project. matr. as tho the camera were seeing from the light
 	XMMATRIX lightView = XMMatrixLookToLH(
@@ -858,8 +929,11 @@ void Game::RefreshImGui(float deltaTime)
 	io.DisplaySize.x = (float)Window::Width();
 	io.DisplaySize.y = (float)Window::Height();
 	// Reset the frame
-	ImGui_ImplDX11_NewFrame();
-	ImGui_ImplWin32_NewFrame();
+	if (!Graphics::IsHeadless())
+	{
+		ImGui_ImplDX11_NewFrame();
+		ImGui_ImplWin32_NewFrame();
+	}
 	ImGui::NewFrame();
 	// Determine new input capture
 	Input::SetKeyboardCapture(io.WantCaptureKeyboard);
@@ -874,9 +948,8 @@ void Game::RefreshImGui(float deltaTime)
 
 
 // Helper method called in Game::Update() for UI-creation
-void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
-	std::vector<std::shared_ptr<GameEntity>> entities,
-	std::vector<std::shared_ptr<Camera>> cameraViews,
+void Game::BuildUI(const std::vector<MeshHandle>& meshes,
+	const std::vector<std::shared_ptr<Camera>>& cameraViews,
 	std::shared_ptr<Camera> &activeCamera,
 	std::vector<Light> &lights)//DirectX::XMFLOAT3 &ambientTerm
 {
@@ -899,6 +972,9 @@ void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
 	// Checkbox
 	ImGui::Checkbox("Check it!", &check);						/***** Make Hide/Show Sky Box??? *****/
 
+	// Simulate the next frame while the previous one is being submitted
+	ImGui::Checkbox("Render Thread", &useRenderThread);
+
 	// Color Editor & Slider to adjust mesh tint & offset
 	//ImGui::ColorEdit4("Mesh Tint", &dataToCopy.tint.x);
 	//ImGui::SliderFloat3("Mesh Offset", &dataToCopy.offset.x, -1.0f, 1.0f);
@@ -909,13 +985,14 @@ void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
 		// Display the available meshes to inspect
 		for (int i = 0; i < meshes.size(); i++) // ARRAYSIZE(meshes) // Or meshes.size()???
 		{
-			ImGui::PushID(meshes[i].get());
+			Mesh* mesh = Resources::Meshes.Get(meshes[i]);
+			ImGui::PushID(mesh);
 
-			if (ImGui::CollapsingHeader(meshes[i]->GetMeshName()))
+			if (ImGui::CollapsingHeader(mesh->GetMeshName()))
 			{
-				ImGui::Text("Triangles: %u", meshes[i]->GetIndexCount() / 3);
-				ImGui::Text("Vertices: %u", meshes[i]->GetVertexCount());
-				ImGui::Text("Indices: %u", meshes[i]->GetIndexCount()); 
+				ImGui::Text("Triangles: %u", mesh->GetIndexCount() / 3);
+				ImGui::Text("Vertices: %u", mesh->GetVertexCount());
+				ImGui::Text("Indices: %u", mesh->GetIndexCount()); 
 			}
 
 			ImGui::PopID();
@@ -925,40 +1002,44 @@ void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
 	// Make a tab to display all entities' transform data 
 	if (ImGui::CollapsingHeader("Entities:"))
 	{
-		for (int i = 0; i < entities.size(); i++)
+		ImGui::Text("Alive: %u", (unsigned int)scene.AliveCount());
+
+		scene.Each<Transform, MeshRenderer>([&](Entity e, Transform& entTransform, MeshRenderer& renderer)
 		{
 			// Push unique internal ID to support multiple widgets with the same name
-			ImGui::PushID(entities[i].get());
+			ImGui::PushID((int)e.Index);
 
-			if (ImGui::TreeNode("Node", "Entity %u", i))
+			if (ImGui::TreeNode("Node", "Entity %u", e.Index))
 			{
-				ImGui::Text("Mesh Index Count: %u", entities[i]->GetMesh()->GetIndexCount());
+				ImGui::Text("Mesh Index Count: %u", Resources::Meshes.Get(renderer.RenderMesh)->GetIndexCount());
 
-				std::shared_ptr<Transform> entTransform = entities[i]->GetTransform(); 
-				XMFLOAT3 entPosition = entTransform->GetPosition();
-				XMFLOAT3 entRotation = entTransform->GetPitchYawRoll();
-				XMFLOAT3 entScale = entTransform->GetScale();
+				XMFLOAT3 entPosition = entTransform.GetPosition();
+				XMFLOAT3 entRotation = entTransform.GetPitchYawRoll();
+				XMFLOAT3 entScale = entTransform.GetScale();
 
 				if (ImGui::DragFloat3("Position", &entPosition.x, 0.1f))
 				{
-					entTransform->SetPosition(entPosition);
+					entTransform.SetPosition(entPosition);
+					RefitInSceneIndex(e);
 				}
 
 				if (ImGui::DragFloat3("Rotation (rad.)", &entRotation.x, 0.1f))
 				{
-					entTransform->SetRotation(entRotation);
+					entTransform.SetRotation(entRotation);
+					RefitInSceneIndex(e);
 				}
 
 				if (ImGui::DragFloat3("Scale", &entScale.x, 0.1f))
 				{
-					entTransform->SetScale(entScale);
+					entTransform.SetScale(entScale);
+					RefitInSceneIndex(e);
 				}
 
 				ImGui::TreePop();
 			}
 
 			ImGui::PopID();
-		}
+		});
 	}
 
 	// Make a tab to display the available cameras to view from 
@@ -986,37 +1067,40 @@ void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
 	{
 		for (int i = 0; i < materials.size(); i++)
 		{
+			Material* material = Resources::Materials.Get(materials[i]);
+
 			// Support multiple widgets with the same name
-			ImGui::PushID(materials[i].get());
+			ImGui::PushID(material);
 
-			ImGui::Text(materials[i]->GetMaterialName());
+			ImGui::Text(material->GetMaterialName());
+			ImGui::Text("Parameter uploads: %llu", material->GetParameterUploads());
 
 			// Adjust the color tint
-			DirectX::XMFLOAT4 matColor = materials[i]->GetColorTint();
+			DirectX::XMFLOAT4 matColor = material->GetColorTint();
 			if (ImGui::ColorEdit4("Color Tint", &matColor.x))
 			{
-				materials[i]->SetColorTint(matColor);
+				material->SetColorTint(matColor);
 			}
 
 			// Adjust the UV scale & offset of the material
-			XMFLOAT2 uvScale = materials[i]->GetUVScale();
-			XMFLOAT2 uvOffset = materials[i]->GetUVOffset();
+			XMFLOAT2 uvScale = material->GetUVScale();
+			XMFLOAT2 uvOffset = material->GetUVOffset();
 
 			if (ImGui::DragFloat2("UV Scale", &uvScale.x, 0.1f))
 			{
-				materials[i]->SetUVScale(uvScale);
+				material->SetUVScale(uvScale);
 			}
 
 			if (ImGui::DragFloat2("UV Offset", &uvOffset.x, 0.1f))
 			{
-				materials[i]->SetUVOffset(uvOffset);
+				material->SetUVOffset(uvOffset);
 			}
 
 			// Display all the textures used in this material
-			for (auto& t : materials[i]->GetTextureSRVMap())
+			for (auto& t : material->GetTextureSRVMap())
 			{
 				ImGui::Text(t.first.c_str());
-				ImGui::Image(unsigned long long(t.second.Get()), ImVec2(256, 256)); // *NOTE:* static_cast<void*> NOR <ImTextureID> were working
+				ImGui::Image(unsigned long long(Resources::GetSRV(t.second)), ImVec2(256, 256)); // *NOTE:* static_cast<void*> NOR <ImTextureID> were working
 			}
 			ImGui::Spacing();
 
@@ -1038,27 +1122,14 @@ void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
 		// Directional, point, & spot lights
 		for (int i = 0; i < lights.size(); i++) 
 		{
-			std::string lightType = " Light (%u)";
-
-			switch (lights[i].Type)
-			{
-				case LIGHT_TYPE_DIRECTIONAL:
-					lightType = "Directional" + lightType;
-					break;
-
-				case LIGHT_TYPE_POINT:
-					lightType = "Point" + lightType;
-					break;
-
-				case LIGHT_TYPE_SPOT:
-					lightType = "Spot" + lightType;
-					break;
-			}
+			// Indexed by LIGHT_TYPE_*, so no string is built per light per frame
+			static const char* lightTypeNames[] = { "Directional", "Point", "Spot" };
+			const char* lightType = lights[i].Type >= 0 && lights[i].Type < (int)ARRAYSIZE(lightTypeNames) ? lightTypeNames[lights[i].Type] : "";
 
 			// Support multiple widgets with the same name
 			ImGui::PushID(&lights[i]);
 
-			if (ImGui::TreeNode("Light Node", lightType.c_str(), i))
+			if (ImGui::TreeNode("Light Node", "%s Light (%u)", lightType, i))
 			{
 				ImGui::ColorEdit3("Color", &lights[i].Color.x);
 				ImGui::SliderFloat("Intensity", &lights[i].Intensity, 0.0f, 5.0f);
@@ -1115,6 +1186,114 @@ void Game::BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
 		ImGui::SliderFloat("Bloom Intensity", &bloomIntensLvl, 0, 10);
 	}
 
+	// Make a tab to show what the camera's frustum culls
+	if (ImGui::CollapsingHeader("Culling:"))
+	{
+		int mode = (int)cullingMode;
+		ImGui::RadioButton("Off", &mode, (int)CullingMode::Off); ImGui::SameLine();
+		ImGui::RadioButton("Linear", &mode, (int)CullingMode::Linear); ImGui::SameLine();
+		ImGui::RadioButton("Tree", &mode, (int)CullingMode::Tree);
+		cullingMode = (CullingMode)mode;
+
+		ImGui::Text("Visible: %u", lastVisibleCount);
+		ImGui::Text("Culled: %u", lastCulledCount);
+
+		ImGui::Checkbox("Occlusion Culling", &occlusionCulling);
+		ImGui::Text("Occluded: %u (%u occluder triangles)", lastOccludedCount, occlusionBuffer.TriangleCount());
+		ImGui::Text("Shadow casters: %u", lastCasterCount);
+		ImGui::Text("Scene index: %zu proxies, height %d", sceneIndex.ProxyCount(), sceneIndex.Height());
+	}
+
+	// Make a tab for choosing which shader permutation the scene uses
+	if (ImGui::CollapsingHeader("Shaders:"))
+	{
+		ImGui::Checkbox("Shadows", &shadowsEnabled);
+		ImGui::Checkbox("Specialize Light Count", &specializeLightCount);
+		ImGui::Checkbox("Instancing", &useInstancing);
+		ImGui::Text("Main pass: %u objects in %u draw calls", lastFrameObjects.load(), lastFrameDrawCalls.load());
+
+		ImGui::Text("Library: %zu keys -> %zu shaders (%zu compiled at run time)",
+			ShaderLibrary::EntryCount(), ShaderLibrary::ShaderCount(), ShaderLibrary::CompiledCount());
+
+		PipelineStates::FrameStats stats = PipelineStates::LastFrameStats();
+		ImGui::Text("Pipelines: %zu (%zu state objects)", PipelineStates::PipelineCount(), PipelineStates::StateObjectCount());
+		ImGui::Text("Last frame: %llu applies, %llu switches, %llu context calls", stats.Applies, stats.Switches, stats.ContextCalls);
+
+		// Redundant binds are dropped by TrackedContext
+		bool filterBinds = TrackedContext::IsFiltering();
+		if (ImGui::Checkbox("Filter Redundant Binds", &filterBinds))
+			TrackedContext::SetFiltering(filterBinds);
+		TrackedContext::FrameStats binds = TrackedContext::LastFrameStats();
+		ImGui::Text("Binds last frame: %llu issued, %llu filtered", binds.Issued, binds.Filtered);
+	}
+
+	// Make a tab to show how much constant buffer data is actually uploaded
+	if (ImGui::CollapsingHeader("Constant Buffers:"))
+	{
+		// Counters are written by whichever thread renders, so let it go idle first
+		if (ImGui::Button("Reset Counters"))
+		{
+			FlushRenderThread();
+			Resources::VertexShaders.Each([](VertexShaderHandle, SimpleVertexShader& s) { s.ResetUploadStats(); });
+			Resources::PixelShaders.Each([](PixelShaderHandle, SimplePixelShader& s) { s.ResetUploadStats(); });
+			uploadRing.ResetStats();
+		}
+
+		// Upload ring (switching needs the render thread idle, as it reads the setting)
+		if (!uploadRing.IsInitialized())
+			ImGui::Text("Upload ring: not supported (no constant buffer offsets)");
+		else
+		{
+			if (ImGui::Checkbox("Upload Ring", &useUploadRing))
+			{
+				FlushRenderThread();
+				ISimpleShader::SetUploadRing(useUploadRing ? &uploadRing : 0);
+			}
+
+			const UploadRing::Stats& ringStats = uploadRing.GetStats();
+			ImGui::Text("Ring: %.1f / %.1f KB in use", uploadRing.BytesInUse() / 1024.0, uploadRing.Capacity() / 1024.0);
+			ImGui::Text("Ring uploads: %llu (%.1f KB), stalls: %llu, failures: %llu",
+				ringStats.Uploads, ringStats.BytesUploaded / 1024.0, ringStats.Stalls, ringStats.Failures);
+		}
+
+		if (ImGui::BeginTable("Uploads", 6, ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg))
+		{
+			ImGui::TableSetupColumn("Shader");
+			ImGui::TableSetupColumn("Uploads");
+			ImGui::TableSetupColumn("Partial");
+			ImGui::TableSetupColumn("Skipped");
+			ImGui::TableSetupColumn("Unchanged Sets");
+			ImGui::TableSetupColumn("KB Sent");
+			ImGui::TableHeadersRow();
+
+			auto row = [](const char* stage, uint32_t index, const SimpleUploadStats& stats)
+			{
+				ImGui::TableNextRow();
+				ImGui::TableNextColumn(); ImGui::Text("%s %u", stage, index);
+				ImGui::TableNextColumn(); ImGui::Text("%llu", stats.Uploads);
+				ImGui::TableNextColumn(); ImGui::Text("%llu", stats.PartialUploads);
+				ImGui::TableNextColumn(); ImGui::Text("%llu", stats.UploadsSkipped);
+				ImGui::TableNextColumn(); ImGui::Text("%llu", stats.UnchangedSets);
+				ImGui::TableNextColumn(); ImGui::Text("%.1f", stats.BytesSent / 1024.0);
+			};
+			Resources::VertexShaders.Each([&](VertexShaderHandle h, SimpleVertexShader& s) { row("VS", h.Index(), s.GetUploadStats()); });
+			Resources::PixelShaders.Each([&](PixelShaderHandle h, SimplePixelShader& s) { row("PS", h.Index(), s.GetUploadStats()); });
+			ImGui::EndTable();
+		}
+	}
+
+	// Make a tab to check the frame stays allocation free
+	if (ImGui::CollapsingHeader("Memory:"))
+	{
+		MemoryTracker::BuildUI();
+	}
+
+	// Make a tab to run the engine's micro benchmarks
+	if (ImGui::CollapsingHeader("Benchmarks:"))
+	{
+		Benchmarks::BuildUI();
+	}
+
 	// End the current window
 	ImGui::End(); 
 }
@@ -1132,12 +1311,14 @@ void Game::Update(float deltaTime, float totalTime)
 	int prevShadowMapRes = shadowMapResolution;
 
 	// Create ImGui UI
-	//BuildUI(meshes, entities, cameraViews, activeCamera, lights, ambientTerm);
-	BuildUI(meshes, entities, cameraViews, activeCamera, lights);
+	//BuildUI(meshes, cameraViews, activeCamera, lights, ambientTerm);
+	BuildUI(meshes, cameraViews, activeCamera, lights);
 
 	// Recreate the shadow map if the res. changed
 	if (prevShadowMapRes != shadowMapResolution)
 	{
+		// Queued frames still render into the old shadow map
+		FlushRenderThread();
 		CreateShadowMap();
 	}
 
@@ -1150,12 +1331,23 @@ void Game::Update(float deltaTime, float totalTime)
 	//heart->GetTransform()->Rotate(0, 0, deltaTime); // Spin about the origin
 	//rgbTriangle->GetTransform()->SetScale(abs(cos(totalTime)), abs(cos(totalTime)), 1); // Bouncy scaling
 
-	entities[1]->GetTransform()->SetPosition(-8.5f, sin(totalTime) * 2 + 1, 0); // Move up & down
-	entities[2]->GetTransform()->SetPosition(-5 + sin(totalTime), 1.5f, cos(totalTime)); // Move in a clockwise circle
-	entities[3]->GetTransform()->Rotate(0, deltaTime, 0); // Spin/twist like a screw
-	entities[4]->GetTransform()->Rotate(deltaTime, 0, deltaTime); // Rotate along the x & z-axis like a gyroscope
-	entities[5]->GetTransform()->SetScale(abs(cos(totalTime)) + 0.1f, abs(cos(totalTime)) + 0.1f, abs(cos(totalTime)) + 0.1f); // Bouncy scaling
-	entities[6]->GetTransform()->SetScale(1, abs(sin(totalTime)) + 0.2f, 1); // Squash & stretch along the y-axis
+	// Animate in parallel straight off the dense Animation array
+	// - Each entity only touches its own Transform, so batches never overlap
+	ComponentPool<Animation>& animations = scene.Pool<Animation>();
+	ComponentPool<Transform>& transforms = scene.Pool<Transform>();
+	JobSystem::ParallelFor((uint32_t)animations.Size(), 256, [&](uint32_t begin, uint32_t end)
+	{
+		const Entity* animated = animations.Entities();
+		for (uint32_t i = begin; i < end; i++)
+		{
+			Transform* transform = transforms.TryGet(animated[i].Index);
+			if (transform)
+				Animate(*transform, animations.Data()[i], deltaTime, totalTime);
+		}
+	});
+
+	// Only what moved is refit in the scene index
+	scene.Each<Animation, SpatialProxy>([&](Entity e, Animation&, SpatialProxy&) { RefitInSceneIndex(e); });
 
 	// Update the camera each frame
 	activeCamera->Update(deltaTime);
@@ -1163,34 +1355,391 @@ void Game::Update(float deltaTime, float totalTime)
 
 
 // --------------------------------------------------------
-// Clear the screen, redraw everything, present to the user
+// Scene index upkeep - an entity's world box is its mesh's
+// local box under its current world matrix
+// --------------------------------------------------------
+void Game::InsertIntoSceneIndex(Entity e)
+{
+	MeshRenderer* renderer = scene.TryGet<MeshRenderer>(e);
+	Transform* transform = scene.TryGet<Transform>(e);
+	if (!renderer || !transform || scene.Has<SpatialProxy>(e))
+		return;
+
+	uint32_t proxy = sceneIndex.Insert(WorldBounds(renderer->RenderMesh, transform->GetWorldMatrix()), e.Index);
+	scene.Add<SpatialProxy>(e, SpatialProxy{ proxy });
+}
+
+void Game::RefitInSceneIndex(Entity e)
+{
+	MeshRenderer* renderer = scene.TryGet<MeshRenderer>(e);
+	Transform* transform = scene.TryGet<Transform>(e);
+	SpatialProxy* proxy = scene.TryGet<SpatialProxy>(e);
+	if (renderer && transform && proxy)
+		sceneIndex.Move(proxy->Proxy, WorldBounds(renderer->RenderMesh, transform->GetWorldMatrix()));
+}
+
+
+// --------------------------------------------------------
+// Capture this frame & hand it off for rendering
+//  - With the render thread off, the snapshot is rendered
+//    right here, so both modes share a single code path
 // --------------------------------------------------------
 void Game::Draw(float deltaTime, float totalTime)
 {
+	// Apply the UI's render thread toggle between frames
+	if (useRenderThread != renderThreadRunning)
+	{
+		if (useRenderThread)
+			StartRenderThread();
+		else
+			StopRenderThread();
+	}
+
+	if (!renderThreadRunning)
+	{
+		BuildSnapshot(snapshots[0], totalTime);
+		RenderSnapshot(snapshots[0]);
+		return;
+	}
+
+	// Waits here only if the render thread is a full FrameSnapshotCount frames behind
+	int slot = freeQueue.Pop();
+	BuildSnapshot(snapshots[slot], totalTime);
+
+	framesInFlight.fetch_add(1);
+	submitQueue.Push(slot);
+}
+
+
+// --------------------------------------------------------
+// Copies everything needed to render this frame out of
+// the live game state, so Update() can change it freely
+// while the snapshot is being drawn
+// --------------------------------------------------------
+void Game::BuildSnapshot(FrameSnapshot& frame, float totalTime)
+{
+	// The render thread is done with this slot, so last frame's arrays can go
+	frame.Allocator.Reset();
+
+	frame.TotalTime = totalTime;
+	memcpy(frame.ClearColor, color, sizeof(color));
+	frame.Width = Window::Width();
+	frame.Height = Window::Height();
+
+	frame.View = activeCamera->GetView();
+	frame.Projection = activeCamera->GetProjection();
+	frame.CameraPosition = activeCamera->GetTransform()->GetPosition();
+
+	frame.Lights = frame.Allocator.AllocateArray<Light>(lights.size());
+	for (size_t i = 0; i < lights.size(); i++)
+		frame.Lights[i] = lights[i];
+	frame.LightView = lightViewMatrix;
+	frame.LightProjection = lightProjectionMatrix;
+	frame.ShadowMapResolution = shadowMapResolution;
+
+	// Which shader variant the scene is drawn with this frame
+	frame.Permutation = shadowsEnabled ? 0 : ShaderPermutation::NoShadows;
+	if (specializeLightCount)
+		frame.Permutation = ShaderPermutation::WithLightCount(frame.Permutation, (uint32_t)(lights.size() < MaxLights ? lights.size() : MaxLights));
+	frame.Instancing = useInstancing;
+
+	// Only what the UI changed since the last snapshot, so the renderer
+	// never reads a material's live parameters
+	frame.MaterialUpdates = frame.Allocator.AllocateArray<MaterialParameters>(Resources::Materials.Count());
+	size_t updateCount = 0;
+	Resources::Materials.Each([&](MaterialHandle, Material& material)
+	{
+		if (updateCount < frame.MaterialUpdates.size() && material.TakeParameters(frame.MaterialUpdates[updateCount].Data))
+			frame.MaterialUpdates[updateCount++].Target = &material;
+	});
+	frame.MaterialUpdates = frame.MaterialUpdates.first(updateCount);
+
+	// World matrices are resolved now, on the game thread, since
+	// GetWorldMatrix() may need to rebuild a dirty transform
+	// - Sized for every renderer, then trimmed to those that also have a transform
+	// - Each also gets a sort key from its shader, material, mesh & view depth,
+	//   and its mesh's bounds moved into world space for culling
+	std::span<DrawItem> items = frame.Allocator.AllocateArray<DrawItem>(scene.Pool<MeshRenderer>().Size());
+	std::span<RenderQueueEntry> queue = frame.Allocator.AllocateArray<RenderQueueEntry>(items.size());
+	bool needBounds = cullingMode == CullingMode::Linear || occlusionCulling;
+	BoundsSoA bounds = Culling::AllocateBounds(frame.Allocator, needBounds ? (uint32_t)items.size() : 0);
+	std::span<uint32_t> itemEntities = frame.Allocator.AllocateArray<uint32_t>(items.size());
+	size_t itemCount = 0;
+	XMFLOAT4X4 view = frame.View;
+	float depthScale = 1.0f / activeCamera->GetFarClip();
+	MaterialHandle lastMaterial;
+	uint32_t shaderId = 0;
+	MeshHandle lastMesh;
+	BoundingVolume meshBounds = {};
+	scene.Each<MeshRenderer, Transform>([&](Entity e, MeshRenderer& renderer, Transform& transform)
+	{
+		DrawItem& item = items[itemCount];
+		itemEntities[itemCount] = e.Index;
+		item = {
+			renderer.RenderMesh,
+			renderer.RenderMaterial,
+			transform.GetWorldMatrix(),
+			transform.GetWorldInverseTransposeMatrix() };
+
+		// Neighbouring entities usually share a material
+		if (renderer.RenderMaterial != lastMaterial)
+		{
+			lastMaterial = renderer.RenderMaterial;
+			Material* material = Resources::Materials.Get(lastMaterial);
+			shaderId = material ? material->GetPixelShaderHandle().Index() : 0;
+		}
+
+		// ...and often a mesh
+		if (needBounds)
+		{
+			if (renderer.RenderMesh != lastMesh)
+			{
+				lastMesh = renderer.RenderMesh;
+				Mesh* mesh = Resources::Meshes.Get(lastMesh);
+				meshBounds = mesh ? mesh->GetBounds() : BoundingVolume{};
+			}
+
+			XMFLOAT3 center;
+			XMFLOAT3 extents;
+			Culling::TransformBounds(meshBounds, item.World, center, extents);
+			bounds.Set((uint32_t)itemCount, center, extents);
+		}
+
+		// View space z of the entity's origin
+		float viewZ = item.World._41 * view._13 + item.World._42 * view._23 + item.World._43 * view._33 + view._43;
+		queue[itemCount] = {
+			RenderQueue::MakeKey(RenderQueue::Opaque, shaderId, renderer.RenderMaterial.Index(), renderer.RenderMesh.Index(), viewZ * depthScale),
+			(uint32_t)itemCount };
+		itemCount++;
+	});
+	frame.DrawItems = items.first(itemCount);
+
+	// Submission order: grouped by state, front to back within each group
+	std::span<RenderQueueEntry> sorted = queue.first(itemCount);
+	RenderQueue::Sort(sorted, frame.Allocator.AllocateArray<RenderQueueEntry>(itemCount));
+
+	// Flags each draw item inside a volume & returns how many are
+	// - Either every box is tested on the job threads, or the scene index
+	//   is walked & its results mapped back to draw items
+	std::span<uint8_t> inside = frame.Allocator.AllocateArray<uint8_t>(itemCount);
+	std::span<uint8_t> insideEntities = frame.Allocator.AllocateArray<uint8_t>(cullingMode == CullingMode::Tree ? scene.Capacity() : 0);
+	auto cull = [&](const Frustum& frustum)
+	{
+		if (cullingMode == CullingMode::Linear)
+		{
+			bounds.Count = (uint32_t)itemCount;
+			return Culling::CullBoxes(frustum, bounds, inside.data());
+		}
+
+		memset(insideEntities.data(), 0, insideEntities.size());
+		sceneIndex.QueryFrustum(frustum, [&](uint32_t entityIndex) { insideEntities[entityIndex] = 1; });
+
+		uint32_t insideCount = 0;
+		for (size_t i = 0; i < itemCount; i++)
+		{
+			inside[i] = insideEntities[itemEntities[i]];
+			insideCount += inside[i];
+		}
+		return insideCount;
+	};
+
+	// The sorted entries that were flagged, still in order, so
+	// neither pass's list needs sorting of its own
+	auto compact = [&](uint32_t insideCount)
+	{
+		if (insideCount == itemCount)
+			return sorted;
+
+		std::span<RenderQueueEntry> entries = frame.Allocator.AllocateArray<RenderQueueEntry>(insideCount);
+		size_t next = 0;
+		for (const RenderQueueEntry& entry : sorted)
+			if (inside[entry.Item])
+				entries[next++] = entry;
+		return entries;
+	};
+
+	// The main pass only draws what intersects the camera's frustum
+	uint32_t visibleCount = (uint32_t)itemCount;
+	if (cullingMode != CullingMode::Off)
+		visibleCount = cull(activeCamera->GetFrustum());
+	else
+		memset(inside.data(), 1, inside.size());
+
+	// ...and isn't hidden behind an occluder
+	uint32_t occludedCount = 0;
+	if (occlusionCulling)
+	{
+		occlusionBuffer.Begin(XMLoadFloat4x4(&frame.View) * XMLoadFloat4x4(&frame.Projection));
+		scene.Each<Occluder, MeshRenderer, Transform>([&](Entity, Occluder&, MeshRenderer& renderer, Transform& transform)
+		{
+			Mesh* mesh = Resources::Meshes.Get(renderer.RenderMesh);
+			if (mesh)
+			{
+				const std::vector<XMFLOAT3>& positions = mesh->GetPositions();
+				const std::vector<unsigned int>& indices = mesh->GetIndices();
+				occlusionBuffer.AddOccluder(positions.data(), (uint32_t)positions.size(), indices.data(), (uint32_t)indices.size(), transform.GetWorldMatrix());
+			}
+		});
+		occlusionBuffer.Rasterize();
+
+		bounds.Count = (uint32_t)itemCount;
+		occludedCount = occlusionBuffer.CullBoxes(bounds, inside.data());
+		visibleCount -= occludedCount;
+	}
+
+	frame.Queue = compact(visibleCount);
+	lastVisibleCount = visibleCount;
+	lastCulledCount = (uint32_t)itemCount - visibleCount - occludedCount;
+	lastOccludedCount = occludedCount;
+
+	// The shadow view only draws what could shadow something the camera
+	// sees, whether or not it's in view (or hidden) itself - see
+	// ShadowCasterFrustum()
+	uint32_t casterCount = 0;
+	if (shadowsEnabled)
+	{
+		Frustum casterFrustum;
+		XMMATRIX cameraViewProjection = XMLoadFloat4x4(&frame.View) * XMLoadFloat4x4(&frame.Projection);
+		if (cullingMode == CullingMode::Off)
+			casterCount = (uint32_t)itemCount;
+		else if (Culling::ShadowCasterFrustum(XMLoadFloat4x4(&frame.LightView), XMLoadFloat4x4(&frame.LightProjection), cameraViewProjection, casterFrustum))
+			casterCount = cull(casterFrustum);
+	}
+	frame.ShadowQueue = casterCount > 0 ? compact(casterCount) : std::span<RenderQueueEntry>();
+	lastCasterCount = casterCount;
+
+	// Room for both queues' matrices, made here so rendering never creates anything
+	ReserveObjectTransforms(ShadowObjectBase(frame) + frame.ShadowQueue.size());
+
+	// Both passes' draws, recorded on the job threads for the renderer to replay
+	PrepareMaterials(frame.Permutation);
+	RecordScenePass(frame);
+	RecordShadowPass(frame);
+	frame.Backend = Graphics::IsHeadless() ? (RenderBackend*)&nullBackend : &d3d11Backend;
+
+	frame.BlurRadius = blurRadius;
+
+	// ImGui reuses its draw lists next frame, so keep a copy
+	ImGui::Render(); // Turns this frame's UI into renderable triangles
+	frame.UI.Capture(ImGui::GetDrawData());
+}
+
+
+// --------------------------------------------------------
+// Render thread body - draws snapshots in submission order
+// until it receives the -1 "quit" slot
+// --------------------------------------------------------
+void Game::RenderThreadLoop()
+{
+	while (true)
+	{
+		int slot = submitQueue.Pop();
+		if (slot < 0)
+			break;
+
+		RenderSnapshot(snapshots[slot]);
+		freeQueue.Push(slot);
+
+		framesInFlight.fetch_sub(1);
+		framesInFlight.notify_all();
+	}
+}
+
+
+void Game::StartRenderThread()
+{
+	if (renderThreadRunning)
+		return;
+
+	renderThread = std::thread(&Game::RenderThreadLoop, this);
+	renderThreadRunning = true;
+}
+
+
+void Game::StopRenderThread()
+{
+	if (!renderThreadRunning)
+		return;
+
+	// Queued frames are still drawn before the thread sees the quit slot
+	submitQueue.Push(-1);
+	renderThread.join();
+	renderThreadRunning = false;
+}
+
+
+void Game::FlushRenderThread()
+{
+	if (!renderThreadRunning)
+		return;
+
+	uint32_t pending = framesInFlight.load();
+	while (pending > 0)
+	{
+		framesInFlight.wait(pending);
+		pending = framesInFlight.load();
+	}
+}
+
+
+// --------------------------------------------------------
+// Clear the screen, redraw everything, present to the user
+//  - Runs on the render thread when it's enabled, so this
+//    must only read from the snapshot (not the scene,
+//    camera or UI state) and must not use the job system
+//  - Every graphics call goes through the snapshot's
+//    backend, and nothing is created here (see
+//    ReserveObjectTransforms()), so the null backend's
+//    frames make none
+// --------------------------------------------------------
+void Game::RenderSnapshot(FrameSnapshot& frame)
+{
+	RenderBackend& backend = *frame.Backend;
+
 	// Frame START
 	// - These things should happen ONCE PER FRAME
 	// - At the beginning of Game::Draw() before drawing *anything*
 	{
+		// Nothing is known to be bound yet (ImGui & others use the context too)
+		backend.BeginFrame();
+
 		// Clear the back buffer (erase what's on screen (with color!)) and depth buffer
-		Graphics::Context->ClearRenderTargetView(Graphics::BackBufferRTV.Get(), color);
-		Graphics::Context->ClearDepthStencilView(Graphics::DepthBufferDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0);
+		backend.ClearTarget(Graphics::BackBufferRTV.Get(), frame.ClearColor);
+		backend.ClearDepth(Graphics::DepthBufferDSV.Get());
+
+		// Draw into them over the whole window (the shadow pass sets its own)
+		backend.SetTargets(Graphics::BackBufferRTV.Get(), Graphics::DepthBufferDSV.Get());
+		backend.SetViewport((float)frame.Width, (float)frame.Height);
 	}
 
+	// Lights & light matrices are the same for every pass
+	SetFrameConstants(frame);
+
+	// Parameters changed since the last snapshot
+	for (const MaterialParameters& update : frame.MaterialUpdates)
+		update.Target->UploadParameters(update.Data, backend);
+
+	// Every object's matrices, for both passes' draws, in one write
+	// - Without them (nothing queued, or no buffer) the recorded
+	//   draws' object indices point at nothing, so neither pass is replayed
+	bool drawScene = UploadObjectTransforms(frame);
+
 	// Before anything else (including changing buffers for PP), render the shadow map
-	RenderShadowMap(); 
+	if (!(frame.Permutation & ShaderPermutation::NoShadows))
+		RenderShadowMap(frame, drawScene); 
 
 	// Clear any and all extra render targets
-	Graphics::Context->ClearRenderTargetView(ppBoxBlurRTV.Get(), color);
+	backend.ClearTarget(ppBoxBlurRTV.Get(), frame.ClearColor);
 
-	Graphics::Context->ClearRenderTargetView(ppBloomRTV.Get(), color);
-	Graphics::Context->ClearRenderTargetView(ppBloomExtractRTV.Get(), color);
+	backend.ClearTarget(ppBloomRTV.Get(), frame.ClearColor);
+	backend.ClearTarget(ppBloomExtractRTV.Get(), frame.ClearColor);
 
-	Graphics::Context->ClearRenderTargetView(horizBlurRTV.Get(), color);
-	Graphics::Context->ClearRenderTargetView(verticBlurRTV.Get(), color);
+	backend.ClearTarget(horizBlurRTV.Get(), frame.ClearColor);
+	backend.ClearTarget(verticBlurRTV.Get(), frame.ClearColor);
 
 	// Swap the active render target for post processing
 	//Graphics::Context->OMSetRenderTargets(1, ppBloomRTV.GetAddressOf(), Graphics::DepthBufferDSV.Get());
-	Graphics::Context->OMSetRenderTargets(1, ppBoxBlurRTV.GetAddressOf(), Graphics::DepthBufferDSV.Get());
+	backend.SetTargets(ppBoxBlurRTV.Get(), Graphics::DepthBufferDSV.Get());
 
 	// Rotate around z-axis based on time
 	//XMMATRIX translMatrix = XMMatrixTranslation(sin(totalTime), 0, 0);
@@ -1205,54 +1754,32 @@ void Game::Draw(float deltaTime, float totalTime)
 	// - These steps are generally repeated for EACH object you draw
 	// - Other Direct3D calls will also be necessary to do more complex things
 	{
-		// Draw all the entities in the list
-		for (auto& e : entities)
-		{
-			// Bind the textures
-			//e->GetMaterial()->GetPixelShader()->SetShaderResourceView("ColorTexture", textureSRV);
-
-			e->GetMaterial()->GetVertexShader()->SetMatrix4x4("lightView", lightViewMatrix);
-			e->GetMaterial()->GetVertexShader()->SetMatrix4x4("lightProj", lightProjectionMatrix);
-
-			//e->GetMaterial()->GetPixelShader()->SetFloat3("ambientColor", ambientTerm);
-			e->GetMaterial()->GetPixelShader()->SetFloat("Time", totalTime);
-			e->GetMaterial()->GetPixelShader()->SetData(
-				"lights", // The name of the variable in the shader
-				&lights[0], // The address of the data to set
-				sizeof(Light) * (int)lights.size()); // The size of the data (the whole structs!) to set
+		// Main pass sees through the active camera (the sky uses this too)
+		SetPassConstants(backend, frame.View, frame.Projection, frame.CameraPosition);
 
-			e->GetMaterial()->GetPixelShader()->SetShaderResourceView("ShadowMap", shadowSRV);
-			e->GetMaterial()->GetPixelShader()->SetSamplerState("ShadowSampler", shadowSampler);
-
-			e->Draw(activeCamera);
-		}
+		// Draw everything captured in the snapshot, as recorded by
+		// RecordScenePass()
+		if (drawScene)
+			CommandStreams::Execute(frame.SceneCommands, backend);
 
 		// Draw the sky box afterwards to avoid unnecessary work
-		skyBox->Draw(activeCamera);
+		skyBox->Draw(backend);
 
 		// Unbind the shadow map as a shader resource so it can be used as a depth buffer at the start of next frame!
-		ID3D11ShaderResourceView* nullSRVs[128] = {};
-		Graphics::Context->PSSetShaderResources(0, 128, nullSRVs);
+		backend.UnbindTextures();
 	}
 
 	// Post Processing:
 	{
-		Graphics::Context->OMSetRenderTargets(1, Graphics::BackBufferRTV.GetAddressOf(), 0); // Reset the backBuffer
-
-		// Swap to "fullscreen triangle trick" by turning off normal vertex & index buffers
-		Graphics::Context->IASetIndexBuffer(0, DXGI_FORMAT_R32_UINT, 0);
-		ID3D11Buffer* emptyBuffer = 0;
-		UINT stride = sizeof(Vertex);
-		UINT offset = 0;
-		Graphics::Context->IASetVertexBuffers(0, 1, &emptyBuffer, &stride, &offset);
+		backend.SetTargets(Graphics::BackBufferRTV.Get(), 0); // Reset the backBuffer
 		/*
 		Graphics::Context->PSSetSamplers(0, 1, postProcSampler.GetAddressOf()); // If all the post process steps have a single sampler at register 0
 
 		// Bloom Extract:
 		// Half-sized texture, so adjust viewport
 		D3D11_VIEWPORT vp = {};
-		vp.Width = Window::Width() * 0.5f;
-		vp.Height = Window::Height() * 0.5f;
+		vp.Width = frame.Width * 0.5f;
+		vp.Height = frame.Height * 0.5f;
 		vp.MaxDepth = 1.0f;
 		Graphics::Context->RSSetViewports(1, &vp);
 
@@ -1295,23 +1822,23 @@ void Game::Draw(float deltaTime, float totalTime)
 		Graphics::Context->IASetVertexBuffers(0, 1, &emptyBuffer, &stride, &offset);*/
 
 		// Activate shaders and bind resources
-		ppFullscrTriVS->SetShader();
-		ppBoxBlurPS->SetShader();
-		ppBoxBlurPS->SetShaderResourceView("Pixels", ppBoxBlurSRV.Get());
-		ppBoxBlurPS->SetSamplerState("ClampSampler", postProcSampler.Get());
+		SimplePixelShader* boxBlurPS = Resources::PixelShaders.Get(ppBoxBlurPS);
+		backend.SetPipeline({ postProcessPipeline });
+		backend.SetTexture(boxBlurPS, "Pixels", ppBoxBlurSRV.Get(), "ClampSampler", postProcSampler.Get());
 
 		// Set required cbuffer data
-		ppBoxBlurPS->SetInt("blurRadius", blurRadius);
-		ppBoxBlurPS->SetFloat("pixelWidth", 1.0f / Window::Width());
-		ppBoxBlurPS->SetFloat("pixelHeight", 1.0f / Window::Height());
-		ppBoxBlurPS->CopyAllBufferData();
+		ShaderStructs::BoxBlurPS::externalData blurData = {};
+		blurData.blurRadius = frame.BlurRadius;
+		blurData.pixelWidth = 1.0f / frame.Width;
+		blurData.pixelHeight = 1.0f / frame.Height;
+		backend.SetConstants({ boxBlurPS, blurData.Register, sizeof(blurData) }, &blurData);
 
-		// Draw the triangle filling the screen
-		Graphics::Context->Draw(3, 0); // Draw exactly 3 vertices (one triangle)
+		// Draw the triangle filling the screen ("fullscreen triangle trick",
+		// with the normal vertex & index buffers turned off)
+		backend.DrawFullscreen(boxBlurPS);
 
 		// Unbind at frame end for rendering into at start of next
-		ID3D11ShaderResourceView* nullSRVs[128] = {};
-		Graphics::Context->PSSetShaderResources(0, 128, nullSRVs);
+		backend.UnbindTextures();
 	}
 
 	// Frame END
@@ -1319,68 +1846,300 @@ void Game::Draw(float deltaTime, float totalTime)
 	// - At the very end of the frame (after drawing *everything*)
 	{
 		// Draw ImGui after Box Blur PP to keep it crisp
-		ImGui::Render(); // Turns this frames UI into renderable triangles
-		ImGui_ImplDX11_RenderDrawData(ImGui::GetDrawData()); // Draws it to the screen
+		// - Already turned into triangles by BuildSnapshot()
+		backend.DrawUI(frame.UI.GetDrawData()); // Draws it to the screen
 
 		// Present at the end of the frame
 		bool vsync = Graphics::VsyncState(); // Syncronize frame rate
 		// Show user what's been rendered
-		Graphics::SwapChain->Present( 
-			vsync ? 1 : 0,
-			vsync ? 0 : DXGI_PRESENT_ALLOW_TEARING);
+		backend.Present(vsync);
 
 		// Re-bind back buffer and depth buffer after presenting
-		Graphics::Context->OMSetRenderTargets(
-			1,
-			Graphics::BackBufferRTV.GetAddressOf(),
-			Graphics::DepthBufferDSV.Get());
+		backend.SetTargets(Graphics::BackBufferRTV.Get(), Graphics::DepthBufferDSV.Get());
+
+		// Destroy any resources released far enough back that the GPU is done with them
+		Resources::EndFrame();
+
+		backend.EndFrame();
 	}
 }
 
 
-void Game::RenderShadowMap()
+// --------------------------------------------------------
+// Records the main pass's draws, in sorted queue order
+// - Each material's pixel shader is swapped for the variant built for
+//   this frame's permutation, already resolved by PrepareMaterials()
+// - Textures & samplers stay bound between draws, so they're only
+//   set when the shader or the material changes
+// - Each material's shaders are a pipeline state, also resolved by
+//   PrepareMaterials(), which is only set when the material changes
+// - Draws use the material vertex shader's INSTANCED variant, which
+//   reads the object's matrices from the transform buffer, so each
+//   draw only carries its object's index (its queue position)
+// - With instancing, each run of draws sharing a mesh & material
+//   (which the queue puts next to each other) is one draw
+// --------------------------------------------------------
+void Game::PrepareMaterials(uint32_t permutation)
+{
+	Resources::Materials.Each([&](MaterialHandle, Material& material) { material.PrepareVariant(permutation); });
+}
+
+void Game::RecordScenePass(FrameSnapshot& frame)
 {
+	auto sameRun = [&](size_t a, size_t b)
+	{
+		const DrawItem& first = frame.DrawItems[frame.Queue[a].Item];
+		const DrawItem& second = frame.DrawItems[frame.Queue[b].Item];
+		return frame.Instancing && first.Mesh == second.Mesh && first.Material == second.Material;
+	};
+
+	CommandStreams::RecordInRanges(frame.Queue, frame.SceneCommands, sameRun, [&](CommandStream& stream, size_t begin, size_t end)
+	{
+		SimplePixelShader* ps = 0;
+		Material* lastMaterial = 0;
+		const PipelineState* pipeline = 0;
+		SimpleVertexShader* vs = 0;
+		bool instancedPipeline = false;
+		for (size_t i = begin; i < end; )
+		{
+			const DrawItem& item = frame.DrawItems[frame.Queue[i].Item];
+			Material* material = Resources::Materials.Get(item.Material);
+			if (material != lastMaterial)
+			{
+				lastMaterial = material;
+
+				// Resolved by PrepareMaterials() before recording started
+				const Material::Variant& variant = material->GetVariant();
+				SimplePixelShader* variantPS = Resources::PixelShaders.Get(variant.PixelShader);
+				bool shaderChanged = !ps || variantPS != ps;
+				ps = variantPS;
+
+				instancedPipeline = variant.Instanced;
+				pipeline = variant.Pipeline;
+				vs = Resources::VertexShaders.Get(variant.VertexShader);
+				stream.SetPipeline(pipeline);
+
+				if (shaderChanged)
+					stream.SetShadowMap(ps, shadowSRV.Get(), shadowSampler.Get());
+				stream.SetMaterial(material, ps);
+			}
+
+			// The whole run is recorded here, even past end, since the
+			// next range skips any of it (see CommandStreams::RecordInRanges())
+			Mesh* mesh = Resources::Meshes.Get(item.Mesh);
+			size_t count = 1;
+			while (i + count < frame.Queue.size() && sameRun(i, i + count))
+				count++;
+
+			if (!instancedPipeline)
+			{
+				// Only per-object data; the rest is in PerPass & PerFrame
+				for (size_t j = i; j < i + count; j++)
+				{
+					const DrawItem& object = frame.DrawItems[frame.Queue[j].Item];
+					ShaderStructs::VertexShader::PerObject perObject = {};
+					perObject.world = object.World;
+					perObject.worldInvTransp = object.WorldInverseTranspose;
+					stream.SetConstants(vs, perObject);
+					stream.Draw(mesh, material, vs, ps);
+				}
+				i += count;
+				continue;
+			}
+
+			// Queue positions are object indices, so the run is one range
+			// - No per-object buffer; the vertex shader only reads the
+			//   shared ones & the transform buffer
+			stream.DrawInstanced(mesh, material, ps, (uint32_t)count, (uint32_t)i);
+			i += count;
+		}
+	});
+
+	uint32_t drawCalls = 0;
+	for (const CommandStream& stream : frame.SceneCommands)
+		drawCalls += stream.DrawCount();
+	lastFrameDrawCalls = drawCalls;
+	lastFrameObjects = (uint32_t)frame.Queue.size();
+}
+
+
+// --------------------------------------------------------
+// Records the shadow map's draws
+// - Depth only, with no pixel shader, so materials don't matter
+//   & instanced runs only need the same mesh
+// - Reads the same transform buffer as the main pass, with the
+//   shadow queue's objects after the main queue's
+// - Queue order, so draws of the same mesh are next to each other
+// --------------------------------------------------------
+void Game::RecordShadowPass(FrameSnapshot& frame)
+{
+	SimpleVertexShader* vs = Resources::VertexShaders.Get(shadowsVS);
+	SimpleVertexShader* instancedVS = Resources::VertexShaders.Get(shadowInstancedPipeline->Desc.VertexShader);
+	bool instanced = instancedVS && instancedVS->GetPerInstanceCompatible();
+	size_t base = ShadowObjectBase(frame);
+
+	auto sameRun = [&](size_t a, size_t b)
+	{
+		return frame.Instancing && instanced && frame.DrawItems[frame.ShadowQueue[a].Item].Mesh == frame.DrawItems[frame.ShadowQueue[b].Item].Mesh;
+	};
+
+	CommandStreams::RecordInRanges(frame.ShadowQueue, frame.ShadowCommands, sameRun, [&](CommandStream& stream, size_t begin, size_t end)
+	{
+		// The biased rasterizer state, & the shadow shaders
+		stream.SetPipeline(instanced ? shadowInstancedPipeline : shadowPipeline);
+
+		for (size_t i = begin; i < end; )
+		{
+			const DrawItem& item = frame.DrawItems[frame.ShadowQueue[i].Item];
+			Mesh* mesh = Resources::Meshes.Get(item.Mesh);
+			if (!instanced)
+			{
+				ShaderStructs::ShadowMapVS::PerObject perObject = {};
+				perObject.world = item.World;
+				stream.SetConstants(vs, perObject);
+				stream.Draw(mesh, 0, vs, 0);
+				i++;
+				continue;
+			}
+
+			size_t count = 1;
+			while (i + count < frame.ShadowQueue.size() && sameRun(i, i + count))
+				count++;
+			stream.DrawInstanced(mesh, 0, 0, (uint32_t)count, (uint32_t)(base + i));
+			i += count;
+		}
+	});
+}
+
+
+// --------------------------------------------------------
+// Grows the transform buffer (& the instance buffer that
+// counts through it) to hold at least count objects
+// - Called on the game thread as each snapshot is built,
+//   so rendering only ever writes to the buffers
+// - Growing waits for the render thread, which is rare
+// - If the buffers can't be made, objectCapacity stays 0
+//   and frames draw nothing
+// --------------------------------------------------------
+void Game::ReserveObjectTransforms(size_t count)
+{
+	if (count <= objectCapacity)
+		return;
+
+	unsigned int capacity = objectCapacity > 0 ? objectCapacity : 256;
+	while (capacity < count)
+		capacity *= 2;
+
+	// Queued frames still read the old ones
+	FlushRenderThread();
+	objectBuffer.Reset();
+	objectSRV.Reset();
+	objectIndexBuffer.Reset();
+	objectCapacity = 0;
+
+	D3D11_BUFFER_DESC desc = {};
+	desc.ByteWidth = capacity * sizeof(ObjectTransform);
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	desc.MiscFlags = D3D11_RESOURCE_MISC_BUFFER_STRUCTURED;
+	desc.StructureByteStride = sizeof(ObjectTransform);
+	if (FAILED(Graphics::Device->CreateBuffer(&desc, 0, objectBuffer.GetAddressOf())))
+		return;
+
+	D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+	srvDesc.Format = DXGI_FORMAT_UNKNOWN;
+	srvDesc.ViewDimension = D3D11_SRV_DIMENSION_BUFFER;
+	srvDesc.Buffer.FirstElement = 0;
+	srvDesc.Buffer.NumElements = capacity;
+	if (FAILED(Graphics::Device->CreateShaderResourceView(objectBuffer.Get(), &srvDesc, objectSRV.GetAddressOf())))
+		return;
+
+	// Slot 1 just counts up, so each instance reads its own position
+	// (offset by the draw's start instance) as its object index
+	std::vector<uint32_t> indices(capacity);
+	for (unsigned int i = 0; i < capacity; i++)
+		indices[i] = i;
+
+	D3D11_BUFFER_DESC indexDesc = {};
+	indexDesc.ByteWidth = capacity * sizeof(uint32_t);
+	indexDesc.Usage = D3D11_USAGE_IMMUTABLE;
+	indexDesc.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+	D3D11_SUBRESOURCE_DATA indexData = {};
+	indexData.pSysMem = indices.data();
+	if (FAILED(Graphics::Device->CreateBuffer(&indexDesc, &indexData, objectIndexBuffer.GetAddressOf())))
+		return;
+
+	objectCapacity = capacity;
+}
+
+
+// --------------------------------------------------------
+// Writes every queued object's matrices into the transform
+// buffer in queue order, with one map, so the draws at queue
+// positions [i, i + n) read objects [i, i + n)
+// - The shadow queue's follow the main queue's (see
+//   ShadowObjectBase())
+// - 3x4 matrices (see ObjectTransform), 96 bytes an object
+//   instead of the 128 a PerObject upload took per draw
+// - The buffers were already sized by BuildSnapshot() (see
+//   ReserveObjectTransforms())
+// - Returns false if there's nothing to draw with
+// --------------------------------------------------------
+bool Game::UploadObjectTransforms(const FrameSnapshot& frame)
+{
+	size_t shadowBase = ShadowObjectBase(frame);
+	size_t count = shadowBase + frame.ShadowQueue.size();
+	if (count == 0 || count > objectCapacity)
+		return false;
+
+	ObjectTransform* objects = static_cast<ObjectTransform*>(frame.Backend->MapBuffer(objectBuffer.Get(), (uint32_t)(count * sizeof(ObjectTransform))));
+	if (!objects)
+		return false;
+
+	auto write = [&](std::span<const RenderQueueEntry> queue, size_t first)
+	{
+		for (size_t i = 0; i < queue.size(); i++)
+		{
+			const DrawItem& item = frame.DrawItems[queue[i].Item];
+			objects[first + i].Set(item.World, item.WorldInverseTranspose);
+		}
+	};
+	if (shadowBase > 0)
+		write(frame.Queue, 0);
+	write(frame.ShadowQueue, shadowBase);
+	frame.Backend->UnmapBuffer(objectBuffer.Get());
+
+	// Stays bound for both passes (nothing else uses these slots)
+	frame.Backend->SetInstanceData(objectIndexBuffer.Get(), sizeof(uint32_t), objectSRV.Get(), ObjectTransformsRegister);
+	return true;
+}
+
+
+void Game::RenderShadowMap(const FrameSnapshot& frame, bool drawCasters)
+{
+	RenderBackend& backend = *frame.Backend;
+
 	// Set up shadow map as depth buffer
-	Graphics::Context->ClearDepthStencilView(shadowDSV.Get(), D3D11_CLEAR_DEPTH, 1.0f, 0); // Clear shadow map
+	backend.ClearDepth(shadowDSV.Get()); // Clear shadow map
 	// Set up output merger stage
 	//ID3D11RenderTargetView* nullRTV{};
 	//Graphics::Context->OMSetRenderTargets(1, &nullRTV, shadowDSV.Get());
-	Graphics::Context->OMSetRenderTargets(0, 0, shadowDSV.Get()); 
-	Graphics::Context->RSSetState(shadowRasterizer.Get());
+	backend.SetTargets(0, shadowDSV.Get());
 
 	// Change other render state to prepare for the shadow render
 	// Match vieewport to shadow map res. instead of screen size
-	D3D11_VIEWPORT viewport{};
-	viewport.TopLeftX = 0.0f;
-	viewport.TopLeftY = 0.0f;
-	viewport.Width = (float)shadowMapResolution;
-	viewport.Height = (float)shadowMapResolution;
-	viewport.MinDepth = 0.0f;
-	viewport.MaxDepth = 1.0f;
-	Graphics::Context->RSSetViewports(1, &viewport);
-
-	// Set up shadow shaders
-	shadowsVS->SetShader();
-	Graphics::Context->PSSetShader(0, 0, 0); // Unbind pixel shader to prevent pixel processing entirely
-
-	shadowsVS->SetMatrix4x4("view", lightViewMatrix);
-	shadowsVS->SetMatrix4x4("projection", lightProjectionMatrix);
-
-	// Loop thru entities & draw to the shadow map
-	for (auto& e : entities)
-	{
-		shadowsVS->SetMatrix4x4("world", e->GetTransform()->GetWorldMatrix());
-		shadowsVS->CopyAllBufferData();
+	backend.SetViewport((float)frame.ShadowMapResolution, (float)frame.ShadowMapResolution);
 
-		// Draw the mesh directly to avoid the entity's material
-		e->GetMesh()->SetAndDrawBuffers();
-	}
+	// Draw from the light's point of view
+	SetPassConstants(backend, frame.LightView, frame.LightProjection, frame.CameraPosition);
+
+	// Casters as recorded by RecordShadowPass()
+	if (drawCasters)
+		CommandStreams::Execute(frame.ShadowCommands, backend);
 
 	// Reset to the normal render target & back buffer
-	Graphics::Context->OMSetRenderTargets(1, Graphics::BackBufferRTV.GetAddressOf(), Graphics::DepthBufferDSV.Get());
+	backend.SetTargets(Graphics::BackBufferRTV.Get(), Graphics::DepthBufferDSV.Get());
 	
-	viewport.Width = (float)Window::Width();
-	viewport.Height = (float)Window::Height(); 
-	Graphics::Context->RSSetViewports(1, &viewport);
-	Graphics::Context->RSSetState(0);
+	backend.SetViewport((float)frame.Width, (float)frame.Height);
 }
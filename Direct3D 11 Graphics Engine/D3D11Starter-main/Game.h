@@ -4,13 +4,25 @@
 #include <wrl/client.h>
 #include <vector>
 #include <memory>
+#include <thread>
+#include <atomic>
 #include <DirectXMath.h>
 #include "Mesh.h"
 #include "Transform.h"
-#include "GameEntity.h"
+#include "ECS.h"
+#include "Components.h"
+#include "ResourceHandles.h"
 #include "Camera.h"
 #include "Lights.h"
+#include "BufferStructs.h"
 #include "Sky.h"
+#include "FrameSnapshot.h"
+#include "SpscQueue.h"
+#include "UploadRing.h"
+#include "PipelineState.h"
+#include "SpatialIndex.h"
+#include "Occlusion.h"
+#include "RenderBackend.h"
 
 class Game
 {
@@ -27,19 +39,58 @@ public:
 	void Draw(float deltaTime, float totalTime);
 	void OnResize();
 
+	// Blocks until the render thread has finished every submitted frame
+	// - Call before destroying or resizing anything a snapshot may reference
+	void FlushRenderThread();
+
+	// What the null backend saw, for headless runs (every frame is
+	// rendered into it when there's no GPU - see RunHeadless() in Main.cpp)
+	const NullBackend::Stats& NullBackendStats() const { return nullBackend.GetStats(); }
+
 private:
 
 	// Initialization helper methods - feel free to customize, combine, remove, etc.
 	void CreateGeometry(); 
 	void RefreshImGui(float deltaTime);
-	void BuildUI(std::vector<std::shared_ptr<Mesh>> meshes,
-		std::vector<std::shared_ptr<GameEntity>> entities,
-		std::vector<std::shared_ptr<Camera>> cameraViews,
+	void BuildUI(const std::vector<MeshHandle>& meshes,
+		const std::vector<std::shared_ptr<Camera>>& cameraViews,
 		std::shared_ptr<Camera>& activeCamera,
 		std::vector<Light>& lights);//DirectX::XMFLOAT3& ambientTerm
 
 	void CreateShadowMap();
-	void RenderShadowMap();
+	void RenderShadowMap(const FrameSnapshot& frame, bool drawCasters);
+
+	// Shared constant buffers (PerPass & PerFrame in ShaderInclude.hlsli)
+	// - Created before any shader loads, so every shader binds them
+	void CreateSharedConstantBuffers();
+	void SetPassConstants(RenderBackend& backend, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& projection, const DirectX::XMFLOAT3& cameraPosition);
+	void SetFrameConstants(const FrameSnapshot& frame);
+
+	// Each pass's draws, recorded into the snapshot's command streams
+	// on the job threads (see CommandStream.h)
+	void RecordScenePass(FrameSnapshot& frame);
+
+	// Resolves every material's shaders & pipeline for this frame's
+	// permutation on the game thread, so recording never compiles or
+	// waits on the shader library or pipeline cache - only does work
+	// when it changed
+	void PrepareMaterials(uint32_t permutation);
+	void RecordShadowPass(FrameSnapshot& frame);
+
+	// Every queued object's matrices, written once a frame for both passes
+	// to index (instancing makes runs sharing a mesh & material one draw)
+	// - The buffers are grown on the game thread, before rendering
+	void ReserveObjectTransforms(size_t count);
+	bool UploadObjectTransforms(const FrameSnapshot& frame);
+
+	// Frame pipelining
+	// - BuildSnapshot() copies everything rendering needs out of the game state
+	// - RenderSnapshot() issues every graphics call, reading only the snapshot
+	void BuildSnapshot(FrameSnapshot& frame, float totalTime);
+	void RenderSnapshot(FrameSnapshot& frame);
+	void StartRenderThread();
+	void StopRenderThread();
+	void RenderThreadLoop();
 
 	// Initialize UI variables 
 	float color[4] = { 0.4f, 0.75f, 0.7f, 1.0f }; // Background color
@@ -49,24 +100,24 @@ private:
 	//VertexShaderData dataToCopy{ DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f),
 		//DirectX::XMMATRIX()}; // Create the constant buffer struct for mesh tint & offset/world
 
-	// Create a pointer to an array (or vector) of meshes to easily loop through for drawing and UI work
-	std::vector<std::shared_ptr<Mesh>> meshes;
+	// Create an array (or vector) of mesh handles to easily loop through for drawing and UI work
+	std::vector<MeshHandle> meshes;
 
 	// Mesh pointer declarations
 	//std::shared_ptr<Mesh> origTriangleMesh; 
 	//std::shared_ptr<Mesh> rectangleMesh;
 	//std::shared_ptr<Mesh> heartMesh;
 
-	std::shared_ptr<Mesh> cubeMesh;
-	std::shared_ptr<Mesh> cylinderMesh;
-	std::shared_ptr<Mesh> helixMesh;
-	std::shared_ptr<Mesh> quadMesh;
-	std::shared_ptr<Mesh> doubleSidedQuadMesh;
-	std::shared_ptr<Mesh> sphereMesh;
-	std::shared_ptr<Mesh> torusMesh;
+	MeshHandle cubeMesh;
+	MeshHandle cylinderMesh;
+	MeshHandle helixMesh;
+	MeshHandle quadMesh;
+	MeshHandle doubleSidedQuadMesh;
+	MeshHandle sphereMesh;
+	MeshHandle torusMesh;
 
 	// Create a list of shared pointers to the differnt cameras
-	std::vector<std::shared_ptr<Material>> materials;
+	std::vector<MaterialHandle> materials;
 
 	/*std::shared_ptr<Material> cyanMaterial;
 	std::shared_ptr<Material> magentaMaterial;
@@ -76,19 +127,24 @@ private:
 	std::shared_ptr<Material> customMaterial;*/
 
 	//std::shared_ptr<Material> arcadeFloorMaterial;
-	std::shared_ptr<Material> blackTealMarbleMaterial;
+	MaterialHandle blackTealMarbleMaterial;
 	//std::shared_ptr<Material> blueTravertineMaterial;
 	//std::shared_ptr<Material> deepBlueTravertineMaterial;
-	std::shared_ptr<Material> woodDiagArrowsMaterial;
-	std::shared_ptr<Material> smoothedRockMaterial;
+	MaterialHandle woodDiagArrowsMaterial;
+	MaterialHandle smoothedRockMaterial;
 	//std::shared_ptr<Material> comboMaterial;
-	std::shared_ptr<Material> turquoiseRustedMetalMaterial;
-	std::shared_ptr<Material> metalTilesMaterial;
-	std::shared_ptr<Material> rustedPaintMaterial;
-	std::shared_ptr<Material> bronzeMaterial;
+	MaterialHandle turquoiseRustedMetalMaterial;
+	MaterialHandle metalTilesMaterial;
+	MaterialHandle rustedPaintMaterial;
+	MaterialHandle bronzeMaterial;
+
+	// All entities and their components (Transform, MeshRenderer, Animation)
+	Registry scene;
 
-	// Create a list of shared pointers to entities for drawing
-	std::vector<std::shared_ptr<GameEntity>> entities;
+	// World bounds of every entity that's drawn, refit only when one moves
+	DynamicAabbTree sceneIndex;
+	void InsertIntoSceneIndex(Entity e);
+	void RefitInSceneIndex(Entity e);
 
 	//std::shared_ptr<GameEntity> rgbTriangle;
 	//std::shared_ptr<GameEntity> rectangle;
@@ -118,13 +174,71 @@ private:
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> shadowSRV;
 	DirectX::XMFLOAT4X4 lightViewMatrix;
 	DirectX::XMFLOAT4X4 lightProjectionMatrix;
-	Microsoft::WRL::ComPtr<ID3D11RasterizerState> shadowRasterizer;
+	const PipelineState* shadowPipeline = 0; // Depth only, biased
+	const PipelineState* shadowInstancedPipeline = 0; // Same, with the INSTANCED vertex shader
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> shadowSampler;
-	std::shared_ptr<SimpleVertexShader> shadowsVS;
+	VertexShaderHandle shadowsVS;
+	bool shadowsEnabled = true; // Set from the UI
+
+	// Pixel shaders are specialized for the scene's light count (set from the UI)
+	bool specializeLightCount = true;
+
+	// Shared constant buffers, each uploaded once per pass/frame
+	Microsoft::WRL::ComPtr<ID3D11Buffer> perPassBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> perFrameBuffer;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> defaultMaterialBuffer; // Bound until a material binds its own
+
+	// Culling for the main pass's view & the shadow map's casters (set from the UI)
+	// - Linear tests every entity's box (4 at a time, on the job threads);
+	//   Tree walks the scene index
+	// - Counts are from the last snapshot built
+	enum class CullingMode { Off, Linear, Tree };
+	CullingMode cullingMode = CullingMode::Tree;
+	uint32_t lastVisibleCount = 0;
+	uint32_t lastCulledCount = 0;
+	uint32_t lastCasterCount = 0;
+
+	// What's left after frustum culling is tested against the Occluder
+	// entities, drawn into a small depth buffer on the CPU
+	OcclusionBuffer occlusionBuffer;
+	bool occlusionCulling = true; // Set from the UI
+	uint32_t lastOccludedCount = 0;
+
+	// Every queued object's matrices, in queue order (see UploadObjectTransforms())
+	// - Read as a structured buffer, at the index from the counting instance buffer
+	Microsoft::WRL::ComPtr<ID3D11Buffer> objectBuffer;
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> objectSRV;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> objectIndexBuffer;
+	unsigned int objectCapacity = 0;
+	bool useInstancing = true; // Set from the UI
+	std::atomic<uint32_t> lastFrameDrawCalls = 0; // Main pass, counted as it's recorded
+	std::atomic<uint32_t> lastFrameObjects = 0;
+
+	// Where each frame is rendered, streams & all
+	// - The null backend makes no graphics calls, so what's left
+	//   of the frame is the CPU's share of it; it's used whenever
+	//   Graphics is headless
+	D3D11Backend d3d11Backend;
+	NullBackend nullBackend;
+
+	// Per-draw constants are suballocated from this (when supported)
+	UploadRing uploadRing;
+	bool useUploadRing = true; // Set from the UI
 
 	// Pointer to the sky box
 	std::shared_ptr<Sky> skyBox;
 
+	// Render thread
+	// - Snapshot slots cycle: free queue -> game thread fills -> submit queue -> render thread draws -> free queue
+	// - A slot index of -1 on the submit queue tells the render thread to exit
+	FrameSnapshot snapshots[FrameSnapshotCount];
+	SpscQueue<int, FrameSnapshotCount + 1> submitQueue;
+	SpscQueue<int, FrameSnapshotCount + 1> freeQueue;
+	std::atomic<uint32_t> framesInFlight = 0;
+	std::thread renderThread;
+	bool useRenderThread = false; // Set from the UI
+	bool renderThreadRunning = false;
+
 	// Post Processes:
 	// Helper functions for window resizing
 	void ResizeRenderTargets(Microsoft::WRL::ComPtr<ID3D11RenderTargetView>& rtv,
@@ -133,17 +247,18 @@ private:
 
 	// Resources that are shared among ALL post processes
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> postProcSampler;
-	std::shared_ptr<SimpleVertexShader> ppFullscrTriVS;
+	VertexShaderHandle ppFullscrTriVS;
+	const PipelineState* postProcessPipeline = 0; // Full screen triangle & box blur
 
 	// Resources that are tied to a particular post process:
 	// Blur
 	int blurRadius; 
-	std::shared_ptr<SimplePixelShader> ppBoxBlurPS;
+	PixelShaderHandle ppBoxBlurPS;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> ppBoxBlurRTV; // For rendering into internal texture
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ppBoxBlurSRV; // For sampling from internal texture
 
 	// Gaussian Blur PP for Bloom
-	std::shared_ptr<SimplePixelShader> gaussianBlurPS;
+	PixelShaderHandle gaussianBlurPS;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> horizBlurRTV;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> horizBlurSRV;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> verticBlurRTV;
@@ -152,8 +267,8 @@ private:
 	// Bloom
 	float brightnessThreshold;
 	float bloomIntensLvl;
-	std::shared_ptr<SimplePixelShader> bloomExtractPS;
-	std::shared_ptr<SimplePixelShader> bloomCombinePS;
+	PixelShaderHandle bloomExtractPS;
+	PixelShaderHandle bloomCombinePS;
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> ppBloomRTV;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> ppBloomSRV; 
 	Microsoft::WRL::ComPtr<ID3D11RenderTargetView> ppBloomExtractRTV;
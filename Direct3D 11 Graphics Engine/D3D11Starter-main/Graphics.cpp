@@ -1,4 +1,5 @@
 #include "Graphics.h"
+#include "NullDevice.h"
 #include <dxgi1_6.h>
 
 // Tell the drivers to use high-performance GPU in multi-GPU systems (like laptops)
@@ -15,6 +16,7 @@ namespace Graphics
 	namespace
 	{
 		bool apiInitialized = false;
+		bool headless = false;
 		bool supportsTearing = false;
 		bool vsyncDesired = false;
 		BOOL isFullscreen = false;
@@ -27,8 +29,12 @@ namespace Graphics
 
 // Getters
 bool Graphics::VsyncState() { return vsyncDesired || !supportsTearing || isFullscreen; }
+bool Graphics::IsHeadless() { return headless; }
 std::wstring Graphics::APIName() 
 { 
+	if (headless)
+		return L"Null";
+
 	switch (featureLevel)
 	{
 	case D3D_FEATURE_LEVEL_10_0: return L"D3D10";
@@ -120,6 +126,15 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 		Device.GetAddressOf(),		// Pointer to our Device pointer
 		&featureLevel,				// Retrieve exact API feature level in use
 		Context.GetAddressOf());	// Pointer to our Device Context pointer
+
+	// No usable GPU (a build machine, say) - fall back to the
+	// WARP software rasterizer so the engine still runs
+	if (FAILED(hr))
+	{
+		hr = D3D11CreateDeviceAndSwapChain(
+			0, D3D_DRIVER_TYPE_WARP, 0, deviceFlags, 0, 0, D3D11_SDK_VERSION,
+			&swapDesc, SwapChain.GetAddressOf(), Device.GetAddressOf(), &featureLevel, Context.GetAddressOf());
+	}
 	if (FAILED(hr)) return hr;
 
 	// We're set up
@@ -142,6 +157,34 @@ HRESULT Graphics::Initialize(unsigned int windowWidth, unsigned int windowHeight
 	return S_OK;
 }
 
+// --------------------------------------------------------
+// Initializes with a NullDevice instead of a GPU, for
+// headless runs - there's no window, swap chain or context
+//
+// - Device creates inert objects, so everything the game
+//   loads is still made (& validated) the usual way
+// - Context & SwapChain stay null, so only code that runs
+//   with a window may use them; frames are rendered into
+//   a NullBackend instead (see Game::BuildSnapshot())
+// - The back buffer is an ordinary texture of this size
+// --------------------------------------------------------
+HRESULT Graphics::InitializeHeadless(unsigned int width, unsigned int height)
+{
+	// Only initialize once
+	if (apiInitialized)
+		return E_FAIL;
+
+	Device.Attach(new NullDevice());
+	featureLevel = Device->GetFeatureLevel();
+
+	apiInitialized = true;
+	headless = true;
+
+	// Sets up the back & depth buffers, as it does with a window
+	ResizeBuffers(width, height);
+	return S_OK;
+}
+
 // --------------------------------------------------------
 // Called at the end of the program to clean up any
 // graphics API specific memory. 
@@ -175,20 +218,37 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height)
 	BackBufferRTV.Reset();
 	DepthBufferDSV.Reset();
 
-	// Resize the swap chain buffers
-	SwapChain->ResizeBuffers(
-		2, 
-		width, 
-		height, 
-		DXGI_FORMAT_R8G8B8A8_UNORM, 
-		supportsTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
-
-	// Grab the references to the first buffer
 	Microsoft::WRL::ComPtr<ID3D11Texture2D> backBufferTexture;
-	SwapChain->GetBuffer(
-		0,
-		__uuidof(ID3D11Texture2D),
-		(void**)backBufferTexture.GetAddressOf());
+	if (headless)
+	{
+		// No swap chain, so the back buffer is just a texture to render into
+		D3D11_TEXTURE2D_DESC backBufferDesc = {};
+		backBufferDesc.Width = width;
+		backBufferDesc.Height = height;
+		backBufferDesc.MipLevels = 1;
+		backBufferDesc.ArraySize = 1;
+		backBufferDesc.Format = DXGI_FORMAT_R8G8B8A8_UNORM;
+		backBufferDesc.Usage = D3D11_USAGE_DEFAULT;
+		backBufferDesc.BindFlags = D3D11_BIND_RENDER_TARGET;
+		backBufferDesc.SampleDesc.Count = 1;
+		Device->CreateTexture2D(&backBufferDesc, 0, backBufferTexture.GetAddressOf());
+	}
+	else
+	{
+		// Resize the swap chain buffers
+		SwapChain->ResizeBuffers(
+			2, 
+			width, 
+			height, 
+			DXGI_FORMAT_R8G8B8A8_UNORM, 
+			supportsTearing ? DXGI_SWAP_CHAIN_FLAG_ALLOW_TEARING : 0);
+
+		// Grab the references to the first buffer
+		SwapChain->GetBuffer(
+			0,
+			__uuidof(ID3D11Texture2D),
+			(void**)backBufferTexture.GetAddressOf());
+	}
 
 	// Now that we have the texture, create a render target view
 	// for the back buffer so we can render into it.
@@ -220,6 +280,10 @@ void Graphics::ResizeBuffers(unsigned int width, unsigned int height)
 		0,
 		DepthBufferDSV.GetAddressOf()); 
 
+	// Nothing to bind them to, or check the state of, without a context
+	if (headless)
+		return;
+
 	// Bind the views to the pipeline, so rendering properly 
 	// uses their underlying textures
 	Context->OMSetRenderTargets(
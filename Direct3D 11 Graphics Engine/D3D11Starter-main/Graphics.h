@@ -26,9 +26,11 @@ namespace Graphics
 	// Getters
 	bool VsyncState();
 	std::wstring APIName();
+	bool IsHeadless();
 
 	// General functions
 	HRESULT Initialize(unsigned int windowWidth, unsigned int windowHeight, HWND windowHandle, bool vsyncIfPossible);
+	HRESULT InitializeHeadless(unsigned int width, unsigned int height);
 	void ShutDown();
 	void ResizeBuffers(unsigned int width, unsigned int height);
 
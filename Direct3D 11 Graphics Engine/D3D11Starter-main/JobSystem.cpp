@@ -0,0 +1,245 @@
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// --------------------------------------------------------
+// Work-stealing job system
+//
+// - Every thread (main thread included) owns a Chase-Lev
+//   deque.  The owner pushes & pops at the bottom without
+//   locking; idle threads steal from the top of others.
+// - Jobs are copied into a per-thread ring so callers don't
+//   need to keep them alive.  ParallelFor caps the number of
+//   batches, so the ring never wraps onto a queued job.
+// - Idle workers sleep on a condition variable, and are only
+//   signalled when someone is actually asleep.
+// --------------------------------------------------------
+
+namespace JobSystem
+{
+	// Annonymous namespace to hold variables
+	// only accessible in this file
+	namespace
+	{
+		constexpr int64_t DequeCapacity = 4096; // Power of 2
+		constexpr uint32_t JobRingSize = 4096; // Power of 2
+
+		// Chase & Lev, "Dynamic Circular Work-Stealing Deque", with the
+		// C11 memory orderings from Le et al. (fixed capacity, no growth)
+		class WorkStealingDeque
+		{
+		public:
+			// Owner only - false if full
+			bool Push(Job* job)
+			{
+				int64_t b = bottom.load(std::memory_order_relaxed);
+				int64_t t = top.load(std::memory_order_acquire);
+				if (b - t >= DequeCapacity)
+					return false;
+
+				buffer[b & (DequeCapacity - 1)].store(job, std::memory_order_relaxed);
+				bottom.store(b + 1, std::memory_order_release); // Publishes the job to thieves
+				return true;
+			}
+
+			// Owner only - newest job first, for cache warmth
+			Job* Pop()
+			{
+				int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+				bottom.store(b, std::memory_order_relaxed);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t t = top.load(std::memory_order_relaxed);
+
+				if (t > b)
+				{
+					// Empty
+					bottom.store(b + 1, std::memory_order_relaxed);
+					return 0;
+				}
+
+				Job* job = buffer[b & (DequeCapacity - 1)].load(std::memory_order_relaxed);
+				if (t == b)
+				{
+					// Last job - race any thieves for it
+					if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+						job = 0;
+					bottom.store(b + 1, std::memory_order_relaxed);
+				}
+				return job;
+			}
+
+			// Any thread - oldest job first
+			Job* Steal()
+			{
+				int64_t t = top.load(std::memory_order_acquire);
+				std::atomic_thread_fence(std::memory_order_seq_cst);
+				int64_t b = bottom.load(std::memory_order_acquire);
+				if (t >= b)
+					return 0;
+
+				Job* job = buffer[t & (DequeCapacity - 1)].load(std::memory_order_relaxed);
+				if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+					return 0; // Lost the race to another thread
+				return job;
+			}
+
+		private:
+			alignas(64) std::atomic<int64_t> top = 0;
+			alignas(64) std::atomic<int64_t> bottom = 0;
+			alignas(64) std::atomic<Job*> buffer[DequeCapacity] = {};
+		};
+
+		struct Worker
+		{
+			WorkStealingDeque deque;
+			Job jobRing[JobRingSize];
+			uint32_t nextJob = 0;
+			std::thread thread;
+		};
+
+		// [0] is the main thread, which has a deque but no std::thread
+		std::vector<std::unique_ptr<Worker>> workers;
+		thread_local unsigned int threadIndex = 0;
+
+		std::atomic<bool> running = false;
+		std::atomic<uint32_t> queuedJobs = 0;
+		std::atomic<uint32_t> sleepingWorkers = 0;
+		std::mutex sleepMutex;
+		std::condition_variable wakeCondition;
+
+		void Execute(const Job& job)
+		{
+			job.Function(job.Data, job.Begin, job.End);
+
+			if (job.Group)
+				job.Group->Pending.fetch_sub(1, std::memory_order_release);
+		}
+
+		// Own deque first, then try stealing from everyone else
+		bool TryRunOneJob(unsigned int index)
+		{
+			Job* job = workers[index]->deque.Pop();
+
+			unsigned int count = (unsigned int)workers.size();
+			for (unsigned int i = 1; !job && i < count; i++)
+				job = workers[(index + i) % count]->deque.Steal();
+
+			if (!job)
+				return false;
+
+			// Copy out before running, so the slot in the owner's ring can be reused
+			Job copy = *job;
+			queuedJobs.fetch_sub(1, std::memory_order_relaxed);
+			Execute(copy);
+			return true;
+		}
+
+		void WorkerLoop(unsigned int index)
+		{
+			threadIndex = index;
+
+			while (running.load(std::memory_order_acquire))
+			{
+				if (TryRunOneJob(index))
+					continue;
+
+				// Nothing to do anywhere - sleep until something is queued
+				std::unique_lock<std::mutex> lock(sleepMutex);
+				sleepingWorkers.fetch_add(1);
+				wakeCondition.wait(lock, [] { return queuedJobs.load() > 0 || !running.load(); });
+				sleepingWorkers.fetch_sub(1);
+			}
+		}
+	}
+}
+
+void JobSystem::Initialize(unsigned int workerThreads)
+{
+	if (!workers.empty())
+		return;
+
+	if (workerThreads == 0)
+	{
+		unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		workerThreads = hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	running = true;
+	for (unsigned int i = 0; i <= workerThreads; i++)
+		workers.push_back(std::make_unique<Worker>());
+
+	// Start threads only after the vector is final, since they read it
+	for (unsigned int i = 1; i <= workerThreads; i++)
+		workers[i]->thread = std::thread(WorkerLoop, i);
+}
+
+void JobSystem::ShutDown()
+{
+	{
+		std::lock_guard<std::mutex> lock(sleepMutex);
+		running = false;
+	}
+	wakeCondition.notify_all();
+
+	for (auto& w : workers)
+	{
+		if (w->thread.joinable())
+			w->thread.join();
+	}
+	workers.clear();
+}
+
+unsigned int JobSystem::ThreadCount() { return workers.empty() ? 1 : (unsigned int)workers.size(); }
+unsigned int JobSystem::ThreadIndex() { return threadIndex; }
+
+void JobSystem::Run(const Job& job, Counter* group)
+{
+	if (group)
+		group->Pending.fetch_add(1, std::memory_order_relaxed);
+
+	// Not initialized - run inline so callers still work
+	if (workers.empty())
+	{
+		Job copy = job;
+		copy.Group = group;
+		Execute(copy);
+		return;
+	}
+
+	Worker& w = *workers[threadIndex];
+	Job* slot = &w.jobRing[w.nextJob++ & (JobRingSize - 1)];
+	*slot = job;
+	slot->Group = group;
+
+	// Count it before it's visible, so a thief can't decrement first
+	queuedJobs.fetch_add(1);
+
+	// Deque is full - do the work ourselves rather than block
+	if (!w.deque.Push(slot))
+	{
+		queuedJobs.fetch_sub(1);
+		Execute(*slot);
+		return;
+	}
+
+	// Only pay for the mutex & notify if a worker is actually asleep
+	if (sleepingWorkers.load() > 0)
+	{
+		{ std::lock_guard<std::mutex> lock(sleepMutex); }
+		wakeCondition.notify_one();
+	}
+}
+
+void JobSystem::Wait(Counter* group)
+{
+	while (!group->IsDone())
+	{
+		// Help out instead of blocking - this is how the main thread participates
+		if (workers.empty() || !TryRunOneJob(threadIndex))
+			std::this_thread::yield();
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// See JobSystem.cpp for implementation details
+
+namespace JobSystem
+{
+	// Tracks how many jobs in a group are still unfinished
+	// - Jobs that depend on a group simply Wait() on its counter
+	struct Counter
+	{
+		std::atomic<uint32_t> Pending = 0;
+		bool IsDone() const { return Pending.load(std::memory_order_acquire) == 0; }
+	};
+
+	// A unit of work: calls Function(Data, Begin, End)
+	// - Kept small & trivially copyable so it can live in the lock-free deques
+	struct Job
+	{
+		void (*Function)(void* data, uint32_t begin, uint32_t end);
+		void* Data;
+		uint32_t Begin;
+		uint32_t End;
+		Counter* Group;
+	};
+
+	// General functions
+	void Initialize(unsigned int workerThreads = 0); // 0 = one per hardware thread, minus the main thread
+	void ShutDown();
+
+	// Getters
+	unsigned int ThreadCount(); // Workers + the main thread
+	unsigned int ThreadIndex(); // 0 on the main thread
+
+	// Queues a job on the calling thread's deque; idle threads steal it from there
+	// - Only the main thread & job threads may call this
+	void Run(const Job& job, Counter* group);
+
+	// Runs other jobs (rather than sleeping) until the group is done
+	void Wait(Counter* group);
+
+	// --------------------------------------------------------
+	// Splits [0, count) into batches of at least minBatchSize
+	// and calls func(begin, end) for each across all threads.
+	// Returns once every batch has finished.
+	// --------------------------------------------------------
+	template<typename Func>
+	void ParallelFor(uint32_t count, uint32_t minBatchSize, Func&& func)
+	{
+		if (count == 0)
+			return;
+
+		// A few batches per thread balances load without flooding the deques
+		uint32_t batches = (count + minBatchSize - 1) / (minBatchSize > 0 ? minBatchSize : 1);
+		uint32_t maxBatches = ThreadCount() * 4;
+		if (batches > maxBatches) batches = maxBatches;
+
+		// Not worth the overhead - just do it here
+		if (batches <= 1)
+		{
+			func(0u, count);
+			return;
+		}
+
+		using FuncType = std::remove_reference_t<Func>;
+		uint32_t batchSize = (count + batches - 1) / batches;
+
+		Counter group;
+		for (uint32_t begin = 0; begin < count; begin += batchSize)
+		{
+			Job job = {};
+			job.Function = [](void* data, uint32_t b, uint32_t e) { (*static_cast<FuncType*>(data))(b, e); };
+			job.Data = const_cast<void*>(static_cast<const void*>(&func));
+			job.Begin = begin;
+			job.End = begin + batchSize < count ? begin + batchSize : count;
+			Run(job, &group);
+		}
+
+		Wait(&group);
+	}
+}
@@ -5,18 +5,14 @@
 #define LIGHT_TYPE_POINT 1
 #define LIGHT_TYPE_SPOT 2
 
-#include <DirectXMath.h>
+// Generated from the HLSL Light struct in ShaderInclude.hlsli (see
+// ShaderStructs.h), so it always matches what the shaders read
+// - Type: which kind of light (see above)
+// - Direction: directional & spot lights
+// - Range & Position: point & spot lights (Range is for attenuation)
+// - Intensity & Color: all lights
+// - SpotInnerAngle & SpotOuterAngle: spot cone, in radians - full light
+//   inside the inner angle, none outside the outer
+#include "ShaderStructs.h"
 
-struct Light
-{
-	// *NOTE: Order important here for use in constant buffer!*
-	int Type; // Which kind of light? 0, 1 or 2 (see above)
-	DirectX::XMFLOAT3 Direction; // Directional and Spot lights need a direction
-	float Range; // Point and Spot lights have a max range for attenuation
-	DirectX::XMFLOAT3 Position; // Point and Spot lights have a position in space
-	float Intensity; // All lights need an intensity
-	DirectX::XMFLOAT3 Color; // All lights need a color
-	float SpotInnerAngle; // Inner cone angle (in radians)  Inside this, full light!
-	float SpotOuterAngle; // Outer cone angle (radians)  Outside this, no light!
-	DirectX::XMFLOAT2 Padding; // Purposefully padding to hit the 16-byte boundary
-};
+using Light = ShaderStructs::Light;
@@ -6,6 +6,15 @@
 #include "Graphics.h"
 #include "Game.h"
 #include "Input.h"
+#include "MemoryTracker.h"
+#include "SelfTests.h"
+#include "NullDevice.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+#include <vector>
 
 // Annonymous namespace to hold variables
 // only accessible in this file
@@ -27,6 +36,132 @@ namespace
 		if(game)
 			game->OnResize();
 	}
+
+	// Called before the swap chain is resized, so
+	// the game can finish any frames still being
+	// rendered with the old buffers
+	void WindowBeforeResizeCallback()
+	{
+		if(game)
+			game->FlushRenderThread();
+	}
+
+	// --------------------------------------------------------
+	// Prints frame timings & what the null backend and device
+	// saw, and returns 1 if the backend saw any errors (0 if not)
+	// --------------------------------------------------------
+	int ReportHeadless(std::span<const double> frameMilliseconds, const NullBackend::Stats& stats, const NullDevice::Stats& deviceStats)
+	{
+		double total = 0;
+		double fastest = frameMilliseconds.empty() ? 0 : frameMilliseconds[0];
+		double slowest = 0;
+		for (double ms : frameMilliseconds)
+		{
+			total += ms;
+			fastest = ms < fastest ? ms : fastest;
+			slowest = ms > slowest ? ms : slowest;
+		}
+
+		size_t frameCount = frameMilliseconds.size();
+		uint64_t frames = stats.Frames > 0 ? stats.Frames : 1;
+		printf("Headless: %zu frames, %.3f ms average (%.3f fastest, %.3f slowest)\n",
+			frameCount, frameCount > 0 ? total / frameCount : 0.0, fastest, slowest);
+		printf("Null device: %llu objects created, %llu bytes of buffers\n",
+			(unsigned long long)deviceStats.Objects, (unsigned long long)deviceStats.BufferBytes);
+		printf("Null backend: %llu pipelines, %llu materials, %llu draws of %llu objects, %llu full screen draws\n",
+			(unsigned long long)stats.Pipelines, (unsigned long long)stats.Materials, (unsigned long long)stats.Draws,
+			(unsigned long long)stats.Instances, (unsigned long long)stats.FullscreenDraws);
+		printf("Null backend: %llu clears, %llu target binds, %llu textures, %llu presents\n",
+			(unsigned long long)stats.Clears, (unsigned long long)stats.TargetBinds, (unsigned long long)stats.Textures,
+			(unsigned long long)stats.Presents);
+		printf("Null backend: %llu bytes a frame - %llu of constants, %llu of buffers (%llu updates, %llu maps), %llu of UI\n",
+			(unsigned long long)((stats.ConstantBytes + stats.BufferBytes + stats.UIBytes) / frames),
+			(unsigned long long)(stats.ConstantBytes / frames), (unsigned long long)(stats.BufferBytes / frames),
+			(unsigned long long)stats.BufferUpdates, (unsigned long long)stats.BufferMaps, (unsigned long long)(stats.UIBytes / frames));
+		if (stats.Errors > 0)
+		{
+			printf("Null backend: %llu errors, first: %s\n", (unsigned long long)stats.Errors, stats.FirstError);
+			return 1;
+		}
+		return 0;
+	}
+
+	// --------------------------------------------------------
+	// Runs a fixed number of frames with a fixed script & prints
+	// how long the CPU took over each, for regression tests
+	//
+	// - There's no window or GPU: the game loads & renders the
+	//   usual way, onto a NullDevice & into the null backend
+	//   (see Graphics::InitializeHeadless())
+	// - Every frame steps time by exactly 1/60 s with no input,
+	//   so the scene's animations (and so culling & the draws
+	//   recorded) play out the same way every run
+	// - Returns 0 if every self test & frame passed, 1 if not
+	// --------------------------------------------------------
+	int RunHeadless(unsigned int frameCount)
+	{
+		const float deltaTime = 1.0f / 60.0f;
+
+		LARGE_INTEGER perfFreq{};
+		QueryPerformanceFrequency(&perfFreq);
+		double perfMilliseconds = 1000.0 / (double)perfFreq.QuadPart;
+
+		// A regression run fails on these before timing anything
+		const char* selfTestFailure = SelfTests::RunAll();
+		if (selfTestFailure)
+		{
+			printf("Self test failed - %s\n", selfTestFailure);
+			return 1;
+		}
+
+		// Textures are still decoded through WIC, which is COM
+		CoInitializeEx(0, COINIT_APARTMENTTHREADED);
+
+		// The same start up as a windowed run, minus the window & GPU
+		Window::CreateHeadless(1280, 720);
+		if (FAILED(Graphics::InitializeHeadless(Window::Width(), Window::Height())))
+		{
+			printf("Headless graphics failed to initialize\n");
+			CoUninitialize();
+			return 1;
+		}
+		Input::Initialize(Window::Handle());
+		MemoryTracker::Initialize();
+
+		game = new Game();
+		game->Initialize();
+
+		std::vector<double> frameTimes(frameCount);
+		for (unsigned int frame = 0; frame < frameCount; frame++)
+		{
+			__int64 start = 0;
+			__int64 end = 0;
+			QueryPerformanceCounter((LARGE_INTEGER*)&start);
+
+			MemoryTracker::BeginFrame();
+			float totalTime = frame * deltaTime;
+			game->Update(deltaTime, totalTime);
+			game->Draw(deltaTime, totalTime);
+			MemoryTracker::EndFrame();
+
+			QueryPerformanceCounter((LARGE_INTEGER*)&end);
+			frameTimes[frame] = (end - start) * perfMilliseconds;
+		}
+
+		// The render thread may still be replaying the last few
+		game->FlushRenderThread();
+
+		NullDevice* device = static_cast<NullDevice*>(Graphics::Device.Get());
+		int result = ReportHeadless(frameTimes, game->NullBackendStats(), device->GetStats());
+
+		// Clean up
+		delete game;
+		game = 0;
+		Input::ShutDown();
+		Graphics::ShutDown();
+		CoUninitialize();
+		return result;
+	}
 }
 
 
@@ -40,6 +175,13 @@ int WINAPI WinMain(
 	_In_ LPSTR lpCmdLine,				// Command line params
 	_In_ int nCmdShow)					// How the window should be shown (we ignore this)
 {
+	// "-headless N" runs N scripted frames without a window or GPU,
+	// prints their timings & quits
+	unsigned int headlessFrames = 0;
+	const char* headlessArg = strstr(lpCmdLine, "-headless");
+	if (headlessArg)
+		sscanf_s(headlessArg, "-headless %u", &headlessFrames);
+
 #if defined(DEBUG) | defined(_DEBUG)
 	// Enable memory leak detection as a quick and dirty
 	// way of determining if we forgot to clean something up
@@ -48,8 +190,21 @@ int WINAPI WinMain(
 	// Do we also want a console window?  Probably only in debug mode
 	Window::CreateConsoleWindow(500, 120, 32, 120);
 	printf("Console window created successfully.  Feel free to printf() here.\n");
+
+	// Catch broken CPU-side pieces before anything uses them
+	const char* selfTestFailure = SelfTests::RunAll();
+	if (selfTestFailure)
+		printf("Self test failed - %s\n", selfTestFailure);
+#else
+	// ...or when there's a headless run to report on
+	if (headlessFrames > 0)
+		Window::CreateConsoleWindow(500, 120, 32, 120);
 #endif
 
+	// Sets up everything itself, without the window
+	if (headlessFrames > 0)
+		return RunHeadless(headlessFrames);
+
 	// Set up app initialization details
 	unsigned int windowWidth = 1280;
 	unsigned int windowHeight = 720;
@@ -67,7 +222,8 @@ int WINAPI WinMain(
 		windowHeight,
 		windowTitle,
 		statsInTitleBar,
-		WindowResizeCallback);
+		WindowResizeCallback,
+		WindowBeforeResizeCallback);
 	if (FAILED(windowResult))
 		return windowResult;
 
@@ -83,6 +239,9 @@ int WINAPI WinMain(
 	// Initalize the input system, which requires the window handle
 	Input::Initialize(Window::Handle());
 
+	// Start counting allocations before ImGui (created by the game) exists
+	MemoryTracker::Initialize();
+
 	// Now the game itself can be initialzied
 	game->Initialize();
 
@@ -116,6 +275,8 @@ int WINAPI WinMain(
 		}
 		else
 		{
+			MemoryTracker::BeginFrame();
+
 			// Calculate up-to-date timing info
 			QueryPerformanceCounter((LARGE_INTEGER*)&currentTime);
 			float deltaTime = max((float)((currentTime - previousTime) * perfSeconds), 0.0f);
@@ -139,6 +300,9 @@ int WINAPI WinMain(
 			// Print any graphics debug messages that occurred this frame
 			Graphics::PrintDebugMessages();
 #endif
+
+			// Reports if this frame touched the heap (debug only)
+			MemoryTracker::EndFrame();
 		}
 	}
 
@@ -148,3 +312,15 @@ int WINAPI WinMain(
 	Graphics::ShutDown();
 	return (HRESULT)msg.wParam;
 }
+
+
+// --------------------------------------------------------
+// Entry point for the console build (Tools/Headless), which
+// only ever runs headless - the only argument is how many
+// frames to run (600 if it's missing)
+// --------------------------------------------------------
+int main(int argc, char** argv)
+{
+	unsigned int frameCount = argc > 1 ? (unsigned int)strtoul(argv[1], 0, 10) : 600;
+	return RunHeadless(frameCount);
+}
@@ -1,9 +1,16 @@
 #include "Material.h"
+#include "Resources.h"
+#include "Graphics.h"
+#include "TrackedContext.h"
+#include "ShaderStructs.h"
+#include "ShaderLibrary.h"
+#include "PipelineState.h"
+#include "RenderBackend.h"
 
 Material::Material(const char* name,
 	DirectX::XMFLOAT4 colorTint,
-	std::shared_ptr<SimpleVertexShader> vertShader,
-	std::shared_ptr<SimplePixelShader> pixShader,
+	VertexShaderHandle vertShader,
+	PixelShaderHandle pixShader,
 	DirectX::XMFLOAT2 uvScale,
 	DirectX::XMFLOAT2 uvOffset):
 		name(name),
@@ -13,23 +20,174 @@ Material::Material(const char* name,
 		uvScale(uvScale),
 		uvOffset(uvOffset)
 {
+	// Made here (not on first upload) so the rendering thread only ever writes it
+	D3D11_BUFFER_DESC cbDesc = {};
+	cbDesc.Usage = D3D11_USAGE_DEFAULT;
+	cbDesc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	cbDesc.ByteWidth = sizeof(Parameters);
+	Graphics::Device->CreateBuffer(&cbDesc, 0, parameterBuffer.GetAddressOf());
 }
 
 // Getters
 const char* Material::GetMaterialName() { return name; }
 DirectX::XMFLOAT4 Material::GetColorTint() { return colorTint; }
-std::shared_ptr<SimpleVertexShader> Material::GetVertexShader() { return vertShader; }
-std::shared_ptr<SimplePixelShader> Material::GetPixelShader() { return pixShader; }
+SimpleVertexShader* Material::GetVertexShader() { return Resources::VertexShaders.Get(vertShader); }
+SimplePixelShader* Material::GetPixelShader() { return Resources::PixelShaders.Get(pixShader); }
+VertexShaderHandle Material::GetVertexShaderHandle() { return vertShader; }
+PixelShaderHandle Material::GetPixelShaderHandle() { return pixShader; }
 DirectX::XMFLOAT2 Material::GetUVScale() { return uvScale; }
 DirectX::XMFLOAT2 Material::GetUVOffset() { return uvOffset; }
-std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> Material::GetTextureSRVMap() { return textureSRVs; }
-std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> Material::GetSamplerMap() { return samplers; }
+const std::unordered_map<std::string, TextureHandle>& Material::GetTextureSRVMap() { return textureSRVs; }
+const std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>>& Material::GetSamplerMap() { return samplers; }
 
 // Setters
-void Material::SetColorTint(DirectX::XMFLOAT4 tint) { this->colorTint = tint; }
-void Material::SetVertexShader(std::shared_ptr<SimpleVertexShader> vertShader) { this->vertShader = vertShader; }
-void Material::SetPixelShader(std::shared_ptr<SimplePixelShader> pixShader) { this->pixShader = pixShader; }
-void Material::SetUVScale(DirectX::XMFLOAT2 uvScale) { this->uvScale = uvScale; }
-void Material::SetUVOffset(DirectX::XMFLOAT2 uvOffset) { this->uvOffset = uvOffset; }
-void Material::AddTextureSRV(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv) { textureSRVs.insert({ name, srv }); }
-void Material::AddSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler) { samplers.insert({ name, sampler }); }
+void Material::SetColorTint(DirectX::XMFLOAT4 tint) { this->colorTint = tint; parametersDirty = true; }
+void Material::SetVertexShader(VertexShaderHandle vertShader) { this->vertShader = vertShader; variant.Prepared = false; }
+void Material::SetPixelShader(PixelShaderHandle pixShader) { this->pixShader = pixShader; variant.Prepared = false; }
+void Material::SetUVScale(DirectX::XMFLOAT2 uvScale) { this->uvScale = uvScale; parametersDirty = true; }
+void Material::SetUVOffset(DirectX::XMFLOAT2 uvOffset) { this->uvOffset = uvOffset; parametersDirty = true; }
+void Material::AddTextureSRV(std::string name, TextureHandle srv) { textureSRVs.insert({ name, srv }); bindings.Shader = 0; }
+void Material::AddSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler) { samplers.insert({ name, sampler }); bindings.Shader = 0; }
+
+// --------------------------------------------------------
+// Resolves the permutation's pixel shader & the vertex
+// shader's INSTANCED variant, falling back to per-object
+// constants if there isn't a usable one
+// --------------------------------------------------------
+const Material::Variant& Material::PrepareVariant(uint32_t permutation)
+{
+	if (variant.Prepared && variant.Permutation == permutation)
+		return variant;
+
+	variant = {};
+	variant.Permutation = permutation;
+	variant.PixelShader = ShaderLibrary::SelectVariant(pixShader, permutation);
+	variant.VertexShader = vertShader;
+
+	VertexShaderHandle instancedVS = ShaderLibrary::SelectVariant(vertShader, ShaderPermutation::Instanced);
+	SimpleVertexShader* candidate = Resources::VertexShaders.Get(instancedVS);
+	if (candidate && candidate->GetPerInstanceCompatible())
+	{
+		variant.VertexShader = instancedVS;
+		variant.Instanced = true;
+	}
+
+	PipelineStateDesc desc;
+	desc.VertexShader = variant.VertexShader;
+	desc.PixelShader = variant.PixelShader;
+	variant.Pipeline = PipelineStates::Get(desc);
+
+	variant.Prepared = true;
+	return variant;
+}
+
+// --------------------------------------------------------
+// Copies the parameters out for a snapshot if they changed,
+// so the rendering thread never reads the live fields
+// --------------------------------------------------------
+bool Material::TakeParameters(Parameters& parameters)
+{
+	if (!parametersDirty)
+		return false;
+
+	parameters = {};
+	parameters.colorTint = colorTint;
+	parameters.uvScale = uvScale;
+	parameters.uvOffset = uvOffset;
+	parametersDirty = false;
+	return true;
+}
+
+void Material::UploadParameters(const Parameters& parameters, RenderBackend& backend)
+{
+	if (!parameterBuffer)
+		return;
+
+	backend.UpdateBuffer(parameterBuffer.Get(), &parameters, sizeof(Parameters));
+	parameterUploads.fetch_add(1, std::memory_order_relaxed);
+}
+
+// --------------------------------------------------------
+// Binds the material's PerMaterial buffer over the default
+// one every pixel shader binds (see CreateSharedConstantBuffers)
+// - A new material is dirty, so the first snapshot it's in
+//   uploads it before any of its draws
+// --------------------------------------------------------
+void Material::BindParameters(ID3D11DeviceContext* context)
+{
+	if (!parameterBuffer)
+		return;
+
+	if (TrackedContext::Tracks(context))
+		TrackedContext::SetConstantBuffer(TrackedContext::Pixel, Parameters::Register, parameterBuffer.Get());
+	else
+		context->PSSetConstantBuffers(Parameters::Register, 1, parameterBuffer.GetAddressOf());
+}
+
+// --------------------------------------------------------
+// Binds the material's textures & samplers as two ranges
+// --------------------------------------------------------
+void Material::BindResources(SimplePixelShader* ps, ID3D11DeviceContext* context)
+{
+	if (bindings.Shader != ps)
+		ResolveBindings(ps);
+
+	if (TrackedContext::Tracks(context))
+	{
+		TrackedContext::SetShaderResources(TrackedContext::Pixel, bindings.FirstSRV, (unsigned int)bindings.SRVs.size(), bindings.SRVs.data());
+		TrackedContext::SetSamplers(TrackedContext::Pixel, bindings.FirstSampler, (unsigned int)bindings.Samplers.size(), bindings.Samplers.data());
+		return;
+	}
+
+	if (!bindings.SRVs.empty())
+		context->PSSetShaderResources(bindings.FirstSRV, (UINT)bindings.SRVs.size(), bindings.SRVs.data());
+	if (!bindings.Samplers.empty())
+		context->PSSetSamplers(bindings.FirstSampler, (UINT)bindings.Samplers.size(), bindings.Samplers.data());
+}
+
+// --------------------------------------------------------
+// Turns the name -> resource maps into register-indexed
+// tables for one shader.  Names the shader doesn't use
+// are skipped, just like SetShaderResourceView() would.
+// --------------------------------------------------------
+void Material::ResolveBindings(SimplePixelShader* ps)
+{
+	bindings = {};
+	bindings.Shader = ps;
+
+	// Each resource's register, and the range they span
+	std::vector<std::pair<unsigned int, ID3D11ShaderResourceView*>> srvSlots;
+	for (auto& t : textureSRVs)
+	{
+		const SimpleSRV* info = ps->GetShaderResourceViewInfo(t.first);
+		if (info) srvSlots.push_back({ info->BindIndex, Resources::GetSRV(t.second) });
+	}
+
+	std::vector<std::pair<unsigned int, ID3D11SamplerState*>> samplerSlots;
+	for (auto& s : samplers)
+	{
+		const SimpleSampler* info = ps->GetSamplerInfo(s.first);
+		if (info) samplerSlots.push_back({ info->BindIndex, s.second.Get() });
+	}
+
+	// Lay both out as [first, last] with the gaps left null
+	auto fill = [](auto& slots, unsigned int& first, auto& table)
+	{
+		if (slots.empty())
+			return;
+
+		first = slots[0].first;
+		unsigned int last = first;
+		for (auto& slot : slots)
+		{
+			if (slot.first < first) first = slot.first;
+			if (slot.first > last) last = slot.first;
+		}
+
+		table.assign(last - first + 1, 0);
+		for (auto& slot : slots)
+			table[slot.first - first] = slot.second;
+	};
+	fill(srvSlots, bindings.FirstSRV, bindings.SRVs);
+	fill(samplerSlots, bindings.FirstSampler, bindings.Samplers);
+}
@@ -2,10 +2,17 @@
 
 #include <d3d11.h> //  Direct3D "stuff"
 #include <memory>
+#include <atomic>
 #include "SimpleShader.h"
+#include "ResourceHandles.h"
 #include "Transform.h"
 #include "Camera.h"
+#include "ShaderStructs.h"
 #include <unordered_map>
+#include <vector>
+
+struct PipelineState;
+class RenderBackend;
 
 class Material
 {
@@ -13,42 +20,104 @@ public:
 	// Constructor
 	Material(const char* name,
 		DirectX::XMFLOAT4 colorTint,
-		std::shared_ptr<SimpleVertexShader> vertShader, 
-		std::shared_ptr<SimplePixelShader> pixShader, 
+		VertexShaderHandle vertShader,
+		PixelShaderHandle pixShader,
 		DirectX::XMFLOAT2 uvScale = DirectX::XMFLOAT2(1, 1),
 		DirectX::XMFLOAT2 uvOffset = DirectX::XMFLOAT2(0, 0));
 
 	// Getters
 	const char* GetMaterialName();
 	DirectX::XMFLOAT4 GetColorTint(); 
-	std::shared_ptr<SimpleVertexShader> GetVertexShader();
-	std::shared_ptr<SimplePixelShader> GetPixelShader();
+	SimpleVertexShader* GetVertexShader(); // Resolved from the shader pools - don't hold on to these
+	SimplePixelShader* GetPixelShader();
+	VertexShaderHandle GetVertexShaderHandle();
+	PixelShaderHandle GetPixelShaderHandle();
 	DirectX::XMFLOAT2 GetUVScale();
 	DirectX::XMFLOAT2 GetUVOffset();
-	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> GetTextureSRVMap();
-	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> GetSamplerMap(); 
+	const std::unordered_map<std::string, TextureHandle>& GetTextureSRVMap();
+	const std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>>& GetSamplerMap();
 
 	// Setters
 	void SetColorTint(DirectX::XMFLOAT4 tint);
-	void SetVertexShader(std::shared_ptr<SimpleVertexShader> vertShader);
-	void SetPixelShader(std::shared_ptr<SimplePixelShader> pixShader);
+	void SetVertexShader(VertexShaderHandle vertShader);
+	void SetPixelShader(PixelShaderHandle pixShader);
 	void SetUVScale(DirectX::XMFLOAT2 uvScale);
 	void SetUVOffset(DirectX::XMFLOAT2 uvOffset); 
 
-	void AddTextureSRV(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
+	void AddTextureSRV(std::string name, TextureHandle srv);
 	void AddSampler(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> sampler);
 
+	// This material's shaders & pipeline for one permutation
+	// - PrepareVariant() resolves them through the shader library (which may
+	//   compile) & the pipeline cache only when the permutation or a shader
+	//   changed - game thread
+	// - GetVariant() is the last prepared, for recording on the job threads
+	struct Variant
+	{
+		uint32_t Permutation = 0;
+		bool Prepared = false;
+		VertexShaderHandle VertexShader; // The INSTANCED variant, when there is one
+		PixelShaderHandle PixelShader;
+		bool Instanced = false;			 // Reads the transform buffer instead of PerObject
+		const PipelineState* Pipeline = 0;
+	};
+	const Variant& PrepareVariant(uint32_t permutation);
+	const Variant& GetVariant() const { return variant; }
+
+	// Parameters only cross to the rendering thread as copies in a frame snapshot
+	// - TakeParameters() fills in the PerMaterial block & returns true if a setter
+	//   changed it since the last take (game thread, as the setters are)
+	// - UploadParameters() writes a taken block to this material's own buffer
+	//   through the frame's backend (rendering thread, before the frame's draws)
+	using Parameters = ShaderStructs::PixelShader::PerMaterial;
+	bool TakeParameters(Parameters& parameters);
+	void UploadParameters(const Parameters& parameters, RenderBackend& backend);
+	uint64_t GetParameterUploads() const { return parameterUploads.load(std::memory_order_relaxed); }
+
+	// Binds this material's own PerMaterial buffer to the pixel shader
+	// - Call after the pixel shader's SetShader(), on the rendering thread
+	void BindParameters(ID3D11DeviceContext* context);
+
+	// Binds this material's textures & samplers with one ranged call each
+	// - The names are resolved against the shader's registers only when the
+	//   shader differs from last time, into flat slot tables
+	// - Call when the material (or its pixel shader) changes, rendering thread only
+	void BindResources(SimplePixelShader* ps, ID3D11DeviceContext* context);
+
 private:
 	// Fields
 	DirectX::XMFLOAT4 colorTint;
-	std::shared_ptr<SimpleVertexShader> vertShader;
-	std::shared_ptr<SimplePixelShader> pixShader;
+	VertexShaderHandle vertShader;
+	PixelShaderHandle pixShader;
 	DirectX::XMFLOAT2 uvScale;
 	DirectX::XMFLOAT2 uvOffset;
 	const char* name; // Name to make displaying in the UI easier
+	Variant variant;
+
+	// Persistent GPU copy of colorTint, uvScale & uvOffset, so draws
+	// of the same material don't re-upload them (created with the material)
+	// - The dirty flag belongs to the game thread; the upload count is
+	//   written by the rendering thread & read by the UI
+	Microsoft::WRL::ComPtr<ID3D11Buffer> parameterBuffer;
+	bool parametersDirty = true;
+	std::atomic<uint64_t> parameterUploads = 0;
+
+	// Contiguous register ranges covering this material's textures & samplers,
+	// built from the maps below for one shader - slots in a range the material
+	// doesn't fill are bound as null.  Textures & samplers must outlive the
+	// material (the pools & maps hold the references).
+	struct BindingTable
+	{
+		SimplePixelShader* Shader = 0; // Shader the table was resolved for
+		unsigned int FirstSRV = 0;
+		unsigned int FirstSampler = 0;
+		std::vector<ID3D11ShaderResourceView*> SRVs;
+		std::vector<ID3D11SamplerState*> Samplers;
+	} bindings;
+	void ResolveBindings(SimplePixelShader* ps);
 
 	// Hash tables to store textures & samplers
-	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> textureSRVs;
+	std::unordered_map<std::string, TextureHandle> textureSRVs;
 	std::unordered_map<std::string, Microsoft::WRL::ComPtr<ID3D11SamplerState>> samplers;
 };
 
@@ -0,0 +1,137 @@
+#include "MemoryTracker.h"
+
+#include <Windows.h>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <malloc.h>
+#include <new>
+
+#include "ImGui/imgui.h"
+
+// --------------------------------------------------------
+// Debug-only heap allocation tracking
+//
+// The steady-state frame is meant to be allocation free.
+// In debug builds this file replaces the global operator
+// new & delete (and ImGui's allocator) with counting
+// versions.  After a short warm up, any frame that still
+// allocates is reported to the console; enabling "Break on
+// allocation" stops in the debugger at the offending call.
+//
+// Release builds compile all of this down to no-ops.
+// --------------------------------------------------------
+
+#if defined(DEBUG) || defined(_DEBUG)
+
+// Annonymous namespace to hold variables
+// only accessible in this file
+namespace
+{
+	// Frames allowed to allocate while caches, arenas & ImGui windows fill up
+	constexpr uint64_t WarmupFrames = 120;
+
+	std::atomic<uint64_t> allocations = 0;
+	std::atomic<uint64_t> bytes = 0;
+	std::atomic<bool> inFrame = false;
+	std::atomic<bool> warmedUp = false;
+	std::atomic<bool> breakOnAllocation = false;
+
+	uint64_t frameNumber = 0;
+	uint64_t lastFrameAllocations = 0;
+	uint64_t lastFrameBytes = 0;
+	uint64_t framesWithAllocations = 0;
+
+	void Count(size_t size)
+	{
+		allocations.fetch_add(1, std::memory_order_relaxed);
+		bytes.fetch_add(size, std::memory_order_relaxed);
+
+		if (breakOnAllocation.load(std::memory_order_relaxed) &&
+			warmedUp.load(std::memory_order_relaxed) &&
+			inFrame.load(std::memory_order_relaxed))
+			__debugbreak();
+	}
+
+	void* ImGuiAlloc(size_t size, void*) { Count(size); return malloc(size); }
+	void ImGuiFree(void* memory, void*) { free(memory); }
+}
+
+// Replacements for the global allocation functions
+// - Array & nothrow forms forward to these by default
+void* operator new(size_t size)
+{
+	Count(size);
+	if (void* memory = malloc(size ? size : 1))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+	Count(size);
+	if (void* memory = _aligned_malloc(size ? size : 1, (size_t)alignment))
+		return memory;
+	throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept { free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { _aligned_free(memory); }
+
+void MemoryTracker::Initialize()
+{
+	ImGui::SetAllocatorFunctions(ImGuiAlloc, ImGuiFree);
+}
+
+void MemoryTracker::BeginFrame()
+{
+	allocations = 0;
+	bytes = 0;
+	inFrame = true;
+}
+
+void MemoryTracker::EndFrame()
+{
+	inFrame = false;
+	lastFrameAllocations = allocations.load();
+	lastFrameBytes = bytes.load();
+	frameNumber++;
+	warmedUp = frameNumber > WarmupFrames;
+
+	if (!warmedUp || lastFrameAllocations == 0)
+		return;
+
+	framesWithAllocations++;
+	printf("MemoryTracker: frame %llu made %llu heap allocations (%llu bytes)\n",
+		frameNumber, lastFrameAllocations, lastFrameBytes);
+}
+
+uint64_t MemoryTracker::LastFrameAllocations() { return lastFrameAllocations; }
+uint64_t MemoryTracker::LastFrameBytes() { return lastFrameBytes; }
+uint64_t MemoryTracker::FramesWithAllocations() { return framesWithAllocations; }
+
+void MemoryTracker::BuildUI()
+{
+	ImGui::Text("Heap allocations last frame: %llu (%llu bytes)", lastFrameAllocations, lastFrameBytes);
+	ImGui::Text("Frames that allocated after warm up: %llu", framesWithAllocations);
+
+	bool breakNow = breakOnAllocation;
+	if (ImGui::Checkbox("Break on allocation", &breakNow))
+		breakOnAllocation = breakNow;
+}
+
+#else
+
+void MemoryTracker::Initialize() {}
+void MemoryTracker::BeginFrame() {}
+void MemoryTracker::EndFrame() {}
+uint64_t MemoryTracker::LastFrameAllocations() { return 0; }
+uint64_t MemoryTracker::LastFrameBytes() { return 0; }
+uint64_t MemoryTracker::FramesWithAllocations() { return 0; }
+
+void MemoryTracker::BuildUI()
+{
+	ImGui::TextDisabled("Allocation tracking is only available in debug builds");
+}
+
+#endif
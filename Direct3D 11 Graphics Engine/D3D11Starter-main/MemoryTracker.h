@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstdint>
+
+// See MemoryTracker.cpp for usage details
+
+namespace MemoryTracker
+{
+	// Hooks ImGui's allocator - call before ImGui::CreateContext()
+	void Initialize();
+
+	// Brackets one iteration of the game loop
+	void BeginFrame();
+	void EndFrame();
+
+	// Debug builds only - always 0 in release
+	uint64_t LastFrameAllocations();
+	uint64_t LastFrameBytes();
+	uint64_t FramesWithAllocations(); // Since the warm up ended
+
+	// Stats & the break-on-allocation toggle
+	void BuildUI();
+}
@@ -1,4 +1,5 @@
 #include "Mesh.h"
+#include "TrackedContext.h"
 
 // For the DirectX Math library
 using namespace DirectX;
@@ -298,6 +299,11 @@ unsigned int Mesh::GetVertexCount() { return vertCount; }
 // Returns the name of this mesh as an identifier
 const char* Mesh::GetMeshName() { return name; }
 
+// Returns the local bounding box & sphere
+const BoundingVolume& Mesh::GetBounds() { return bounds; }
+const std::vector<DirectX::XMFLOAT3>& Mesh::GetPositions() { return cpuPositions; }
+const std::vector<unsigned int>& Mesh::GetIndices() { return cpuIndices; }
+
 void Mesh::CreateVertIndBuffers(Vertex* vertices, unsigned int vertCount, unsigned int* indices, unsigned int indCount)
 {
 	// Create a VERTEX BUFFER to hold vertex data of triangles for a single object
@@ -337,16 +343,24 @@ void Mesh::CreateVertIndBuffers(Vertex* vertices, unsigned int vertCount, unsign
 	// Store the vertex & index counts
 	this->vertCount = (unsigned int)vertCount;
 	this->indCount = (unsigned int)indCount;
+
+	// Positions & indices stay on the CPU for the occlusion rasterizer
+	cpuPositions.resize(vertCount);
+	for (unsigned int i = 0; i < vertCount; i++)
+		cpuPositions[i] = vertices[i].Position;
+	cpuIndices.assign(indices, indices + indCount);
+
+	// Bounds for culling, while the vertices are still on the CPU
+	bounds = Culling::ComputeBounds(&vertices[0].Position, vertCount, sizeof(Vertex));
 }
 
 // Sets the buffers and draws using the correct number of indices
 void Mesh::SetAndDrawBuffers()
 {
 	// Refer to Game::Draw() to see the code necessary for setting buffers and drawing
-	UINT stride = sizeof(Vertex);
-	UINT offset = 0;
-	Graphics::Context->IASetVertexBuffers(0, 1, vertBuffer.GetAddressOf(), &stride, &offset);
-	Graphics::Context->IASetIndexBuffer(indBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+	// - Consecutive draws of the same mesh skip these (see TrackedContext.h)
+	TrackedContext::SetVertexBuffer(0, vertBuffer.Get(), sizeof(Vertex), 0);
+	TrackedContext::SetIndexBuffer(indBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
 
 	Graphics::Context->DrawIndexed(
 		indCount, // The number of indices to use (we could draw a subset if we wanted) ***
@@ -354,6 +368,18 @@ void Mesh::SetAndDrawBuffers()
 		0); // Offset to add to each index when looking up vertices
 }
 
+// --------------------------------------------------------
+// Draws this mesh once per instance, reading instances
+// startInstance onward from whatever's bound to slot 1
+// --------------------------------------------------------
+void Mesh::SetAndDrawInstanced(unsigned int instanceCount, unsigned int startInstance)
+{
+	TrackedContext::SetVertexBuffer(0, vertBuffer.Get(), sizeof(Vertex), 0);
+	TrackedContext::SetIndexBuffer(indBuffer.Get(), DXGI_FORMAT_R32_UINT, 0);
+
+	Graphics::Context->DrawIndexedInstanced(indCount, instanceCount, 0, 0, startInstance);
+}
+
 // Calc. Tangents
 // --------------------------------------------------------
 // Author: Chris Cascioli
@@ -4,6 +4,7 @@
 #include <wrl/client.h> // ComPtrs for Direct3D objects
 #include "Graphics.h" // Starter codes Graphics::Device & Graphics::Context objects
 #include "Vertex.h" // Access the custom Vertex struct
+#include "Culling.h" // Bounding volumes
 #include <vector>
 #include <fstream> 
 #include <stdexcept>
@@ -26,10 +27,14 @@ public:
 	unsigned int GetIndexCount(); // Returns the # of indices this mesh contains
 	unsigned int GetVertexCount(); // Returns the # of vertices this mesh contains
 	const char* GetMeshName(); // Return the identifying string of this mesh
+	const BoundingVolume& GetBounds(); // Box & sphere around the vertices, in the mesh's own space
+	const std::vector<DirectX::XMFLOAT3>& GetPositions(); // CPU copies, for the occlusion rasterizer
+	const std::vector<unsigned int>& GetIndices();
 
 	// Methods
 	void CreateVertIndBuffers(Vertex* vertices, unsigned int vertCount, unsigned int* indices, unsigned int indCount);
 	void SetAndDrawBuffers(); // Sets the buffers and draws using the correct number of indices
+	void SetAndDrawInstanced(unsigned int instanceCount, unsigned int startInstance); // Same, for a range of the bound instance buffer
 	void CalculateTangents(Vertex* verts, int numVerts, unsigned int* indices, int numIndices);
 
 private:
@@ -41,5 +46,9 @@ private:
 	// # of vertices in this mesh's vertex buffer
 	unsigned int vertCount = 0; 
 	const char* name;
+	// Computed from the vertices when the buffers are made
+	BoundingVolume bounds = {};
+	std::vector<DirectX::XMFLOAT3> cpuPositions;
+	std::vector<unsigned int> cpuIndices;
 };
 
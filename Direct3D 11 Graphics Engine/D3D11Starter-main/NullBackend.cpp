@@ -0,0 +1,241 @@
+#include "RenderBackend.h"
+
+#include "ImGui/imgui.h"
+
+// Annonymous namespace to hold variables
+// only accessible in this file
+namespace
+{
+	// Objects created on this thread (see CountCreation())
+	thread_local uint64_t creations = 0;
+}
+
+void NullBackend::CountCreation()
+{
+	creations++;
+}
+
+// --------------------------------------------------------
+// Checks are only on what the calls themselves say - which
+// pointers are set & in what order - since nothing they
+// point at may exist
+// --------------------------------------------------------
+void NullBackend::SetPipeline(const CommandStream::SetPipelinePacket& packet)
+{
+	stats.Pipelines++;
+	if (!packet.Pipeline)
+		Fail("SetPipeline with no pipeline");
+
+	pipeline = packet.Pipeline;
+}
+
+void NullBackend::SetShadowMap(const CommandStream::SetShadowMapPacket& packet)
+{
+	stats.ShadowMaps++;
+	if (!packet.PixelShader || !packet.ShadowMap || !packet.Sampler)
+		Fail("SetShadowMap missing its shader, map or sampler");
+}
+
+void NullBackend::SetMaterial(const CommandStream::SetMaterialPacket& packet)
+{
+	stats.Materials++;
+	if (!packet.RenderMaterial || !packet.PixelShader)
+		Fail("SetMaterial missing its material or shader");
+
+	material = packet.RenderMaterial;
+}
+
+void NullBackend::SetConstants(const CommandStream::SetConstantsPacket& packet, const void* data)
+{
+	stats.Constants++;
+	stats.ConstantBytes += packet.Size;
+
+	// Constant buffers are whole 16 byte registers
+	if (!packet.Shader || !data)
+		Fail("SetConstants with no shader or data");
+	else if (packet.Size == 0 || packet.Size % 16 != 0)
+		Fail("SetConstants size isn't a whole number of registers");
+}
+
+void NullBackend::Draw(const CommandStream::DrawPacket& packet)
+{
+	stats.Draws++;
+	stats.Instances += packet.InstanceCount > 0 ? packet.InstanceCount : 1;
+
+	CheckDraw();
+	if (!packet.RenderMesh)
+		Fail("Draw with no mesh");
+	else if (packet.RenderMaterial && packet.RenderMaterial != material)
+		Fail("Draw's material isn't the one bound by SetMaterial");
+	else if (packet.InstanceCount > 0 && !instanceDataBound)
+		Fail("Instanced draw with no instance data bound");
+}
+
+void NullBackend::BeginStream()
+{
+	pipeline = 0;
+	material = 0;
+}
+
+void NullBackend::BeginFrame()
+{
+	pipeline = 0;
+	material = 0;
+	targetsBound = false;
+	viewportSet = false;
+	instanceDataBound = false;
+	mapped = 0;
+	creationsAtBeginFrame = creations;
+}
+
+void NullBackend::EndFrame()
+{
+	stats.Frames++;
+	if (mapped)
+		Fail("A buffer was still mapped at the end of the frame");
+
+	// Everything a frame renders with is made on the game thread or at setup
+	if (creations != creationsAtBeginFrame)
+		Fail("Resources were created while rendering a frame");
+}
+
+void NullBackend::ClearTarget(ID3D11RenderTargetView* target, const float color[4])
+{
+	stats.Clears++;
+	if (!target || !color)
+		Fail("ClearTarget with no target or color");
+}
+
+void NullBackend::ClearDepth(ID3D11DepthStencilView* depth)
+{
+	stats.Clears++;
+	if (!depth)
+		Fail("ClearDepth with no depth buffer");
+}
+
+void NullBackend::SetTargets(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depth)
+{
+	stats.TargetBinds++;
+	if (!target && !depth)
+		Fail("SetTargets with neither a target nor a depth buffer");
+
+	targetsBound = target || depth;
+}
+
+void NullBackend::SetViewport(float width, float height)
+{
+	if (!(width > 0 && height > 0))
+		Fail("SetViewport with no area");
+
+	viewportSet = true;
+}
+
+void NullBackend::UpdateBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size)
+{
+	stats.BufferUpdates++;
+	stats.BufferBytes += size;
+
+	if (!buffer || !data || size == 0)
+		Fail("UpdateBuffer with no buffer or data");
+	else if (buffer == mapped)
+		Fail("UpdateBuffer on a mapped buffer");
+}
+
+// --------------------------------------------------------
+// Hands out the scratch copy, grown to fit, so the caller's
+// writes land somewhere real
+// --------------------------------------------------------
+void* NullBackend::MapBuffer(ID3D11Buffer* buffer, uint32_t size)
+{
+	stats.BufferMaps++;
+	stats.BufferBytes += size;
+
+	if (!buffer || size == 0)
+	{
+		Fail("MapBuffer with no buffer or size");
+		return 0;
+	}
+	if (mapped)
+	{
+		Fail("MapBuffer while another buffer is mapped");
+		return 0;
+	}
+
+	if (mapScratch.size() < size)
+		mapScratch.resize(size);
+	mapped = buffer;
+	return mapScratch.data();
+}
+
+void NullBackend::UnmapBuffer(ID3D11Buffer* buffer)
+{
+	if (!buffer || buffer != mapped)
+		Fail("UnmapBuffer of a buffer that isn't mapped");
+
+	mapped = 0;
+}
+
+void NullBackend::SetInstanceData(ID3D11Buffer* indices, uint32_t indexStride, ID3D11ShaderResourceView* transforms, uint32_t /*transformsRegister*/)
+{
+	if (!indices || indexStride == 0 || !transforms)
+		Fail("SetInstanceData missing its indices or transforms");
+
+	instanceDataBound = indices && transforms;
+}
+
+void NullBackend::SetTexture(SimplePixelShader* ps, const char* textureName, ID3D11ShaderResourceView* texture, const char* samplerName, ID3D11SamplerState* sampler)
+{
+	stats.Textures++;
+	if (!ps || !textureName || !samplerName)
+		Fail("SetTexture missing its shader or names");
+	else if (!texture || !sampler)
+		Fail("SetTexture missing its texture or sampler");
+}
+
+void NullBackend::UnbindTextures()
+{
+}
+
+void NullBackend::DrawFullscreen(SimplePixelShader* ps)
+{
+	stats.FullscreenDraws++;
+
+	CheckDraw();
+	if (!ps)
+		Fail("DrawFullscreen with no pixel shader");
+}
+
+void NullBackend::DrawUI(ImDrawData* drawData)
+{
+	// No UI at all is fine; ImGui just had nothing to draw
+	if (!drawData)
+		return;
+
+	stats.UIBytes += (uint64_t)drawData->TotalVtxCount * sizeof(ImDrawVert) + (uint64_t)drawData->TotalIdxCount * sizeof(ImDrawIdx);
+}
+
+void NullBackend::Present(bool /*vsync*/)
+{
+	stats.Presents++;
+	if (mapped)
+		Fail("Present while a buffer is mapped");
+}
+
+void NullBackend::CheckDraw()
+{
+	if (!pipeline)
+		Fail("Draw before any SetPipeline");
+	else if (!targetsBound)
+		Fail("Draw with no render target or depth buffer bound");
+	else if (!viewportSet)
+		Fail("Draw before any SetViewport");
+	else if (mapped)
+		Fail("Draw while a buffer is mapped");
+}
+
+void NullBackend::Fail(const char* error)
+{
+	stats.Errors++;
+	if (!stats.FirstError)
+		stats.FirstError = error;
+}
@@ -0,0 +1,439 @@
+#include "NullDevice.h"
+#include "RenderBackend.h"
+
+#include <cstring>
+#include <wrl/client.h>
+
+// Annonymous namespace to hold variables/helpers
+// only accessible in this file
+namespace
+{
+	// --------------------------------------------------------
+	// What every object the device makes has in common: a
+	// reference count, the device it came from, and answering
+	// QueryInterface() for its own interface & the Bases it
+	// derives from (ID3D11Resource, ID3D11View...)
+	// --------------------------------------------------------
+	template<typename Interface, typename... Bases>
+	class NullChild : public Interface
+	{
+	public:
+		explicit NullChild(ID3D11Device* device) : device(device) {}
+		virtual ~NullChild() = default;
+
+		HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override
+		{
+			if (!object)
+				return E_POINTER;
+
+			// Every interface here inherits singly, so they all share one address
+			if (riid == __uuidof(Interface) || ((riid == __uuidof(Bases)) || ...) ||
+				riid == __uuidof(ID3D11DeviceChild) || riid == __uuidof(IUnknown))
+			{
+				*object = static_cast<Interface*>(this);
+				AddRef();
+				return S_OK;
+			}
+
+			*object = 0;
+			return E_NOINTERFACE;
+		}
+
+		ULONG STDMETHODCALLTYPE AddRef() override { return ++references; }
+
+		ULONG STDMETHODCALLTYPE Release() override
+		{
+			ULONG remaining = --references;
+			if (remaining == 0)
+				delete this;
+			return remaining;
+		}
+
+		void STDMETHODCALLTYPE GetDevice(ID3D11Device** out) override
+		{
+			*out = device.Get();
+			device->AddRef();
+		}
+
+		HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID, UINT* dataSize, void*) override
+		{
+			if (dataSize)
+				*dataSize = 0;
+			return DXGI_ERROR_NOT_FOUND;
+		}
+		HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID, UINT, const void*) override { return S_OK; }
+		HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID, const IUnknown*) override { return S_OK; }
+
+	private:
+		std::atomic<ULONG> references = 1;
+		Microsoft::WRL::ComPtr<ID3D11Device> device;
+	};
+
+	// Buffers & textures, which only remember how they were described
+	template<typename Interface, typename Desc, D3D11_RESOURCE_DIMENSION Dimension>
+	class NullResource : public NullChild<Interface, ID3D11Resource>
+	{
+	public:
+		NullResource(ID3D11Device* device, const Desc& desc) : NullChild<Interface, ID3D11Resource>(device), desc(desc) {}
+
+		void STDMETHODCALLTYPE GetDesc(Desc* out) override { *out = desc; }
+		void STDMETHODCALLTYPE GetType(D3D11_RESOURCE_DIMENSION* out) override { *out = Dimension; }
+		void STDMETHODCALLTYPE SetEvictionPriority(UINT priority) override { evictionPriority = priority; }
+		UINT STDMETHODCALLTYPE GetEvictionPriority() override { return evictionPriority; }
+
+	private:
+		Desc desc;
+		UINT evictionPriority = 0;
+	};
+
+	// Views, which also keep their resource alive
+	// - A view made with no description keeps an empty one
+	template<typename Interface, typename Desc>
+	class NullView : public NullChild<Interface, ID3D11View>
+	{
+	public:
+		NullView(ID3D11Device* device, ID3D11Resource* resource, const Desc* desc) :
+			NullChild<Interface, ID3D11View>(device), resource(resource), desc(desc ? *desc : Desc{}) {}
+
+		void STDMETHODCALLTYPE GetDesc(Desc* out) override { *out = desc; }
+
+		void STDMETHODCALLTYPE GetResource(ID3D11Resource** out) override
+		{
+			*out = resource.Get();
+			resource->AddRef();
+		}
+
+	private:
+		Microsoft::WRL::ComPtr<ID3D11Resource> resource;
+		Desc desc;
+	};
+
+	// Fixed function states
+	template<typename Interface, typename Desc>
+	class NullState : public NullChild<Interface>
+	{
+	public:
+		NullState(ID3D11Device* device, const Desc& desc) : NullChild<Interface>(device), desc(desc) {}
+
+		void STDMETHODCALLTYPE GetDesc(Desc* out) override { *out = desc; }
+
+	private:
+		Desc desc;
+	};
+
+	using NullBuffer = NullResource<ID3D11Buffer, D3D11_BUFFER_DESC, D3D11_RESOURCE_DIMENSION_BUFFER>;
+	using NullTexture1D = NullResource<ID3D11Texture1D, D3D11_TEXTURE1D_DESC, D3D11_RESOURCE_DIMENSION_TEXTURE1D>;
+	using NullTexture2D = NullResource<ID3D11Texture2D, D3D11_TEXTURE2D_DESC, D3D11_RESOURCE_DIMENSION_TEXTURE2D>;
+	using NullTexture3D = NullResource<ID3D11Texture3D, D3D11_TEXTURE3D_DESC, D3D11_RESOURCE_DIMENSION_TEXTURE3D>;
+
+	// Shaders & input layouts have nothing to them past the basics
+	bool ValidBytecode(const void* bytecode, SIZE_T bytecodeLength)
+	{
+		return bytecode && bytecodeLength > 0;
+	}
+
+	// Immutable resources can't be made without their contents
+	bool ValidInitialData(D3D11_USAGE usage, const D3D11_SUBRESOURCE_DATA* initialData)
+	{
+		return usage != D3D11_USAGE_IMMUTABLE || (initialData && initialData->pSysMem);
+	}
+}
+
+NullDevice::Stats NullDevice::GetStats() const
+{
+	Stats stats;
+	stats.Objects = objects.load(std::memory_order_relaxed);
+	stats.BufferBytes = bufferBytes.load(std::memory_order_relaxed);
+	return stats;
+}
+
+template<typename Interface>
+HRESULT NullDevice::Created(Interface* object, Interface** out)
+{
+	objects.fetch_add(1, std::memory_order_relaxed);
+	NullBackend::CountCreation();
+
+	// A null out pointer is D3D's way of only validating the arguments
+	if (!out)
+	{
+		object->Release();
+		return S_FALSE;
+	}
+
+	*out = object;
+	return S_OK;
+}
+
+// --------------------------------------------------------
+// IUnknown - the device is its own only interface
+// --------------------------------------------------------
+HRESULT NullDevice::QueryInterface(REFIID riid, void** object)
+{
+	if (!object)
+		return E_POINTER;
+
+	if (riid == __uuidof(ID3D11Device) || riid == __uuidof(IUnknown))
+	{
+		*object = static_cast<ID3D11Device*>(this);
+		AddRef();
+		return S_OK;
+	}
+
+	*object = 0;
+	return E_NOINTERFACE;
+}
+
+ULONG NullDevice::AddRef() { return ++references; }
+
+ULONG NullDevice::Release()
+{
+	ULONG remaining = --references;
+	if (remaining == 0)
+		delete this;
+	return remaining;
+}
+
+// --------------------------------------------------------
+// Resources & views
+// --------------------------------------------------------
+HRESULT NullDevice::CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Buffer** buffer)
+{
+	// Constant buffers are whole 16 byte registers
+	if (!desc || desc->ByteWidth == 0 || !ValidInitialData(desc->Usage, initialData))
+		return E_INVALIDARG;
+	if ((desc->BindFlags & D3D11_BIND_CONSTANT_BUFFER) && desc->ByteWidth % 16 != 0)
+		return E_INVALIDARG;
+
+	bufferBytes.fetch_add(desc->ByteWidth, std::memory_order_relaxed);
+	return Created<ID3D11Buffer>(new NullBuffer(this, *desc), buffer);
+}
+
+HRESULT NullDevice::CreateTexture1D(const D3D11_TEXTURE1D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Texture1D** texture)
+{
+	if (!desc || desc->Width == 0 || desc->ArraySize == 0 || !ValidInitialData(desc->Usage, initialData))
+		return E_INVALIDARG;
+
+	return Created<ID3D11Texture1D>(new NullTexture1D(this, *desc), texture);
+}
+
+HRESULT NullDevice::CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Texture2D** texture)
+{
+	if (!desc || desc->Width == 0 || desc->Height == 0 || desc->ArraySize == 0 || !ValidInitialData(desc->Usage, initialData))
+		return E_INVALIDARG;
+
+	return Created<ID3D11Texture2D>(new NullTexture2D(this, *desc), texture);
+}
+
+HRESULT NullDevice::CreateTexture3D(const D3D11_TEXTURE3D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Texture3D** texture)
+{
+	if (!desc || desc->Width == 0 || desc->Height == 0 || desc->Depth == 0 || !ValidInitialData(desc->Usage, initialData))
+		return E_INVALIDARG;
+
+	return Created<ID3D11Texture3D>(new NullTexture3D(this, *desc), texture);
+}
+
+HRESULT NullDevice::CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc, ID3D11ShaderResourceView** view)
+{
+	if (!resource)
+		return E_INVALIDARG;
+
+	return Created<ID3D11ShaderResourceView>(new NullView<ID3D11ShaderResourceView, D3D11_SHADER_RESOURCE_VIEW_DESC>(this, resource, desc), view);
+}
+
+HRESULT NullDevice::CreateUnorderedAccessView(ID3D11Resource* resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D11UnorderedAccessView** view)
+{
+	if (!resource)
+		return E_INVALIDARG;
+
+	return Created<ID3D11UnorderedAccessView>(new NullView<ID3D11UnorderedAccessView, D3D11_UNORDERED_ACCESS_VIEW_DESC>(this, resource, desc), view);
+}
+
+HRESULT NullDevice::CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC* desc, ID3D11RenderTargetView** view)
+{
+	if (!resource)
+		return E_INVALIDARG;
+
+	return Created<ID3D11RenderTargetView>(new NullView<ID3D11RenderTargetView, D3D11_RENDER_TARGET_VIEW_DESC>(this, resource, desc), view);
+}
+
+HRESULT NullDevice::CreateDepthStencilView(ID3D11Resource* resource, const D3D11_DEPTH_STENCIL_VIEW_DESC* desc, ID3D11DepthStencilView** view)
+{
+	if (!resource)
+		return E_INVALIDARG;
+
+	return Created<ID3D11DepthStencilView>(new NullView<ID3D11DepthStencilView, D3D11_DEPTH_STENCIL_VIEW_DESC>(this, resource, desc), view);
+}
+
+// --------------------------------------------------------
+// Shaders & input layouts
+// --------------------------------------------------------
+HRESULT NullDevice::CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount, const void* bytecode, SIZE_T bytecodeLength, ID3D11InputLayout** layout)
+{
+	if (!elements || elementCount == 0 || !ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11InputLayout>(new NullChild<ID3D11InputLayout>(this), layout);
+}
+
+HRESULT NullDevice::CreateVertexShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* /*linkage*/, ID3D11VertexShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11VertexShader>(new NullChild<ID3D11VertexShader>(this), shader);
+}
+
+HRESULT NullDevice::CreateGeometryShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* /*linkage*/, ID3D11GeometryShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11GeometryShader>(new NullChild<ID3D11GeometryShader>(this), shader);
+}
+
+HRESULT NullDevice::CreateGeometryShaderWithStreamOutput(const void* bytecode, SIZE_T bytecodeLength, const D3D11_SO_DECLARATION_ENTRY* declaration, UINT entryCount, const UINT* /*bufferStrides*/, UINT /*strideCount*/, UINT /*rasterizedStream*/, ID3D11ClassLinkage* /*linkage*/, ID3D11GeometryShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength) || (entryCount > 0 && !declaration))
+		return E_INVALIDARG;
+
+	return Created<ID3D11GeometryShader>(new NullChild<ID3D11GeometryShader>(this), shader);
+}
+
+HRESULT NullDevice::CreatePixelShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* /*linkage*/, ID3D11PixelShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11PixelShader>(new NullChild<ID3D11PixelShader>(this), shader);
+}
+
+HRESULT NullDevice::CreateHullShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* /*linkage*/, ID3D11HullShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11HullShader>(new NullChild<ID3D11HullShader>(this), shader);
+}
+
+HRESULT NullDevice::CreateDomainShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* /*linkage*/, ID3D11DomainShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11DomainShader>(new NullChild<ID3D11DomainShader>(this), shader);
+}
+
+HRESULT NullDevice::CreateComputeShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* /*linkage*/, ID3D11ComputeShader** shader)
+{
+	if (!ValidBytecode(bytecode, bytecodeLength))
+		return E_INVALIDARG;
+
+	return Created<ID3D11ComputeShader>(new NullChild<ID3D11ComputeShader>(this), shader);
+}
+
+HRESULT NullDevice::CreateClassLinkage(ID3D11ClassLinkage** /*linkage*/) { return E_NOTIMPL; }
+
+// --------------------------------------------------------
+// Fixed function states
+// --------------------------------------------------------
+HRESULT NullDevice::CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** state)
+{
+	if (!desc)
+		return E_INVALIDARG;
+
+	return Created<ID3D11BlendState>(new NullState<ID3D11BlendState, D3D11_BLEND_DESC>(this, *desc), state);
+}
+
+HRESULT NullDevice::CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** state)
+{
+	if (!desc)
+		return E_INVALIDARG;
+
+	return Created<ID3D11DepthStencilState>(new NullState<ID3D11DepthStencilState, D3D11_DEPTH_STENCIL_DESC>(this, *desc), state);
+}
+
+HRESULT NullDevice::CreateRasterizerState(const D3D11_RASTERIZER_DESC* desc, ID3D11RasterizerState** state)
+{
+	if (!desc)
+		return E_INVALIDARG;
+
+	return Created<ID3D11RasterizerState>(new NullState<ID3D11RasterizerState, D3D11_RASTERIZER_DESC>(this, *desc), state);
+}
+
+HRESULT NullDevice::CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** state)
+{
+	if (!desc)
+		return E_INVALIDARG;
+
+	return Created<ID3D11SamplerState>(new NullState<ID3D11SamplerState, D3D11_SAMPLER_DESC>(this, *desc), state);
+}
+
+// --------------------------------------------------------
+// Queries, contexts & sharing
+// --------------------------------------------------------
+HRESULT NullDevice::CreateQuery(const D3D11_QUERY_DESC* /*desc*/, ID3D11Query** /*query*/) { return E_NOTIMPL; }
+HRESULT NullDevice::CreatePredicate(const D3D11_QUERY_DESC* /*desc*/, ID3D11Predicate** /*predicate*/) { return E_NOTIMPL; }
+HRESULT NullDevice::CreateCounter(const D3D11_COUNTER_DESC* /*desc*/, ID3D11Counter** /*counter*/) { return E_NOTIMPL; }
+HRESULT NullDevice::CreateDeferredContext(UINT /*flags*/, ID3D11DeviceContext** /*context*/) { return E_NOTIMPL; }
+HRESULT NullDevice::OpenSharedResource(HANDLE /*resource*/, REFIID /*riid*/, void** /*object*/) { return E_NOTIMPL; }
+
+// --------------------------------------------------------
+// Capabilities
+// --------------------------------------------------------
+HRESULT NullDevice::CheckFormatSupport(DXGI_FORMAT /*format*/, UINT* support)
+{
+	if (!support)
+		return E_INVALIDARG;
+
+	*support = ~0u;
+	return S_OK;
+}
+
+HRESULT NullDevice::CheckMultisampleQualityLevels(DXGI_FORMAT /*format*/, UINT sampleCount, UINT* qualityLevels)
+{
+	if (!qualityLevels)
+		return E_INVALIDARG;
+
+	// Only the single sample "multisampling" every texture has
+	*qualityLevels = sampleCount == 1 ? 1 : 0;
+	return S_OK;
+}
+
+void NullDevice::CheckCounterInfo(D3D11_COUNTER_INFO* info)
+{
+	if (info)
+		*info = {};
+}
+
+HRESULT NullDevice::CheckCounter(const D3D11_COUNTER_DESC* /*desc*/, D3D11_COUNTER_TYPE* /*type*/, UINT* /*activeCounters*/, LPSTR /*name*/, UINT* /*nameLength*/, LPSTR /*units*/, UINT* /*unitsLength*/, LPSTR /*description*/, UINT* /*descriptionLength*/)
+{
+	return E_NOTIMPL;
+}
+
+// Options the engine checks for (offset & partial constant buffer
+// updates) need an 11.1 context, which there isn't, so they're all off
+HRESULT NullDevice::CheckFeatureSupport(D3D11_FEATURE /*feature*/, void* data, UINT dataSize)
+{
+	if (!data)
+		return E_INVALIDARG;
+
+	memset(data, 0, dataSize);
+	return S_OK;
+}
+
+HRESULT NullDevice::GetPrivateData(REFGUID /*guid*/, UINT* dataSize, void* /*data*/)
+{
+	if (dataSize)
+		*dataSize = 0;
+	return DXGI_ERROR_NOT_FOUND;
+}
+
+HRESULT NullDevice::SetPrivateData(REFGUID /*guid*/, UINT /*dataSize*/, const void* /*data*/) { return S_OK; }
+HRESULT NullDevice::SetPrivateDataInterface(REFGUID /*guid*/, const IUnknown* /*data*/) { return S_OK; }
+
+D3D_FEATURE_LEVEL NullDevice::GetFeatureLevel() { return D3D_FEATURE_LEVEL_11_0; }
+UINT NullDevice::GetCreationFlags() { return 0; }
+HRESULT NullDevice::GetDeviceRemovedReason() { return S_OK; }
+void NullDevice::GetImmediateContext(ID3D11DeviceContext** context) { *context = 0; }
+HRESULT NullDevice::SetExceptionMode(UINT /*flags*/) { return S_OK; }
+UINT NullDevice::GetExceptionMode() { return 0; }
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <d3d11.h>
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------
+// A D3D11 device with no GPU behind it, for headless runs
+// (see Graphics::InitializeHeadless())
+//
+// - Creating buffers, textures, views, shaders, input
+//   layouts & states succeeds with small objects that only
+//   keep their descriptions, so loading runs unchanged
+// - Initial data & shader bytecode are checked for, then
+//   ignored - nothing is ever drawn from them
+// - Anything the engine never makes (queries, class
+//   linkage, deferred contexts, shared resources) fails
+//   with E_NOTIMPL
+// - There's no immediate context, so GetImmediateContext()
+//   hands back null
+// - Every object created is reported to NullBackend, which
+//   fails any frame that creates one while it's rendered
+// --------------------------------------------------------
+class NullDevice final : public ID3D11Device
+{
+public:
+	// Counters since the device was made (any thread)
+	struct Stats
+	{
+		uint64_t Objects = 0;
+		uint64_t BufferBytes = 0;
+	};
+	Stats GetStats() const;
+
+	// IUnknown
+	HRESULT STDMETHODCALLTYPE QueryInterface(REFIID riid, void** object) override;
+	ULONG STDMETHODCALLTYPE AddRef() override;
+	ULONG STDMETHODCALLTYPE Release() override;
+
+	// Resources & views
+	HRESULT STDMETHODCALLTYPE CreateBuffer(const D3D11_BUFFER_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Buffer** buffer) override;
+	HRESULT STDMETHODCALLTYPE CreateTexture1D(const D3D11_TEXTURE1D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Texture1D** texture) override;
+	HRESULT STDMETHODCALLTYPE CreateTexture2D(const D3D11_TEXTURE2D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Texture2D** texture) override;
+	HRESULT STDMETHODCALLTYPE CreateTexture3D(const D3D11_TEXTURE3D_DESC* desc, const D3D11_SUBRESOURCE_DATA* initialData, ID3D11Texture3D** texture) override;
+	HRESULT STDMETHODCALLTYPE CreateShaderResourceView(ID3D11Resource* resource, const D3D11_SHADER_RESOURCE_VIEW_DESC* desc, ID3D11ShaderResourceView** view) override;
+	HRESULT STDMETHODCALLTYPE CreateUnorderedAccessView(ID3D11Resource* resource, const D3D11_UNORDERED_ACCESS_VIEW_DESC* desc, ID3D11UnorderedAccessView** view) override;
+	HRESULT STDMETHODCALLTYPE CreateRenderTargetView(ID3D11Resource* resource, const D3D11_RENDER_TARGET_VIEW_DESC* desc, ID3D11RenderTargetView** view) override;
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilView(ID3D11Resource* resource, const D3D11_DEPTH_STENCIL_VIEW_DESC* desc, ID3D11DepthStencilView** view) override;
+
+	// Shaders & input layouts
+	HRESULT STDMETHODCALLTYPE CreateInputLayout(const D3D11_INPUT_ELEMENT_DESC* elements, UINT elementCount, const void* bytecode, SIZE_T bytecodeLength, ID3D11InputLayout** layout) override;
+	HRESULT STDMETHODCALLTYPE CreateVertexShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* linkage, ID3D11VertexShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreateGeometryShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* linkage, ID3D11GeometryShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreateGeometryShaderWithStreamOutput(const void* bytecode, SIZE_T bytecodeLength, const D3D11_SO_DECLARATION_ENTRY* declaration, UINT entryCount, const UINT* bufferStrides, UINT strideCount, UINT rasterizedStream, ID3D11ClassLinkage* linkage, ID3D11GeometryShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreatePixelShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* linkage, ID3D11PixelShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreateHullShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* linkage, ID3D11HullShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreateDomainShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* linkage, ID3D11DomainShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreateComputeShader(const void* bytecode, SIZE_T bytecodeLength, ID3D11ClassLinkage* linkage, ID3D11ComputeShader** shader) override;
+	HRESULT STDMETHODCALLTYPE CreateClassLinkage(ID3D11ClassLinkage** linkage) override;
+
+	// Fixed function states
+	HRESULT STDMETHODCALLTYPE CreateBlendState(const D3D11_BLEND_DESC* desc, ID3D11BlendState** state) override;
+	HRESULT STDMETHODCALLTYPE CreateDepthStencilState(const D3D11_DEPTH_STENCIL_DESC* desc, ID3D11DepthStencilState** state) override;
+	HRESULT STDMETHODCALLTYPE CreateRasterizerState(const D3D11_RASTERIZER_DESC* desc, ID3D11RasterizerState** state) override;
+	HRESULT STDMETHODCALLTYPE CreateSamplerState(const D3D11_SAMPLER_DESC* desc, ID3D11SamplerState** state) override;
+
+	// Queries, contexts & sharing (none of these are supported)
+	HRESULT STDMETHODCALLTYPE CreateQuery(const D3D11_QUERY_DESC* desc, ID3D11Query** query) override;
+	HRESULT STDMETHODCALLTYPE CreatePredicate(const D3D11_QUERY_DESC* desc, ID3D11Predicate** predicate) override;
+	HRESULT STDMETHODCALLTYPE CreateCounter(const D3D11_COUNTER_DESC* desc, ID3D11Counter** counter) override;
+	HRESULT STDMETHODCALLTYPE CreateDeferredContext(UINT flags, ID3D11DeviceContext** context) override;
+	HRESULT STDMETHODCALLTYPE OpenSharedResource(HANDLE resource, REFIID riid, void** object) override;
+
+	// Capabilities - every format does everything, at feature level 11.0
+	HRESULT STDMETHODCALLTYPE CheckFormatSupport(DXGI_FORMAT format, UINT* support) override;
+	HRESULT STDMETHODCALLTYPE CheckMultisampleQualityLevels(DXGI_FORMAT format, UINT sampleCount, UINT* qualityLevels) override;
+	void STDMETHODCALLTYPE CheckCounterInfo(D3D11_COUNTER_INFO* info) override;
+	HRESULT STDMETHODCALLTYPE CheckCounter(const D3D11_COUNTER_DESC* desc, D3D11_COUNTER_TYPE* type, UINT* activeCounters, LPSTR name, UINT* nameLength, LPSTR units, UINT* unitsLength, LPSTR description, UINT* descriptionLength) override;
+	HRESULT STDMETHODCALLTYPE CheckFeatureSupport(D3D11_FEATURE feature, void* data, UINT dataSize) override;
+
+	// Private data is accepted but not kept
+	HRESULT STDMETHODCALLTYPE GetPrivateData(REFGUID guid, UINT* dataSize, void* data) override;
+	HRESULT STDMETHODCALLTYPE SetPrivateData(REFGUID guid, UINT dataSize, const void* data) override;
+	HRESULT STDMETHODCALLTYPE SetPrivateDataInterface(REFGUID guid, const IUnknown* data) override;
+
+	D3D_FEATURE_LEVEL STDMETHODCALLTYPE GetFeatureLevel() override;
+	UINT STDMETHODCALLTYPE GetCreationFlags() override;
+	HRESULT STDMETHODCALLTYPE GetDeviceRemovedReason() override;
+	void STDMETHODCALLTYPE GetImmediateContext(ID3D11DeviceContext** context) override;
+	HRESULT STDMETHODCALLTYPE SetExceptionMode(UINT flags) override;
+	UINT STDMETHODCALLTYPE GetExceptionMode() override;
+
+private:
+	std::atomic<ULONG> references = 1; // The creator's
+	std::atomic<uint64_t> objects = 0;
+	std::atomic<uint64_t> bufferBytes = 0;
+
+	// Counts a successful creation (hands the object out, or
+	// releases it if the caller only wanted validation)
+	template<typename Interface>
+	HRESULT Created(Interface* object, Interface** out);
+};
@@ -0,0 +1,368 @@
+#include "Occlusion.h"
+#include "JobSystem.h"
+
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Where clip space z crosses 0 (the near plane) between two vertices
+	XMFLOAT4 ClipToNear(const XMFLOAT4& inside, const XMFLOAT4& outside)
+	{
+		float t = inside.z / (inside.z - outside.z);
+		return {
+			inside.x + (outside.x - inside.x) * t,
+			inside.y + (outside.y - inside.y) * t,
+			0.0f,
+			inside.w + (outside.w - inside.w) * t };
+	}
+
+	int Clamp(int value, int low, int high)
+	{
+		return value < low ? low : (value > high ? high : value);
+	}
+}
+
+OcclusionBuffer::OcclusionBuffer()
+{
+	for (uint32_t level = 0; level < Levels; level++)
+	{
+		size_t size = (size_t)(Width >> level) * (Height >> level);
+		maxDepth[level].resize(size, 1.0f);
+		if (level > 0)
+			minDepth[level].resize(size, 1.0f);
+	}
+
+	XMStoreFloat4x4(&viewProjection, XMMatrixIdentity());
+}
+
+void OcclusionBuffer::Begin(FXMMATRIX viewProjection)
+{
+	XMStoreFloat4x4(&this->viewProjection, viewProjection);
+	occluders.clear();
+
+	// Emptied, but keeping their memory for this frame's triangles
+	threadBins.resize(JobSystem::ThreadCount());
+	for (ThreadBins& bins : threadBins)
+	{
+		bins.Triangles.clear();
+		for (std::vector<uint32_t>& tile : bins.Tiles)
+			tile.clear();
+	}
+}
+
+void OcclusionBuffer::AddOccluder(const XMFLOAT3* positions, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount, const XMFLOAT4X4& world)
+{
+	if (vertexCount > 0 && indexCount >= 3)
+		occluders.push_back({ positions, vertexCount, indices, indexCount, world });
+}
+
+void OcclusionBuffer::Rasterize()
+{
+	// Set up & bin - each occluder on one thread, into that thread's bins
+	JobSystem::ParallelFor((uint32_t)occluders.size(), 1, [&](uint32_t begin, uint32_t end)
+	{
+		ThreadBins& bins = threadBins[JobSystem::ThreadIndex()];
+		for (uint32_t i = begin; i < end; i++)
+			SetUpOccluder(occluders[i], bins);
+	});
+
+	triangleCount = 0;
+	for (const ThreadBins& bins : threadBins)
+		triangleCount += (uint32_t)bins.Triangles.size();
+
+	// Every tile on its own
+	JobSystem::ParallelFor(TilesX * TilesY, 1, [&](uint32_t begin, uint32_t end)
+	{
+		for (uint32_t tile = begin; tile < end; tile++)
+			RasterizeTile(tile);
+	});
+
+	BuildLevels();
+}
+
+void OcclusionBuffer::SetUpOccluder(const Occluder& occluder, ThreadBins& bins) const
+{
+	// Every vertex into clip space once, as most are shared by several triangles
+	XMMATRIX worldViewProjection = XMLoadFloat4x4(&occluder.World) * XMLoadFloat4x4(&viewProjection);
+	bins.Clip.resize(occluder.VertexCount);
+	for (uint32_t v = 0; v < occluder.VertexCount; v++)
+		XMStoreFloat4(&bins.Clip[v], XMVector3Transform(XMLoadFloat3(&occluder.Positions[v]), worldViewProjection));
+
+	for (uint32_t i = 0; i + 2 < occluder.IndexCount; i += 3)
+	{
+		XMFLOAT4 clip[3] = {
+			bins.Clip[occluder.Indices[i]],
+			bins.Clip[occluder.Indices[i + 1]],
+			bins.Clip[occluder.Indices[i + 2]] };
+
+		// Cut off whatever's in front of the near plane, which leaves
+		// nothing, the triangle, or a quad (as two triangles)
+		int outside = (clip[0].z < 0.0f) + (clip[1].z < 0.0f) + (clip[2].z < 0.0f);
+		if (outside == 3)
+			continue;
+		if (outside == 0)
+		{
+			AddTriangle(clip, bins);
+			continue;
+		}
+
+		XMFLOAT4 polygon[4];
+		int count = 0;
+		for (int v = 0; v < 3; v++)
+		{
+			const XMFLOAT4& current = clip[v];
+			const XMFLOAT4& next = clip[(v + 1) % 3];
+			if (current.z >= 0.0f)
+				polygon[count++] = current;
+			if ((current.z >= 0.0f) != (next.z >= 0.0f))
+				polygon[count++] = current.z >= 0.0f ? ClipToNear(current, next) : ClipToNear(next, current);
+		}
+
+		XMFLOAT4 first[3] = { polygon[0], polygon[1], polygon[2] };
+		AddTriangle(first, bins);
+		if (count == 4)
+		{
+			XMFLOAT4 second[3] = { polygon[0], polygon[2], polygon[3] };
+			AddTriangle(second, bins);
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Projects a triangle that's entirely past the near plane,
+// sets up its edge & depth planes & bins it to the tiles
+// its pixel bounds touch
+// --------------------------------------------------------
+void OcclusionBuffer::AddTriangle(const XMFLOAT4* clip, ThreadBins& bins) const
+{
+	float x[3], y[3], z[3];
+	for (int v = 0; v < 3; v++)
+	{
+		float inverseW = 1.0f / clip[v].w;
+		x[v] = (clip[v].x * inverseW * 0.5f + 0.5f) * Width;
+		y[v] = (0.5f - clip[v].y * inverseW * 0.5f) * Height;
+		z[v] = clip[v].z * inverseW;
+	}
+
+	// Twice the signed area - edges are flipped below so the inside is
+	// positive whichever way the triangle winds
+	float area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+	if (fabsf(area) < 1e-6f)
+		return;
+
+	float minX = fminf(x[0], fminf(x[1], x[2])), maxX = fmaxf(x[0], fmaxf(x[1], x[2]));
+	float minY = fminf(y[0], fminf(y[1], y[2])), maxY = fmaxf(y[0], fmaxf(y[1], y[2]));
+	if (maxX < 0.0f || maxY < 0.0f || minX >= Width || minY >= Height)
+		return;
+
+	Triangle triangle;
+	float sign = area > 0.0f ? 1.0f : -1.0f;
+	float* edges[3] = { triangle.EdgeA, triangle.EdgeB, triangle.EdgeC };
+	for (int e = 0; e < 3; e++)
+	{
+		int i = e, j = (e + 1) % 3;
+		edges[e][0] = sign * (y[i] - y[j]);
+		edges[e][1] = sign * (x[j] - x[i]);
+		edges[e][2] = sign * (x[i] * y[j] - x[j] * y[i]);
+	}
+
+	triangle.DepthA = ((z[1] - z[0]) * (y[2] - y[0]) - (z[2] - z[0]) * (y[1] - y[0])) / area;
+	triangle.DepthB = ((x[1] - x[0]) * (z[2] - z[0]) - (x[2] - x[0]) * (z[1] - z[0])) / area;
+	triangle.DepthC = z[0] - triangle.DepthA * x[0] - triangle.DepthB * y[0];
+
+	triangle.MinX = (uint16_t)Clamp((int)floorf(minX), 0, Width - 1);
+	triangle.MaxX = (uint16_t)Clamp((int)floorf(maxX), 0, Width - 1);
+	triangle.MinY = (uint16_t)Clamp((int)floorf(minY), 0, Height - 1);
+	triangle.MaxY = (uint16_t)Clamp((int)floorf(maxY), 0, Height - 1);
+
+	uint32_t index = (uint32_t)bins.Triangles.size();
+	bins.Triangles.push_back(triangle);
+	for (uint32_t ty = triangle.MinY / TileHeight; ty <= triangle.MaxY / TileHeight; ty++)
+		for (uint32_t tx = triangle.MinX / TileWidth; tx <= triangle.MaxX / TileWidth; tx++)
+			bins.Tiles[ty * TilesX + tx].push_back(index);
+}
+
+// --------------------------------------------------------
+// Clears one tile & draws every thread's triangles binned to
+// it, 4 pixels (one SIMD vector) at a time - a pixel is
+// covered when its center is inside all three edges
+// --------------------------------------------------------
+void OcclusionBuffer::RasterizeTile(uint32_t tile)
+{
+	uint32_t tileX = (tile % TilesX) * TileWidth;
+	uint32_t tileY = (tile / TilesX) * TileHeight;
+	float* depth = maxDepth[0].data();
+
+	for (uint32_t y = tileY; y < tileY + TileHeight; y++)
+		for (uint32_t x = tileX; x < tileX + TileWidth; x++)
+			depth[y * Width + x] = 1.0f;
+
+	XMVECTOR laneOffsets = XMVectorSet(0.5f, 1.5f, 2.5f, 3.5f);
+	XMVECTOR zero = XMVectorZero();
+	for (const ThreadBins& bins : threadBins)
+	{
+		for (uint32_t index : bins.Tiles[tile])
+		{
+			const Triangle& triangle = bins.Triangles[index];
+
+			// The triangle's pixels within this tile, starting on a whole vector
+			uint32_t startX = (triangle.MinX > tileX ? triangle.MinX : tileX) & ~3u;
+			uint32_t endX = triangle.MaxX < tileX + TileWidth - 1 ? triangle.MaxX : tileX + TileWidth - 1;
+			uint32_t startY = triangle.MinY > tileY ? triangle.MinY : tileY;
+			uint32_t endY = triangle.MaxY < tileY + TileHeight - 1 ? triangle.MaxY : tileY + TileHeight - 1;
+
+			XMVECTOR edgeX[3] = { XMVectorReplicate(triangle.EdgeA[0]), XMVectorReplicate(triangle.EdgeB[0]), XMVectorReplicate(triangle.EdgeC[0]) };
+			XMVECTOR depthX = XMVectorReplicate(triangle.DepthA);
+
+			for (uint32_t y = startY; y <= endY; y++)
+			{
+				// Everything but x is the same along the row
+				float pixelY = y + 0.5f;
+				XMVECTOR edgeRow[3] = {
+					XMVectorReplicate(triangle.EdgeA[1] * pixelY + triangle.EdgeA[2]),
+					XMVectorReplicate(triangle.EdgeB[1] * pixelY + triangle.EdgeB[2]),
+					XMVectorReplicate(triangle.EdgeC[1] * pixelY + triangle.EdgeC[2]) };
+				XMVECTOR depthRow = XMVectorReplicate(triangle.DepthB * pixelY + triangle.DepthC);
+
+				float* row = depth + y * Width;
+				for (uint32_t x = startX; x <= endX; x += 4)
+				{
+					XMVECTOR pixelX = XMVectorAdd(XMVectorReplicate((float)x), laneOffsets);
+					XMVECTOR inside = XMVectorGreaterOrEqual(XMVectorMultiplyAdd(pixelX, edgeX[0], edgeRow[0]), zero);
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(pixelX, edgeX[1], edgeRow[1]), zero));
+					inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(XMVectorMultiplyAdd(pixelX, edgeX[2], edgeRow[2]), zero));
+
+					XMVECTOR z = XMVectorMultiplyAdd(pixelX, depthX, depthRow);
+					XMVECTOR old = XMLoadFloat4(reinterpret_cast<const XMFLOAT4*>(row + x));
+					XMStoreFloat4(reinterpret_cast<XMFLOAT4*>(row + x), XMVectorSelect(old, XMVectorMin(old, z), inside));
+				}
+			}
+		}
+	}
+}
+
+void OcclusionBuffer::BuildLevels()
+{
+	for (uint32_t level = 1; level < Levels; level++)
+	{
+		uint32_t width = Width >> level;
+		uint32_t height = Height >> level;
+		uint32_t sourceWidth = width * 2;
+		const float* sourceMax = maxDepth[level - 1].data();
+		const float* sourceMin = level > 1 ? minDepth[level - 1].data() : sourceMax;
+
+		for (uint32_t y = 0; y < height; y++)
+		{
+			for (uint32_t x = 0; x < width; x++)
+			{
+				uint32_t a = (y * 2) * sourceWidth + x * 2;
+				uint32_t b = a + sourceWidth;
+				maxDepth[level][y * width + x] = fmaxf(fmaxf(sourceMax[a], sourceMax[a + 1]), fmaxf(sourceMax[b], sourceMax[b + 1]));
+				minDepth[level][y * width + x] = fminf(fminf(sourceMin[a], sourceMin[a + 1]), fminf(sourceMin[b], sourceMin[b + 1]));
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------
+// The box's screen rectangle & nearest depth, tested at the
+// level where the rectangle covers at most 2x2 texels:
+// - Behind the farthest occluder in all of them: hidden
+// - In front of the nearest occluder in any: visible
+// - Otherwise, two levels finer (at most ~8x8 texels) it's
+//   hidden only if it's behind the farthest in every one
+// --------------------------------------------------------
+bool OcclusionBuffer::IsVisible(const XMFLOAT3& center, const XMFLOAT3& extents) const
+{
+	XMMATRIX matrix = XMLoadFloat4x4(&viewProjection);
+	float minX = FLT_MAX, minY = FLT_MAX, maxX = -FLT_MAX, maxY = -FLT_MAX;
+	float nearest = FLT_MAX;
+	for (int corner = 0; corner < 8; corner++)
+	{
+		XMVECTOR position = XMVectorSet(
+			center.x + ((corner & 1) ? extents.x : -extents.x),
+			center.y + ((corner & 2) ? extents.y : -extents.y),
+			center.z + ((corner & 4) ? extents.z : -extents.z),
+			1.0f);
+		XMFLOAT4 clip;
+		XMStoreFloat4(&clip, XMVector4Transform(position, matrix));
+
+		// Reaches past the near plane, so it could be covering the screen
+		if (clip.z < 0.0f)
+			return true;
+
+		float inverseW = 1.0f / clip.w;
+		float x = (clip.x * inverseW * 0.5f + 0.5f) * Width;
+		float y = (0.5f - clip.y * inverseW * 0.5f) * Height;
+		minX = fminf(minX, x); maxX = fmaxf(maxX, x);
+		minY = fminf(minY, y); maxY = fmaxf(maxY, y);
+		nearest = fminf(nearest, clip.z * inverseW);
+	}
+
+	// Off screen is for frustum culling to decide
+	if (maxX < 0.0f || maxY < 0.0f || minX >= Width || minY >= Height)
+		return true;
+
+	int x0 = Clamp((int)floorf(minX), 0, Width - 1), x1 = Clamp((int)floorf(maxX), 0, Width - 1);
+	int y0 = Clamp((int)floorf(minY), 0, Height - 1), y1 = Clamp((int)floorf(maxY), 0, Height - 1);
+
+	uint32_t coarse = 0;
+	while (coarse < Levels - 1 && ((x1 >> coarse) - (x0 >> coarse) > 1 || (y1 >> coarse) - (y0 >> coarse) > 1))
+		coarse++;
+
+	bool hidden = true;
+	uint32_t width = Width >> coarse;
+	for (int y = y0 >> coarse; y <= (y1 >> coarse); y++)
+	{
+		for (int x = x0 >> coarse; x <= (x1 >> coarse); x++)
+		{
+			uint32_t texel = y * width + x;
+			float minimum = coarse > 0 ? minDepth[coarse][texel] : maxDepth[0][texel];
+			if (nearest < minimum)
+				return true;
+			if (nearest <= maxDepth[coarse][texel])
+				hidden = false;
+		}
+	}
+	if (hidden || coarse == 0)
+		return !hidden;
+
+	uint32_t fine = coarse > 2 ? coarse - 2 : 0;
+	width = Width >> fine;
+	for (int y = y0 >> fine; y <= (y1 >> fine); y++)
+		for (int x = x0 >> fine; x <= (x1 >> fine); x++)
+			if (nearest <= maxDepth[fine][y * width + x])
+				return true;
+
+	return false;
+}
+
+uint32_t OcclusionBuffer::CullBoxes(const BoundsSoA& bounds, uint8_t* visible) const
+{
+	std::atomic<uint32_t> hiddenCount = 0;
+	JobSystem::ParallelFor(bounds.Count, 64, [&](uint32_t begin, uint32_t end)
+	{
+		uint32_t hidden = 0;
+		for (uint32_t i = begin; i < end; i++)
+		{
+			if (!visible[i])
+				continue;
+
+			XMFLOAT3 center(bounds.CenterX[i], bounds.CenterY[i], bounds.CenterZ[i]);
+			XMFLOAT3 extents(bounds.ExtentX[i], bounds.ExtentY[i], bounds.ExtentZ[i]);
+			if (!IsVisible(center, extents))
+			{
+				visible[i] = 0;
+				hidden++;
+			}
+		}
+		hiddenCount += hidden;
+	});
+	return hiddenCount;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+#include <vector>
+#include "Culling.h"
+
+// --------------------------------------------------------
+// Software occlusion culling against a small CPU depth buffer
+//
+// - Occluders (a few big, solid meshes) are drawn depth only
+//   into a Width x Height buffer, then every box that passed
+//   frustum culling is tested against it before submission
+// - All on the CPU, so there's no readback latency & it
+//   works without a GPU
+// - Triangles are set up & binned to screen tiles across the
+//   job threads (each thread its own bins), then each tile is
+//   rasterized by one job, 4 pixels at a time with
+//   DirectXMath's SIMD vectors - no two jobs write the same
+//   pixel, so nothing needs a lock
+// - Depth is D3D's 0 (near) to 1 (far), nearest kept
+// - Boxes are tested against min/max depth mips, only going
+//   to finer levels when the coarse test can't decide
+// --------------------------------------------------------
+class OcclusionBuffer
+{
+public:
+	static constexpr uint32_t Width = 256;
+	static constexpr uint32_t Height = 128;
+	static constexpr uint32_t TileWidth = 64;
+	static constexpr uint32_t TileHeight = 32;
+	static constexpr uint32_t TilesX = Width / TileWidth;
+	static constexpr uint32_t TilesY = Height / TileHeight;
+	static constexpr uint32_t Levels = 8; // 256x128 down to 2x1
+
+	OcclusionBuffer();
+
+	// Starts a frame seen through a (row vector) view-projection matrix
+	// - Forgets last frame's occluders (the depth is cleared as it's redrawn)
+	void Begin(DirectX::FXMMATRIX viewProjection);
+
+	// Queues an indexed triangle mesh to draw under a world matrix
+	// - The arrays must stay alive until Rasterize() returns
+	void AddOccluder(const DirectX::XMFLOAT3* positions, uint32_t vertexCount, const unsigned int* indices, uint32_t indexCount, const DirectX::XMFLOAT4X4& world);
+
+	// Draws every queued occluder & builds the depth mips
+	// - Call from the main thread or a job, before any tests
+	void Rasterize();
+
+	// True unless the box is certainly hidden behind the occluders
+	// - Boxes crossing the near plane or off screen count as visible
+	bool IsVisible(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents) const;
+
+	// Clears visible[i] for each flagged box that's hidden, split across
+	// the job system, & returns how many were
+	uint32_t CullBoxes(const BoundsSoA& bounds, uint8_t* visible) const;
+
+	// Stats
+	uint32_t TriangleCount() const { return triangleCount; }
+	const float* GetDepth() const { return maxDepth[0].data(); }
+
+private:
+	// Screen space triangle, with its edge & depth planes set up
+	struct Triangle
+	{
+		float EdgeA[3], EdgeB[3], EdgeC[3]; // a*x + b*y + c >= 0 inside
+		float DepthA, DepthB, DepthC;		// z = a*x + b*y + c
+		uint16_t MinX, MinY, MaxX, MaxY;	// Pixel bounds, inclusive
+	};
+
+	// One thread's set up triangles & the tiles they touch
+	struct ThreadBins
+	{
+		std::vector<Triangle> Triangles;
+		std::vector<uint32_t> Tiles[TilesX * TilesY];
+		std::vector<DirectX::XMFLOAT4> Clip; // The occluder being set up's vertices
+	};
+
+	struct Occluder
+	{
+		const DirectX::XMFLOAT3* Positions;
+		uint32_t VertexCount;
+		const unsigned int* Indices;
+		uint32_t IndexCount;
+		DirectX::XMFLOAT4X4 World;
+	};
+
+	DirectX::XMFLOAT4X4 viewProjection;
+	std::vector<Occluder> occluders;
+	std::vector<ThreadBins> threadBins;
+	uint32_t triangleCount = 0;
+
+	// Level 0 is the depth itself; each level after covers 2x2 of the last
+	// - There's no minDepth[0], as it'd be the same as maxDepth[0]
+	std::vector<float> minDepth[Levels];
+	std::vector<float> maxDepth[Levels];
+
+	void SetUpOccluder(const Occluder& occluder, ThreadBins& bins) const;
+	void AddTriangle(const DirectX::XMFLOAT4* clip, ThreadBins& bins) const;
+	void RasterizeTile(uint32_t tile);
+	void BuildLevels();
+};
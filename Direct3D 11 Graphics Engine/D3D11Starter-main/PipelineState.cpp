@@ -0,0 +1,238 @@
+#include "PipelineState.h"
+#include "Graphics.h"
+#include "Resources.h"
+#include "TrackedContext.h"
+
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+// Annonymous namespace to hold variables/helpers
+// only accessible in this file
+namespace
+{
+	// Descriptions are keyed by their raw bytes, held in place
+	// (so a lookup never allocates) & hashed with FNV-1a
+	template<typename Desc>
+	struct DescKey
+	{
+		Desc Value;
+
+		bool operator==(const DescKey& other) const { return memcmp(&Value, &other.Value, sizeof(Desc)) == 0; }
+	};
+
+	struct DescHash
+	{
+		template<typename Desc>
+		size_t operator()(const DescKey<Desc>& key) const
+		{
+			const unsigned char* bytes = reinterpret_cast<const unsigned char*>(&key.Value);
+			uint64_t hash = 14695981039346656037ull;
+			for (size_t i = 0; i < sizeof(Desc); i++)
+				hash = (hash ^ bytes[i]) * 1099511628211ull;
+			return (size_t)hash;
+		}
+	};
+
+	template<typename Desc, typename T>
+	using DescMap = std::unordered_map<DescKey<Desc>, T, DescHash>;
+
+	std::mutex mutex;
+	DescMap<PipelineStateDesc, std::unique_ptr<PipelineState>> pipelines;
+	DescMap<D3D11_RASTERIZER_DESC, Microsoft::WRL::ComPtr<ID3D11RasterizerState>> rasterizers;
+	DescMap<D3D11_DEPTH_STENCIL_DESC, Microsoft::WRL::ComPtr<ID3D11DepthStencilState>> depthStencils;
+	DescMap<D3D11_BLEND_DESC, Microsoft::WRL::ComPtr<ID3D11BlendState>> blends;
+	DescMap<D3D11_SAMPLER_DESC, Microsoft::WRL::ComPtr<ID3D11SamplerState>> samplers;
+
+	// Rendering thread only
+	const PipelineState* current = 0;
+	PipelineStates::FrameStats frameStats = {};
+
+	// Guarded by the mutex, since the UI reads it
+	PipelineStates::FrameStats lastFrameStats = {};
+
+	// Copies byte for byte, padding included, so equal descriptions
+	// are equal keys
+	template<typename Desc>
+	DescKey<Desc> KeyOf(const Desc& desc)
+	{
+		DescKey<Desc> key;
+		memcpy(&key.Value, &desc, sizeof(Desc));
+		return key;
+	}
+
+	// Finds or creates the state object for a description - caller holds the mutex
+	// - Failures are remembered too (as null), so they're only tried once
+	template<typename Desc, typename State, typename CreateFunc>
+	Microsoft::WRL::ComPtr<State> Find(DescMap<Desc, Microsoft::WRL::ComPtr<State>>& cache, const Desc& desc, CreateFunc create)
+	{
+		DescKey<Desc> key = KeyOf(desc);
+		auto existing = cache.find(key);
+		if (existing != cache.end())
+			return existing->second;
+
+		Microsoft::WRL::ComPtr<State> state;
+		create(&desc, state.GetAddressOf());
+		cache.insert({ key, state });
+		return state;
+	}
+}
+
+// --------------------------------------------------------
+// Zeroes everything (so the padding hashes the same every
+// time), then fills in the D3D11 defaults field by field
+// --------------------------------------------------------
+PipelineStateDesc::PipelineStateDesc()
+{
+	memset(this, 0, sizeof(*this));
+
+	Rasterizer.FillMode = D3D11_FILL_SOLID;
+	Rasterizer.CullMode = D3D11_CULL_BACK;
+	Rasterizer.DepthClipEnable = true;
+
+	DepthStencil.DepthEnable = true;
+	DepthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ALL;
+	DepthStencil.DepthFunc = D3D11_COMPARISON_LESS;
+	DepthStencil.StencilReadMask = D3D11_DEFAULT_STENCIL_READ_MASK;
+	DepthStencil.StencilWriteMask = D3D11_DEFAULT_STENCIL_WRITE_MASK;
+	D3D11_DEPTH_STENCILOP_DESC stencilOp = { D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, D3D11_STENCIL_OP_KEEP, D3D11_COMPARISON_ALWAYS };
+	DepthStencil.FrontFace = stencilOp;
+	DepthStencil.BackFace = stencilOp;
+
+	for (D3D11_RENDER_TARGET_BLEND_DESC& target : Blend.RenderTarget)
+	{
+		target.SrcBlend = D3D11_BLEND_ONE;
+		target.DestBlend = D3D11_BLEND_ZERO;
+		target.BlendOp = D3D11_BLEND_OP_ADD;
+		target.SrcBlendAlpha = D3D11_BLEND_ONE;
+		target.DestBlendAlpha = D3D11_BLEND_ZERO;
+		target.BlendOpAlpha = D3D11_BLEND_OP_ADD;
+		target.RenderTargetWriteMask = D3D11_COLOR_WRITE_ENABLE_ALL;
+	}
+
+	Topology = D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST;
+}
+
+const PipelineState* PipelineStates::Get(const PipelineStateDesc& desc)
+{
+	DescKey<PipelineStateDesc> key = KeyOf(desc);
+	std::lock_guard<std::mutex> lock(mutex);
+
+	auto existing = pipelines.find(key);
+	if (existing != pipelines.end())
+		return existing->second.get();
+
+	std::unique_ptr<PipelineState> pipeline = std::make_unique<PipelineState>();
+	memcpy(&pipeline->Desc, &desc, sizeof(desc)); // Byte for byte, padding included
+	pipeline->Rasterizer = Find(rasterizers, desc.Rasterizer,
+		[](auto d, auto s) { return Graphics::Device->CreateRasterizerState(d, s); });
+	pipeline->DepthStencil = Find(depthStencils, desc.DepthStencil,
+		[](auto d, auto s) { return Graphics::Device->CreateDepthStencilState(d, s); });
+	pipeline->Blend = Find(blends, desc.Blend,
+		[](auto d, auto s) { return Graphics::Device->CreateBlendState(d, s); });
+
+	const PipelineState* result = pipeline.get();
+	pipelines.insert({ key, std::move(pipeline) });
+	return result;
+}
+
+Microsoft::WRL::ComPtr<ID3D11SamplerState> PipelineStates::GetSampler(const D3D11_SAMPLER_DESC& desc)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Find(samplers, desc,
+		[](auto d, auto s) { return Graphics::Device->CreateSamplerState(d, s); });
+}
+
+// --------------------------------------------------------
+// Sets a pipeline, skipping every part that's the same as
+// the one set before it
+// --------------------------------------------------------
+void PipelineStates::Apply(const PipelineState* pipeline)
+{
+	frameStats.Applies++;
+	if (pipeline == current)
+		return;
+
+	const PipelineState* previous = current;
+	current = pipeline;
+	frameStats.Switches++;
+
+	// Shaders set their own input layout & constant buffers
+	if (!previous || previous->Desc.VertexShader != pipeline->Desc.VertexShader)
+	{
+		SimpleVertexShader* vs = Resources::VertexShaders.Get(pipeline->Desc.VertexShader);
+		if (vs) vs->SetShader();
+		else TrackedContext::SetVertexShader(0);
+		frameStats.ContextCalls++;
+	}
+
+	if (!previous || previous->Desc.PixelShader != pipeline->Desc.PixelShader)
+	{
+		SimplePixelShader* ps = Resources::PixelShaders.Get(pipeline->Desc.PixelShader);
+		if (ps) ps->SetShader();
+		else TrackedContext::SetPixelShader(0);
+		frameStats.ContextCalls++;
+	}
+
+	if (!previous || previous->Rasterizer != pipeline->Rasterizer)
+	{
+		Graphics::Context->RSSetState(pipeline->Rasterizer.Get());
+		frameStats.ContextCalls++;
+	}
+
+	if (!previous || previous->DepthStencil != pipeline->DepthStencil)
+	{
+		Graphics::Context->OMSetDepthStencilState(pipeline->DepthStencil.Get(), 0);
+		frameStats.ContextCalls++;
+	}
+
+	if (!previous || previous->Blend != pipeline->Blend)
+	{
+		Graphics::Context->OMSetBlendState(pipeline->Blend.Get(), 0, 0xFFFFFFFF);
+		frameStats.ContextCalls++;
+	}
+
+	if (!previous || previous->Desc.Topology != pipeline->Desc.Topology)
+	{
+		Graphics::Context->IASetPrimitiveTopology(pipeline->Desc.Topology);
+		frameStats.ContextCalls++;
+	}
+}
+
+void PipelineStates::BeginFrame()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	lastFrameStats = frameStats;
+	frameStats = {};
+	current = 0;
+}
+
+PipelineStates::FrameStats PipelineStates::LastFrameStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return lastFrameStats;
+}
+
+size_t PipelineStates::PipelineCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return pipelines.size();
+}
+
+size_t PipelineStates::StateObjectCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return rasterizers.size() + depthStencils.size() + blends.size() + samplers.size();
+}
+
+void PipelineStates::Clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	pipelines.clear();
+	rasterizers.clear();
+	depthStencils.clear();
+	blends.clear();
+	samplers.clear();
+	current = 0;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include <cstdint>
+#include "ResourceHandles.h"
+
+// --------------------------------------------------------
+// Everything that describes how a draw is set up, apart from
+// its resources: shaders (and so the input layout, which the
+// vertex shader owns), rasterizer, depth-stencil & blend
+// states and the primitive topology
+//
+// - Starts out as the D3D11 defaults with triangle lists, so
+//   only the differences need filling in
+// - Compared & hashed as raw bytes, which is why the
+//   constructor zeroes the whole thing (padding included)
+// --------------------------------------------------------
+struct PipelineStateDesc
+{
+	VertexShaderHandle VertexShader;
+	PixelShaderHandle PixelShader; // Null turns the pixel stage off (depth-only passes)
+	D3D11_RASTERIZER_DESC Rasterizer;
+	D3D11_DEPTH_STENCIL_DESC DepthStencil;
+	D3D11_BLEND_DESC Blend;
+	D3D11_PRIMITIVE_TOPOLOGY Topology;
+
+	PipelineStateDesc();
+};
+
+// --------------------------------------------------------
+// An immutable, shared pipeline state - get one from
+// PipelineStates::Get() and set it with Apply()
+// --------------------------------------------------------
+struct PipelineState
+{
+	PipelineStateDesc Desc;
+	Microsoft::WRL::ComPtr<ID3D11RasterizerState> Rasterizer;
+	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> DepthStencil;
+	Microsoft::WRL::ComPtr<ID3D11BlendState> Blend;
+};
+
+// --------------------------------------------------------
+// Hash-consed cache of pipeline & sampler states
+//
+// - Identical descriptions always return the same object,
+//   and pipelines that only differ in shaders share their
+//   rasterizer/depth/blend objects
+// - Pointers stay valid until Clear()
+// - Apply() remembers what it last set on Graphics::Context
+//   and only issues the calls for the parts that differ
+// - Get() & GetSampler() are safe from any thread; Apply()
+//   & BeginFrame() belong to the rendering thread
+// --------------------------------------------------------
+namespace PipelineStates
+{
+	const PipelineState* Get(const PipelineStateDesc& desc);
+	Microsoft::WRL::ComPtr<ID3D11SamplerState> GetSampler(const D3D11_SAMPLER_DESC& desc);
+
+	void Apply(const PipelineState* pipeline);
+
+	// Forgets what's bound (anything may have touched the context
+	// since last frame) & starts this frame's counters
+	void BeginFrame();
+
+	// State change costs, counted over the last full frame
+	struct FrameStats
+	{
+		uint64_t Applies;		// Apply() calls
+		uint64_t Switches;		// ...that changed the pipeline
+		uint64_t ContextCalls;	// Set calls actually made on the context
+	};
+	FrameStats LastFrameStats();
+
+	size_t PipelineCount();		// Distinct pipelines
+	size_t StateObjectCount();	// Distinct rasterizer, depth, blend & sampler objects
+
+	// Releases everything (call before the device goes away)
+	void Clear();
+}
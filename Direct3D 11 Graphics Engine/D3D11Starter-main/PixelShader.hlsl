@@ -1,13 +1,12 @@
 #include "ShaderInclude.hlsli" // Contains all necessary structs, helper functions, etc.
 
-cbuffer ExternalData : register(b0)
+// Camera position & lights come from PerPass & PerFrame (see ShaderInclude.hlsli)
+cbuffer PerMaterial : register(b1)
 {
 	float4 colorTint;
     float2 uvScale;
     float2 uvOffset;
-	float3 currentCamPos;
     //float3 ambientColor;
-    Light lights[6]; // Max # of lights (must change before going over)
 }
 
 Texture2D SurfaceTexture : register(t0); // Albedo
@@ -30,6 +29,7 @@ SamplerComparisonState ShadowSampler : register(s1);
 // --------------------------------------------------------
 float4 main(VertexToPixel input) : SV_TARGET
 {
+#if SHADOWS
 	// Perform the perspective divide (divide by W) ourselves
     input.shadowMapPos /= input.shadowMapPos.w;
     
@@ -41,6 +41,9 @@ float4 main(VertexToPixel input) : SV_TARGET
     float distToLight = input.shadowMapPos.z;
     // Get a ratio of comparison results using SampleCmpLevelZero()
     float shadowAmount = ShadowMap.SampleCmpLevelZero(ShadowSampler, shadowUV, distToLight).r;
+#else
+    float shadowAmount = 1.0f; // Shadows are off in this variant
+#endif
     //float distShadowMap = ShadowMap.Sample(BasicSampler, shadowUV).r;
     
     // For testing, just return black where there are shadows.
@@ -103,8 +106,9 @@ float4 main(VertexToPixel input) : SV_TARGET
 	// Apply the ambient lighting to the surface color
 	//float3 totalLight = ambientColor * textureColor.xyz;
     
-	// Loop thru & add all the lights
-    for (int i = 0; i < 6; i++)
+	// Loop thru & add all the lights (a known count, so it unrolls)
+    [unroll]
+    for (int i = 0; i < LIGHT_COUNT; i++)
     {
 		// Make extra sure the light's direction is normalized
 		Light light = lights[i];
@@ -0,0 +1,210 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "CommandStream.h"
+
+struct ID3D11Buffer;
+struct ID3D11RenderTargetView;
+struct ID3D11DepthStencilView;
+struct ImDrawData;
+class UploadRing;
+
+// --------------------------------------------------------
+// Where a frame's rendering goes - the one place the
+// renderer meets a graphics API
+//
+// - CommandStream::Execute() reads each packet & hands it
+//   to one of these, in recorded order
+// - The renderer makes the rest of the frame's calls here
+//   too (clears, targets, viewports, buffer writes, the
+//   full screen pass, UI & present), around the streams
+// - D3D11Backend makes them on Graphics::Context; NullBackend
+//   makes none at all, so the CPU side of a frame can be
+//   timed without a GPU
+// - Views & buffers are only passed through - creating
+//   them is still up to the caller
+// - Rendering thread only (or whichever thread replays)
+// --------------------------------------------------------
+class RenderBackend
+{
+public:
+	virtual ~RenderBackend() = default;
+
+	// Called before each stream, which binds everything it uses itself
+	virtual void BeginStream() {}
+
+	virtual void SetPipeline(const CommandStream::SetPipelinePacket& packet) = 0;
+	virtual void SetShadowMap(const CommandStream::SetShadowMapPacket& packet) = 0;
+	virtual void SetMaterial(const CommandStream::SetMaterialPacket& packet) = 0;
+	virtual void SetConstants(const CommandStream::SetConstantsPacket& packet, const void* data) = 0;
+	virtual void Draw(const CommandStream::DrawPacket& packet) = 0;
+
+	// Called once before anything else in a frame, & once after
+	// everything else (Present() included)
+	virtual void BeginFrame() = 0;
+	virtual void EndFrame() = 0;
+
+	// Output merger & rasterizer - either target may be null
+	virtual void ClearTarget(ID3D11RenderTargetView* target, const float color[4]) = 0;
+	virtual void ClearDepth(ID3D11DepthStencilView* depth) = 0;
+	virtual void SetTargets(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depth) = 0;
+	virtual void SetViewport(float width, float height) = 0;
+
+	// Whole buffer writes - UpdateBuffer() copies into a default
+	// buffer, MapBuffer() returns size bytes of a dynamic one to
+	// fill (discarding what was there), or null if it failed
+	virtual void UpdateBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size) = 0;
+	virtual void* MapBuffer(ID3D11Buffer* buffer, uint32_t size) = 0;
+	virtual void UnmapBuffer(ID3D11Buffer* buffer) = 0;
+
+	// What instanced draws read their objects from: a vertex buffer
+	// counting up & the vertex shader's structured buffer of transforms
+	virtual void SetInstanceData(ID3D11Buffer* indices, uint32_t indexStride, ID3D11ShaderResourceView* transforms, uint32_t transformsRegister) = 0;
+
+	// A pixel shader's texture & sampler, by their names in the shader
+	virtual void SetTexture(SimplePixelShader* ps, const char* textureName, ID3D11ShaderResourceView* texture, const char* samplerName, ID3D11SamplerState* sampler) = 0;
+
+	// Unbinds every pixel shader texture, so their resources can be targets
+	virtual void UnbindTextures() = 0;
+
+	// Uploads the pixel shader's constants, then draws three vertices
+	// with no buffers (the full screen triangle)
+	virtual void DrawFullscreen(SimplePixelShader* ps) = 0;
+
+	virtual void DrawUI(ImDrawData* drawData) = 0;
+	virtual void Present(bool vsync) = 0;
+};
+
+// --------------------------------------------------------
+// Replays onto Graphics::Context through PipelineStates,
+// the materials & SimpleShader (so TrackedContext still
+// filters what's redundant)
+// --------------------------------------------------------
+class D3D11Backend : public RenderBackend
+{
+public:
+	// Fences the ring's frames along with the backend's own
+	void SetUploadRing(UploadRing* ring) { uploadRing = ring; }
+
+	void SetPipeline(const CommandStream::SetPipelinePacket& packet) override;
+	void SetShadowMap(const CommandStream::SetShadowMapPacket& packet) override;
+	void SetMaterial(const CommandStream::SetMaterialPacket& packet) override;
+	void SetConstants(const CommandStream::SetConstantsPacket& packet, const void* data) override;
+	void Draw(const CommandStream::DrawPacket& packet) override;
+
+	void BeginFrame() override;
+	void EndFrame() override;
+	void ClearTarget(ID3D11RenderTargetView* target, const float color[4]) override;
+	void ClearDepth(ID3D11DepthStencilView* depth) override;
+	void SetTargets(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depth) override;
+	void SetViewport(float width, float height) override;
+	void UpdateBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size) override;
+	void* MapBuffer(ID3D11Buffer* buffer, uint32_t size) override;
+	void UnmapBuffer(ID3D11Buffer* buffer) override;
+	void SetInstanceData(ID3D11Buffer* indices, uint32_t indexStride, ID3D11ShaderResourceView* transforms, uint32_t transformsRegister) override;
+	void SetTexture(SimplePixelShader* ps, const char* textureName, ID3D11ShaderResourceView* texture, const char* samplerName, ID3D11SamplerState* sampler) override;
+	void UnbindTextures() override;
+	void DrawFullscreen(SimplePixelShader* ps) override;
+	void DrawUI(ImDrawData* drawData) override;
+	void Present(bool vsync) override;
+
+private:
+	UploadRing* uploadRing = 0;
+};
+
+// --------------------------------------------------------
+// Renders nothing - only counts what it's given & checks
+// that each draw has what it needs bound
+//
+// - Never dereferences a view, buffer or packet pointer, so
+//   it runs without a device (and builds without any D3D
+//   headers)
+// - Mapped buffers are a scratch copy kept here, so the
+//   caller still does (and pays for) the writes
+// - Problems are counted & the first is kept, rather than
+//   stopping the frame
+// - Paired with a NullDevice (see Graphics::InitializeHeadless()),
+//   it's also a problem for a frame to create anything
+// --------------------------------------------------------
+class NullBackend : public RenderBackend
+{
+public:
+	// Counters since the last ResetStats()
+	struct Stats
+	{
+		uint64_t Pipelines = 0;
+		uint64_t ShadowMaps = 0;
+		uint64_t Materials = 0;
+		uint64_t Constants = 0;
+		uint64_t ConstantBytes = 0;
+		uint64_t Draws = 0;
+		uint64_t Instances = 0;		// Objects drawn, counting every instance
+		uint64_t Frames = 0;
+		uint64_t Clears = 0;
+		uint64_t TargetBinds = 0;
+		uint64_t Textures = 0;
+		uint64_t BufferUpdates = 0;
+		uint64_t BufferMaps = 0;
+		uint64_t BufferBytes = 0;	// Updated & mapped, not counting constants
+		uint64_t FullscreenDraws = 0;
+		uint64_t UIBytes = 0;		// Vertices & indices
+		uint64_t Presents = 0;
+		uint64_t Errors = 0;
+		const char* FirstError = 0;	// Null until something's wrong
+	};
+
+	void SetPipeline(const CommandStream::SetPipelinePacket& packet) override;
+	void SetShadowMap(const CommandStream::SetShadowMapPacket& packet) override;
+	void SetMaterial(const CommandStream::SetMaterialPacket& packet) override;
+	void SetConstants(const CommandStream::SetConstantsPacket& packet, const void* data) override;
+	void Draw(const CommandStream::DrawPacket& packet) override;
+
+	// Forgets the pipeline & material, so a stream leaning on
+	// the last one's bindings is caught
+	void BeginStream() override;
+
+	// Forgets everything, so a frame leaning on the last one's
+	// targets, viewport or instance data is caught
+	void BeginFrame() override;
+	void EndFrame() override;
+	void ClearTarget(ID3D11RenderTargetView* target, const float color[4]) override;
+	void ClearDepth(ID3D11DepthStencilView* depth) override;
+	void SetTargets(ID3D11RenderTargetView* target, ID3D11DepthStencilView* depth) override;
+	void SetViewport(float width, float height) override;
+	void UpdateBuffer(ID3D11Buffer* buffer, const void* data, uint32_t size) override;
+	void* MapBuffer(ID3D11Buffer* buffer, uint32_t size) override;
+	void UnmapBuffer(ID3D11Buffer* buffer) override;
+	void SetInstanceData(ID3D11Buffer* indices, uint32_t indexStride, ID3D11ShaderResourceView* transforms, uint32_t transformsRegister) override;
+	void SetTexture(SimplePixelShader* ps, const char* textureName, ID3D11ShaderResourceView* texture, const char* samplerName, ID3D11SamplerState* sampler) override;
+	void UnbindTextures() override;
+	void DrawFullscreen(SimplePixelShader* ps) override;
+	void DrawUI(ImDrawData* drawData) override;
+	void Present(bool vsync) override;
+
+	const Stats& GetStats() const { return stats; }
+	void ResetStats() { stats = {}; }
+
+	// Called by NullDevice for each object it creates
+	// - Counted per thread, so a frame that creates anything
+	//   while it renders fails, but the game thread may still
+	//   create while another thread renders
+	static void CountCreation();
+
+private:
+	Stats stats;
+	const PipelineState* pipeline = 0;
+	const Material* material = 0;
+
+	// Frame state, forgotten by BeginFrame()
+	uint64_t creationsAtBeginFrame = 0;
+	bool targetsBound = false;
+	bool viewportSet = false;
+	bool instanceDataBound = false;
+	ID3D11Buffer* mapped = 0;
+	std::vector<uint8_t> mapScratch;
+
+	// Whatever any draw needs, whether recorded or not
+	void CheckDraw();
+	void Fail(const char* error);
+};
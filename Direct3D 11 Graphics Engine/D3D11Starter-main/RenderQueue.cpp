@@ -0,0 +1,70 @@
+#include "RenderQueue.h"
+
+#include <cstring>
+
+uint64_t RenderQueue::MakeKey(Pass pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth01)
+{
+	constexpr uint32_t maxDepth = (1u << DepthBits) - 1;
+	if (depth01 < 0.0f) depth01 = 0.0f;
+	if (depth01 > 1.0f) depth01 = 1.0f;
+	uint32_t depth = (uint32_t)(depth01 * maxDepth);
+	if (pass == Transparent)
+		depth = maxDepth - depth; // Back to front
+
+	return
+		((uint64_t)pass << PassShift) |
+		((uint64_t)(shader & ((1u << ShaderBits) - 1)) << ShaderShift) |
+		((uint64_t)(material & ((1u << MaterialBits) - 1)) << MaterialShift) |
+		((uint64_t)(mesh & ((1u << MeshBits) - 1)) << MeshShift) |
+		depth;
+}
+
+void RenderQueue::Sort(std::span<RenderQueueEntry> entries, std::span<RenderQueueEntry> scratch)
+{
+	if (entries.size() < 2)
+		return;
+
+	// Every byte's histogram in one read over the keys
+	uint32_t counts[8][256];
+	memset(counts, 0, sizeof(counts));
+	for (const RenderQueueEntry& entry : entries)
+	{
+		uint64_t key = entry.Key;
+		for (int b = 0; b < 8; b++)
+			counts[b][(key >> (b * 8)) & 0xFF]++;
+	}
+
+	RenderQueueEntry* source = entries.data();
+	RenderQueueEntry* destination = scratch.data();
+	for (int b = 0; b < 8; b++)
+	{
+		// All keys share this byte, so this pass wouldn't move anything
+		uint32_t first = (uint32_t)((source[0].Key >> (b * 8)) & 0xFF);
+		if (counts[b][first] == entries.size())
+			continue;
+
+		// Counts -> starting offsets
+		uint32_t offsets[256];
+		uint32_t total = 0;
+		for (int i = 0; i < 256; i++)
+		{
+			offsets[i] = total;
+			total += counts[b][i];
+		}
+
+		int shift = b * 8;
+		for (size_t i = 0; i < entries.size(); i++)
+		{
+			const RenderQueueEntry& entry = source[i];
+			destination[offsets[(entry.Key >> shift) & 0xFF]++] = entry;
+		}
+
+		RenderQueueEntry* swap = source;
+		source = destination;
+		destination = swap;
+	}
+
+	// An odd number of passes leaves the result in the scratch space
+	if (source != entries.data())
+		memcpy(entries.data(), source, entries.size() * sizeof(RenderQueueEntry));
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+
+// --------------------------------------------------------
+// Draw submission order, as sorted 64-bit keys
+//
+//   [pass:4][shader:12][material:16][mesh:12][depth:20]
+//
+// - Sorting the keys groups draws by what's most expensive
+//   to change first, so consecutive draws share as much
+//   state as possible
+// - Depth is the view distance quantized to 20 bits: near
+//   first for opaque passes (less overdraw), far first for
+//   transparent ones (correct blending)
+// - Ids wider than their field wrap, which only costs
+//   some grouping - never correctness
+// --------------------------------------------------------
+
+// One draw to submit - Item indexes the frame's DrawItems
+struct RenderQueueEntry
+{
+	uint64_t Key;
+	uint32_t Item;
+};
+
+namespace RenderQueue
+{
+	enum Pass : uint32_t
+	{
+		Opaque = 0,
+		Transparent = 1,
+	};
+
+	constexpr int DepthBits = 20;
+	constexpr int MeshBits = 12;
+	constexpr int MaterialBits = 16;
+	constexpr int ShaderBits = 12;
+	constexpr int PassBits = 4;
+	static_assert(DepthBits + MeshBits + MaterialBits + ShaderBits + PassBits == 64, "Sort keys are 64 bits");
+
+	constexpr int MeshShift = DepthBits;
+	constexpr int MaterialShift = MeshShift + MeshBits;
+	constexpr int ShaderShift = MaterialShift + MaterialBits;
+	constexpr int PassShift = ShaderShift + ShaderBits;
+
+	// Everything above the depth - draws with the same state key
+	// can share shaders, material & mesh bindings
+	constexpr uint64_t StateMask = ~((1ull << DepthBits) - 1);
+
+	// depth01 is view distance / far clip distance (clamped to 0-1)
+	uint64_t MakeKey(Pass pass, uint32_t shader, uint32_t material, uint32_t mesh, float depth01);
+
+	// LSD radix sort on the keys, one byte per pass, skipping any
+	// byte every key shares (usually most of the upper ones)
+	// - Stable, so equal keys keep their submission order
+	// - scratch must be as big as entries; the result ends up in entries
+	void Sort(std::span<RenderQueueEntry> entries, std::span<RenderQueueEntry> scratch);
+}
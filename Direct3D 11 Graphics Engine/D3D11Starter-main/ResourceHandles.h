@@ -0,0 +1,19 @@
+#pragma once
+
+#include <d3d11.h>
+#include <wrl/client.h>
+#include "ResourcePool.h"
+
+// Lightweight handle types for anything stored in the
+// Resources pools (see Resources.h) - safe to include
+// from other headers without pulling in the pools themselves
+class Mesh;
+class Material;
+class SimpleVertexShader;
+class SimplePixelShader;
+
+using MeshHandle = Handle<Mesh>;
+using MaterialHandle = Handle<Material>;
+using VertexShaderHandle = Handle<SimpleVertexShader>;
+using PixelShaderHandle = Handle<SimplePixelShader>;
+using TextureHandle = Handle<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>>;
@@ -0,0 +1,246 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+// --------------------------------------------------------
+// Generational handles & pooled storage for shared resources
+//
+// - A handle is 32 bits: a 20-bit slot index and a 12-bit
+//   generation.  Looking one up is two array indexes and a
+//   compare - no hashing and no reference counting.
+// - Slots live in fixed-size pages that never move, so a
+//   pointer from Get() stays valid until the resource is
+//   destroyed, even while other threads create resources.
+// - Get() takes no lock: pages are published with release
+//   stores, and a slot only reads as alive once its object
+//   is fully constructed.  Everything else locks.
+// - Release() makes the handle stale right away, but the
+//   object itself is only destroyed by EndFrame() once the
+//   GPU can no longer be reading from it.
+// --------------------------------------------------------
+
+// Typed handle so a MeshHandle can't be passed where a MaterialHandle is expected
+template<typename T>
+struct Handle
+{
+	static constexpr uint32_t IndexBits = 20;
+	static constexpr uint32_t IndexMask = (1u << IndexBits) - 1;
+	static constexpr uint32_t GenerationMask = (1u << (32 - IndexBits)) - 1;
+
+	uint32_t Value = 0; // 0 is never handed out, so it doubles as "null"
+
+	uint32_t Index() const { return Value & IndexMask; }
+	uint32_t Generation() const { return Value >> IndexBits; }
+	bool IsNull() const { return Value == 0; }
+
+	bool operator==(const Handle& other) const { return Value == other.Value; }
+	bool operator!=(const Handle& other) const { return Value != other.Value; }
+
+	static Handle Make(uint32_t index, uint32_t generation)
+	{
+		Handle h;
+		h.Value = (generation << IndexBits) | (index & IndexMask);
+		return h;
+	}
+};
+
+template<typename T>
+class ResourcePool
+{
+public:
+	// How many frames a released resource is kept alive for
+	// (matches the number of frames the GPU may be behind)
+	static constexpr uint64_t DestroyLatency = 3;
+
+	static constexpr uint32_t PageSize = 256;
+	static constexpr uint32_t MaxPages = (Handle<T>::IndexMask + 1) / PageSize;
+
+	ResourcePool() = default;
+	~ResourcePool()
+	{
+		ReleaseAll();
+		for (std::atomic<Slot*>& page : pages)
+			delete[] page.load(std::memory_order_relaxed);
+	}
+	ResourcePool(const ResourcePool&) = delete;
+	ResourcePool& operator=(const ResourcePool&) = delete;
+
+	// Constructs a T in place and returns its handle
+	// - Safe to call from multiple threads at once
+	template<typename... Args>
+	Handle<T> Create(Args&&... args)
+	{
+		uint32_t index;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			index = AllocateSlot();
+		}
+
+		// Construct outside the lock so slow constructors (file loading!) run in parallel
+		// - The slot isn't alive yet, so nothing else touches it meanwhile
+		Slot& slot = SlotAt(index);
+		new (slot.Storage) T(std::forward<Args>(args)...);
+		slot.Constructed = true;
+
+		// Publishes the constructed object to Get() on other threads
+		uint32_t generation = slot.Generation.load(std::memory_order_relaxed);
+		slot.Alive.store(true, std::memory_order_release);
+
+		return Handle<T>::Make(index, generation);
+	}
+
+	// Returns null for null or stale handles
+	T* Get(Handle<T> h) const
+	{
+		if (h.IsNull())
+			return 0;
+
+		const Slot* page = pages[h.Index() / PageSize].load(std::memory_order_acquire);
+		if (!page)
+			return 0;
+
+		const Slot& slot = page[h.Index() % PageSize];
+		if (!slot.Alive.load(std::memory_order_acquire) || slot.Generation.load(std::memory_order_relaxed) != h.Generation())
+			return 0;
+
+		return const_cast<T*>(reinterpret_cast<const T*>(slot.Storage));
+	}
+
+	bool IsValid(Handle<T> h) const { return Get(h) != 0; }
+
+	// Invalidates the handle now; the object is destroyed
+	// DestroyLatency frames later by EndFrame()
+	void Release(Handle<T> h)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		if (!Get(h))
+			return;
+
+		Slot& slot = SlotAt(h.Index());
+		slot.Alive.store(false, std::memory_order_relaxed);
+		slot.Generation.store(NextGeneration(slot.Generation.load(std::memory_order_relaxed)), std::memory_order_relaxed);
+		pendingDestroys.push_back({ h.Index(), frame });
+		liveCount--;
+	}
+
+	// Destroys anything released long enough ago
+	// - Call once per frame, after Present()
+	void EndFrame()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		frame++;
+
+		size_t kept = 0;
+		for (size_t i = 0; i < pendingDestroys.size(); i++)
+		{
+			if (frame - pendingDestroys[i].Frame >= DestroyLatency)
+				DestroySlot(pendingDestroys[i].Index);
+			else
+				pendingDestroys[kept++] = pendingDestroys[i];
+		}
+		pendingDestroys.resize(kept);
+	}
+
+	// Immediately destroys everything - only for shutdown,
+	// when the GPU is known to be idle
+	void ReleaseAll()
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (uint32_t i = 0; i < slotCount; i++)
+		{
+			if (SlotAt(i).Constructed)
+				DestroySlot(i);
+		}
+		pendingDestroys.clear();
+		liveCount = 0;
+	}
+
+	// Number of live (non-released) resources
+	uint32_t Count() const
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		return liveCount;
+	}
+
+	// Calls func(Handle<T>, T&) for every live resource, in slot order
+	// - Holds the lock throughout, so nothing is released (or destroyed
+	//   by EndFrame() on the render thread) mid-walk - func mustn't
+	//   create or release resources in this same pool
+	template<typename Func>
+	void Each(Func&& func)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		for (uint32_t i = 0; i < slotCount; i++)
+		{
+			Slot& slot = SlotAt(i);
+			if (slot.Alive.load(std::memory_order_acquire))
+				func(Handle<T>::Make(i, slot.Generation.load(std::memory_order_relaxed)), *reinterpret_cast<T*>(slot.Storage));
+		}
+	}
+
+private:
+	struct Slot
+	{
+		alignas(T) unsigned char Storage[sizeof(T)];
+		std::atomic<uint32_t> Generation = 1;	// Only changed under the lock, read by Get() without it
+		bool Constructed = false;				// Storage holds a T that still needs destroying
+		std::atomic<bool> Alive = false;		// Reachable through a handle (false once released) - set after construction
+	};
+
+	struct PendingDestroy
+	{
+		uint32_t Index;
+		uint64_t Frame;
+	};
+
+	// Owned, & only ever written once (under the lock) - Get() reads them without it
+	std::atomic<Slot*> pages[MaxPages] = {};
+	std::vector<uint32_t> freeList;
+	std::vector<PendingDestroy> pendingDestroys;
+	uint32_t slotCount = 0;
+	uint32_t liveCount = 0;
+	uint64_t frame = 0;
+	mutable std::mutex mutex;
+
+	Slot& SlotAt(uint32_t index) { return pages[index / PageSize].load(std::memory_order_acquire)[index % PageSize]; }
+
+	// Generation 0 is skipped so a valid handle is never 0
+	static uint32_t NextGeneration(uint32_t generation)
+	{
+		generation = (generation + 1) & Handle<T>::GenerationMask;
+		return generation == 0 ? 1 : generation;
+	}
+
+	// Caller holds the mutex
+	uint32_t AllocateSlot()
+	{
+		liveCount++;
+		if (!freeList.empty())
+		{
+			uint32_t index = freeList.back();
+			freeList.pop_back();
+			return index;
+		}
+
+		// Fully built before it's published to Get()
+		uint32_t index = slotCount++;
+		if (!pages[index / PageSize].load(std::memory_order_relaxed))
+			pages[index / PageSize].store(new Slot[PageSize], std::memory_order_release);
+		return index;
+	}
+
+	// Caller holds the mutex
+	void DestroySlot(uint32_t index)
+	{
+		Slot& slot = SlotAt(index);
+		reinterpret_cast<T*>(slot.Storage)->~T();
+		slot.Constructed = false;
+		slot.Alive.store(false, std::memory_order_relaxed);
+		freeList.push_back(index);
+	}
+};
@@ -0,0 +1,47 @@
+#include "Resources.h"
+#include "Graphics.h"
+#include "PathHelpers.h"
+
+#include "WICTextureLoader.h" // DirectXTK for loading textures
+
+MeshHandle Resources::LoadMesh(const char* name, const std::string& objFile)
+{
+	return Meshes.Create(name, FixPath(objFile).c_str());
+}
+
+
+TextureHandle Resources::LoadTexture(const std::wstring& imageFile)
+{
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv;
+	DirectX::CreateWICTextureFromFile(Graphics::Device.Get(), // Graphics device
+		Graphics::Context.Get(), // The context for auto MIPs
+		FixPath(imageFile).c_str(), // Texture
+		0, // Not the actual texture object, could also use nullptr
+		srv.GetAddressOf()); // Get SRV
+
+	return Textures.Create(srv);
+}
+
+ID3D11ShaderResourceView* Resources::GetSRV(TextureHandle texture)
+{
+	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>* srv = Textures.Get(texture);
+	return srv ? srv->Get() : 0;
+}
+
+void Resources::EndFrame()
+{
+	Meshes.EndFrame();
+	Materials.EndFrame();
+	VertexShaders.EndFrame();
+	PixelShaders.EndFrame();
+	Textures.EndFrame();
+}
+
+void Resources::ReleaseAll()
+{
+	Materials.ReleaseAll();
+	Meshes.ReleaseAll();
+	VertexShaders.ReleaseAll();
+	PixelShaders.ReleaseAll();
+	Textures.ReleaseAll();
+}
@@ -0,0 +1,32 @@
+#pragma once
+
+#include "ResourceHandles.h"
+#include "Mesh.h"
+#include "Material.h"
+#include "SimpleShader.h"
+
+namespace Resources
+{
+	// --- GLOBAL VARS ---
+
+	// Every shared resource lives in one of these pools and is
+	// referred to by handle; nothing outside owns a reference
+	inline ResourcePool<Mesh> Meshes;
+	inline ResourcePool<Material> Materials;
+	inline ResourcePool<SimpleVertexShader> VertexShaders;
+	inline ResourcePool<SimplePixelShader> PixelShaders;
+	inline ResourcePool<Microsoft::WRL::ComPtr<ID3D11ShaderResourceView>> Textures;
+
+	// --- FUNCTIONS ---
+
+	// Loaders (shaders are loaded through ShaderLibrary.h)
+	MeshHandle LoadMesh(const char* name, const std::string& objFile);
+	TextureHandle LoadTexture(const std::wstring& imageFile);
+
+	// Shortcut for binding - null if the handle is stale
+	ID3D11ShaderResourceView* GetSRV(TextureHandle texture);
+
+	// Lifetime
+	void EndFrame(); // Destroys resources released a few frames ago
+	void ReleaseAll(); // Shutdown only - call before Graphics::ShutDown()
+}
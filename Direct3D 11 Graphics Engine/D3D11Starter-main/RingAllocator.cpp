@@ -0,0 +1,66 @@
+#include "RingAllocator.h"
+
+RingAllocator::RingAllocator(uint64_t capacity)
+{
+	Reset(capacity);
+}
+
+void RingAllocator::Reset(uint64_t capacity)
+{
+	this->capacity = capacity;
+	head = 0;
+	tail = 0;
+	pendingStart = 0;
+	pendingCount = 0;
+}
+
+uint64_t RingAllocator::Allocate(uint64_t size, uint64_t alignment)
+{
+	if (size == 0 || size > capacity)
+		return Invalid;
+
+	uint64_t start = (head + alignment - 1) & ~(alignment - 1);
+
+	// Would run off the end - skip the rest of the ring instead
+	uint64_t offset = start % capacity;
+	if (offset + size > capacity)
+		start += capacity - offset;
+
+	// Would run into memory that hasn't been reclaimed yet
+	if (start + size - tail > capacity)
+		return Invalid;
+
+	head = start + size;
+	return start % capacity;
+}
+
+void RingAllocator::EndFrame(uint64_t frame)
+{
+	// Full - fold into the newest mark, so this frame's memory
+	// is simply freed along with the one before it
+	if (pendingCount == MaxPendingFrames)
+	{
+		FrameMark& newest = pending[(pendingStart + pendingCount - 1) % MaxPendingFrames];
+		newest.Frame = frame;
+		newest.Head = head;
+		return;
+	}
+
+	pending[(pendingStart + pendingCount) % MaxPendingFrames] = { frame, head };
+	pendingCount++;
+}
+
+void RingAllocator::Reclaim(uint64_t completedFrame)
+{
+	while (pendingCount > 0 && pending[pendingStart].Frame <= completedFrame)
+	{
+		tail = pending[pendingStart].Head;
+		pendingStart = (pendingStart + 1) % MaxPendingFrames;
+		pendingCount--;
+	}
+}
+
+uint64_t RingAllocator::OldestPendingFrame() const
+{
+	return pendingCount > 0 ? pending[pendingStart].Frame : Invalid;
+}
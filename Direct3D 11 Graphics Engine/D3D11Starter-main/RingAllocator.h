@@ -0,0 +1,66 @@
+#pragma once
+
+#include <cstdint>
+
+// --------------------------------------------------------
+// Frame-fenced ring of offsets into a fixed-size buffer
+//
+// - Allocate() bumps the head; an allocation never wraps
+//   around the end, it skips to the start instead
+// - EndFrame() tags everything allocated so far with a
+//   frame number, and Reclaim() frees whole frames once
+//   the caller knows they're finished (e.g. a GPU fence)
+// - Only hands out offsets - it never touches the memory
+//   itself, so it has no graphics API dependencies
+// - Not thread safe
+// --------------------------------------------------------
+class RingAllocator
+{
+public:
+	static constexpr uint64_t Invalid = UINT64_MAX;
+
+	// Frames that can be waiting on Reclaim() at once - any
+	// more and the newest ones are merged (freed together)
+	static constexpr int MaxPendingFrames = 8;
+
+	explicit RingAllocator(uint64_t capacity = 0);
+
+	// Forgets every allocation and changes the capacity
+	// - Capacity must be a multiple of every alignment used
+	void Reset(uint64_t capacity);
+
+	// Returns the offset of size bytes, or Invalid if that much
+	// contiguous space isn't free yet
+	// - Alignment must be a power of 2
+	uint64_t Allocate(uint64_t size, uint64_t alignment);
+
+	// Everything allocated since the last EndFrame() belongs to frame
+	// - Frame numbers must increase
+	void EndFrame(uint64_t frame);
+
+	// Frees the allocations of every frame <= completedFrame
+	void Reclaim(uint64_t completedFrame);
+
+	// Frame whose allocations would be freed next (Invalid if none are pending)
+	uint64_t OldestPendingFrame() const;
+
+	uint64_t Capacity() const { return capacity; }
+	uint64_t BytesInUse() const { return head - tail; }
+	int PendingFrames() const { return pendingCount; }
+
+private:
+	struct FrameMark
+	{
+		uint64_t Frame;
+		uint64_t Head; // Where the ring's head was when the frame ended
+	};
+
+	// Head & tail only ever increase; the offset is their value % capacity
+	uint64_t capacity = 0;
+	uint64_t head = 0;
+	uint64_t tail = 0;
+
+	FrameMark pending[MaxPendingFrames] = {};
+	int pendingStart = 0;
+	int pendingCount = 0;
+};
@@ -0,0 +1,68 @@
+#include "SelfTests.h"
+#include "RingAllocator.h"
+
+// Returns the description from the enclosing test if the condition's false
+#define SELF_TEST_CHECK(condition, description) if (!(condition)) return description
+
+// --------------------------------------------------------
+// The ring's allocation, wrapping & frame fencing rules
+// (see RingAllocator.h), on a 1 KB ring
+// --------------------------------------------------------
+const char* SelfTests::RingAllocator()
+{
+	::RingAllocator ring(1024);
+
+	// Aligned bumps from the start
+	SELF_TEST_CHECK(ring.Allocate(100, 16) == 0, "RingAllocator: first allocation isn't at 0");
+	SELF_TEST_CHECK(ring.Allocate(100, 256) == 256, "RingAllocator: allocation isn't aligned");
+	SELF_TEST_CHECK(ring.BytesInUse() == 356, "RingAllocator: wrong bytes in use after two allocations");
+	ring.EndFrame(1);
+
+	// Doesn't fit before the end & the start's still in use
+	SELF_TEST_CHECK(ring.Allocate(700, 256) == RingAllocator::Invalid, "RingAllocator: allocated over memory that's still in use");
+	SELF_TEST_CHECK(ring.Allocate(2048, 16) == RingAllocator::Invalid, "RingAllocator: allocated more than its capacity");
+	SELF_TEST_CHECK(ring.Allocate(0, 16) == RingAllocator::Invalid, "RingAllocator: allocated 0 bytes");
+
+	// Fills to the end, then wraps to the start once frame 1 is reclaimed
+	SELF_TEST_CHECK(ring.Allocate(512, 256) == 512, "RingAllocator: allocation up to the end failed");
+	ring.EndFrame(2);
+	SELF_TEST_CHECK(ring.Allocate(16, 16) == RingAllocator::Invalid, "RingAllocator: allocated while full");
+	SELF_TEST_CHECK(ring.OldestPendingFrame() == 1, "RingAllocator: oldest pending frame isn't 1");
+
+	ring.Reclaim(1);
+	SELF_TEST_CHECK(ring.PendingFrames() == 1 && ring.OldestPendingFrame() == 2, "RingAllocator: reclaiming frame 1 didn't leave frame 2 pending");
+	SELF_TEST_CHECK(ring.Allocate(300, 16) == 0, "RingAllocator: didn't wrap to the start");
+	SELF_TEST_CHECK(ring.Allocate(300, 16) == RingAllocator::Invalid, "RingAllocator: wrapped allocation ran into frame 2");
+
+	// Reclaiming frees whole frames in order, & never frames past the one completed
+	ring.EndFrame(3);
+	ring.Reclaim(2);
+	SELF_TEST_CHECK(ring.OldestPendingFrame() == 3 && ring.BytesInUse() == 300, "RingAllocator: reclaiming frame 2 freed the wrong memory");
+	ring.Reclaim(3);
+	SELF_TEST_CHECK(ring.PendingFrames() == 0 && ring.BytesInUse() == 0, "RingAllocator: reclaiming every frame left memory in use");
+	SELF_TEST_CHECK(ring.OldestPendingFrame() == RingAllocator::Invalid, "RingAllocator: a frame is pending after reclaiming all of them");
+
+	// Past MaxPendingFrames, the newest frames fold together
+	for (int frame = 0; frame < RingAllocator::MaxPendingFrames + 3; frame++)
+	{
+		SELF_TEST_CHECK(ring.Allocate(16, 16) != RingAllocator::Invalid, "RingAllocator: small allocation failed while folding frames");
+		ring.EndFrame(10 + frame);
+	}
+	SELF_TEST_CHECK(ring.PendingFrames() == RingAllocator::MaxPendingFrames, "RingAllocator: more frames pending than MaxPendingFrames");
+
+	// The last mark now covers the last 4 frames, so reclaiming up
+	// to one before the newest frees none of them
+	uint64_t newest = 10 + RingAllocator::MaxPendingFrames + 2;
+	ring.Reclaim(newest - 1);
+	SELF_TEST_CHECK(ring.PendingFrames() == 1 && ring.BytesInUse() == 16 * 4, "RingAllocator: folded frames weren't kept together");
+	ring.Reclaim(newest);
+	SELF_TEST_CHECK(ring.PendingFrames() == 0 && ring.BytesInUse() == 0, "RingAllocator: folded frames weren't freed together");
+
+	return 0;
+}
+
+const char* SelfTests::RunAll()
+{
+	const char* failure = RingAllocator();
+	return failure;
+}
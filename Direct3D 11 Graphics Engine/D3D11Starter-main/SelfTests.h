@@ -0,0 +1,17 @@
+#pragma once
+
+// --------------------------------------------------------
+// Checks of the engine's pure CPU pieces, with no window,
+// device or job threads needed
+//
+// - Run at startup in debug builds & by "-headless" runs
+// - Each returns 0 if everything passed, or a description
+//   of the first check that failed
+// --------------------------------------------------------
+namespace SelfTests
+{
+	const char* RingAllocator();
+
+	// Every test above, stopping at the first failure
+	const char* RunAll();
+}
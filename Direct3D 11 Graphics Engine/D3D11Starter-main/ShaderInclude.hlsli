@@ -9,6 +9,26 @@
 
 #define MAX_SPECULAR_EXPONENT 256.0f
 
+#define MAX_LIGHTS 6 // Must match MaxLights in BufferStructs.h
+
+// Permutation defines (set by ShaderLibrary when compiling a variant)
+// - LIGHT_COUNT is how many lights the loops run over; the
+//   cbuffer always holds MAX_LIGHTS so its layout never changes
+// - SHADOWS 0 drops the shadow map lookup
+// - INSTANCED 1 reads each object's matrices from the Objects
+//   buffer, at the index in InstanceInput, instead of PerObject
+#ifndef LIGHT_COUNT
+#define LIGHT_COUNT MAX_LIGHTS
+#endif
+
+#ifndef SHADOWS
+#define SHADOWS 1
+#endif
+
+#ifndef INSTANCED
+#define INSTANCED 0
+#endif
+
 // CONSTANTS ===================
 // A constant Fresnel value for non-metals (glass and plastic have values of about 0.04)
 static const float F0_NON_METAL = 0.04f;
@@ -37,6 +57,36 @@ struct VertexShaderInput
     float3 tangent : TANGENT; // Can be used to compute the bi-tangent vector as well
 };
 
+// One object's matrices in the Objects buffer, written once a frame
+// - Must match ObjectTransform in BufferStructs.h
+// - Each is 3x4: the top three rows of the matrix as a cbuffer would
+//   read it (the transpose of the C++ one), as the last is always
+//   0,0,0,1 (the inverse transpose only ever has its 3x3 used)
+struct ObjectTransform
+{
+    float4 world[3];
+    float4 worldInvTransp[3];
+};
+
+#if INSTANCED
+StructuredBuffer<ObjectTransform> Objects : register(t0); // Must match ObjectTransformsRegister
+#endif
+
+// Which object in Objects this instance is (vertex buffer slot 1)
+// - The "_PER_INSTANCE" semantic makes SimpleShader step it once per instance
+// - Slot 1 just counts 0, 1, 2..., so a draw's first instance reads
+//   its StartInstance - the only per-draw data there is
+struct InstanceInput
+{
+    uint objectIndex : OBJECT_PER_INSTANCE;
+};
+
+// Rebuilds a full matrix from an ObjectTransform's rows
+matrix ObjectMatrix(float4 rows[3])
+{
+    return float4x4(rows[0], rows[1], rows[2], float4(0, 0, 0, 1));
+}
+
 // Struct representing the data we're sending down the pipeline
 // - The output of our corresponding vertex shader should match our pixel shader's input (hence the name: Vertex to Pixel)
 // - At a minimum, we need a piece of data defined tagged as SV_POSITION
@@ -81,6 +131,27 @@ struct Light
     float2 Padding; // Purposefully padding to hit the 16-byte boundary
 };
 
+// SHARED CONSTANT BUFFERS ======
+// - Recognized BY NAME when a shader is loaded: SimpleShader binds the
+//   engine's single copy of each instead of making its own, so they're
+//   filled & uploaded once (per frame or per pass) for every shader
+// - Per-object & per-material buffers stay in each shader (b0, b1...)
+// - Layouts must match PerPassData & PerFrameData in BufferStructs.h
+cbuffer PerPass : register(b12) // Once per render pass (main camera, shadow map, ...)
+{
+    matrix view;
+    matrix projection;
+    float3 currentCamPos;
+};
+
+cbuffer PerFrame : register(b13) // Once per frame
+{
+    matrix lightView;
+    matrix lightProj;
+    Light lights[MAX_LIGHTS];
+    float time;
+};
+
 /* Lighting Helper Functions: */
 
 // Decrease light as it gets further away
@@ -0,0 +1,186 @@
+#include "ShaderLibrary.h"
+#include "Resources.h"
+#include "Graphics.h"
+#include "PathHelpers.h"
+
+#include <d3dcompiler.h>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+// Annonymous namespace to hold variables
+// only accessible in this file
+namespace
+{
+	struct ShaderKey
+	{
+		std::wstring Source;
+		uint32_t Permutation;
+
+		bool operator==(const ShaderKey& other) const { return Permutation == other.Permutation && Source == other.Source; }
+	};
+
+	struct ShaderKeyHash
+	{
+		size_t operator()(const ShaderKey& key) const
+		{
+			return std::hash<std::wstring>()(key.Source) ^ (key.Permutation * 0x9E3779B97F4A7C15ull);
+		}
+	};
+
+	// One per shader stage
+	template<typename T>
+	struct ShaderTable
+	{
+		std::unordered_map<ShaderKey, Handle<T>, ShaderKeyHash> byKey;
+		std::unordered_map<uint32_t, std::wstring> sourceOf; // Handle value -> source, for SelectVariant()
+		std::unordered_map<uint64_t, Handle<T>> variants; // (handle value, permutation) -> variant, so a repeat SelectVariant() doesn't allocate
+	};
+
+	std::mutex mutex;
+	ShaderTable<SimpleVertexShader> vertexShaders;
+	ShaderTable<SimplePixelShader> pixelShaders;
+	size_t compiledCount = 0;
+
+	// Compiles one permutation of a source, or returns null
+	Microsoft::WRL::ComPtr<ID3DBlob> Compile(const std::wstring& source, uint32_t permutation, const char* target)
+	{
+		// The define strings have to outlive the compile
+		std::string lightCount = std::to_string(ShaderPermutation::LightCount(permutation));
+		std::vector<D3D_SHADER_MACRO> defines;
+		if (permutation & ShaderPermutation::NoShadows)
+			defines.push_back({ "SHADOWS", "0" });
+		if (permutation & ShaderPermutation::Instanced)
+			defines.push_back({ "INSTANCED", "1" });
+		if (ShaderPermutation::LightCount(permutation) > 0)
+			defines.push_back({ "LIGHT_COUNT", lightCount.c_str() });
+		defines.push_back({ 0, 0 });
+
+		UINT flags = D3DCOMPILE_OPTIMIZATION_LEVEL3;
+#if defined(DEBUG) || defined(_DEBUG)
+		flags = D3DCOMPILE_DEBUG | D3DCOMPILE_SKIP_OPTIMIZATION;
+#endif
+
+		// Next to the executable if the source was shipped there,
+		// otherwise the working directory (the project folder when
+		// started from Visual Studio)
+		std::wstring paths[] = { FixPath(source + L".hlsl"), source + L".hlsl" };
+		for (const std::wstring& path : paths)
+		{
+			if (GetFileAttributesW(path.c_str()) == INVALID_FILE_ATTRIBUTES)
+				continue;
+
+			Microsoft::WRL::ComPtr<ID3DBlob> blob;
+			Microsoft::WRL::ComPtr<ID3DBlob> errors;
+			HRESULT hr = D3DCompileFromFile(path.c_str(), defines.data(), D3D_COMPILE_STANDARD_FILE_INCLUDE,
+				"main", target, flags, 0, blob.GetAddressOf(), errors.GetAddressOf());
+			if (errors)
+				OutputDebugStringA(static_cast<const char*>(errors->GetBufferPointer()));
+
+			if (FAILED(hr))
+				return 0;
+			return blob;
+		}
+
+		return 0;
+	}
+
+	// Finds or creates the shader for a key - caller holds the mutex
+	template<typename T>
+	Handle<T> Get(ShaderTable<T>& table, ResourcePool<T>& pool, const std::wstring& source, uint32_t permutation, const char* target)
+	{
+		ShaderKey key = { source, permutation };
+		auto existing = table.byKey.find(key);
+		if (existing != table.byKey.end())
+			return existing->second;
+
+		Handle<T> shader;
+		if (permutation == 0)
+		{
+			shader = pool.Create(Graphics::Device, Graphics::Context, FixPath(source + L".cso").c_str());
+		}
+		else if (Microsoft::WRL::ComPtr<ID3DBlob> blob = Compile(source, permutation, target))
+		{
+			shader = pool.Create(Graphics::Device, Graphics::Context, blob);
+			compiledCount++;
+		}
+		else
+		{
+			// Can't specialize - share the default instead
+			shader = Get(table, pool, source, 0, target);
+		}
+
+		table.byKey.insert({ key, shader });
+		table.sourceOf.insert({ shader.Value, source });
+		return shader;
+	}
+
+	// Finds or creates a shader's variant - caller holds the mutex
+	// - Only a miss touches the source name (or compiles)
+	template<typename T>
+	Handle<T> Select(ShaderTable<T>& table, ResourcePool<T>& pool, Handle<T> shader, uint32_t permutation, const char* target)
+	{
+		uint64_t key = ((uint64_t)shader.Value << 32) | permutation;
+		auto known = table.variants.find(key);
+		if (known != table.variants.end())
+			return known->second;
+
+		Handle<T> variant = shader;
+		auto source = table.sourceOf.find(shader.Value);
+		if (source != table.sourceOf.end())
+			variant = Get(table, pool, source->second, permutation, target);
+
+		table.variants.insert({ key, variant });
+		return variant;
+	}
+}
+
+VertexShaderHandle ShaderLibrary::GetVertexShader(const std::wstring& source, uint32_t permutation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Get(vertexShaders, Resources::VertexShaders, source, permutation, "vs_5_0");
+}
+
+PixelShaderHandle ShaderLibrary::GetPixelShader(const std::wstring& source, uint32_t permutation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Get(pixelShaders, Resources::PixelShaders, source, permutation, "ps_5_0");
+}
+
+VertexShaderHandle ShaderLibrary::SelectVariant(VertexShaderHandle shader, uint32_t permutation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Select(vertexShaders, Resources::VertexShaders, shader, permutation, "vs_5_0");
+}
+
+PixelShaderHandle ShaderLibrary::SelectVariant(PixelShaderHandle shader, uint32_t permutation)
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return Select(pixelShaders, Resources::PixelShaders, shader, permutation, "ps_5_0");
+}
+
+size_t ShaderLibrary::EntryCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return vertexShaders.byKey.size() + pixelShaders.byKey.size();
+}
+
+size_t ShaderLibrary::ShaderCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return vertexShaders.sourceOf.size() + pixelShaders.sourceOf.size();
+}
+
+size_t ShaderLibrary::CompiledCount()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return compiledCount;
+}
+
+void ShaderLibrary::Clear()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	vertexShaders = {};
+	pixelShaders = {};
+	compiledCount = 0;
+}
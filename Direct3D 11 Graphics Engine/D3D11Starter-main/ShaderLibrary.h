@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include "ResourceHandles.h"
+
+// --------------------------------------------------------
+// Permutation keys - a bitmask of what a shader variant was
+// compiled with.  Each bit (or field) becomes a #define.
+// 0 is always the build's own precompiled .cso.
+// --------------------------------------------------------
+namespace ShaderPermutation
+{
+	// Feature bits
+	constexpr uint32_t NoShadows = 1u << 0; // SHADOWS 0 - skips the shadow map lookup
+	constexpr uint32_t Instanced = 1u << 1; // INSTANCED 1 - vertex shaders read matrices per instance
+
+	// Bits 8-15 hold the light count to compile the light loop
+	// for (LIGHT_COUNT); 0 keeps the shader's own MAX_LIGHTS
+	constexpr uint32_t LightCountShift = 8;
+	constexpr uint32_t LightCountMask = 0xFFu << LightCountShift;
+
+	constexpr uint32_t LightCount(uint32_t permutation) { return (permutation & LightCountMask) >> LightCountShift; }
+	constexpr uint32_t WithLightCount(uint32_t permutation, uint32_t lightCount)
+	{
+		return (permutation & ~LightCountMask) | ((lightCount << LightCountShift) & LightCountMask);
+	}
+}
+
+// --------------------------------------------------------
+// Every shader the game draws with, keyed by (source, permutation)
+//
+// - A source is the shader's file name with no extension
+//   ("PixelShader"), so it names both the .cso and the .hlsl
+// - Each key is loaded once, and asking again returns the
+//   same handle, so materials share shader objects
+// - Other permutations are compiled from the .hlsl the first
+//   time they're asked for.  If that can't be done (source not
+//   found, compile error) the default is used instead, and
+//   that's remembered so it's only tried once.
+// - Safe to call from any thread
+// --------------------------------------------------------
+namespace ShaderLibrary
+{
+	// Loaders
+	VertexShaderHandle GetVertexShader(const std::wstring& source, uint32_t permutation = 0);
+	PixelShaderHandle GetPixelShader(const std::wstring& source, uint32_t permutation = 0);
+
+	// The variant of a shader from this library for another permutation.
+	// Shaders that didn't come from here are returned as-is.
+	// - Asking again for the same (shader, permutation) is a lookup that
+	//   doesn't allocate, but the first ask may compile - so resolve them
+	//   on the game thread ahead of recording (see Material::PrepareVariant())
+	VertexShaderHandle SelectVariant(VertexShaderHandle shader, uint32_t permutation);
+	PixelShaderHandle SelectVariant(PixelShaderHandle shader, uint32_t permutation);
+
+	// Stats
+	size_t EntryCount();	// Distinct (source, permutation) keys seen
+	size_t ShaderCount();	// Distinct shader objects behind them
+	size_t CompiledCount();	// Variants compiled at run time
+
+	// Forgets every key (the shaders are freed by Resources::ReleaseAll())
+	void Clear();
+}
@@ -0,0 +1,216 @@
+#pragma once
+
+// --------------------------------------------------------
+// GENERATED by Tools/ShaderStructGen from the compiled
+// shaders on every build - don't edit by hand
+//
+// C++ mirrors of each shader's constant buffers, laid out
+// exactly like the HLSL, so one can be set whole with
+// ISimpleShader::Set()
+// --------------------------------------------------------
+
+#include <DirectXMath.h>
+#include <cstddef>
+#include <cstdint>
+
+namespace ShaderStructs
+{
+	// HLSL structs
+	struct Light
+	{
+		static constexpr const char* Name = "Light";
+
+		int32_t Type;
+		DirectX::XMFLOAT3 Direction;
+		float Range;
+		DirectX::XMFLOAT3 Position;
+		float Intensity;
+		DirectX::XMFLOAT3 Color;
+		float SpotInnerAngle;
+		float SpotOuterAngle;
+		DirectX::XMFLOAT2 Padding;
+	};
+	static_assert(offsetof(Light, Type) == 0, "Light::Type moved");
+	static_assert(offsetof(Light, Direction) == 4, "Light::Direction moved");
+	static_assert(offsetof(Light, Range) == 16, "Light::Range moved");
+	static_assert(offsetof(Light, Position) == 20, "Light::Position moved");
+	static_assert(offsetof(Light, Intensity) == 32, "Light::Intensity moved");
+	static_assert(offsetof(Light, Color) == 36, "Light::Color moved");
+	static_assert(offsetof(Light, SpotInnerAngle) == 48, "Light::SpotInnerAngle moved");
+	static_assert(offsetof(Light, SpotOuterAngle) == 52, "Light::SpotOuterAngle moved");
+	static_assert(offsetof(Light, Padding) == 56, "Light::Padding moved");
+	static_assert(sizeof(Light) == 64, "Light changed size");
+
+	// Buffers shared by several shaders
+	struct PerPass
+	{
+		static constexpr const char* Name = "PerPass";
+		static constexpr unsigned int Register = 12;
+
+		DirectX::XMFLOAT4X4 view;
+		DirectX::XMFLOAT4X4 projection;
+		DirectX::XMFLOAT3 currentCamPos;
+		uint32_t Pad0[1];
+	};
+	static_assert(offsetof(PerPass, view) == 0, "PerPass::view moved");
+	static_assert(offsetof(PerPass, projection) == 64, "PerPass::projection moved");
+	static_assert(offsetof(PerPass, currentCamPos) == 128, "PerPass::currentCamPos moved");
+	static_assert(sizeof(PerPass) == 144, "PerPass changed size");
+
+	struct PerFrame
+	{
+		static constexpr const char* Name = "PerFrame";
+		static constexpr unsigned int Register = 13;
+
+		DirectX::XMFLOAT4X4 lightView;
+		DirectX::XMFLOAT4X4 lightProj;
+		Light lights[6];
+		float time;
+		uint32_t Pad0[3];
+	};
+	static_assert(offsetof(PerFrame, lightView) == 0, "PerFrame::lightView moved");
+	static_assert(offsetof(PerFrame, lightProj) == 64, "PerFrame::lightProj moved");
+	static_assert(offsetof(PerFrame, lights) == 128, "PerFrame::lights moved");
+	static_assert(offsetof(PerFrame, time) == 512, "PerFrame::time moved");
+	static_assert(sizeof(PerFrame) == 528, "PerFrame changed size");
+
+	// BloomPS_Combine.hlsl
+	namespace BloomPS_Combine
+	{
+		struct externalData
+		{
+			static constexpr const char* Name = "externalData";
+			static constexpr unsigned int Register = 0;
+
+			float intensityLvl;
+			uint32_t Pad0[3];
+		};
+		static_assert(offsetof(externalData, intensityLvl) == 0, "externalData::intensityLvl moved");
+		static_assert(sizeof(externalData) == 16, "externalData changed size");
+
+	}
+
+	// BloomPS_Extract.hlsl
+	namespace BloomPS_Extract
+	{
+		struct externalData
+		{
+			static constexpr const char* Name = "externalData";
+			static constexpr unsigned int Register = 0;
+
+			float brightnessThreshold;
+			uint32_t Pad0[3];
+		};
+		static_assert(offsetof(externalData, brightnessThreshold) == 0, "externalData::brightnessThreshold moved");
+		static_assert(sizeof(externalData) == 16, "externalData changed size");
+
+	}
+
+	// BoxBlurPS.hlsl
+	namespace BoxBlurPS
+	{
+		struct externalData
+		{
+			static constexpr const char* Name = "externalData";
+			static constexpr unsigned int Register = 0;
+
+			int32_t blurRadius;
+			float pixelWidth;
+			float pixelHeight;
+			uint32_t Pad0[1];
+		};
+		static_assert(offsetof(externalData, blurRadius) == 0, "externalData::blurRadius moved");
+		static_assert(offsetof(externalData, pixelWidth) == 4, "externalData::pixelWidth moved");
+		static_assert(offsetof(externalData, pixelHeight) == 8, "externalData::pixelHeight moved");
+		static_assert(sizeof(externalData) == 16, "externalData changed size");
+
+	}
+
+	// CombinePS.hlsl
+	namespace CombinePS
+	{
+		struct ExternalData
+		{
+			static constexpr const char* Name = "ExternalData";
+			static constexpr unsigned int Register = 0;
+
+			DirectX::XMFLOAT4 colorTint;
+			DirectX::XMFLOAT2 uvScale;
+			DirectX::XMFLOAT2 uvOffset;
+		};
+		static_assert(offsetof(ExternalData, colorTint) == 0, "ExternalData::colorTint moved");
+		static_assert(offsetof(ExternalData, uvScale) == 16, "ExternalData::uvScale moved");
+		static_assert(offsetof(ExternalData, uvOffset) == 24, "ExternalData::uvOffset moved");
+		static_assert(sizeof(ExternalData) == 32, "ExternalData changed size");
+
+	}
+
+	// GaussianBlurPS.hlsl
+	namespace GaussianBlurPS
+	{
+		struct externalData
+		{
+			static constexpr const char* Name = "externalData";
+			static constexpr unsigned int Register = 0;
+
+			DirectX::XMFLOAT2 pixelUVSize;
+			DirectX::XMFLOAT2 blurDirect;
+		};
+		static_assert(offsetof(externalData, pixelUVSize) == 0, "externalData::pixelUVSize moved");
+		static_assert(offsetof(externalData, blurDirect) == 8, "externalData::blurDirect moved");
+		static_assert(sizeof(externalData) == 16, "externalData changed size");
+
+	}
+
+	// PixelShader.hlsl
+	namespace PixelShader
+	{
+		struct PerMaterial
+		{
+			static constexpr const char* Name = "PerMaterial";
+			static constexpr unsigned int Register = 1;
+
+			DirectX::XMFLOAT4 colorTint;
+			DirectX::XMFLOAT2 uvScale;
+			DirectX::XMFLOAT2 uvOffset;
+		};
+		static_assert(offsetof(PerMaterial, colorTint) == 0, "PerMaterial::colorTint moved");
+		static_assert(offsetof(PerMaterial, uvScale) == 16, "PerMaterial::uvScale moved");
+		static_assert(offsetof(PerMaterial, uvOffset) == 24, "PerMaterial::uvOffset moved");
+		static_assert(sizeof(PerMaterial) == 32, "PerMaterial changed size");
+
+	}
+
+	// ShadowMapVS.hlsl
+	namespace ShadowMapVS
+	{
+		struct PerObject
+		{
+			static constexpr const char* Name = "PerObject";
+			static constexpr unsigned int Register = 0;
+
+			DirectX::XMFLOAT4X4 world;
+		};
+		static_assert(offsetof(PerObject, world) == 0, "PerObject::world moved");
+		static_assert(sizeof(PerObject) == 64, "PerObject changed size");
+
+	}
+
+	// VertexShader.hlsl
+	namespace VertexShader
+	{
+		struct PerObject
+		{
+			static constexpr const char* Name = "PerObject";
+			static constexpr unsigned int Register = 0;
+
+			DirectX::XMFLOAT4X4 world;
+			DirectX::XMFLOAT4X4 worldInvTransp;
+		};
+		static_assert(offsetof(PerObject, world) == 0, "PerObject::world moved");
+		static_assert(offsetof(PerObject, worldInvTransp) == 64, "PerObject::worldInvTransp moved");
+		static_assert(sizeof(PerObject) == 128, "PerObject changed size");
+
+	}
+
+}
@@ -1,17 +1,26 @@
 #include "ShaderInclude.hlsli" // Contains all necessary structs, helper functions, etc.
 
 // Constant Buffer for external (C++) data
-cbuffer externalData : register(b0)
+// - View & projection (the light's, for this pass) come from PerPass
+// - The INSTANCED variant reads world from the Objects buffer instead
+#if !INSTANCED
+cbuffer PerObject : register(b0)
 {
     matrix world;
-    matrix view;
-    matrix projection;
 };
+#endif
 // --------------------------------------------------------
 // A simplified vertex shader for rendering to a shadow map
 // --------------------------------------------------------
+#if INSTANCED
+float4 main(VertexShaderInput input, InstanceInput instance) : SV_POSITION
+#else
 float4 main(VertexShaderInput input) : SV_POSITION
+#endif
 {
+#if INSTANCED
+    matrix world = ObjectMatrix(Objects[instance.objectIndex].world);
+#endif
     matrix wvp = mul(projection, mul(view, world));
     return mul(wvp, float4(input.localPosition, 1.0f));
 }
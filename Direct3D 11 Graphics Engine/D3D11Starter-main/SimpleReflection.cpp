@@ -0,0 +1,301 @@
+#include "SimpleReflection.h"
+
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	// Anything bigger than this can't be a real cache file
+	constexpr uint64_t MaxFileSize = 16 * 1024 * 1024;
+
+	// Picks the input layout format for a vertex shader input
+	// from its component count (mask) & component type
+	DXGI_FORMAT InputFormat(const D3D11_SIGNATURE_PARAMETER_DESC& paramDesc)
+	{
+		static const DXGI_FORMAT formats[4][3] =
+		{
+			// UINT32						SINT32							FLOAT32
+			{ DXGI_FORMAT_R32_UINT,				DXGI_FORMAT_R32_SINT,				DXGI_FORMAT_R32_FLOAT },
+			{ DXGI_FORMAT_R32G32_UINT,			DXGI_FORMAT_R32G32_SINT,			DXGI_FORMAT_R32G32_FLOAT },
+			{ DXGI_FORMAT_R32G32B32_UINT,		DXGI_FORMAT_R32G32B32_SINT,			DXGI_FORMAT_R32G32B32_FLOAT },
+			{ DXGI_FORMAT_R32G32B32A32_UINT,	DXGI_FORMAT_R32G32B32A32_SINT,		DXGI_FORMAT_R32G32B32A32_FLOAT },
+		};
+
+		int components;
+		if (paramDesc.Mask == 1) components = 0;
+		else if (paramDesc.Mask <= 3) components = 1;
+		else if (paramDesc.Mask <= 7) components = 2;
+		else if (paramDesc.Mask <= 15) components = 3;
+		else return DXGI_FORMAT_UNKNOWN;
+
+		switch (paramDesc.ComponentType)
+		{
+		case D3D_REGISTER_COMPONENT_UINT32: return formats[components][0];
+		case D3D_REGISTER_COMPONENT_SINT32: return formats[components][1];
+		case D3D_REGISTER_COMPONENT_FLOAT32: return formats[components][2];
+		default: return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
+	bool EndsWith(std::string_view text, std::string_view suffix)
+	{
+		return text.size() >= suffix.size() && text.compare(text.size() - suffix.size(), suffix.size(), suffix) == 0;
+	}
+}
+
+uint64_t SimpleReflection::HashBytecode(const void* bytecode, size_t size)
+{
+	const unsigned char* bytes = static_cast<const unsigned char*>(bytecode);
+	uint64_t hash = 14695981039346656037ull;
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ull;
+	}
+	return hash;
+}
+
+// --------------------------------------------------------
+// Runs D3DReflect and flattens what it finds into one block
+// --------------------------------------------------------
+bool SimpleReflection::Reflect(const void* bytecode, size_t size)
+{
+	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
+	if (FAILED(D3DReflect(bytecode, size, IID_ID3D11ShaderReflection, (void**)refl.GetAddressOf())))
+		return false;
+
+	D3D11_SHADER_DESC shaderDesc;
+	refl->GetDesc(&shaderDesc);
+
+	std::vector<SimpleReflectedBuffer> buffers;
+	std::vector<SimpleReflectedVariable> variables;
+	std::vector<SimpleReflectedResource> resources;
+	std::vector<SimpleReflectedInput> inputs;
+	std::string strings;
+	auto addString = [&](const char* s)
+	{
+		uint32_t offset = (uint32_t)strings.size();
+		strings.append(s);
+		strings.push_back('\0');
+		return offset;
+	};
+
+	// Textures, structured buffers & samplers (constant buffers are next)
+	for (unsigned int r = 0; r < shaderDesc.BoundResources; r++)
+	{
+		D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
+		refl->GetResourceBindingDesc(r, &resourceDesc);
+
+		if (resourceDesc.Type == D3D_SIT_STRUCTURED ||
+			resourceDesc.Type == D3D_SIT_TEXTURE ||
+			resourceDesc.Type == D3D_SIT_SAMPLER)
+			resources.push_back({ addString(resourceDesc.Name), (uint32_t)resourceDesc.Type, resourceDesc.BindPoint });
+	}
+
+	// Constant buffers & their variables
+	for (unsigned int b = 0; b < shaderDesc.ConstantBuffers; b++)
+	{
+		ID3D11ShaderReflectionConstantBuffer* cb = refl->GetConstantBufferByIndex(b);
+		D3D11_SHADER_BUFFER_DESC bufferDesc;
+		cb->GetDesc(&bufferDesc);
+
+		D3D11_SHADER_INPUT_BIND_DESC bindDesc;
+		refl->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
+
+		SimpleReflectedBuffer buffer = {};
+		buffer.Name = addString(bufferDesc.Name);
+		buffer.Type = (uint32_t)bufferDesc.Type;
+		buffer.Size = bufferDesc.Size;
+		buffer.BindIndex = bindDesc.BindPoint;
+		buffer.FirstVariable = (uint32_t)variables.size();
+		buffer.VariableCount = bufferDesc.Variables;
+		buffers.push_back(buffer);
+
+		for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+		{
+			D3D11_SHADER_VARIABLE_DESC varDesc;
+			cb->GetVariableByIndex(v)->GetDesc(&varDesc);
+			variables.push_back({ addString(varDesc.Name), varDesc.StartOffset, varDesc.Size });
+		}
+	}
+
+	// Vertex inputs, for building an input layout
+	if (D3D11_SHVER_GET_TYPE(shaderDesc.Version) == D3D11_SHVER_VERTEX_SHADER)
+	{
+		for (unsigned int i = 0; i < shaderDesc.InputParameters; i++)
+		{
+			D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
+			refl->GetInputParameterDesc(i, &paramDesc);
+
+			SimpleReflectedInput input = {};
+			input.SemanticName = addString(paramDesc.SemanticName);
+			input.SemanticIndex = paramDesc.SemanticIndex;
+			input.Format = (uint32_t)InputFormat(paramDesc);
+			input.PerInstance = EndsWith(paramDesc.SemanticName, "_PER_INSTANCE");
+			inputs.push_back(input);
+		}
+	}
+
+	// Pack it all into one block
+	size_t totalSize =
+		sizeof(SimpleReflectionHeader) +
+		sizeof(SimpleReflectedBuffer) * buffers.size() +
+		sizeof(SimpleReflectedVariable) * variables.size() +
+		sizeof(SimpleReflectedResource) * resources.size() +
+		sizeof(SimpleReflectedInput) * inputs.size() +
+		strings.size();
+	data = std::make_unique<unsigned char[]>(totalSize);
+
+	SimpleReflectionHeader header = {};
+	header.Magic = Magic;
+	header.Version = Version;
+	header.BytecodeHash = HashBytecode(bytecode, size);
+	header.TotalSize = (uint32_t)totalSize;
+	header.BufferCount = (uint32_t)buffers.size();
+	header.VariableCount = (uint32_t)variables.size();
+	header.ResourceCount = (uint32_t)resources.size();
+	header.InputCount = (uint32_t)inputs.size();
+	header.StringBytes = (uint32_t)strings.size();
+
+	unsigned char* write = data.get();
+	auto append = [&](const void* source, size_t bytes)
+	{
+		if (bytes > 0) memcpy(write, source, bytes);
+		write += bytes;
+	};
+	append(&header, sizeof(header));
+	append(buffers.data(), sizeof(SimpleReflectedBuffer) * buffers.size());
+	append(variables.data(), sizeof(SimpleReflectedVariable) * variables.size());
+	append(resources.data(), sizeof(SimpleReflectedResource) * resources.size());
+	append(inputs.data(), sizeof(SimpleReflectedInput) * inputs.size());
+	append(strings.data(), strings.size());
+	return true;
+}
+
+// --------------------------------------------------------
+// Reads a whole cache file with one read into one block
+// --------------------------------------------------------
+bool SimpleReflection::Load(const std::wstring& path, uint64_t bytecodeHash)
+{
+	HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER fileSize = {};
+	bool ok =
+		GetFileSizeEx(file, &fileSize) &&
+		fileSize.QuadPart >= (LONGLONG)sizeof(SimpleReflectionHeader) &&
+		fileSize.QuadPart <= (LONGLONG)MaxFileSize;
+
+	std::unique_ptr<unsigned char[]> block;
+	if (ok)
+	{
+		DWORD size = (DWORD)fileSize.QuadPart;
+		DWORD bytesRead = 0;
+		block.reset(new unsigned char[size]);
+		ok = ReadFile(file, block.get(), size, &bytesRead, 0) && bytesRead == size;
+	}
+	CloseHandle(file);
+
+	if (!ok)
+		return false;
+
+	data = std::move(block);
+	if (!Validate((size_t)fileSize.QuadPart) || Header().BytecodeHash != bytecodeHash)
+	{
+		data.reset();
+		return false;
+	}
+
+	return true;
+}
+
+// --------------------------------------------------------
+// Writes the block to a temporary file, then swaps it in,
+// so a reader never sees a half-written cache
+// --------------------------------------------------------
+bool SimpleReflection::Save(const std::wstring& path) const
+{
+	if (!data)
+		return false;
+
+	std::wstring tempPath = path + L"." + std::to_wstring(GetCurrentThreadId()) + L".tmp";
+	HANDLE file = CreateFileW(tempPath.c_str(), GENERIC_WRITE, 0, 0, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	DWORD bytesWritten = 0;
+	bool ok = WriteFile(file, data.get(), Header().TotalSize, &bytesWritten, 0) && bytesWritten == Header().TotalSize;
+	CloseHandle(file);
+
+	if (ok)
+		ok = MoveFileExW(tempPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING);
+
+	if (!ok)
+		DeleteFileW(tempPath.c_str());
+
+	return ok;
+}
+
+// --------------------------------------------------------
+// A cache file is untrusted input - make sure every count
+// and offset in it stays inside the block
+// --------------------------------------------------------
+bool SimpleReflection::Validate(size_t size) const
+{
+	const SimpleReflectionHeader& header = Header();
+	if (header.Magic != Magic || header.Version != Version || header.TotalSize != size)
+		return false;
+
+	uint64_t expectedSize =
+		sizeof(SimpleReflectionHeader) +
+		sizeof(SimpleReflectedBuffer) * (uint64_t)header.BufferCount +
+		sizeof(SimpleReflectedVariable) * (uint64_t)header.VariableCount +
+		sizeof(SimpleReflectedResource) * (uint64_t)header.ResourceCount +
+		sizeof(SimpleReflectedInput) * (uint64_t)header.InputCount +
+		header.StringBytes;
+	if (expectedSize != size)
+		return false;
+
+	// Strings must be terminated, so none can run off the end
+	if (header.StringBytes > 0 && data[size - 1] != '\0')
+		return false;
+
+	auto validName = [&](uint32_t offset) { return offset < header.StringBytes; };
+
+	for (uint32_t b = 0; b < header.BufferCount; b++)
+	{
+		const SimpleReflectedBuffer& buffer = Buffers()[b];
+		if (!validName(buffer.Name) ||
+			(uint64_t)buffer.FirstVariable + buffer.VariableCount > header.VariableCount)
+			return false;
+
+		// Variables are written straight into a buffer of this size
+		for (uint32_t v = buffer.FirstVariable; v < buffer.FirstVariable + buffer.VariableCount; v++)
+		{
+			const SimpleReflectedVariable& variable = Variables()[v];
+			if (!validName(variable.Name) ||
+				(uint64_t)variable.ByteOffset + variable.Size > buffer.Size)
+				return false;
+		}
+	}
+
+	for (uint32_t r = 0; r < header.ResourceCount; r++)
+	{
+		if (!validName(Resources()[r].Name))
+			return false;
+	}
+
+	for (uint32_t i = 0; i < header.InputCount; i++)
+	{
+		if (!validName(Inputs()[i].SemanticName))
+			return false;
+	}
+
+	return true;
+}
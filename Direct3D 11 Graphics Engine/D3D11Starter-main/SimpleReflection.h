@@ -0,0 +1,99 @@
+#pragma once
+
+#include <d3d11.h>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+// --------------------------------------------------------
+// Everything SimpleShader needs from shader reflection,
+// packed into one flat, position-independent block
+//
+//   [header][buffers][variables][resources][inputs][strings]
+//
+// - Names are byte offsets into the string block, so the
+//   block can be written to disk and read back as-is
+// - Keyed by a hash of the bytecode it was reflected from,
+//   so a cache file from an older build is never used
+// - Load() is a single read into a single allocation;
+//   Reflect() is the slow path that runs D3DReflect
+// --------------------------------------------------------
+
+struct SimpleReflectionHeader
+{
+	uint32_t Magic;
+	uint32_t Version;
+	uint64_t BytecodeHash;
+	uint32_t TotalSize;
+	uint32_t BufferCount;
+	uint32_t VariableCount;
+	uint32_t ResourceCount;
+	uint32_t InputCount;
+	uint32_t StringBytes;
+};
+
+struct SimpleReflectedBuffer
+{
+	uint32_t Name;
+	uint32_t Type;			// D3D_CBUFFER_TYPE
+	uint32_t Size;
+	uint32_t BindIndex;
+	uint32_t FirstVariable;
+	uint32_t VariableCount;
+};
+
+struct SimpleReflectedVariable
+{
+	uint32_t Name;
+	uint32_t ByteOffset;
+	uint32_t Size;
+};
+
+// Textures, structured buffers & samplers
+struct SimpleReflectedResource
+{
+	uint32_t Name;
+	uint32_t Type;			// D3D_SHADER_INPUT_TYPE
+	uint32_t BindIndex;
+};
+
+// Vertex shader inputs, already turned into input layout terms
+struct SimpleReflectedInput
+{
+	uint32_t SemanticName;
+	uint32_t SemanticIndex;
+	uint32_t Format;		// DXGI_FORMAT
+	uint32_t PerInstance;	// Semantic ends in "_PER_INSTANCE"
+};
+
+class SimpleReflection
+{
+public:
+	static constexpr uint32_t Magic = 0x4C465253; // "SRFL"
+	static constexpr uint32_t Version = 1;
+
+	// 64-bit FNV-1a of the compiled shader
+	static uint64_t HashBytecode(const void* bytecode, size_t size);
+
+	// Builds the block with D3DReflect
+	bool Reflect(const void* bytecode, size_t size);
+
+	// Reads a block saved by Save(), if it exists, is intact
+	// and was reflected from bytecode with this hash
+	bool Load(const std::wstring& path, uint64_t bytecodeHash);
+	bool Save(const std::wstring& path) const;
+
+	// Getters (only valid after Reflect() or Load() succeeded)
+	const SimpleReflectionHeader& Header() const { return *reinterpret_cast<const SimpleReflectionHeader*>(data.get()); }
+	const SimpleReflectedBuffer* Buffers() const { return reinterpret_cast<const SimpleReflectedBuffer*>(data.get() + sizeof(SimpleReflectionHeader)); }
+	const SimpleReflectedVariable* Variables() const { return reinterpret_cast<const SimpleReflectedVariable*>(Buffers() + Header().BufferCount); }
+	const SimpleReflectedResource* Resources() const { return reinterpret_cast<const SimpleReflectedResource*>(Variables() + Header().VariableCount); }
+	const SimpleReflectedInput* Inputs() const { return reinterpret_cast<const SimpleReflectedInput*>(Resources() + Header().ResourceCount); }
+	const char* String(uint32_t offset) const { return reinterpret_cast<const char*>(Inputs() + Header().InputCount) + offset; }
+
+private:
+	std::unique_ptr<unsigned char[]> data;
+
+	// Checks the counts & string offsets all stay inside size bytes
+	bool Validate(size_t size) const;
+};
@@ -1,4 +1,9 @@
 #include "SimpleShader.h"
+#include "UploadRing.h"
+#include "SimpleReflection.h"
+#include "TrackedContext.h"
+
+#include <algorithm>
 
 // Default error reporting state
 bool ISimpleShader::ReportErrors = false;
@@ -11,6 +16,15 @@ bool ISimpleShader::ReportWarnings = false;
 // ISimpleShader::ReportErrors = true;
 // ISimpleShader::ReportWarnings = true;
 
+// Shared constant buffers (none until registered)
+SimpleNameTable<Microsoft::WRL::ComPtr<ID3D11Buffer>> ISimpleShader::sharedBuffers;
+
+// Upload ring for transient data (off until set)
+UploadRing* ISimpleShader::uploadRing = 0;
+
+// Reflection cache files (see LoadShaderFile)
+bool ISimpleShader::UseReflectionCache = true;
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // ------ BASE SIMPLE SHADER --------------------------------------------------
@@ -29,6 +43,16 @@ ISimpleShader::ISimpleShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Micros
 	this->constantBufferCount = 0;
 	this->constantBuffers = 0;
 	this->shaderValid = false;
+
+	// Partial constant buffer updates need an 11.1 context AND driver support
+	// (headless devices have no context at all)
+	this->partialUpdates = false;
+	if (context && SUCCEEDED(context.As(&deviceContext1)))
+	{
+		D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+		if (SUCCEEDED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))))
+			this->partialUpdates = options.ConstantBufferPartialUpdate;
+	}
 }
 
 // --------------------------------------------------------
@@ -46,28 +70,46 @@ ISimpleShader::~ISimpleShader()
 void ISimpleShader::CleanUp()
 {
 	// Handle constant buffers and local data buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		delete[] constantBuffers[i].LocalDataBuffer;
-	}
-
 	if (constantBuffers)
 	{
 		delete[] constantBuffers;
+		constantBuffers = 0;
 		constantBufferCount = 0;
 	}
+	localData.reset();
 
-	for (unsigned int i = 0; i < shaderResourceViews.size(); i++)
-		delete shaderResourceViews[i];
-	
-	for (unsigned int i = 0; i < samplerStates.size(); i++)
-		delete samplerStates[i];
+	shaderResourceViews.clear();
+	samplerStates.clear();
 
 	// Clean up tables
 	varTable.clear();
 	cbTable.clear();
 	samplerTable.clear();
 	textureTable.clear();
+	varHashes.clear();
+	srvHashes.clear();
+	samplerHashes.clear();
+}
+
+// --------------------------------------------------------
+// Registers (or with a null buffer, removes) a constant
+// buffer shared between all shaders that declare a cbuffer
+// with this name.  Only affects shaders loaded afterwards.
+// --------------------------------------------------------
+void ISimpleShader::SetSharedConstantBuffer(std::string_view name, Microsoft::WRL::ComPtr<ID3D11Buffer> buffer)
+{
+	auto existing = sharedBuffers.find(name);
+	if (!buffer)
+	{
+		if (existing != sharedBuffers.end())
+			sharedBuffers.erase(existing);
+		return;
+	}
+
+	if (existing != sharedBuffers.end())
+		existing->second = buffer;
+	else
+		sharedBuffers.insert({ std::string(name), buffer });
 }
 
 // --------------------------------------------------------
@@ -94,99 +136,166 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 		return false;
 	}
 
+	return LoadShaderBlob(shaderBlob, shaderFile);
+}
+
+// --------------------------------------------------------
+// Builds the shader & its tables from bytecode that's
+// already in memory (loaded or compiled at run time)
+//
+// shaderFile - Where the bytecode came from, for the reflection
+//              cache & error messages.  Null skips the cache.
+// 
+// Returns true if shader is loaded properly, false otherwise
+// --------------------------------------------------------
+bool ISimpleShader::LoadShaderBlob(Microsoft::WRL::ComPtr<ID3DBlob> blob, LPCWSTR shaderFile)
+{
+	shaderBlob = blob;
+	LPCWSTR source = shaderFile ? shaderFile : L"(compiled in memory)";
+	bool useCache = UseReflectionCache && shaderFile;
+
+	// Get the reflection data, from the cache next to the shader if
+	// it was made from this exact bytecode, or else by reflecting
+	// (and then refreshing the cache for next time)
+	SimpleReflection reflection;
+	uint64_t bytecodeHash = SimpleReflection::HashBytecode(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize());
+	std::wstring cachePath = useCache ? std::wstring(shaderFile) + L".refl" : std::wstring();
+	if (!useCache || !reflection.Load(cachePath, bytecodeHash))
+	{
+		if (!reflection.Reflect(shaderBlob->GetBufferPointer(), shaderBlob->GetBufferSize()))
+		{
+			if (ReportErrors)
+			{
+				LogError("SimpleShader::LoadShaderBlob() - Error reflecting shader from '");
+				LogW(source);
+				LogError("'.\n");
+			}
+
+			return false;
+		}
+
+		if (useCache)
+			reflection.Save(cachePath);
+	}
+
 	// Create the shader - Calls an overloaded version of this abstract
 	// method in the appropriate child class
+	this->reflection = &reflection;
 	shaderValid = CreateShader(shaderBlob);
+	this->reflection = 0;
 	if (!shaderValid)
 	{
 		if (ReportErrors)
 		{
-			LogError("SimpleShader::LoadShaderFile() - Error creating shader from file '");
-			LogW(shaderFile);
+			LogError("SimpleShader::LoadShaderBlob() - Error creating shader from '");
+			LogW(source);
 			LogError("'. Ensure the type of shader (vertex, pixel, etc.) matches the SimpleShader type (SimpleVertexShader, SimplePixelShader, etc.) you're using.\n");
 		}
 
 		return false;
 	}
 
-	// Set up shader reflection to get information about
-	// this shader and its variables,  buffers, etc.
-	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)refl.GetAddressOf());
-	
-	// Get the description of the shader
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
+	const SimpleReflectionHeader& header = reflection.Header();
 
-	// Create resource arrays
-	constantBufferCount = shaderDesc.ConstantBuffers;
+	// Size everything up front, so building the tables below
+	// doesn't keep reallocating them
+	constantBufferCount = header.BufferCount;
 	constantBuffers = new SimpleConstantBuffer[constantBufferCount];
+	shaderResourceViews.reserve(header.ResourceCount);
+	samplerStates.reserve(header.ResourceCount);
+	textureTable.reserve(header.ResourceCount);
+	samplerTable.reserve(header.ResourceCount);
+	srvHashes.reserve(header.ResourceCount);
+	samplerHashes.reserve(header.ResourceCount);
+	cbTable.reserve(header.BufferCount);
+	varTable.reserve(header.VariableCount);
+	varHashes.reserve(header.VariableCount);
 	
 	// Handle bound resources (like shaders and samplers)
-	unsigned int resourceCount = shaderDesc.BoundResources;
-	for (unsigned int r = 0; r < resourceCount; r++)
+	// - Stored by value, so the tables can point into the arrays
+	for (unsigned int r = 0; r < header.ResourceCount; r++)
 	{
-		// Get this resource's description
-		D3D11_SHADER_INPUT_BIND_DESC resourceDesc;
-		refl->GetResourceBindingDesc(r, &resourceDesc);
+		const SimpleReflectedResource& resource = reflection.Resources()[r];
+		const char* name = reflection.String(resource.Name);
 
 		// Check the type
-		switch (resourceDesc.Type)
+		switch (resource.Type)
 		{
 		case D3D_SIT_STRUCTURED: // Treat structured buffers as texture resources
 		case D3D_SIT_TEXTURE: // A texture resource
 		{
 			// Create the SRV wrapper
-			SimpleSRV* srv = new SimpleSRV();
-			srv->BindIndex = resourceDesc.BindPoint;				// Shader bind point
-			srv->Index = (unsigned int)shaderResourceViews.size();	// Raw index
+			SimpleSRV srv = {};
+			srv.BindIndex = resource.BindIndex;						// Shader bind point
+			srv.Index = (unsigned int)shaderResourceViews.size();	// Raw index
 
-			textureTable.insert(std::pair<std::string, SimpleSRV*>(resourceDesc.Name, srv));
 			shaderResourceViews.push_back(srv);
+			textureTable.insert(std::pair<std::string, SimpleSRV*>(name, &shaderResourceViews.back()));
+			srvHashes.push_back({ SimpleShaderName::HashOf(name), SimpleBindHandle{ srv.BindIndex } });
 		}
 			break;
 
 		case D3D_SIT_SAMPLER: // A sampler resource
 		{
 			// Create the sampler wrapper
-			SimpleSampler* samp = new SimpleSampler();
-			samp->BindIndex = resourceDesc.BindPoint;			// Shader bind point
-			samp->Index = (unsigned int)samplerStates.size();	// Raw index
+			SimpleSampler samp = {};
+			samp.BindIndex = resource.BindIndex;				// Shader bind point
+			samp.Index = (unsigned int)samplerStates.size();	// Raw index
 
-			samplerTable.insert(std::pair<std::string, SimpleSampler*>(resourceDesc.Name, samp));
 			samplerStates.push_back(samp);
+			samplerTable.insert(std::pair<std::string, SimpleSampler*>(name, &samplerStates.back()));
+			samplerHashes.push_back({ SimpleShaderName::HashOf(name), SimpleBindHandle{ samp.BindIndex } });
 		}
 			break;
 		}
 	}
 
+	// Every local data buffer lives in one block, padded to 16-byte rows
+	// - Starts zeroed & dirty, as the GPU buffers have no initial contents
+	unsigned int localDataSize = 0;
+	for (unsigned int b = 0; b < constantBufferCount; b++)
+		localDataSize += ((reflection.Buffers()[b].Size + 15) / 16) * 16;
+	localData = std::make_unique<unsigned char[]>(localDataSize);
+	unsigned char* nextLocalData = localData.get();
+
 	// Loop through all constant buffers
 	for (unsigned int b = 0; b < constantBufferCount; b++)
 	{
-		// Get this buffer
-		ID3D11ShaderReflectionConstantBuffer* cb =
-			refl->GetConstantBufferByIndex(b);
-		
-		// Get the description of this buffer
-		D3D11_SHADER_BUFFER_DESC bufferDesc;
-		cb->GetDesc(&bufferDesc);
+		const SimpleReflectedBuffer& bufferDesc = reflection.Buffers()[b];
+		const char* bufferName = reflection.String(bufferDesc.Name);
 
 		// Save the type, which we reference when setting these buffers
-		constantBuffers[b].Type = bufferDesc.Type;
-		
-		// Get the description of the resource binding, so
-		// we know exactly how it's bound in the shader
-		D3D11_SHADER_INPUT_BIND_DESC bindDesc;
-		refl->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
+		constantBuffers[b].Type = (D3D_CBUFFER_TYPE)bufferDesc.Type;
 		
 		// Set up the buffer and put its pointer in the table
-		constantBuffers[b].BindIndex = bindDesc.BindPoint;
-		constantBuffers[b].Name = bufferDesc.Name;
-		cbTable.insert(std::pair<std::string, SimpleConstantBuffer*>(bufferDesc.Name, &constantBuffers[b]));
+		constantBuffers[b].BindIndex = bufferDesc.BindIndex;
+		constantBuffers[b].Name = bufferName;
+		cbTable.insert(std::pair<std::string, SimpleConstantBuffer*>(bufferName, &constantBuffers[b]));
+
+		// Shared buffers are bound rather than created, as long as the
+		// registered one is big enough for this shader's declaration
+		// - Their variables are left out of the tables on purpose, so
+		//   setting one through the shader is reported, not ignored
+		auto shared = sharedBuffers.find(bufferName);
+		if (shared != sharedBuffers.end() && bufferDesc.Type == D3D11_CT_CBUFFER)
+		{
+			D3D11_BUFFER_DESC sharedDesc = {};
+			shared->second->GetDesc(&sharedDesc);
+			if (sharedDesc.ByteWidth >= bufferDesc.Size)
+			{
+				constantBuffers[b].ConstantBuffer = shared->second;
+				constantBuffers[b].Size = bufferDesc.Size;
+				constantBuffers[b].Shared = true;
+				continue;
+			}
+
+			if (ReportErrors)
+			{
+				LogError("SimpleShader::LoadShaderBlob() - Shared constant buffer '");
+				Log(bufferName);
+				LogError("' is smaller than this shader's declaration of it. Creating a separate buffer instead.\n");
+			}
+		}
 
 		// Create this constant buffer
 		D3D11_BUFFER_DESC newBuffDesc = {};
@@ -200,39 +309,77 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 
 		// Set up the data buffer for this constant buffer
 		constantBuffers[b].Size = bufferDesc.Size;
-		constantBuffers[b].LocalDataBuffer = new unsigned char[bufferDesc.Size];
-		ZeroMemory(constantBuffers[b].LocalDataBuffer, bufferDesc.Size);
+		constantBuffers[b].LocalDataBuffer = nextLocalData;
+		constantBuffers[b].DirtyStart = 0;
+		constantBuffers[b].DirtyEnd = bufferDesc.Size;
+		nextLocalData += newBuffDesc.ByteWidth;
 
 		// Loop through all variables in this buffer
-		for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+		constantBuffers[b].Variables.reserve(bufferDesc.VariableCount);
+		for (unsigned int v = 0; v < bufferDesc.VariableCount; v++)
 		{
-			// Get this variable
-			ID3D11ShaderReflectionVariable* var =
-				cb->GetVariableByIndex(v);
-			
-			// Get the description of the variable and its type
-			D3D11_SHADER_VARIABLE_DESC varDesc;
-			var->GetDesc(&varDesc);
+			const SimpleReflectedVariable& varDesc = reflection.Variables()[bufferDesc.FirstVariable + v];
+			const char* varName = reflection.String(varDesc.Name);
 
 			// Create the variable struct
 			SimpleShaderVariable varStruct = {};
 			varStruct.ConstantBufferIndex = b;
-			varStruct.ByteOffset = varDesc.StartOffset;
+			varStruct.ByteOffset = varDesc.ByteOffset;
 			varStruct.Size = varDesc.Size;
-			
-			// Get a string version
-			std::string varName(varDesc.Name);
 
 			// Add this variable to the table and the constant buffer
 			varTable.insert(std::pair<std::string, SimpleShaderVariable>(varName, varStruct));
 			constantBuffers[b].Variables.push_back(varStruct);
+			varHashes.push_back({ SimpleShaderName::HashOf(varName), SimpleVariableHandle{ b, varStruct.ByteOffset, varStruct.Size } });
 		}
 	}
 
+	// Sort the hash tables for binary searching
+	SortHashTable(varHashes, "variable");
+	SortHashTable(srvHashes, "SRV");
+	SortHashTable(samplerHashes, "sampler");
+
 	// All set
 	return true;
 }
 
+// --------------------------------------------------------
+// Sorts a name hash table by hash and reports collisions
+// (two names in one shader with the same hash), in which
+// case lookups by SimpleShaderName are ambiguous
+// --------------------------------------------------------
+template<typename Handle>
+void ISimpleShader::SortHashTable(std::vector<std::pair<uint32_t, Handle>>& table, const char* kind)
+{
+	std::sort(table.begin(), table.end(),
+		[](const auto& a, const auto& b) { return a.first < b.first; });
+
+	for (size_t i = 1; i < table.size(); i++)
+	{
+		if (table[i].first == table[i - 1].first && ReportWarnings)
+		{
+			LogWarning("SimpleShader::LoadShaderBlob() - Two ");
+			Log(kind);
+			LogWarning(" names share a hash. Use the string overloads of Get*Handle() for them.\n");
+		}
+	}
+}
+
+// --------------------------------------------------------
+// Binary searches a sorted name hash table
+// --------------------------------------------------------
+template<typename Handle>
+Handle ISimpleShader::FindHash(const std::vector<std::pair<uint32_t, Handle>>& table, uint32_t hash)
+{
+	auto result = std::lower_bound(table.begin(), table.end(), hash,
+		[](const std::pair<uint32_t, Handle>& entry, uint32_t h) { return entry.first < h; });
+
+	if (result == table.end() || result->first != hash)
+		return Handle{};
+
+	return result->second;
+}
+
 // --------------------------------------------------------
 // Helper for looking up a variable by name and also
 // verifying that it is the requested size
@@ -240,10 +387,10 @@ bool ISimpleShader::LoadShaderFile(LPCWSTR shaderFile)
 // name - the name of the variable to look for
 // size - the size of the variable (for verification), or -1 to bypass
 // --------------------------------------------------------
-SimpleShaderVariable* ISimpleShader::FindVariable(std::string name, int size)
+SimpleShaderVariable* ISimpleShader::FindVariable(std::string_view name, int size)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleShaderVariable>::iterator result =
+	auto result =
 		varTable.find(name);
 
 	// Did we find the key?
@@ -264,10 +411,10 @@ SimpleShaderVariable* ISimpleShader::FindVariable(std::string name, int size)
 // --------------------------------------------------------
 // Helper for looking up a constant buffer by name
 // --------------------------------------------------------
-SimpleConstantBuffer* ISimpleShader::FindConstantBuffer(std::string name)
+SimpleConstantBuffer* ISimpleShader::FindConstantBuffer(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleConstantBuffer*>::iterator result =
+	auto result =
 		cbTable.find(name);
 
 	// Did we find the key?
@@ -345,14 +492,9 @@ void ISimpleShader::CopyAllBufferData()
 	// Ensure the shader is valid
 	if (!shaderValid) return;
 
-	// Loop through the constant buffers and copy all data
+	// Loop through the constant buffers and copy any changed data
 	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Copy the entire local data buffer
-		deviceContext->UpdateSubresource(
-			constantBuffers[i].ConstantBuffer.Get(), 0, 0,
-			constantBuffers[i].LocalDataBuffer, 0, 0);
-	}
+		UploadBuffer(constantBuffers[i]);
 }
 
 // --------------------------------------------------------
@@ -375,14 +517,8 @@ void ISimpleShader::CopyBufferData(unsigned int index)
 	if(index >= this->constantBufferCount)
 		return;
 
-	// Check for the buffer
-	SimpleConstantBuffer* cb = &this->constantBuffers[index];
-	if (!cb) return;
-
-	// Copy the data and get out
-	deviceContext->UpdateSubresource(
-		cb->ConstantBuffer.Get(), 0, 0, 
-		cb->LocalDataBuffer, 0, 0);
+	// Copy the data (if it changed) and get out
+	UploadBuffer(this->constantBuffers[index]);
 }
 
 // --------------------------------------------------------
@@ -392,7 +528,7 @@ void ISimpleShader::CopyBufferData(unsigned int index)
 //              Useful for updating more frequently-changing
 //              variables without having to re-copy all buffers.
 // --------------------------------------------------------
-void ISimpleShader::CopyBufferData(std::string bufferName)
+void ISimpleShader::CopyBufferData(std::string_view bufferName)
 {
 	// Ensure the shader is valid
 	if (!shaderValid) return;
@@ -401,10 +537,158 @@ void ISimpleShader::CopyBufferData(std::string bufferName)
 	SimpleConstantBuffer* cb = this->FindConstantBuffer(bufferName);
 	if (!cb) return;
 
-	// Copy the data and get out
-	deviceContext->UpdateSubresource(
-		cb->ConstantBuffer.Get(), 0, 0, 
-		cb->LocalDataBuffer, 0, 0);
+	// Copy the data (if it changed) and get out
+	UploadBuffer(*cb);
+}
+
+// --------------------------------------------------------
+// Copies data into a constant buffer's local copy, growing
+// the buffer's dirty range - unless the bytes are already
+// identical, in which case nothing needs uploading
+// --------------------------------------------------------
+void ISimpleShader::WriteVariable(SimpleConstantBuffer& cb, unsigned int byteOffset, const void* data, unsigned int size)
+{
+	unsigned char* dest = cb.LocalDataBuffer + byteOffset;
+	if (memcmp(dest, data, size) == 0)
+	{
+		uploadStats.UnchangedSets++;
+		return;
+	}
+
+	memcpy(dest, data, size);
+
+	if (cb.DirtyStart >= cb.DirtyEnd)
+	{
+		cb.DirtyStart = byteOffset;
+		cb.DirtyEnd = byteOffset + size;
+	}
+	else
+	{
+		if (byteOffset < cb.DirtyStart) cb.DirtyStart = byteOffset;
+		if (byteOffset + size > cb.DirtyEnd) cb.DirtyEnd = byteOffset + size;
+	}
+}
+
+// --------------------------------------------------------
+// Sends a constant buffer's dirty range to the GPU
+//
+// - Clean buffers are skipped entirely
+// - With an upload ring set, the whole buffer is copied
+//   into a fresh window of the ring & bound from there
+// - Otherwise (or if the ring is full), with partial
+//   update support only the 16-byte rows covering the
+//   dirty range are sent; otherwise the whole buffer is
+// --------------------------------------------------------
+void ISimpleShader::UploadBuffer(SimpleConstantBuffer& cb)
+{
+	// Its owner uploads it
+	if (cb.Shared)
+		return;
+
+	unsigned int width = ((cb.Size + 15) / 16) * 16;
+
+	if (uploadRing && cb.Type == D3D11_CT_CBUFFER)
+	{
+		// Clean & already in the ring this frame, so what's bound is current
+		if (cb.DirtyStart >= cb.DirtyEnd && IsInRing(cb))
+		{
+			uploadStats.UploadsSkipped++;
+			return;
+		}
+
+		if (uploadRing->Upload(cb.LocalDataBuffer, width, cb.RingFirstConstant, cb.RingNumConstants))
+		{
+			cb.RingFrame = uploadRing->CurrentFrame();
+			BindConstantBuffer(cb.BindIndex, uploadRing->GetBuffer(), cb.RingFirstConstant, cb.RingNumConstants);
+
+			uploadStats.Uploads++;
+			uploadStats.BytesSent += width;
+			cb.DirtyStart = 0;
+			cb.DirtyEnd = 0;
+			return;
+		}
+	}
+
+	// The buffer's own copy missed every ring upload, so
+	// all of it is stale - send the lot & bind it again
+	bool rebind = false;
+	if (cb.RingNumConstants > 0)
+	{
+		cb.RingNumConstants = 0;
+		cb.DirtyStart = 0;
+		cb.DirtyEnd = cb.Size;
+		rebind = true;
+	}
+
+	if (cb.DirtyStart >= cb.DirtyEnd)
+	{
+		uploadStats.UploadsSkipped++;
+		return;
+	}
+
+	unsigned int start = cb.DirtyStart & ~15u;
+	unsigned int end = ((cb.DirtyEnd + 15) / 16) * 16;
+	if (end > width) end = width;
+
+	if (partialUpdates && (start > 0 || end < width))
+	{
+		D3D11_BOX box = {};
+		box.left = start;
+		box.right = end;
+		box.bottom = 1;
+		box.back = 1;
+		deviceContext1->UpdateSubresource1(
+			cb.ConstantBuffer.Get(), 0, &box,
+			cb.LocalDataBuffer + start, 0, 0, 0);
+
+		uploadStats.PartialUploads++;
+		uploadStats.BytesSent += end - start;
+	}
+	else
+	{
+		deviceContext->UpdateSubresource(
+			cb.ConstantBuffer.Get(), 0, 0,
+			cb.LocalDataBuffer, 0, 0);
+
+		uploadStats.BytesSent += width;
+	}
+
+	uploadStats.Uploads++;
+	cb.DirtyStart = 0;
+	cb.DirtyEnd = 0;
+
+	if (rebind)
+		BindConstantBuffer(cb.BindIndex, cb.ConstantBuffer.Get(), 0, 0);
+}
+
+// --------------------------------------------------------
+// Binds every true constant buffer to this shader's stage,
+// from the upload ring if its data is there this frame
+// --------------------------------------------------------
+void ISimpleShader::BindConstantBuffers()
+{
+	for (unsigned int i = 0; i < constantBufferCount; i++)
+	{
+		SimpleConstantBuffer& cb = constantBuffers[i];
+
+		// Skip "buffers" that aren't true constant buffers
+		if (cb.Type != D3D11_CT_CBUFFER)
+			continue;
+
+		if (IsInRing(cb))
+			BindConstantBuffer(cb.BindIndex, uploadRing->GetBuffer(), cb.RingFirstConstant, cb.RingNumConstants);
+		else
+			BindConstantBuffer(cb.BindIndex, cb.ConstantBuffer.Get(), 0, 0);
+	}
+}
+
+// --------------------------------------------------------
+// Whether a buffer's data is in a ring window that can't
+// have been reclaimed (i.e. it was uploaded this frame)
+// --------------------------------------------------------
+bool ISimpleShader::IsInRing(const SimpleConstantBuffer& cb)
+{
+	return uploadRing && cb.RingNumConstants > 0 && cb.RingFrame == uploadRing->CurrentFrame();
 }
 
 
@@ -417,7 +701,7 @@ void ISimpleShader::CopyBufferData(std::string bufferName)
 //
 // Returns true if data is copied, false if variable doesn't exist
 // --------------------------------------------------------
-bool ISimpleShader::SetData(std::string name, const void* data, unsigned int size)
+bool ISimpleShader::SetData(std::string_view name, const void* data, unsigned int size)
 {
 	// Look for the variable and verify
 	SimpleShaderVariable* var = FindVariable(name, -1);
@@ -426,7 +710,7 @@ bool ISimpleShader::SetData(std::string name, const void* data, unsigned int siz
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleShader::SetData() - Shader variable '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' not found. Ensure the name is spelled correctly and that it exists in a constant buffer in the shader.\n");
 		}
 		return false;
@@ -439,17 +723,14 @@ bool ISimpleShader::SetData(std::string name, const void* data, unsigned int siz
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleShader::SetData() - Shader variable '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' is smaller than the size of the data being set. Ensure the variable is large enough for the specified data.\n");
 		}
 		return false;
 	}
 
 	// Set the data in the local data buffer
-	memcpy(
-		constantBuffers[var->ConstantBufferIndex].LocalDataBuffer + var->ByteOffset,
-		data,
-		size);
+	WriteVariable(constantBuffers[var->ConstantBufferIndex], var->ByteOffset, data, size);
 
 	// Success
 	return true;
@@ -458,7 +739,7 @@ bool ISimpleShader::SetData(std::string name, const void* data, unsigned int siz
 // --------------------------------------------------------
 // Sets INTEGER data
 // --------------------------------------------------------
-bool ISimpleShader::SetInt(std::string name, int data)
+bool ISimpleShader::SetInt(std::string_view name, int data)
 {
 	return this->SetData(name, (void*)(&data), sizeof(int));
 }
@@ -466,7 +747,7 @@ bool ISimpleShader::SetInt(std::string name, int data)
 // --------------------------------------------------------
 // Sets a FLOAT variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat(std::string name, float data)
+bool ISimpleShader::SetFloat(std::string_view name, float data)
 {
 	return this->SetData(name, (void*)(&data), sizeof(float));
 }
@@ -474,7 +755,7 @@ bool ISimpleShader::SetFloat(std::string name, float data)
 // --------------------------------------------------------
 // Sets a FLOAT2 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat2(std::string name, const float data[2])
+bool ISimpleShader::SetFloat2(std::string_view name, const float data[2])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 2);
 }
@@ -482,7 +763,7 @@ bool ISimpleShader::SetFloat2(std::string name, const float data[2])
 // --------------------------------------------------------
 // Sets a FLOAT2 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat2(std::string name, const DirectX::XMFLOAT2 data)
+bool ISimpleShader::SetFloat2(std::string_view name, const DirectX::XMFLOAT2 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 2);
 }
@@ -490,7 +771,7 @@ bool ISimpleShader::SetFloat2(std::string name, const DirectX::XMFLOAT2 data)
 // --------------------------------------------------------
 // Sets a FLOAT3 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat3(std::string name, const float data[3])
+bool ISimpleShader::SetFloat3(std::string_view name, const float data[3])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 3);
 }
@@ -498,7 +779,7 @@ bool ISimpleShader::SetFloat3(std::string name, const float data[3])
 // --------------------------------------------------------
 // Sets a FLOAT3 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat3(std::string name, const DirectX::XMFLOAT3 data)
+bool ISimpleShader::SetFloat3(std::string_view name, const DirectX::XMFLOAT3 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 3);
 }
@@ -506,7 +787,7 @@ bool ISimpleShader::SetFloat3(std::string name, const DirectX::XMFLOAT3 data)
 // --------------------------------------------------------
 // Sets a FLOAT4 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat4(std::string name, const float data[4])
+bool ISimpleShader::SetFloat4(std::string_view name, const float data[4])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 4);
 }
@@ -514,7 +795,7 @@ bool ISimpleShader::SetFloat4(std::string name, const float data[4])
 // --------------------------------------------------------
 // Sets a FLOAT4 variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetFloat4(std::string name, const DirectX::XMFLOAT4 data)
+bool ISimpleShader::SetFloat4(std::string_view name, const DirectX::XMFLOAT4 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 4);
 }
@@ -522,7 +803,7 @@ bool ISimpleShader::SetFloat4(std::string name, const DirectX::XMFLOAT4 data)
 // --------------------------------------------------------
 // Sets a MATRIX (4x4) variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetMatrix4x4(std::string name, const float data[16])
+bool ISimpleShader::SetMatrix4x4(std::string_view name, const float data[16])
 {
 	return this->SetData(name, (void*)data, sizeof(float) * 16);
 }
@@ -530,16 +811,117 @@ bool ISimpleShader::SetMatrix4x4(std::string name, const float data[16])
 // --------------------------------------------------------
 // Sets a MATRIX (4x4) variable by name in the local data buffer
 // --------------------------------------------------------
-bool ISimpleShader::SetMatrix4x4(std::string name, const DirectX::XMFLOAT4X4 data)
+bool ISimpleShader::SetMatrix4x4(std::string_view name, const DirectX::XMFLOAT4X4 data)
 {
 	return this->SetData(name, &data, sizeof(float) * 16);
 }
 
+// --------------------------------------------------------
+// Resolves a variable name to a handle (invalid if the
+// variable doesn't exist in this shader)
+// --------------------------------------------------------
+SimpleVariableHandle ISimpleShader::GetVariableHandle(std::string_view name)
+{
+	SimpleShaderVariable* var = FindVariable(name, -1);
+	if (var == 0)
+		return SimpleVariableHandle{};
+
+	return SimpleVariableHandle{ var->ConstantBufferIndex, var->ByteOffset, var->Size };
+}
+
+SimpleVariableHandle ISimpleShader::GetVariableHandle(SimpleShaderName name)
+{
+	return FindHash(varHashes, name.Hash);
+}
+
+// --------------------------------------------------------
+// Resolves an SRV or sampler name to its register
+// --------------------------------------------------------
+SimpleBindHandle ISimpleShader::GetShaderResourceViewHandle(std::string_view name)
+{
+	const SimpleSRV* srv = GetShaderResourceViewInfo(name);
+	return srv ? SimpleBindHandle{ srv->BindIndex } : SimpleBindHandle{};
+}
+
+SimpleBindHandle ISimpleShader::GetShaderResourceViewHandle(SimpleShaderName name)
+{
+	return FindHash(srvHashes, name.Hash);
+}
+
+SimpleBindHandle ISimpleShader::GetSamplerHandle(std::string_view name)
+{
+	const SimpleSampler* samp = GetSamplerInfo(name);
+	return samp ? SimpleBindHandle{ samp->BindIndex } : SimpleBindHandle{};
+}
+
+SimpleBindHandle ISimpleShader::GetSamplerHandle(SimpleShaderName name)
+{
+	return FindHash(samplerHashes, name.Hash);
+}
+
+// --------------------------------------------------------
+// Sets data through a pre-resolved handle
+//
+// No lookup - just checks that the write stays inside both
+// the variable and its constant buffer, then writes
+// --------------------------------------------------------
+bool ISimpleShader::SetData(SimpleVariableHandle handle, const void* data, unsigned int size)
+{
+	if (!handle.IsValid() ||
+		handle.ConstantBufferIndex >= constantBufferCount ||
+		size > handle.Size ||
+		handle.ByteOffset + size > constantBuffers[handle.ConstantBufferIndex].Size)
+		return false;
+
+	WriteVariable(constantBuffers[handle.ConstantBufferIndex], handle.ByteOffset, data, size);
+	return true;
+}
+
+bool ISimpleShader::SetInt(SimpleVariableHandle handle, int data) { return SetData(handle, &data, sizeof(int)); }
+bool ISimpleShader::SetFloat(SimpleVariableHandle handle, float data) { return SetData(handle, &data, sizeof(float)); }
+bool ISimpleShader::SetFloat2(SimpleVariableHandle handle, const DirectX::XMFLOAT2 data) { return SetData(handle, &data, sizeof(float) * 2); }
+bool ISimpleShader::SetFloat3(SimpleVariableHandle handle, const DirectX::XMFLOAT3 data) { return SetData(handle, &data, sizeof(float) * 3); }
+bool ISimpleShader::SetFloat4(SimpleVariableHandle handle, const DirectX::XMFLOAT4 data) { return SetData(handle, &data, sizeof(float) * 4); }
+bool ISimpleShader::SetMatrix4x4(SimpleVariableHandle handle, const DirectX::XMFLOAT4X4& data) { return SetData(handle, &data, sizeof(float) * 16); }
+
+// --------------------------------------------------------
+// Sets a whole constant buffer in one write
+//
+// The buffer is found by register (a shader only has a few),
+// and must be exactly size bytes, so a struct from an older
+// build of the shader is refused rather than misread
+// --------------------------------------------------------
+bool ISimpleShader::SetBufferData(unsigned int bindIndex, const void* data, unsigned int size)
+{
+	for (unsigned int i = 0; i < constantBufferCount; i++)
+	{
+		SimpleConstantBuffer& cb = constantBuffers[i];
+		if (cb.BindIndex != bindIndex)
+			continue;
+
+		if (cb.Shared || cb.Size != size)
+		{
+			if (ReportErrors)
+			{
+				LogError("SimpleShader::SetBufferData() - Constant buffer '");
+				Log(cb.Name);
+				LogError("' doesn't match the data being set.\n");
+			}
+			return false;
+		}
+
+		WriteVariable(cb, 0, data, size);
+		return true;
+	}
+
+	return false;
+}
+
 // --------------------------------------------------------
 // Determines if the shader contains the specified
 // variable within one of its constant buffers
 // --------------------------------------------------------
-bool ISimpleShader::HasVariable(std::string name)
+bool ISimpleShader::HasVariable(std::string_view name)
 {
 	return FindVariable(name, -1) != 0;
 }
@@ -547,7 +929,7 @@ bool ISimpleShader::HasVariable(std::string name)
 // --------------------------------------------------------
 // Determines if the shader contains the specified SRV
 // --------------------------------------------------------
-bool ISimpleShader::HasShaderResourceView(std::string name)
+bool ISimpleShader::HasShaderResourceView(std::string_view name)
 {
 	return GetShaderResourceViewInfo(name) != 0;
 }
@@ -555,7 +937,7 @@ bool ISimpleShader::HasShaderResourceView(std::string name)
 // --------------------------------------------------------
 // Determines if the shader contains the specified sampler
 // --------------------------------------------------------
-bool ISimpleShader::HasSamplerState(std::string name)
+bool ISimpleShader::HasSamplerState(std::string_view name)
 {
 	return GetSamplerInfo(name) != 0;
 }
@@ -563,7 +945,7 @@ bool ISimpleShader::HasSamplerState(std::string name)
 // --------------------------------------------------------
 // Gets info about a shader variable, if it exists
 // --------------------------------------------------------
-const SimpleShaderVariable* ISimpleShader::GetVariableInfo(std::string name)
+const SimpleShaderVariable* ISimpleShader::GetVariableInfo(std::string_view name)
 {
 	return FindVariable(name, -1);
 }
@@ -573,10 +955,10 @@ const SimpleShaderVariable* ISimpleShader::GetVariableInfo(std::string name)
 //
 // name - the name of the SRV
 // --------------------------------------------------------
-const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(std::string name)
+const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleSRV*>::iterator result =
+	auto result =
 		textureTable.find(name);
 
 	// Did we find the key?
@@ -599,7 +981,7 @@ const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(unsigned int index)
 	if (index >= shaderResourceViews.size()) return 0;
 
 	// Grab the bind index
-	return shaderResourceViews[index];
+	return &shaderResourceViews[index];
 }
 
 
@@ -608,10 +990,10 @@ const SimpleSRV* ISimpleShader::GetShaderResourceViewInfo(unsigned int index)
 // 
 // name - the name of the sampler
 // --------------------------------------------------------
-const SimpleSampler* ISimpleShader::GetSamplerInfo(std::string name)
+const SimpleSampler* ISimpleShader::GetSamplerInfo(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, SimpleSampler*>::iterator result =
+	auto result =
 		samplerTable.find(name);
 
 	// Did we find the key?
@@ -633,7 +1015,7 @@ const SimpleSampler* ISimpleShader::GetSamplerInfo(unsigned int index)
 	if (index >= samplerStates.size()) return 0;
 
 	// Grab the bind index
-	return samplerStates[index];
+	return &samplerStates[index];
 }
 
 
@@ -661,7 +1043,7 @@ unsigned int ISimpleShader::GetBufferSize(unsigned int index)
 // Gets info about a particular constant buffer 
 // by name, if it exists
 // --------------------------------------------------------
-const SimpleConstantBuffer * ISimpleShader::GetBufferInfo(std::string name)
+const SimpleConstantBuffer * ISimpleShader::GetBufferInfo(std::string_view name)
 {
 	return FindConstantBuffer(name);
 }
@@ -721,6 +1103,16 @@ SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> devi
 	this->LoadShaderFile(shaderFile);
 }
 
+// --------------------------------------------------------
+// Constructor overload for bytecode compiled at run time
+// --------------------------------------------------------
+SimpleVertexShader::SimpleVertexShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob)
+	: ISimpleShader(device, context)
+{
+	this->perInstanceCompatible = false;
+	this->LoadShaderBlob(shaderBlob, 0);
+}
+
 // --------------------------------------------------------
 // Destructor - Clean up actual shader (base will be called automatically)
 // --------------------------------------------------------
@@ -767,48 +1159,31 @@ bool SimpleVertexShader::CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlo
 		return true;
 
 	// Vertex shader was created successfully, so we now use the
-	// shader code to re-reflect and create an input layout that 
-	// matches what the vertex shader expects.  Code adapted from:
+	// reflected inputs to create an input layout that matches
+	// what the vertex shader expects.  Code adapted from:
 	// https://takinginitiative.wordpress.com/2011/12/11/directx-1011-basic-shader-reflection-automatic-input-layout-creation/
+	// - Formats & "_PER_INSTANCE" semantics are resolved by SimpleReflection
+	if (!reflection || reflection->Header().InputCount == 0)
+		return true;
 
-	// Reflect shader info
-	Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
-	D3DReflect(
-		shaderBlob->GetBufferPointer(),
-		shaderBlob->GetBufferSize(),
-		IID_ID3D11ShaderReflection,
-		(void**)refl.GetAddressOf());
-	
-	// Get shader info
-	D3D11_SHADER_DESC shaderDesc;
-	refl->GetDesc(&shaderDesc);
-
-	// Read input layout description from shader info
 	std::vector<D3D11_INPUT_ELEMENT_DESC> inputLayoutDesc;
-	for (unsigned int i = 0; i< shaderDesc.InputParameters; i++)
+	inputLayoutDesc.reserve(reflection->Header().InputCount);
+	for (unsigned int i = 0; i < reflection->Header().InputCount; i++)
 	{
-		D3D11_SIGNATURE_PARAMETER_DESC paramDesc;
-		refl->GetInputParameterDesc(i, &paramDesc);
-
-		// Check the semantic name for "_PER_INSTANCE"
-		std::string perInstanceStr = "_PER_INSTANCE";
-		std::string sem = paramDesc.SemanticName;
-		int lenDiff = (int)sem.size() - (int)perInstanceStr.size();
-		bool isPerInstance = 
-			lenDiff >= 0 &&
-			sem.compare(lenDiff, perInstanceStr.size(), perInstanceStr) == 0;
+		const SimpleReflectedInput& input = reflection->Inputs()[i];
 
 		// Fill out input element desc
 		D3D11_INPUT_ELEMENT_DESC elementDesc = {};
-		elementDesc.SemanticName = paramDesc.SemanticName;
-		elementDesc.SemanticIndex = paramDesc.SemanticIndex;
+		elementDesc.SemanticName = reflection->String(input.SemanticName);
+		elementDesc.SemanticIndex = input.SemanticIndex;
+		elementDesc.Format = (DXGI_FORMAT)input.Format;
 		elementDesc.InputSlot = 0;
 		elementDesc.AlignedByteOffset = D3D11_APPEND_ALIGNED_ELEMENT;
 		elementDesc.InputSlotClass = D3D11_INPUT_PER_VERTEX_DATA;
 		elementDesc.InstanceDataStepRate = 0;
 
 		// Replace anything affected by "per instance" data
-		if (isPerInstance)
+		if (input.PerInstance)
 		{
 			elementDesc.InputSlot = 1; // Assume per instance data comes from another input slot!
 			elementDesc.InputSlotClass = D3D11_INPUT_PER_INSTANCE_DATA;
@@ -817,32 +1192,6 @@ bool SimpleVertexShader::CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlo
 			perInstanceCompatible = true;
 		}
 
-		// Determine DXGI format
-		if (paramDesc.Mask == 1)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32_FLOAT;
-		}
-		else if (paramDesc.Mask <= 3)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32G32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32G32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32G32_FLOAT;
-		}
-		else if (paramDesc.Mask <= 7)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32G32B32_FLOAT;
-		}
-		else if (paramDesc.Mask <= 15)
-		{
-			if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_UINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32A32_UINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_SINT32) elementDesc.Format = DXGI_FORMAT_R32G32B32A32_SINT;
-			else if (paramDesc.ComponentType == D3D_REGISTER_COMPONENT_FLOAT32) elementDesc.Format = DXGI_FORMAT_R32G32B32A32_FLOAT;
-		}
-
 		// Save element desc
 		inputLayoutDesc.push_back(elementDesc);
 	}
@@ -869,22 +1218,33 @@ void SimpleVertexShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 
 	// Set the shader and input layout
-	deviceContext->IASetInputLayout(inputLayout.Get());
-	deviceContext->VSSetShader(shader.Get(), 0, 0);
+	if (TrackedContext::Tracks(deviceContext.Get()))
+	{
+		TrackedContext::SetInputLayout(inputLayout.Get());
+		TrackedContext::SetVertexShader(shader.Get());
+	}
+	else
+	{
+		deviceContext->IASetInputLayout(inputLayout.Get());
+		deviceContext->VSSetShader(shader.Get(), 0, 0);
+	}
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
+	BindConstantBuffers();
+}
 
-		// This is a real constant buffer, so set it
-		deviceContext->VSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+// --------------------------------------------------------
+// Binds a constant buffer to the vertex shader stage
+// - A non-zero numConstants binds just that window of it
+// --------------------------------------------------------
+void SimpleVertexShader::BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetConstantBuffer(TrackedContext::Vertex, slot, buffer, firstConstant, numConstants);
+	else if (numConstants > 0)
+		deviceContext1->VSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	else
+		deviceContext->VSSetConstantBuffers(slot, 1, &buffer);
 }
 
 // --------------------------------------------------------
@@ -895,7 +1255,7 @@ void SimpleVertexShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleVertexShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleVertexShader::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -904,14 +1264,17 @@ bool SimpleVertexShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleVertexShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->VSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetShaderResources(TrackedContext::Vertex, srvInfo->BindIndex, 1, &srv);
+	else
+		deviceContext->VSSetShaderResources(srvInfo->BindIndex, 1, &srv);
 
 	// Success
 	return true;
@@ -925,7 +1288,7 @@ bool SimpleVertexShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleVertexShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleVertexShader::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -934,19 +1297,50 @@ bool SimpleVertexShader::SetSamplerState(std::string name, Microsoft::WRL::ComPt
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleVertexShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->VSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetSamplers(TrackedContext::Vertex, sampInfo->BindIndex, 1, &samplerState);
+	else
+		deviceContext->VSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Sets a shader resource view / sampler state in the
+// vertex shader stage through pre-resolved handles
+// --------------------------------------------------------
+bool SimpleVertexShader::SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (!handle.IsValid())
+		return false;
+
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetShaderResources(TrackedContext::Vertex, handle.BindIndex, 1, &srv);
+	else
+		deviceContext->VSSetShaderResources(handle.BindIndex, 1, &srv);
+	return true;
+}
+
+bool SimpleVertexShader::SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (!handle.IsValid())
+		return false;
+
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetSamplers(TrackedContext::Vertex, handle.BindIndex, 1, &samplerState);
+	else
+		deviceContext->VSSetSamplers(handle.BindIndex, 1, &samplerState);
+	return true;
+}
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // ------ SIMPLE PIXEL SHADER -------------------------------------------------
@@ -962,6 +1356,15 @@ SimplePixelShader::SimplePixelShader(Microsoft::WRL::ComPtr<ID3D11Device> device
 	this->LoadShaderFile(shaderFile);
 }
 
+// --------------------------------------------------------
+// Constructor overload for bytecode compiled at run time
+// --------------------------------------------------------
+SimplePixelShader::SimplePixelShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob)
+	: ISimpleShader(device, context)
+{
+	this->LoadShaderBlob(shaderBlob, 0);
+}
+
 // --------------------------------------------------------
 // Destructor - Clean up actual shader (base will be called automatically)
 // --------------------------------------------------------
@@ -1012,21 +1415,27 @@ void SimplePixelShader::SetShaderAndCBs()
 	if (!shaderValid) return;
 	
 	// Set the shader
-	deviceContext->PSSetShader(shader.Get(), 0, 0);
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetPixelShader(shader.Get());
+	else
+		deviceContext->PSSetShader(shader.Get(), 0, 0);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
+	BindConstantBuffers();
+}
 
-		// This is a real constant buffer, so set it
-		deviceContext->PSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+// --------------------------------------------------------
+// Binds a constant buffer to the pixel shader stage
+// - A non-zero numConstants binds just that window of it
+// --------------------------------------------------------
+void SimplePixelShader::BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetConstantBuffer(TrackedContext::Pixel, slot, buffer, firstConstant, numConstants);
+	else if (numConstants > 0)
+		deviceContext1->PSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	else
+		deviceContext->PSSetConstantBuffers(slot, 1, &buffer);
 }
 
 // --------------------------------------------------------
@@ -1037,7 +1446,7 @@ void SimplePixelShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimplePixelShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimplePixelShader::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1046,14 +1455,17 @@ bool SimplePixelShader::SetShaderResourceView(std::string name, Microsoft::WRL::
 		if (ReportWarnings)
 		{
 			LogWarning("SimplePixelShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->PSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetShaderResources(TrackedContext::Pixel, srvInfo->BindIndex, 1, &srv);
+	else
+		deviceContext->PSSetShaderResources(srvInfo->BindIndex, 1, &srv);
 
 	// Success
 	return true;
@@ -1067,7 +1479,7 @@ bool SimplePixelShader::SetShaderResourceView(std::string name, Microsoft::WRL::
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimplePixelShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimplePixelShader::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1076,19 +1488,50 @@ bool SimplePixelShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr
 		if (ReportWarnings)
 		{
 			LogWarning("SimplePixelShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->PSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetSamplers(TrackedContext::Pixel, sampInfo->BindIndex, 1, &samplerState);
+	else
+		deviceContext->PSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Sets a shader resource view / sampler state in the
+// pixel shader stage through pre-resolved handles
+// --------------------------------------------------------
+bool SimplePixelShader::SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (!handle.IsValid())
+		return false;
+
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetShaderResources(TrackedContext::Pixel, handle.BindIndex, 1, &srv);
+	else
+		deviceContext->PSSetShaderResources(handle.BindIndex, 1, &srv);
+	return true;
+}
+
+bool SimplePixelShader::SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (!handle.IsValid())
+		return false;
+
+	if (TrackedContext::Tracks(deviceContext.Get()))
+		TrackedContext::SetSamplers(TrackedContext::Pixel, handle.BindIndex, 1, &samplerState);
+	else
+		deviceContext->PSSetSamplers(handle.BindIndex, 1, &samplerState);
+	return true;
+}
+
 
 
 
@@ -1159,18 +1602,19 @@ void SimpleDomainShader::SetShaderAndCBs()
 	deviceContext->DSSetShader(shader.Get(), 0, 0);
 
 	// Set the constant buffers
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
+	BindConstantBuffers();
+}
 
-		// This is a real constant buffer, so set it
-		deviceContext->DSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+// --------------------------------------------------------
+// Binds a constant buffer to the domain shader stage
+// - A non-zero numConstants binds just that window of it
+// --------------------------------------------------------
+void SimpleDomainShader::BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (numConstants > 0)
+		deviceContext1->DSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	else
+		deviceContext->DSSetConstantBuffers(slot, 1, &buffer);
 }
 
 // --------------------------------------------------------
@@ -1181,7 +1625,7 @@ void SimpleDomainShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleDomainShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleDomainShader::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1190,14 +1634,14 @@ bool SimpleDomainShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleDomainShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->DSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	deviceContext->DSSetShaderResources(srvInfo->BindIndex, 1, &srv);
 
 	// Success
 	return true;
@@ -1211,7 +1655,7 @@ bool SimpleDomainShader::SetShaderResourceView(std::string name, Microsoft::WRL:
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleDomainShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleDomainShader::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1220,19 +1664,41 @@ bool SimpleDomainShader::SetSamplerState(std::string name, Microsoft::WRL::ComPt
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleDomainShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->DSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	deviceContext->DSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Sets a shader resource view / sampler state in the
+// domain shader stage through pre-resolved handles
+// --------------------------------------------------------
+bool SimpleDomainShader::SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->DSSetShaderResources(handle.BindIndex, 1, &srv);
+	return true;
+}
+
+bool SimpleDomainShader::SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->DSSetSamplers(handle.BindIndex, 1, &samplerState);
+	return true;
+}
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1301,19 +1767,20 @@ void SimpleHullShader::SetShaderAndCBs()
 	// Set the shader
 	deviceContext->HSSetShader(shader.Get(), 0, 0);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
+	// Set the constant buffers
+	BindConstantBuffers();
+}
 
-		// This is a real constant buffer, so set it
-		deviceContext->HSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+// --------------------------------------------------------
+// Binds a constant buffer to the hull shader stage
+// - A non-zero numConstants binds just that window of it
+// --------------------------------------------------------
+void SimpleHullShader::BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (numConstants > 0)
+		deviceContext1->HSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	else
+		deviceContext->HSSetConstantBuffers(slot, 1, &buffer);
 }
 
 // --------------------------------------------------------
@@ -1324,7 +1791,7 @@ void SimpleHullShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleHullShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleHullShader::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1333,14 +1800,14 @@ bool SimpleHullShader::SetShaderResourceView(std::string name, Microsoft::WRL::C
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleHullShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->HSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	deviceContext->HSSetShaderResources(srvInfo->BindIndex, 1, &srv);
 
 	// Success
 	return true;
@@ -1354,7 +1821,7 @@ bool SimpleHullShader::SetShaderResourceView(std::string name, Microsoft::WRL::C
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleHullShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleHullShader::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1363,19 +1830,41 @@ bool SimpleHullShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleHullShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->HSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	deviceContext->HSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Sets a shader resource view / sampler state in the
+// hull shader stage through pre-resolved handles
+// --------------------------------------------------------
+bool SimpleHullShader::SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->HSSetShaderResources(handle.BindIndex, 1, &srv);
+	return true;
+}
+
+bool SimpleHullShader::SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->HSSetSamplers(handle.BindIndex, 1, &samplerState);
+	return true;
+}
+
 
 
 
@@ -1575,19 +2064,20 @@ void SimpleGeometryShader::SetShaderAndCBs()
 	// Set the shader
 	deviceContext->GSSetShader(shader.Get(), 0, 0);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
+	// Set the constant buffers
+	BindConstantBuffers();
+}
 
-		// This is a real constant buffer, so set it
-		deviceContext->GSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+// --------------------------------------------------------
+// Binds a constant buffer to the geometry shader stage
+// - A non-zero numConstants binds just that window of it
+// --------------------------------------------------------
+void SimpleGeometryShader::BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (numConstants > 0)
+		deviceContext1->GSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	else
+		deviceContext->GSSetConstantBuffers(slot, 1, &buffer);
 }
 
 // --------------------------------------------------------
@@ -1598,7 +2088,7 @@ void SimpleGeometryShader::SetShaderAndCBs()
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleGeometryShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleGeometryShader::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1607,14 +2097,14 @@ bool SimpleGeometryShader::SetShaderResourceView(std::string name, Microsoft::WR
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleGeometryShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->GSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	deviceContext->GSSetShaderResources(srvInfo->BindIndex, 1, &srv);
 
 	// Success
 	return true;
@@ -1628,7 +2118,7 @@ bool SimpleGeometryShader::SetShaderResourceView(std::string name, Microsoft::WR
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleGeometryShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleGeometryShader::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1637,19 +2127,41 @@ bool SimpleGeometryShader::SetSamplerState(std::string name, Microsoft::WRL::Com
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleGeometryShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->GSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	deviceContext->GSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Sets a shader resource view / sampler state in the
+// geometry shader stage through pre-resolved handles
+// --------------------------------------------------------
+bool SimpleGeometryShader::SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->GSSetShaderResources(handle.BindIndex, 1, &srv);
+	return true;
+}
+
+bool SimpleGeometryShader::SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->GSSetSamplers(handle.BindIndex, 1, &samplerState);
+	return true;
+}
+
 // --------------------------------------------------------
 // Calculates the number of components specified by a parameter description mask
 //
@@ -1785,19 +2297,20 @@ void SimpleComputeShader::SetShaderAndCBs()
 	// Set the shader
 	deviceContext->CSSetShader(shader.Get(), 0, 0);
 
-	// Set the constant buffers?
-	for (unsigned int i = 0; i < constantBufferCount; i++)
-	{
-		// Skip "buffers" that aren't true constant buffers
-		if (constantBuffers[i].Type != D3D11_CT_CBUFFER)
-			continue;
+	// Set the constant buffers
+	BindConstantBuffers();
+}
 
-		// This is a real constant buffer, so set it
-		deviceContext->CSSetConstantBuffers(
-			constantBuffers[i].BindIndex,
-			1,
-			constantBuffers[i].ConstantBuffer.GetAddressOf());
-	}
+// --------------------------------------------------------
+// Binds a constant buffer to the compute shader stage
+// - A non-zero numConstants binds just that window of it
+// --------------------------------------------------------
+void SimpleComputeShader::BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (numConstants > 0)
+		deviceContext1->CSSetConstantBuffers1(slot, 1, &buffer, &firstConstant, &numConstants);
+	else
+		deviceContext->CSSetConstantBuffers(slot, 1, &buffer);
 }
 
 // --------------------------------------------------------
@@ -1856,7 +2369,7 @@ void SimpleComputeShader::DispatchByThreads(unsigned int threadsX, unsigned int
 // --------------------------------------------------------
 // Determines if this shader has the specified UAV
 // --------------------------------------------------------
-bool SimpleComputeShader::HasUnorderedAccessView(std::string name)
+bool SimpleComputeShader::HasUnorderedAccessView(std::string_view name)
 {
 	return GetUnorderedAccessViewIndex(name) != -1;
 }
@@ -1869,7 +2382,7 @@ bool SimpleComputeShader::HasUnorderedAccessView(std::string name)
 //
 // Returns true if a texture of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv)
+bool SimpleComputeShader::SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv)
 {
 	// Look for the variable and verify
 	const SimpleSRV* srvInfo = GetShaderResourceViewInfo(name);
@@ -1878,14 +2391,14 @@ bool SimpleComputeShader::SetShaderResourceView(std::string name, Microsoft::WRL
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleComputeShader::SetShaderResourceView() - SRV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->CSSetShaderResources(srvInfo->BindIndex, 1, srv.GetAddressOf());
+	deviceContext->CSSetShaderResources(srvInfo->BindIndex, 1, &srv);
 
 	// Success
 	return true;
@@ -1899,7 +2412,7 @@ bool SimpleComputeShader::SetShaderResourceView(std::string name, Microsoft::WRL
 //
 // Returns true if a sampler of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState)
+bool SimpleComputeShader::SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState)
 {
 	// Look for the variable and verify
 	const SimpleSampler* sampInfo = GetSamplerInfo(name);
@@ -1908,19 +2421,41 @@ bool SimpleComputeShader::SetSamplerState(std::string name, Microsoft::WRL::ComP
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleComputeShader::SetSamplerState() - Sampler named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
 	}
 
 	// Set the shader resource view
-	deviceContext->CSSetSamplers(sampInfo->BindIndex, 1, samplerState.GetAddressOf());
+	deviceContext->CSSetSamplers(sampInfo->BindIndex, 1, &samplerState);
 
 	// Success
 	return true;
 }
 
+// --------------------------------------------------------
+// Sets a shader resource view / sampler state in the
+// Compute shader stage through pre-resolved handles
+// --------------------------------------------------------
+bool SimpleComputeShader::SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->CSSetShaderResources(handle.BindIndex, 1, &srv);
+	return true;
+}
+
+bool SimpleComputeShader::SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState)
+{
+	if (!handle.IsValid())
+		return false;
+
+	deviceContext->CSSetSamplers(handle.BindIndex, 1, &samplerState);
+	return true;
+}
+
 // --------------------------------------------------------
 // Sets an unordered access view in the Compute shader stage
 //
@@ -1930,7 +2465,7 @@ bool SimpleComputeShader::SetSamplerState(std::string name, Microsoft::WRL::ComP
 //
 // Returns true if a UAV of the given name was found, false otherwise
 // --------------------------------------------------------
-bool SimpleComputeShader::SetUnorderedAccessView(std::string name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset)
+bool SimpleComputeShader::SetUnorderedAccessView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset)
 {
 	// Look for the variable and verify
 	unsigned int bindIndex = GetUnorderedAccessViewIndex(name);
@@ -1939,7 +2474,7 @@ bool SimpleComputeShader::SetUnorderedAccessView(std::string name, Microsoft::WR
 		if (ReportWarnings)
 		{
 			LogWarning("SimpleComputeShader::SetUnorderedAccessView() - UAV named '");
-			Log(name);
+			Log(std::string(name));
 			LogWarning("' was not found in the shader. Ensure the name is spelled correctly and that it exists in the shader.\n");
 		}
 		return false;
@@ -1955,10 +2490,10 @@ bool SimpleComputeShader::SetUnorderedAccessView(std::string name, Microsoft::WR
 // --------------------------------------------------------
 // Gets the index of the specified UAV (or -1)
 // --------------------------------------------------------
-int SimpleComputeShader::GetUnorderedAccessViewIndex(std::string name)
+int SimpleComputeShader::GetUnorderedAccessViewIndex(std::string_view name)
 {
 	// Look for the key
-	std::unordered_map<std::string, unsigned int>::iterator result =
+	auto result =
 		uavTable.find(name);
 
 	// Did we find the key?
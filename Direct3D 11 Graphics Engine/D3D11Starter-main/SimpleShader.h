@@ -3,13 +3,88 @@
 #pragma comment(lib, "d3dcompiler.lib")
 
 #include <d3d11.h>
+#include <d3d11_1.h>
 #include <d3dcompiler.h>
 #include <DirectXMath.h>
 #include <wrl/client.h>
 
 #include <unordered_map>
+#include <memory>
 #include <vector>
 #include <string>
+#include <string_view>
+#include <cstdint>
+#include <climits>
+
+class UploadRing;
+class SimpleReflection;
+
+// --------------------------------------------------------
+// Name -> info tables that can be searched with a
+// string_view (or string literal) directly, so a lookup
+// never builds a temporary std::string
+// --------------------------------------------------------
+struct SimpleNameHash
+{
+	using is_transparent = void;
+	size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+};
+
+template<typename T>
+using SimpleNameTable = std::unordered_map<std::string, T, SimpleNameHash, std::equal_to<>>;
+
+
+// --------------------------------------------------------
+// A shader variable/resource name hashed at compile time
+//
+//   constexpr SimpleShaderName WorldName("world");
+//
+// Pass one to Get*Handle() to resolve a name without
+// touching the string at runtime (32-bit FNV-1a)
+// --------------------------------------------------------
+struct SimpleShaderName
+{
+	uint32_t Hash;
+
+	constexpr explicit SimpleShaderName(std::string_view name) : Hash(HashOf(name)) {}
+
+	static constexpr uint32_t HashOf(std::string_view name)
+	{
+		uint32_t hash = 2166136261u;
+		for (char c : name)
+		{
+			hash ^= (unsigned char)c;
+			hash *= 16777619u;
+		}
+		return hash;
+	}
+};
+
+// --------------------------------------------------------
+// Pre-resolved location of a constant buffer variable
+//
+// Look one up once (per shader), then set through it:
+// the set is a bounds check and a memcpy, with no lookup.
+// Only meaningful for the shader that produced it.
+// --------------------------------------------------------
+struct SimpleVariableHandle
+{
+	unsigned int ConstantBufferIndex = UINT_MAX;
+	unsigned int ByteOffset = 0;
+	unsigned int Size = 0;
+
+	bool IsValid() const { return ConstantBufferIndex != UINT_MAX; }
+};
+
+// --------------------------------------------------------
+// Pre-resolved register of an SRV or sampler
+// --------------------------------------------------------
+struct SimpleBindHandle
+{
+	unsigned int BindIndex = UINT_MAX;
+
+	bool IsValid() const { return BindIndex != UINT_MAX; }
+};
 
 
 // --------------------------------------------------------
@@ -35,8 +110,35 @@ struct SimpleConstantBuffer
 	unsigned int Size = 0;
 	unsigned int BindIndex = 0;
 	Microsoft::WRL::ComPtr<ID3D11Buffer> ConstantBuffer = 0;
-	unsigned char* LocalDataBuffer = 0;
+	unsigned char* LocalDataBuffer = 0; // Points into the shader's single local data block
 	std::vector<SimpleShaderVariable> Variables;
+
+	// Bytes [DirtyStart, DirtyEnd) of LocalDataBuffer differ from the GPU copy
+	// - Empty (start >= end) means the buffer doesn't need uploading
+	unsigned int DirtyStart = 0;
+	unsigned int DirtyEnd = 0;
+
+	// Bound from a registered shared buffer (see SetSharedConstantBuffer),
+	// which its owner fills - this shader never writes or uploads it
+	bool Shared = false;
+
+	// Window of the upload ring (see SetUploadRing) last holding this data
+	// - Zero constants means the buffer's own ConstantBuffer is in use
+	uint64_t RingFrame = 0;
+	UINT RingFirstConstant = 0;
+	UINT RingNumConstants = 0;
+};
+
+// --------------------------------------------------------
+// Constant buffer upload counters for a single shader
+// --------------------------------------------------------
+struct SimpleUploadStats
+{
+	uint64_t Uploads = 0;			// Buffers actually sent to the GPU
+	uint64_t PartialUploads = 0;	// ...of which only sent their dirty range
+	uint64_t UploadsSkipped = 0;	// Copy requests for buffers that were clean
+	uint64_t UnchangedSets = 0;		// Set calls whose value was already there
+	uint64_t BytesSent = 0;
 };
 
 // --------------------------------------------------------
@@ -73,51 +175,100 @@ public:
 	void SetShader();
 	void CopyAllBufferData();
 	void CopyBufferData(unsigned int index);
-	void CopyBufferData(std::string bufferName);
+	void CopyBufferData(std::string_view bufferName);
 
 	// Sets arbitrary shader data
-	bool SetData(std::string name, const void* data, unsigned int size);
-
-	bool SetInt(std::string name, int data);
-	bool SetFloat(std::string name, float data);
-	bool SetFloat2(std::string name, const float data[2]);
-	bool SetFloat2(std::string name, const DirectX::XMFLOAT2 data);
-	bool SetFloat3(std::string name, const float data[3]);
-	bool SetFloat3(std::string name, const DirectX::XMFLOAT3 data);
-	bool SetFloat4(std::string name, const float data[4]);
-	bool SetFloat4(std::string name, const DirectX::XMFLOAT4 data);
-	bool SetMatrix4x4(std::string name, const float data[16]);
-	bool SetMatrix4x4(std::string name, const DirectX::XMFLOAT4X4 data);
+	bool SetData(std::string_view name, const void* data, unsigned int size);
+
+	bool SetInt(std::string_view name, int data);
+	bool SetFloat(std::string_view name, float data);
+	bool SetFloat2(std::string_view name, const float data[2]);
+	bool SetFloat2(std::string_view name, const DirectX::XMFLOAT2 data);
+	bool SetFloat3(std::string_view name, const float data[3]);
+	bool SetFloat3(std::string_view name, const DirectX::XMFLOAT3 data);
+	bool SetFloat4(std::string_view name, const float data[4]);
+	bool SetFloat4(std::string_view name, const DirectX::XMFLOAT4 data);
+	bool SetMatrix4x4(std::string_view name, const float data[16]);
+	bool SetMatrix4x4(std::string_view name, const DirectX::XMFLOAT4X4 data);
+
+	// Resolving names to handles (do this once, not per set)
+	SimpleVariableHandle GetVariableHandle(std::string_view name);
+	SimpleVariableHandle GetVariableHandle(SimpleShaderName name);
+	SimpleBindHandle GetShaderResourceViewHandle(std::string_view name);
+	SimpleBindHandle GetShaderResourceViewHandle(SimpleShaderName name);
+	SimpleBindHandle GetSamplerHandle(std::string_view name);
+	SimpleBindHandle GetSamplerHandle(SimpleShaderName name);
+
+	// Sets shader data through a pre-resolved handle
+	bool SetData(SimpleVariableHandle handle, const void* data, unsigned int size);
+
+	bool SetInt(SimpleVariableHandle handle, int data);
+	bool SetFloat(SimpleVariableHandle handle, float data);
+	bool SetFloat2(SimpleVariableHandle handle, const DirectX::XMFLOAT2 data);
+	bool SetFloat3(SimpleVariableHandle handle, const DirectX::XMFLOAT3 data);
+	bool SetFloat4(SimpleVariableHandle handle, const DirectX::XMFLOAT4 data);
+	bool SetMatrix4x4(SimpleVariableHandle handle, const DirectX::XMFLOAT4X4& data);
+
+	// Sets a whole constant buffer from its generated mirror struct
+	// (see ShaderStructs.h) - one memcpy, no name lookups
+	template<typename T>
+	bool Set(const T& data) { return SetBufferData(T::Register, &data, sizeof(T)); }
+	bool SetBufferData(unsigned int bindIndex, const void* data, unsigned int size);
 
 	// Setting shader resources
-	virtual bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv) = 0;
-	virtual bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState) = 0;
+	virtual bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv) = 0;
+	virtual bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState) = 0;
+	virtual bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv) = 0;
+	virtual bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState) = 0;
 
 	// Simple resource checking
-	bool HasVariable(std::string name);
-	bool HasShaderResourceView(std::string name);
-	bool HasSamplerState(std::string name);
+	bool HasVariable(std::string_view name);
+	bool HasShaderResourceView(std::string_view name);
+	bool HasSamplerState(std::string_view name);
 
 	// Getting data about variables and resources
-	const SimpleShaderVariable* GetVariableInfo(std::string name);
+	const SimpleShaderVariable* GetVariableInfo(std::string_view name);
 	
-	const SimpleSRV* GetShaderResourceViewInfo(std::string name);
+	const SimpleSRV* GetShaderResourceViewInfo(std::string_view name);
 	const SimpleSRV* GetShaderResourceViewInfo(unsigned int index);
 	size_t GetShaderResourceViewCount() { return textureTable.size(); }
 	
-	const SimpleSampler* GetSamplerInfo(std::string name);
+	const SimpleSampler* GetSamplerInfo(std::string_view name);
 	const SimpleSampler* GetSamplerInfo(unsigned int index);
 	size_t GetSamplerCount() { return samplerTable.size(); }
 
 	// Get data about constant buffers
 	unsigned int GetBufferCount();
 	unsigned int GetBufferSize(unsigned int index);
-	const SimpleConstantBuffer* GetBufferInfo(std::string name);
+	const SimpleConstantBuffer* GetBufferInfo(std::string_view name);
 	const SimpleConstantBuffer* GetBufferInfo(unsigned int index);
 	
 	// Misc getters
 	Microsoft::WRL::ComPtr<ID3DBlob> GetShaderBlob() { return shaderBlob; }
 
+	// Upload counters (since creation or the last reset)
+	const SimpleUploadStats& GetUploadStats() { return uploadStats; }
+	void ResetUploadStats() { uploadStats = {}; }
+
+	// Shared constant buffers
+	// - Any cbuffer with this name in a shader loaded AFTERWARDS is
+	//   bound to this buffer instead of getting its own, and its
+	//   variables can't be set through the shader
+	// - The owner updates the buffer once for every shader using it
+	static void SetSharedConstantBuffer(std::string_view name, Microsoft::WRL::ComPtr<ID3D11Buffer> buffer);
+
+	// Transient constant data
+	// - While a ring is set, uploads are suballocated from it and bound
+	//   with an offset instead of rewriting each shader's own buffers
+	// - Uploading binds, so only copy data for a shader that's been set
+	// - Null goes back to the shaders' own buffers
+	static void SetUploadRing(UploadRing* ring) { uploadRing = ring; }
+
+	// Reflection cache
+	// - Reflected layouts are saved next to each shader (as .cso.refl)
+	//   and reused while the bytecode hasn't changed
+	static bool UseReflectionCache;
+
 	// Error reporting
 	static bool ReportErrors;
 	static bool ReportWarnings;
@@ -129,30 +280,62 @@ protected:
 	Microsoft::WRL::ComPtr<ID3D11Device> device;
 	Microsoft::WRL::ComPtr<ID3D11DeviceContext> deviceContext;
 
+	// Partial constant buffer updates (D3D 11.1+ with driver support)
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> deviceContext1;
+	bool partialUpdates;
+	SimpleUploadStats uploadStats;
+
 	// Resource counts
 	unsigned int constantBufferCount;
 	
 	// Maps for variables and buffers
 	SimpleConstantBuffer*		constantBuffers; // For index-based lookup
-	std::vector<SimpleSRV*>		shaderResourceViews;
-	std::vector<SimpleSampler*>	samplerStates;
-	std::unordered_map<std::string, SimpleConstantBuffer*> cbTable;
-	std::unordered_map<std::string, SimpleShaderVariable> varTable;
-	std::unordered_map<std::string, SimpleSRV*> textureTable;
-	std::unordered_map<std::string, SimpleSampler*> samplerTable;
-
-	// Initialization method
+	std::unique_ptr<unsigned char[]> localData; // Every buffer's LocalDataBuffer
+	std::vector<SimpleSRV>		shaderResourceViews;
+	std::vector<SimpleSampler>	samplerStates;
+	SimpleNameTable<SimpleConstantBuffer*> cbTable;
+	SimpleNameTable<SimpleShaderVariable> varTable;
+	SimpleNameTable<SimpleSRV*> textureTable;
+	SimpleNameTable<SimpleSampler*> samplerTable;
+
+	// Shared constant buffers by cbuffer name
+	static SimpleNameTable<Microsoft::WRL::ComPtr<ID3D11Buffer>> sharedBuffers;
+	static UploadRing* uploadRing;
+
+	// Name hash -> handle, sorted by hash for binary searching
+	std::vector<std::pair<uint32_t, SimpleVariableHandle>> varHashes;
+	std::vector<std::pair<uint32_t, SimpleBindHandle>> srvHashes;
+	std::vector<std::pair<uint32_t, SimpleBindHandle>> samplerHashes;
+
+	// Initialization methods
 	bool LoadShaderFile(LPCWSTR shaderFile);
+	bool LoadShaderBlob(Microsoft::WRL::ComPtr<ID3DBlob> blob, LPCWSTR shaderFile);
+
+	// Reflected layout, only set while CreateShader() runs
+	const SimpleReflection* reflection = 0;
 
 	// Pure virtual functions for dealing with shader types
 	virtual bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob) = 0;
 	virtual void SetShaderAndCBs() = 0;
+	virtual void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants) = 0;
 
 	virtual void CleanUp();
 
+	// Helpers for dirty tracking, uploading & binding
+	void WriteVariable(SimpleConstantBuffer& cb, unsigned int byteOffset, const void* data, unsigned int size);
+	void UploadBuffer(SimpleConstantBuffer& cb);
+	void BindConstantBuffers();
+	bool IsInRing(const SimpleConstantBuffer& cb);
+
 	// Helpers for finding data by name
-	SimpleShaderVariable* FindVariable(std::string name, int size);
-	SimpleConstantBuffer* FindConstantBuffer(std::string name);
+	SimpleShaderVariable* FindVariable(std::string_view name, int size);
+	SimpleConstantBuffer* FindConstantBuffer(std::string_view name);
+
+	// Helpers for the name hash tables
+	template<typename Handle>
+	void SortHashTable(std::vector<std::pair<uint32_t, Handle>>& table, const char* kind);
+	template<typename Handle>
+	static Handle FindHash(const std::vector<std::pair<uint32_t, Handle>>& table, uint32_t hash);
 
 	// Error logging
 	void Log(std::string message, WORD color);
@@ -173,13 +356,16 @@ class SimpleVertexShader : public ISimpleShader
 public:
 	SimpleVertexShader( Microsoft::WRL::ComPtr<ID3D11Device> device,  Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile);
 	SimpleVertexShader( Microsoft::WRL::ComPtr<ID3D11Device> device,  Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile, Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout, bool perInstanceCompatible);
+	SimpleVertexShader( Microsoft::WRL::ComPtr<ID3D11Device> device,  Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	~SimpleVertexShader();
 	Microsoft::WRL::ComPtr<ID3D11VertexShader> GetDirectXShader() { return shader; }
 	Microsoft::WRL::ComPtr<ID3D11InputLayout> GetInputLayout() { return inputLayout; }
 	bool GetPerInstanceCompatible() { return perInstanceCompatible; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
+	bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState);
 
 protected:
 	bool perInstanceCompatible;
@@ -187,6 +373,7 @@ protected:
 	 Microsoft::WRL::ComPtr<ID3D11VertexShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants);
 	void CleanUp();
 };
 
@@ -198,16 +385,20 @@ class SimplePixelShader : public ISimpleShader
 {
 public:
 	SimplePixelShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, LPCWSTR shaderFile);
+	SimplePixelShader(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	~SimplePixelShader();
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
+	bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11PixelShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants);
 	void CleanUp();
 };
 
@@ -221,13 +412,16 @@ public:
 	~SimpleDomainShader();
 	Microsoft::WRL::ComPtr<ID3D11DomainShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
+	bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11DomainShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants);
 	void CleanUp();
 };
 
@@ -241,13 +435,16 @@ public:
 	~SimpleHullShader();
 	Microsoft::WRL::ComPtr<ID3D11HullShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
+	bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11HullShader> shader;
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants);
 	void CleanUp();
 };
 
@@ -261,8 +458,10 @@ public:
 	~SimpleGeometryShader();
 	Microsoft::WRL::ComPtr<ID3D11GeometryShader> GetDirectXShader() { return shader; }
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
+	bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
+	bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState);
 
 	bool CreateCompatibleStreamOutBuffer(Microsoft::WRL::ComPtr<ID3D11Buffer> buffer, int vertexCount);
 
@@ -280,6 +479,7 @@ protected:
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	bool CreateShaderWithStreamOut(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants);
 	void CleanUp();
 
 	// Helpers
@@ -300,17 +500,19 @@ public:
 	void DispatchByGroups(unsigned int groupsX, unsigned int groupsY, unsigned int groupsZ);
 	void DispatchByThreads(unsigned int threadsX, unsigned int threadsY, unsigned int threadsZ);
 
-	bool HasUnorderedAccessView(std::string name);
+	bool HasUnorderedAccessView(std::string_view name);
 
-	bool SetShaderResourceView(std::string name, Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> srv);
-	bool SetSamplerState(std::string name, Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerState);
-	bool SetUnorderedAccessView(std::string name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset = -1);
+	bool SetShaderResourceView(std::string_view name, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(std::string_view name, ID3D11SamplerState* samplerState);
+	bool SetShaderResourceView(SimpleBindHandle handle, ID3D11ShaderResourceView* srv);
+	bool SetSamplerState(SimpleBindHandle handle, ID3D11SamplerState* samplerState);
+	bool SetUnorderedAccessView(std::string_view name, Microsoft::WRL::ComPtr<ID3D11UnorderedAccessView> uav, unsigned int appendConsumeOffset = -1);
 
-	int GetUnorderedAccessViewIndex(std::string name);
+	int GetUnorderedAccessViewIndex(std::string_view name);
 
 protected:
 	Microsoft::WRL::ComPtr<ID3D11ComputeShader> shader;
-	std::unordered_map<std::string, unsigned int> uavTable;
+	SimpleNameTable<unsigned int> uavTable;
 
 	unsigned int threadsX;
 	unsigned int threadsY;
@@ -319,5 +521,6 @@ protected:
 
 	bool CreateShader(Microsoft::WRL::ComPtr<ID3DBlob> shaderBlob);
 	void SetShaderAndCBs();
+	void BindConstantBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants);
 	void CleanUp();
 };
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "Sky.h"
 #include "WICTextureLoader.h"
 #include "Graphics.h"
+#include "Resources.h"
 #include "DDSTextureLoader.h"
 
 using namespace DirectX;
@@ -12,9 +13,9 @@ Sky::Sky(const wchar_t* right,
 	const wchar_t* down,
 	const wchar_t* front,
 	const wchar_t* back,
-	std::shared_ptr<Mesh> skyMesh,
-	std::shared_ptr<SimplePixelShader> skyPS,
-	std::shared_ptr<SimpleVertexShader> skyVS,
+	MeshHandle skyMesh,
+	PixelShaderHandle skyPS,
+	VertexShaderHandle skyVS,
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerOpts) : 
 		skyMesh(skyMesh),
 		skyVS(skyVS),
@@ -24,46 +25,36 @@ Sky::Sky(const wchar_t* right,
 	// Create the cube map texture
 	skyTextureSRV = CreateCubemap(right, left, up, down, front, back);
 
-	// Create rasterizer render state
-	D3D11_RASTERIZER_DESC rasterDescr = {};
-	rasterDescr.FillMode = D3D11_FILL_SOLID;
-	rasterDescr.CullMode = D3D11_CULL_FRONT; // Draw the back faces/"inside"
-	Graphics::Device->CreateRasterizerState(&rasterDescr, rasterOpts.GetAddressOf());
-
-	// Create depth-stencil render state
-	D3D11_DEPTH_STENCIL_DESC depthStenDescr = {};
-	depthStenDescr.DepthEnable = true;
-	depthStenDescr.DepthFunc = D3D11_COMPARISON_LESS_EQUAL; // Ensure pixels will be accepted if depth values are <= to existing values
-	Graphics::Device->CreateDepthStencilState(&depthStenDescr, depthBuffCompType.GetAddressOf());
+	// Sky shaders with its own rasterizer & depth-stencil states
+	PipelineStateDesc desc;
+	desc.VertexShader = skyVS;
+	desc.PixelShader = skyPS;
+	desc.Rasterizer.CullMode = D3D11_CULL_FRONT; // Draw the back faces/"inside"
+	desc.Rasterizer.DepthClipEnable = false;
+	desc.DepthStencil.DepthWriteMask = D3D11_DEPTH_WRITE_MASK_ZERO;
+	desc.DepthStencil.DepthFunc = D3D11_COMPARISON_LESS_EQUAL; // Ensure pixels will be accepted if depth values are <= to existing values
+	pipeline = PipelineStates::Get(desc);
 }
 
 Sky::~Sky()
 {
 }
 
-void Sky::Draw(std::shared_ptr<Camera> camera)
+void Sky::Draw(RenderBackend& backend)
 {
-	// Change the rasterizer & depth states
-	Graphics::Context->RSSetState(rasterOpts.Get());
-	Graphics::Context->OMSetDepthStencilState(depthBuffCompType.Get(), 0);
+	SimpleVertexShader* vs = Resources::VertexShaders.Get(skyVS);
+	SimplePixelShader* ps = Resources::PixelShaders.Get(skyPS);
 
-	// Activate & set the sky-specific shaders for drawing
-	skyVS->SetShader();
-	skyPS->SetShader();
+	// Activate the sky-specific shaders & render states
+	// - Whatever draws next applies its own, so nothing to reset after
+	backend.SetPipeline({ pipeline });
 
-	skyPS->SetShaderResourceView("SkyTexture", skyTextureSRV);
-	skyPS->SetSamplerState("BasicSampler", samplerOpts);
+	backend.SetTexture(ps, "SkyTexture", skyTextureSRV.Get(), "BasicSampler", samplerOpts.Get());
 
-	skyVS->SetMatrix4x4("view", camera->GetView());
-	skyVS->SetMatrix4x4("projection", camera->GetProjection());
-	skyVS->CopyAllBufferData();
-
-	// Draw the mesh
-	skyMesh->SetAndDrawBuffers();
-
-	// Reset the render states
-	Graphics::Context->RSSetState(0); // Null/0 restores defaults
-	Graphics::Context->OMSetDepthStencilState(0, 0);
+	// View & projection come from the shared PerPass buffer, which the
+	// caller has already filled for this pass - nothing to upload here
+	// beyond the vertex shader's own buffers
+	backend.Draw({ Resources::Meshes.Get(skyMesh), 0, vs, 0, 0, 0 });
 }
 
 // --------------------------------------------------------
@@ -136,22 +127,27 @@ Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> Sky::CreateCubemap(
 
 	// Loop through the individual face textures and copy them,
 	// one at a time, to the cube map texure
-	for (int i = 0; i < 6; i++)
+	// - Headless runs have no context to copy with, and never
+	//   sample the cube map anyway
+	if (Graphics::Context)
 	{
-		// Calculate the subresource position to copy into
-		unsigned int subresource = D3D11CalcSubresource(
-			0,  // Which mip (zero, since there's only one)
-			i,  // Which array element?
-			1); // How many mip levels are in the texture?
-
-		// Copy from one resource (texture) to another
-		Graphics::Context->CopySubresourceRegion(
-			cubeMapTexture.Get(),  // Destination resource
-			subresource,           // Dest subresource index (one of the array elements)
-			0, 0, 0,               // XYZ location of copy
-			textures[i].Get(),     // Source resource
-			0,                     // Source subresource index (we're assuming there's only one)
-			0);                    // Source subresource "box" of data to copy (zero means the whole thing)
+		for (int i = 0; i < 6; i++)
+		{
+			// Calculate the subresource position to copy into
+			unsigned int subresource = D3D11CalcSubresource(
+				0,  // Which mip (zero, since there's only one)
+				i,  // Which array element?
+				1); // How many mip levels are in the texture?
+
+			// Copy from one resource (texture) to another
+			Graphics::Context->CopySubresourceRegion(
+				cubeMapTexture.Get(),  // Destination resource
+				subresource,           // Dest subresource index (one of the array elements)
+				0, 0, 0,               // XYZ location of copy
+				textures[i].Get(),     // Source resource
+				0,                     // Source subresource index (we're assuming there's only one)
+				0);                    // Source subresource "box" of data to copy (zero means the whole thing)
+		}
 	}
 
 	// At this point, all of the faces have been copied into the 
@@ -4,6 +4,9 @@
 #include "Mesh.h"
 #include "SimpleShader.h"
 #include "Camera.h"
+#include "ResourceHandles.h"
+#include "PipelineState.h"
+#include "RenderBackend.h"
 #include <memory>
 
 class Sky
@@ -17,23 +20,22 @@ public:
 		const wchar_t* down,
 		const wchar_t* front,
 		const wchar_t* back,
-		std::shared_ptr<Mesh> skyMesh,
-		std::shared_ptr<SimplePixelShader> skyPS,
-		std::shared_ptr<SimpleVertexShader> skyVS,
+		MeshHandle skyMesh,
+		PixelShaderHandle skyPS,
+		VertexShaderHandle skyVS,
 		Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerOpts
 	);
 	// Deconstructor
 	~Sky();
-	void Draw(std::shared_ptr<Camera> camera);
+	void Draw(RenderBackend& backend); // Uses the current PerPass camera
 
 private:
 	Microsoft::WRL::ComPtr<ID3D11SamplerState> samplerOpts;
 	Microsoft::WRL::ComPtr<ID3D11ShaderResourceView> skyTextureSRV;
-	Microsoft::WRL::ComPtr<ID3D11DepthStencilState> depthBuffCompType;
-	Microsoft::WRL::ComPtr<ID3D11RasterizerState> rasterOpts; // Drawing the objects inside
-	std::shared_ptr<Mesh> skyMesh; // Geometry to use when drawing the sky
-	std::shared_ptr<SimplePixelShader> skyPS;
-	std::shared_ptr<SimpleVertexShader> skyVS;
+	const PipelineState* pipeline; // Sky shaders, drawing the "inside" at max depth
+	MeshHandle skyMesh; // Geometry to use when drawing the sky
+	PixelShaderHandle skyPS;
+	VertexShaderHandle skyVS;
 
 	// --------------------------------------------------------
 	// Author: Chris Cascioli
@@ -1,10 +1,6 @@
 #include "ShaderInclude.hlsli" // Contains all necessary structs, helper functions, etc.
 
-cbuffer ExternalData : register(b0) 
-{
-    matrix view;
-    matrix projection;	
-}
+// View & projection come from PerPass (see ShaderInclude.hlsli)
 
 VertexToPixel_Sky main(VertexShaderInput input) 
 {
@@ -0,0 +1,416 @@
+#include "SpatialIndex.h"
+
+#include <algorithm>
+
+using namespace DirectX;
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	Aabb Union(const Aabb& a, const Aabb& b)
+	{
+		return {
+			{ a.Min.x < b.Min.x ? a.Min.x : b.Min.x, a.Min.y < b.Min.y ? a.Min.y : b.Min.y, a.Min.z < b.Min.z ? a.Min.z : b.Min.z },
+			{ a.Max.x > b.Max.x ? a.Max.x : b.Max.x, a.Max.y > b.Max.y ? a.Max.y : b.Max.y, a.Max.z > b.Max.z ? a.Max.z : b.Max.z } };
+	}
+
+	// The insertion cost - what a box adds to every ray or query that has to enter it
+	float SurfaceArea(const Aabb& box)
+	{
+		float x = box.Max.x - box.Min.x;
+		float y = box.Max.y - box.Min.y;
+		float z = box.Max.z - box.Min.z;
+		return 2.0f * (x * y + y * z + z * x);
+	}
+
+	bool Contains(const Aabb& outer, const Aabb& inner)
+	{
+		return
+			outer.Min.x <= inner.Min.x && outer.Min.y <= inner.Min.y && outer.Min.z <= inner.Min.z &&
+			inner.Max.x <= outer.Max.x && inner.Max.y <= outer.Max.y && inner.Max.z <= outer.Max.z;
+	}
+
+	// Ordering for the k-nearest heaps
+	struct Closer
+	{
+		bool operator()(const DynamicAabbTree::Neighbor& a, const DynamicAabbTree::Neighbor& b) const { return a.DistanceSquared < b.DistanceSquared; }
+	};
+	struct Further
+	{
+		bool operator()(const DynamicAabbTree::Neighbor& a, const DynamicAabbTree::Neighbor& b) const { return a.DistanceSquared > b.DistanceSquared; }
+	};
+}
+
+DynamicAabbTree::DynamicAabbTree(float margin) :
+	margin(margin)
+{
+}
+
+bool DynamicAabbTree::Overlaps(const Aabb& a, const Aabb& b)
+{
+	return
+		a.Min.x <= b.Max.x && b.Min.x <= a.Max.x &&
+		a.Min.y <= b.Max.y && b.Min.y <= a.Max.y &&
+		a.Min.z <= b.Max.z && b.Min.z <= a.Max.z;
+}
+
+float DynamicAabbTree::DistanceSquared(const Aabb& box, const XMFLOAT3& point)
+{
+	float dx = point.x < box.Min.x ? box.Min.x - point.x : (point.x > box.Max.x ? point.x - box.Max.x : 0.0f);
+	float dy = point.y < box.Min.y ? box.Min.y - point.y : (point.y > box.Max.y ? point.y - box.Max.y : 0.0f);
+	float dz = point.z < box.Min.z ? box.Min.z - point.z : (point.z > box.Max.z ? point.z - box.Max.z : 0.0f);
+	return dx * dx + dy * dy + dz * dz;
+}
+
+uint32_t DynamicAabbTree::Insert(const Aabb& box, uint32_t userData)
+{
+	uint32_t leaf = AllocateNode();
+	Node& node = nodes[leaf];
+	node.Box = {
+		{ box.Min.x - margin, box.Min.y - margin, box.Min.z - margin },
+		{ box.Max.x + margin, box.Max.y + margin, box.Max.z + margin } };
+	node.UserData = userData;
+	node.Height = 0;
+	leafBoxes[leaf] = box;
+
+	InsertLeaf(leaf);
+	proxyCount++;
+	return leaf;
+}
+
+void DynamicAabbTree::Remove(uint32_t proxy)
+{
+	RemoveLeaf(proxy);
+	FreeNode(proxy);
+	proxyCount--;
+}
+
+void DynamicAabbTree::Clear()
+{
+	nodes.clear();
+	leafBoxes.clear();
+	root = Null;
+	freeList = Null;
+	proxyCount = 0;
+}
+
+bool DynamicAabbTree::Move(uint32_t proxy, const Aabb& box)
+{
+	// Still inside the fat box - nothing above the leaf changes
+	leafBoxes[proxy] = box;
+	if (Contains(nodes[proxy].Box, box))
+		return false;
+
+	RemoveLeaf(proxy);
+	nodes[proxy].Box = {
+		{ box.Min.x - margin, box.Min.y - margin, box.Min.z - margin },
+		{ box.Max.x + margin, box.Max.y + margin, box.Max.z + margin } };
+	InsertLeaf(proxy);
+	return true;
+}
+
+// --------------------------------------------------------
+// Best first: nodes are visited closest box first, and the
+// search ends once the closest unvisited box is further than
+// the kth best so far
+// --------------------------------------------------------
+void DynamicAabbTree::QueryNearest(const XMFLOAT3& point, uint32_t k, std::vector<Neighbor>& nearest) const
+{
+	nearest.clear();
+	if (root == Null || k == 0)
+		return;
+
+	// Min heap of nodes to visit (UserData holds the node here);
+	// nearest is a max heap until the end, so its worst is in front
+	thread_local std::vector<Neighbor> open;
+	open.clear();
+	open.push_back({ root, DistanceSquared(nodes[root].Box, point) });
+
+	while (!open.empty())
+	{
+		std::pop_heap(open.begin(), open.end(), Further());
+		Neighbor next = open.back();
+		open.pop_back();
+
+		if (nearest.size() == k && next.DistanceSquared >= nearest.front().DistanceSquared)
+			break;
+
+		const Node& node = nodes[next.UserData];
+		if (node.IsLeaf())
+		{
+			Neighbor found = { node.UserData, DistanceSquared(leafBoxes[next.UserData], point) };
+			if (nearest.size() < k)
+			{
+				nearest.push_back(found);
+				std::push_heap(nearest.begin(), nearest.end(), Closer());
+			}
+			else if (found.DistanceSquared < nearest.front().DistanceSquared)
+			{
+				std::pop_heap(nearest.begin(), nearest.end(), Closer());
+				nearest.back() = found;
+				std::push_heap(nearest.begin(), nearest.end(), Closer());
+			}
+			continue;
+		}
+
+		uint32_t children[2] = { node.Child1, node.Child2 };
+		for (uint32_t child : children)
+		{
+			float distance = DistanceSquared(nodes[child].Box, point);
+			if (nearest.size() == k && distance >= nearest.front().DistanceSquared)
+				continue;
+
+			open.push_back({ child, distance });
+			std::push_heap(open.begin(), open.end(), Further());
+		}
+	}
+
+	std::sort_heap(nearest.begin(), nearest.end(), Closer());
+}
+
+uint32_t DynamicAabbTree::AllocateNode()
+{
+	uint32_t index;
+	if (freeList != Null)
+	{
+		index = freeList;
+		freeList = nodes[index].Parent;
+	}
+	else
+	{
+		index = (uint32_t)nodes.size();
+		nodes.emplace_back();
+		leafBoxes.emplace_back();
+	}
+
+	Node& node = nodes[index];
+	node.Parent = Null;
+	node.Child1 = Null;
+	node.Child2 = Null;
+	node.Height = 0;
+	node.UserData = 0;
+	return index;
+}
+
+void DynamicAabbTree::FreeNode(uint32_t node)
+{
+	nodes[node].Parent = freeList;
+	nodes[node].Height = -1;
+	freeList = node;
+}
+
+// --------------------------------------------------------
+// Walks down picking whichever child is cheaper to grow,
+// stopping where a new parent right here is cheapest
+// --------------------------------------------------------
+void DynamicAabbTree::InsertLeaf(uint32_t leaf)
+{
+	if (root == Null)
+	{
+		root = leaf;
+		nodes[root].Parent = Null;
+		return;
+	}
+
+	Aabb leafBox = nodes[leaf].Box;
+	uint32_t index = root;
+	while (!nodes[index].IsLeaf())
+	{
+		const Node& node = nodes[index];
+		float area = SurfaceArea(node.Box);
+		float combinedArea = SurfaceArea(Union(node.Box, leafBox));
+
+		// A new parent for this node & the leaf
+		float cost = 2.0f * combinedArea;
+
+		// Going further down grows this node's box too
+		float inheritance = 2.0f * (combinedArea - area);
+
+		auto descendCost = [&](uint32_t child)
+		{
+			const Node& c = nodes[child];
+			float grown = SurfaceArea(Union(leafBox, c.Box));
+			return (c.IsLeaf() ? grown : grown - SurfaceArea(c.Box)) + inheritance;
+		};
+		float cost1 = descendCost(node.Child1);
+		float cost2 = descendCost(node.Child2);
+
+		if (cost < cost1 && cost < cost2)
+			break;
+		index = cost1 < cost2 ? node.Child1 : node.Child2;
+	}
+
+	// New parent between the sibling & its old parent
+	uint32_t sibling = index;
+	uint32_t oldParent = nodes[sibling].Parent;
+	uint32_t newParent = AllocateNode();
+	nodes[newParent].Parent = oldParent;
+	nodes[newParent].Box = Union(leafBox, nodes[sibling].Box);
+	nodes[newParent].Height = nodes[sibling].Height + 1;
+	nodes[newParent].Child1 = sibling;
+	nodes[newParent].Child2 = leaf;
+	nodes[sibling].Parent = newParent;
+	nodes[leaf].Parent = newParent;
+
+	if (oldParent == Null)
+		root = newParent;
+	else if (nodes[oldParent].Child1 == sibling)
+		nodes[oldParent].Child1 = newParent;
+	else
+		nodes[oldParent].Child2 = newParent;
+
+	// Refit & rebalance on the way back up
+	Refit(nodes[leaf].Parent);
+}
+
+void DynamicAabbTree::RemoveLeaf(uint32_t leaf)
+{
+	if (leaf == root)
+	{
+		root = Null;
+		return;
+	}
+
+	// The sibling takes the parent's place
+	uint32_t parent = nodes[leaf].Parent;
+	uint32_t grandParent = nodes[parent].Parent;
+	uint32_t sibling = nodes[parent].Child1 == leaf ? nodes[parent].Child2 : nodes[parent].Child1;
+
+	if (grandParent == Null)
+	{
+		root = sibling;
+		nodes[sibling].Parent = Null;
+		FreeNode(parent);
+		return;
+	}
+
+	if (nodes[grandParent].Child1 == parent)
+		nodes[grandParent].Child1 = sibling;
+	else
+		nodes[grandParent].Child2 = sibling;
+	nodes[sibling].Parent = grandParent;
+	FreeNode(parent);
+
+	Refit(grandParent);
+}
+
+// Rebalances each node from here to the root & recomputes its box & height
+void DynamicAabbTree::Refit(uint32_t node)
+{
+	while (node != Null)
+	{
+		node = Balance(node);
+
+		Node& n = nodes[node];
+		const Node& child1 = nodes[n.Child1];
+		const Node& child2 = nodes[n.Child2];
+		n.Height = 1 + (child1.Height > child2.Height ? child1.Height : child2.Height);
+		n.Box = Union(child1.Box, child2.Box);
+
+		node = n.Parent;
+	}
+}
+
+// --------------------------------------------------------
+// If one child is more than a level taller than the other,
+// rotates it up into this node's place.  Returns whichever
+// node is now where this one was.
+// --------------------------------------------------------
+uint32_t DynamicAabbTree::Balance(uint32_t iA)
+{
+	Node& a = nodes[iA];
+	if (a.IsLeaf() || a.Height < 2)
+		return iA;
+
+	uint32_t iB = a.Child1;
+	uint32_t iC = a.Child2;
+	Node& b = nodes[iB];
+	Node& c = nodes[iC];
+	int balance = c.Height - b.Height;
+
+	// Puts "up" where A was under A's parent
+	auto replaceInParent = [&](uint32_t up)
+	{
+		nodes[up].Parent = a.Parent;
+		a.Parent = up;
+		uint32_t parent = nodes[up].Parent;
+		if (parent == Null)
+			root = up;
+		else if (nodes[parent].Child1 == iA)
+			nodes[parent].Child1 = up;
+		else
+			nodes[parent].Child2 = up;
+	};
+
+	// Rotate C up
+	if (balance > 1)
+	{
+		uint32_t iF = c.Child1;
+		uint32_t iG = c.Child2;
+		Node& f = nodes[iF];
+		Node& g = nodes[iG];
+
+		c.Child1 = iA;
+		replaceInParent(iC);
+
+		// C keeps the taller of its children, A takes the other
+		if (f.Height > g.Height)
+		{
+			c.Child2 = iF;
+			a.Child2 = iG;
+			g.Parent = iA;
+			a.Box = Union(b.Box, g.Box);
+			c.Box = Union(a.Box, f.Box);
+			a.Height = 1 + (b.Height > g.Height ? b.Height : g.Height);
+			c.Height = 1 + (a.Height > f.Height ? a.Height : f.Height);
+		}
+		else
+		{
+			c.Child2 = iG;
+			a.Child2 = iF;
+			f.Parent = iA;
+			a.Box = Union(b.Box, f.Box);
+			c.Box = Union(a.Box, g.Box);
+			a.Height = 1 + (b.Height > f.Height ? b.Height : f.Height);
+			c.Height = 1 + (a.Height > g.Height ? a.Height : g.Height);
+		}
+		return iC;
+	}
+
+	// Rotate B up
+	if (balance < -1)
+	{
+		uint32_t iD = b.Child1;
+		uint32_t iE = b.Child2;
+		Node& d = nodes[iD];
+		Node& e = nodes[iE];
+
+		b.Child1 = iA;
+		replaceInParent(iB);
+
+		if (d.Height > e.Height)
+		{
+			b.Child2 = iD;
+			a.Child1 = iE;
+			e.Parent = iA;
+			a.Box = Union(c.Box, e.Box);
+			b.Box = Union(a.Box, d.Box);
+			a.Height = 1 + (c.Height > e.Height ? c.Height : e.Height);
+			b.Height = 1 + (a.Height > d.Height ? a.Height : d.Height);
+		}
+		else
+		{
+			b.Child2 = iE;
+			a.Child1 = iD;
+			d.Parent = iA;
+			a.Box = Union(c.Box, d.Box);
+			b.Box = Union(a.Box, e.Box);
+			a.Height = 1 + (c.Height > d.Height ? c.Height : d.Height);
+			b.Height = 1 + (a.Height > e.Height ? a.Height : e.Height);
+		}
+		return iB;
+	}
+
+	return iA;
+}
@@ -0,0 +1,241 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+#include "Culling.h"
+
+// Axis aligned box by its corners
+struct Aabb
+{
+	DirectX::XMFLOAT3 Min;
+	DirectX::XMFLOAT3 Max;
+};
+
+// --------------------------------------------------------
+// Dynamic AABB tree over world bounds, for culling and
+// proximity queries that don't touch every entity
+// (Box2D's b2DynamicTree, in 3D)
+//
+// - Each proxy is a leaf whose box is its real box grown by
+//   a margin, so small moves stay inside it & only update
+//   the leaf; a box that leaves its fat box is taken out &
+//   reinserted, refitting the nodes above it
+// - Inserts go next to the sibling that adds the least
+//   surface area, and rotations keep the tree balanced
+// - Queries walk down from the root, skipping any subtree
+//   whose box misses.  Frustum queries also stop testing
+//   under a node that's fully inside, and leaves are tested
+//   against their real box so results are exact.
+// - Not thread safe: queries may run at the same time as
+//   each other, but not with changes
+// --------------------------------------------------------
+class DynamicAabbTree
+{
+public:
+	static constexpr uint32_t Null = UINT32_MAX;
+
+	// One k-nearest result
+	struct Neighbor
+	{
+		uint32_t UserData;
+		float DistanceSquared; // From the query point to the proxy's box
+	};
+
+	explicit DynamicAabbTree(float margin = 0.1f);
+
+	// Returns the proxy (stable until it's removed)
+	uint32_t Insert(const Aabb& box, uint32_t userData);
+	void Remove(uint32_t proxy);
+	void Clear();
+
+	// Returns true if the box left its fat box & was reinserted
+	bool Move(uint32_t proxy, const Aabb& box);
+
+	uint32_t GetUserData(uint32_t proxy) const { return nodes[proxy].UserData; }
+	const Aabb& GetBox(uint32_t proxy) const { return leafBoxes[proxy]; }
+
+	// Stats
+	size_t ProxyCount() const { return proxyCount; }
+	int Height() const { return root == Null ? 0 : nodes[root].Height; }
+
+	// Calls func(userData) for each proxy that intersects the frustum
+	template<typename Func>
+	void QueryFrustum(const Frustum& frustum, Func&& func) const;
+
+	// Calls func(userData) for each proxy overlapping a box or sphere
+	template<typename Func>
+	void QueryBox(const Aabb& box, Func&& func) const;
+	template<typename Func>
+	void QuerySphere(const DirectX::XMFLOAT3& center, float radius, Func&& func) const;
+
+	// The k proxies closest to a point, nearest first
+	void QueryNearest(const DirectX::XMFLOAT3& point, uint32_t k, std::vector<Neighbor>& nearest) const;
+
+	// Shared box math
+	static bool Overlaps(const Aabb& a, const Aabb& b);
+	static float DistanceSquared(const Aabb& box, const DirectX::XMFLOAT3& point);
+
+private:
+	struct Node
+	{
+		Aabb Box;			// Fat for leaves, the union of both children otherwise
+		uint32_t Parent;	// Next free node when it's on the free list
+		uint32_t Child1;
+		uint32_t Child2;
+		int32_t Height;		// 0 for leaves, -1 when free
+		uint32_t UserData;
+
+		bool IsLeaf() const { return Child1 == Null; }
+	};
+
+	// Depth first traversal stack - on the stack of the calling
+	// thread unless a (very unbalanced) tree outgrows it
+	template<typename T>
+	class Stack
+	{
+	public:
+		void Push(const T& value)
+		{
+			if (count < Capacity) local[count] = value;
+			else spill.push_back(value);
+			count++;
+		}
+
+		T Pop()
+		{
+			count--;
+			if (count < Capacity)
+				return local[count];
+			T value = spill.back();
+			spill.pop_back();
+			return value;
+		}
+
+		bool IsEmpty() const { return count == 0; }
+
+	private:
+		static constexpr uint32_t Capacity = 128;
+		T local[Capacity];
+		std::vector<T> spill;
+		uint32_t count = 0;
+	};
+
+	float margin;
+	uint32_t root = Null;
+	uint32_t freeList = Null;
+	size_t proxyCount = 0;
+	std::vector<Node> nodes;
+	std::vector<Aabb> leafBoxes; // Each leaf's real box, by node
+
+	uint32_t AllocateNode();
+	void FreeNode(uint32_t node);
+	void InsertLeaf(uint32_t leaf);
+	void RemoveLeaf(uint32_t leaf);
+	uint32_t Balance(uint32_t node);
+	void Refit(uint32_t node);
+
+	// Visits every leaf whose box passes test(box)
+	template<typename Test, typename Func>
+	void Query(Test&& test, Func&& func) const;
+};
+
+template<typename Test, typename Func>
+void DynamicAabbTree::Query(Test&& test, Func&& func) const
+{
+	if (root == Null)
+		return;
+
+	Stack<uint32_t> stack;
+	stack.Push(root);
+	while (!stack.IsEmpty())
+	{
+		const Node& node = nodes[stack.Pop()];
+		if (!test(node.Box))
+			continue;
+
+		if (node.IsLeaf())
+		{
+			if (test(leafBoxes[&node - nodes.data()]))
+				func(node.UserData);
+		}
+		else
+		{
+			stack.Push(node.Child1);
+			stack.Push(node.Child2);
+		}
+	}
+}
+
+template<typename Func>
+void DynamicAabbTree::QueryBox(const Aabb& box, Func&& func) const
+{
+	Query([&](const Aabb& nodeBox) { return Overlaps(nodeBox, box); }, func);
+}
+
+template<typename Func>
+void DynamicAabbTree::QuerySphere(const DirectX::XMFLOAT3& center, float radius, Func&& func) const
+{
+	float radiusSquared = radius * radius;
+	Query([&](const Aabb& nodeBox) { return DistanceSquared(nodeBox, center) <= radiusSquared; }, func);
+}
+
+// --------------------------------------------------------
+// Each node carries a mask of the planes it still has to be
+// tested against: a box fully inside a plane drops it for
+// the whole subtree, and once none are left everything
+// under the node is reported without another test
+// --------------------------------------------------------
+template<typename Func>
+void DynamicAabbTree::QueryFrustum(const Frustum& frustum, Func&& func) const
+{
+	if (root == Null)
+		return;
+
+	struct Entry
+	{
+		uint32_t Node;
+		uint32_t Planes;
+	};
+
+	Stack<Entry> stack;
+	stack.Push({ root, 0x3F });
+	while (!stack.IsEmpty())
+	{
+		Entry entry = stack.Pop();
+		const Node& node = nodes[entry.Node];
+
+		// Leaves are tested against their real box
+		const Aabb& box = node.IsLeaf() ? leafBoxes[entry.Node] : node.Box;
+		float cx = (box.Min.x + box.Max.x) * 0.5f, ex = (box.Max.x - box.Min.x) * 0.5f;
+		float cy = (box.Min.y + box.Max.y) * 0.5f, ey = (box.Max.y - box.Min.y) * 0.5f;
+		float cz = (box.Min.z + box.Max.z) * 0.5f, ez = (box.Max.z - box.Min.z) * 0.5f;
+
+		bool outside = false;
+		uint32_t planes = entry.Planes;
+		for (int p = 0; p < 6 && !outside; p++)
+		{
+			if (!(planes & (1u << p)))
+				continue;
+
+			const DirectX::XMFLOAT4& plane = frustum.Planes[p];
+			float distance = plane.x * cx + plane.y * cy + plane.z * cz + plane.w;
+			float reach = fabsf(plane.x) * ex + fabsf(plane.y) * ey + fabsf(plane.z) * ez;
+			if (distance + reach < 0.0f)
+				outside = true;
+			else if (distance - reach >= 0.0f)
+				planes &= ~(1u << p);
+		}
+		if (outside)
+			continue;
+
+		if (node.IsLeaf())
+			func(node.UserData);
+		else
+		{
+			stack.Push({ node.Child1, planes });
+			stack.Push({ node.Child2, planes });
+		}
+	}
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+// --------------------------------------------------------
+// Bounded single-producer / single-consumer queue
+//
+// - Lock-free: each side only writes its own index, and
+//   reads the other side's with acquire ordering
+// - Push() & Pop() block (via atomic wait/notify, not a
+//   spin) when full or empty; TryPush() & TryPop() don't
+// --------------------------------------------------------
+template<typename T, uint32_t Capacity>
+class SpscQueue
+{
+public:
+	// Producer only
+	bool TryPush(const T& item)
+	{
+		uint32_t t = tail.load(std::memory_order_relaxed);
+		if (t - head.load(std::memory_order_acquire) == Capacity)
+			return false;
+
+		items[t % Capacity] = item;
+		tail.store(t + 1, std::memory_order_release);
+		tail.notify_one();
+		return true;
+	}
+
+	// Consumer only
+	bool TryPop(T& item)
+	{
+		uint32_t h = head.load(std::memory_order_relaxed);
+		if (tail.load(std::memory_order_acquire) == h)
+			return false;
+
+		item = items[h % Capacity];
+		head.store(h + 1, std::memory_order_release);
+		head.notify_one();
+		return true;
+	}
+
+	// Producer only - waits for the consumer to make room
+	void Push(const T& item)
+	{
+		while (true)
+		{
+			uint32_t h = head.load(std::memory_order_acquire);
+			if (TryPush(item))
+				return;
+			head.wait(h, std::memory_order_acquire);
+		}
+	}
+
+	// Consumer only - waits for the producer to add something
+	T Pop()
+	{
+		T item;
+		while (true)
+		{
+			uint32_t t = tail.load(std::memory_order_acquire);
+			if (TryPop(item))
+				return item;
+			tail.wait(t, std::memory_order_acquire);
+		}
+	}
+
+	bool IsEmpty() const { return head.load(std::memory_order_acquire) == tail.load(std::memory_order_acquire); }
+
+private:
+	alignas(64) std::atomic<uint32_t> head = 0; // Next slot to read (written by the consumer)
+	alignas(64) std::atomic<uint32_t> tail = 0; // Next slot to write (written by the producer)
+	T items[Capacity];
+};
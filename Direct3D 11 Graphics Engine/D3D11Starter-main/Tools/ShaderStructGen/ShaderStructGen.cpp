@@ -0,0 +1,441 @@
+// --------------------------------------------------------
+// ShaderStructGen
+//
+// Build step that reflects the compiled shaders (.cso) and
+// writes C++ mirrors of their constant buffers, with every
+// member's offset & each struct's size static_asserted
+//
+//   ShaderStructGen.exe <output.h> <shader.cso> [<shader.cso>...]
+//
+// - A cbuffer found in more than one shader with the same
+//   layout (the shared PerPass & PerFrame) is written once;
+//   the rest go in a namespace named after their shader
+// - HLSL structs used by a cbuffer (Light) are written once
+// - Padding the HLSL packing rules insert becomes explicit
+//   PadN members, so the C++ struct can be copied whole
+// - The header is only rewritten if its contents changed,
+//   so an untouched shader doesn't cause a rebuild
+// --------------------------------------------------------
+
+#include <Windows.h>
+#include <d3d11.h>
+#include <d3d11shader.h>
+#include <d3dcompiler.h>
+#include <wrl/client.h>
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#pragma comment(lib, "d3dcompiler.lib")
+#pragma comment(lib, "dxguid.lib")
+
+// Annonymous namespace to hold helpers
+// only accessible in this file
+namespace
+{
+	struct Member
+	{
+		std::string Name;
+		std::string Type;	// C++ type, or empty to write raw bytes
+		std::string Note;	// Why it's raw bytes
+		unsigned int Offset;
+		unsigned int Size;
+		unsigned int Count;	// Array elements (0 = not an array)
+
+		bool operator==(const Member& other) const
+		{
+			return Name == other.Name && Type == other.Type && Offset == other.Offset && Size == other.Size && Count == other.Count;
+		}
+	};
+
+	struct Layout
+	{
+		std::string Name;
+		unsigned int Size = 0;
+		int Register = -1;	// -1 for HLSL structs (not bound themselves)
+		std::vector<Member> Members;
+
+		bool SameLayout(const Layout& other) const { return Name == other.Name && Size == other.Size && Members == other.Members; }
+	};
+
+	struct Shader
+	{
+		std::string Name; // File name without the extension
+		std::vector<Layout> Buffers;
+	};
+
+	std::vector<Layout> structs; // HLSL structs, in first-seen order
+	bool failed = false;
+
+	void Error(const std::string& message)
+	{
+		fprintf(stderr, "ShaderStructGen: error: %s\n", message.c_str());
+		failed = true;
+	}
+
+	unsigned int RoundUp16(unsigned int size) { return (size + 15) & ~15u; }
+
+	// Size of a single element (all HLSL struct & array elements
+	// start on a 16-byte row, so a struct is padded out to one)
+	unsigned int ElementSize(const D3D11_SHADER_TYPE_DESC& typeDesc)
+	{
+		unsigned int scalar = 4;
+		switch (typeDesc.Class)
+		{
+		case D3D_SVC_SCALAR: return scalar;
+		case D3D_SVC_VECTOR: return scalar * typeDesc.Columns;
+		case D3D_SVC_MATRIX_ROWS: return 16 * (typeDesc.Rows - 1) + scalar * typeDesc.Columns;
+		case D3D_SVC_MATRIX_COLUMNS: return 16 * (typeDesc.Columns - 1) + scalar * typeDesc.Rows;
+		default: return 0; // Structs are measured from their members
+		}
+	}
+
+	Layout BuildStruct(ID3D11ShaderReflectionType* type, const D3D11_SHADER_TYPE_DESC& typeDesc);
+
+	// Picks the C++ type for a reflected HLSL type, or returns
+	// false (with a note) where there isn't a layout-safe one
+	bool CppType(ID3D11ShaderReflectionType* type, const D3D11_SHADER_TYPE_DESC& typeDesc, std::string& cppType, std::string& note)
+	{
+		if (typeDesc.Class == D3D_SVC_STRUCT)
+		{
+			Layout layout = BuildStruct(type, typeDesc);
+			bool known = false;
+			for (const Layout& existing : structs)
+			{
+				if (existing.Name != layout.Name)
+					continue;
+				if (!existing.SameLayout(layout))
+					Error("struct " + layout.Name + " has two different layouts");
+				known = true;
+			}
+			if (!known)
+				structs.push_back(layout);
+
+			cppType = layout.Name;
+			return true;
+		}
+
+		std::string base;
+		std::string vectorBase;
+		switch (typeDesc.Type)
+		{
+		case D3D_SVT_FLOAT: base = "float"; vectorBase = "DirectX::XMFLOAT"; break;
+		case D3D_SVT_INT: base = "int32_t"; vectorBase = "DirectX::XMINT"; break;
+		case D3D_SVT_UINT: base = "uint32_t"; vectorBase = "DirectX::XMUINT"; break;
+		case D3D_SVT_BOOL: base = "uint32_t"; vectorBase = "DirectX::XMUINT"; break; // HLSL bools are 4 bytes
+		default: note = "unsupported type"; return false;
+		}
+
+		if (typeDesc.Class == D3D_SVC_SCALAR)
+		{
+			cppType = base;
+			return true;
+		}
+
+		if (typeDesc.Class == D3D_SVC_VECTOR && typeDesc.Columns >= 2)
+		{
+			cppType = vectorBase + std::to_string(typeDesc.Columns);
+			return true;
+		}
+
+		// Only full 4x4 float matrices pack the same in C++ & HLSL
+		if ((typeDesc.Class == D3D_SVC_MATRIX_COLUMNS || typeDesc.Class == D3D_SVC_MATRIX_ROWS) &&
+			typeDesc.Type == D3D_SVT_FLOAT && typeDesc.Rows == 4 && typeDesc.Columns == 4)
+		{
+			cppType = "DirectX::XMFLOAT4X4";
+			return true;
+		}
+
+		note = "matrix rows are padded to 16 bytes";
+		return false;
+	}
+
+	Member BuildMember(const char* name, ID3D11ShaderReflectionType* type, unsigned int offset, unsigned int size)
+	{
+		D3D11_SHADER_TYPE_DESC typeDesc;
+		type->GetDesc(&typeDesc);
+
+		Member member = {};
+		member.Name = name;
+		member.Offset = offset;
+		member.Size = size;
+		member.Count = typeDesc.Elements;
+
+		if (!CppType(type, typeDesc, member.Type, member.Note))
+			member.Type.clear();
+
+		// Reflection leaves off the last struct element's padding, but
+		// the C++ struct has it, so count whole elements instead
+		if (typeDesc.Class == D3D_SVC_STRUCT)
+		{
+			for (const Layout& layout : structs)
+			{
+				if (layout.Name == member.Type)
+					member.Size = layout.Size * (member.Count > 0 ? member.Count : 1);
+			}
+		}
+
+		// Array elements each start on a new 16-byte row, so an
+		// array is only a plain C++ array if its elements fill them
+		if (!member.Type.empty() && member.Count > 0 && typeDesc.Class != D3D_SVC_STRUCT && ElementSize(typeDesc) % 16 != 0)
+		{
+			member.Note = member.Type + "[" + std::to_string(member.Count) + "], one per 16-byte row";
+			member.Type.clear();
+		}
+
+		return member;
+	}
+
+	Layout BuildStruct(ID3D11ShaderReflectionType* type, const D3D11_SHADER_TYPE_DESC& typeDesc)
+	{
+		Layout layout;
+		layout.Name = typeDesc.Name ? typeDesc.Name : "UnnamedStruct";
+
+		unsigned int end = 0;
+		for (unsigned int m = 0; m < typeDesc.Members; m++)
+		{
+			ID3D11ShaderReflectionType* memberType = type->GetMemberTypeByIndex(m);
+			D3D11_SHADER_TYPE_DESC memberDesc;
+			memberType->GetDesc(&memberDesc);
+
+			// Reflection doesn't give member sizes, so work them out
+			unsigned int size;
+			if (memberDesc.Class == D3D_SVC_STRUCT)
+			{
+				Layout inner = BuildStruct(memberType, memberDesc);
+				size = inner.Size * (memberDesc.Elements > 0 ? memberDesc.Elements : 1);
+			}
+			else
+			{
+				unsigned int element = ElementSize(memberDesc);
+				size = memberDesc.Elements > 0 ? RoundUp16(element) * (memberDesc.Elements - 1) + element : element;
+			}
+
+			layout.Members.push_back(BuildMember(type->GetMemberTypeName(m), memberType, memberDesc.Offset, size));
+			end = memberDesc.Offset + size;
+		}
+
+		layout.Size = RoundUp16(end);
+		return layout;
+	}
+
+	bool ReflectShader(const std::wstring& path, Shader& shader)
+	{
+		Microsoft::WRL::ComPtr<ID3DBlob> blob;
+		if (FAILED(D3DReadFileToBlob(path.c_str(), blob.GetAddressOf())))
+			return false;
+
+		Microsoft::WRL::ComPtr<ID3D11ShaderReflection> refl;
+		if (FAILED(D3DReflect(blob->GetBufferPointer(), blob->GetBufferSize(), IID_ID3D11ShaderReflection, (void**)refl.GetAddressOf())))
+			return false;
+
+		D3D11_SHADER_DESC shaderDesc;
+		refl->GetDesc(&shaderDesc);
+
+		for (unsigned int b = 0; b < shaderDesc.ConstantBuffers; b++)
+		{
+			ID3D11ShaderReflectionConstantBuffer* cb = refl->GetConstantBufferByIndex(b);
+			D3D11_SHADER_BUFFER_DESC bufferDesc;
+			cb->GetDesc(&bufferDesc);
+
+			// Structured buffers show up here too, but aren't cbuffers
+			if (bufferDesc.Type != D3D_CT_CBUFFER)
+				continue;
+
+			D3D11_SHADER_INPUT_BIND_DESC bindDesc;
+			refl->GetResourceBindingDescByName(bufferDesc.Name, &bindDesc);
+
+			Layout layout;
+			layout.Name = bufferDesc.Name;
+			layout.Size = bufferDesc.Size;
+			layout.Register = (int)bindDesc.BindPoint;
+
+			for (unsigned int v = 0; v < bufferDesc.Variables; v++)
+			{
+				ID3D11ShaderReflectionVariable* var = cb->GetVariableByIndex(v);
+				D3D11_SHADER_VARIABLE_DESC varDesc;
+				var->GetDesc(&varDesc);
+				layout.Members.push_back(BuildMember(varDesc.Name, var->GetType(), varDesc.StartOffset, varDesc.Size));
+			}
+
+			shader.Buffers.push_back(layout);
+		}
+
+		return true;
+	}
+
+	// Writes one struct, with padding members filling any gaps
+	void WriteLayout(std::ostringstream& out, const Layout& layout, const std::string& indent)
+	{
+		out << indent << "struct " << layout.Name << "\n" << indent << "{\n";
+		out << indent << "\tstatic constexpr const char* Name = \"" << layout.Name << "\";\n";
+		if (layout.Register >= 0)
+			out << indent << "\tstatic constexpr unsigned int Register = " << layout.Register << ";\n";
+		out << "\n";
+
+		unsigned int cursor = 0;
+		int pad = 0;
+		auto padTo = [&](unsigned int offset)
+		{
+			if (offset > cursor)
+				out << indent << "\tuint32_t Pad" << pad++ << "[" << (offset - cursor) / 4 << "];\n";
+			cursor = offset;
+		};
+
+		for (const Member& member : layout.Members)
+		{
+			padTo(member.Offset);
+
+			if (member.Type.empty())
+				out << indent << "\tunsigned char " << member.Name << "[" << member.Size << "]; // " << member.Note << "\n";
+			else if (member.Count > 0)
+				out << indent << "\t" << member.Type << " " << member.Name << "[" << member.Count << "];\n";
+			else
+				out << indent << "\t" << member.Type << " " << member.Name << ";\n";
+
+			cursor = member.Offset + member.Size;
+		}
+		padTo(layout.Size);
+
+		out << indent << "};\n";
+		for (const Member& member : layout.Members)
+		{
+			out << indent << "static_assert(offsetof(" << layout.Name << ", " << member.Name << ") == " << member.Offset
+				<< ", \"" << layout.Name << "::" << member.Name << " moved\");\n";
+		}
+		out << indent << "static_assert(sizeof(" << layout.Name << ") == " << layout.Size
+			<< ", \"" << layout.Name << " changed size\");\n\n";
+	}
+
+	std::string FileStem(const std::wstring& path)
+	{
+		size_t slash = path.find_last_of(L"\\/");
+		size_t start = slash == std::wstring::npos ? 0 : slash + 1;
+		size_t dot = path.find_last_of(L'.');
+		if (dot == std::wstring::npos || dot < start)
+			dot = path.size();
+
+		std::string stem;
+		for (size_t i = start; i < dot; i++)
+			stem.push_back((char)path[i]);
+		return stem;
+	}
+}
+
+int wmain(int argc, wchar_t* argv[])
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: ShaderStructGen <output.h> <shader.cso>...\n");
+		return 1;
+	}
+
+	std::vector<Shader> shaders;
+	for (int i = 2; i < argc; i++)
+	{
+		Shader shader;
+		shader.Name = FileStem(argv[i]);
+		if (!ReflectShader(argv[i], shader))
+		{
+			Error("couldn't reflect " + shader.Name);
+			continue;
+		}
+		shaders.push_back(shader);
+	}
+
+	// Buffers with the same name & layout in more than one shader are shared
+	std::vector<Layout> shared;
+	for (size_t s = 0; s < shaders.size(); s++)
+	{
+		for (const Layout& buffer : shaders[s].Buffers)
+		{
+			bool alreadyShared = false;
+			for (const Layout& existing : shared)
+				alreadyShared |= existing.SameLayout(buffer);
+			if (alreadyShared)
+				continue;
+
+			for (size_t other = s + 1; other < shaders.size(); other++)
+			{
+				bool match = false;
+				for (const Layout& otherBuffer : shaders[other].Buffers)
+					match |= otherBuffer.SameLayout(buffer) && otherBuffer.Register == buffer.Register;
+				if (match)
+				{
+					shared.push_back(buffer);
+					break;
+				}
+			}
+		}
+	}
+
+	if (failed)
+		return 1;
+
+	std::ostringstream out;
+	out << "#pragma once\n\n";
+	out << "// --------------------------------------------------------\n";
+	out << "// GENERATED by Tools/ShaderStructGen from the compiled\n";
+	out << "// shaders on every build - don't edit by hand\n";
+	out << "//\n";
+	out << "// C++ mirrors of each shader's constant buffers, laid out\n";
+	out << "// exactly like the HLSL, so one can be set whole with\n";
+	out << "// ISimpleShader::Set()\n";
+	out << "// --------------------------------------------------------\n\n";
+	out << "#include <DirectXMath.h>\n";
+	out << "#include <cstddef>\n";
+	out << "#include <cstdint>\n\n";
+	out << "namespace ShaderStructs\n{\n";
+
+	out << "\t// HLSL structs\n";
+	for (const Layout& layout : structs)
+		WriteLayout(out, layout, "\t");
+
+	out << "\t// Buffers shared by several shaders\n";
+	for (const Layout& layout : shared)
+		WriteLayout(out, layout, "\t");
+
+	for (const Shader& shader : shaders)
+	{
+		std::vector<const Layout*> own;
+		for (const Layout& buffer : shader.Buffers)
+		{
+			bool isShared = false;
+			for (const Layout& s : shared)
+				isShared |= s.SameLayout(buffer) && s.Register == buffer.Register;
+			if (!isShared)
+				own.push_back(&buffer);
+		}
+		if (own.empty())
+			continue;
+
+		out << "\t// " << shader.Name << ".hlsl\n";
+		out << "\tnamespace " << shader.Name << "\n\t{\n";
+		for (const Layout* layout : own)
+			WriteLayout(out, *layout, "\t\t");
+		out << "\t}\n\n";
+	}
+	out << "}\n";
+
+	// Leave the file (and its timestamp) alone if nothing changed
+	std::string header = out.str();
+	std::ifstream existingFile(argv[1], std::ios::binary);
+	std::string existing((std::istreambuf_iterator<char>(existingFile)), std::istreambuf_iterator<char>());
+	existingFile.close();
+	if (existing == header)
+		return 0;
+
+	std::ofstream outFile(argv[1], std::ios::binary | std::ios::trunc);
+	outFile << header;
+	if (!outFile)
+	{
+		fprintf(stderr, "ShaderStructGen: error: couldn't write the header\n");
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,311 @@
+#include "TrackedContext.h"
+
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <atomic>
+#include <mutex>
+
+// Annonymous namespace to hold variables/helpers
+// only accessible in this file
+namespace
+{
+	constexpr unsigned int MaxVertexBuffers = 4; // More than the game binds
+
+	// What's bound in one slot, if it's known at all
+	template<typename T>
+	struct Slot
+	{
+		T Value;
+		bool Known;
+	};
+
+	struct ConstantBufferSlot
+	{
+		ID3D11Buffer* Buffer;
+		UINT FirstConstant;
+		UINT NumConstants;
+		bool Known;
+	};
+
+	struct StageState
+	{
+		ConstantBufferSlot ConstantBuffers[D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT];
+		Slot<ID3D11ShaderResourceView*> SRVs[D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT];
+		Slot<ID3D11SamplerState*> Samplers[D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT];
+	};
+
+	struct VertexBufferSlot
+	{
+		ID3D11Buffer* Buffer;
+		UINT Stride;
+		UINT Offset;
+		bool Known;
+	};
+
+	struct IndexBufferState
+	{
+		ID3D11Buffer* Buffer;
+		DXGI_FORMAT Format;
+		UINT Offset;
+		bool Known;
+	};
+
+	struct RenderTargetState
+	{
+		ID3D11RenderTargetView* RTVs[D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT];
+		unsigned int Count;
+		ID3D11DepthStencilView* DSV;
+		bool Known;
+	};
+
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1; // For constant buffer offsets
+	std::atomic<bool> filtering = true;
+
+	// Only raw pointers are kept: the context holds a reference to
+	// everything bound, so nothing here can be freed & its address
+	// reused while it's still recorded as bound
+	StageState stages[TrackedContext::StageCount];
+	Slot<ID3D11VertexShader*> vertexShader;
+	Slot<ID3D11PixelShader*> pixelShader;
+	Slot<ID3D11InputLayout*> inputLayout;
+	VertexBufferSlot vertexBuffers[MaxVertexBuffers];
+	IndexBufferState indexBuffer;
+	RenderTargetState renderTargets;
+
+	TrackedContext::FrameStats frameStats = {};
+
+	// Guarded by the mutex, since the UI reads it
+	std::mutex mutex;
+	TrackedContext::FrameStats lastFrameStats = {};
+
+	void ForgetAll()
+	{
+		for (StageState& stage : stages)
+			stage = {};
+		vertexShader = {};
+		pixelShader = {};
+		inputLayout = {};
+		for (VertexBufferSlot& slot : vertexBuffers)
+			slot = {};
+		indexBuffer = {};
+		renderTargets = {};
+	}
+
+	// Counts a call & says whether it has to be made
+	bool Issue(bool changed)
+	{
+		if (changed || !filtering.load(std::memory_order_relaxed))
+		{
+			frameStats.Issued++;
+			return true;
+		}
+
+		frameStats.Filtered++;
+		return false;
+	}
+
+	// Single-value state (shaders, input layout)
+	template<typename T>
+	bool Update(Slot<T>& slot, T value)
+	{
+		if (!Issue(!slot.Known || slot.Value != value))
+			return false;
+
+		slot = { value, true };
+		return true;
+	}
+
+	// Ranged state - only the span from the first to the last changed
+	// slot is passed to set(), and the call is dropped if none changed
+	template<typename T, typename SetFunc>
+	void UpdateRange(Slot<T>* slots, unsigned int capacity, unsigned int start, unsigned int count, T const* values, SetFunc set)
+	{
+		if (count == 0)
+			return;
+
+		// Past the end of the table, so not tracked at all
+		if (start >= capacity || count > capacity - start)
+		{
+			frameStats.Issued++;
+			set(start, count, values);
+			return;
+		}
+
+		bool all = !filtering.load(std::memory_order_relaxed);
+		unsigned int first = count;
+		unsigned int last = 0;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const Slot<T>& slot = slots[start + i];
+			if (all || !slot.Known || slot.Value != values[i])
+			{
+				if (first == count) first = i;
+				last = i;
+			}
+		}
+
+		if (first == count)
+		{
+			frameStats.Filtered++;
+			return;
+		}
+
+		for (unsigned int i = first; i <= last; i++)
+			slots[start + i] = { values[i], true };
+
+		frameStats.Issued++;
+		set(start + first, last - first + 1, values + first);
+	}
+}
+
+void TrackedContext::Initialize(ID3D11DeviceContext* deviceContext)
+{
+	context = deviceContext;
+	context1.Reset();
+	context.As(&context1);
+	ForgetAll();
+}
+
+void TrackedContext::ShutDown()
+{
+	context.Reset();
+	context1.Reset();
+	ForgetAll();
+}
+
+bool TrackedContext::Tracks(ID3D11DeviceContext* deviceContext)
+{
+	return context && context.Get() == deviceContext;
+}
+
+void TrackedContext::BeginFrame()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	lastFrameStats = frameStats;
+	frameStats = {};
+	ForgetAll();
+}
+
+void TrackedContext::SetFiltering(bool enabled) { filtering = enabled; }
+bool TrackedContext::IsFiltering() { return filtering; }
+
+void TrackedContext::SetVertexShader(ID3D11VertexShader* shader)
+{
+	if (Update(vertexShader, shader))
+		context->VSSetShader(shader, 0, 0);
+}
+
+void TrackedContext::SetPixelShader(ID3D11PixelShader* shader)
+{
+	if (Update(pixelShader, shader))
+		context->PSSetShader(shader, 0, 0);
+}
+
+void TrackedContext::SetInputLayout(ID3D11InputLayout* layout)
+{
+	if (Update(inputLayout, layout))
+		context->IASetInputLayout(layout);
+}
+
+void TrackedContext::SetConstantBuffer(Stage stage, unsigned int slotIndex, ID3D11Buffer* buffer, UINT firstConstant, UINT numConstants)
+{
+	if (slotIndex >= D3D11_COMMONSHADER_CONSTANT_BUFFER_API_SLOT_COUNT)
+		return;
+
+	ConstantBufferSlot& slot = stages[stage].ConstantBuffers[slotIndex];
+	bool changed = !slot.Known || slot.Buffer != buffer || slot.FirstConstant != firstConstant || slot.NumConstants != numConstants;
+	if (!Issue(changed))
+		return;
+
+	slot = { buffer, firstConstant, numConstants, true };
+	if (numConstants > 0 && context1)
+	{
+		if (stage == Vertex) context1->VSSetConstantBuffers1(slotIndex, 1, &buffer, &firstConstant, &numConstants);
+		else context1->PSSetConstantBuffers1(slotIndex, 1, &buffer, &firstConstant, &numConstants);
+	}
+	else
+	{
+		if (stage == Vertex) context->VSSetConstantBuffers(slotIndex, 1, &buffer);
+		else context->PSSetConstantBuffers(slotIndex, 1, &buffer);
+	}
+}
+
+void TrackedContext::SetShaderResources(Stage stage, unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs)
+{
+	UpdateRange(stages[stage].SRVs, D3D11_COMMONSHADER_INPUT_RESOURCE_SLOT_COUNT, startSlot, count, srvs,
+		[stage](unsigned int start, unsigned int n, ID3D11ShaderResourceView* const* values)
+		{
+			if (stage == Vertex) context->VSSetShaderResources(start, n, values);
+			else context->PSSetShaderResources(start, n, values);
+		});
+}
+
+void TrackedContext::SetSamplers(Stage stage, unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplers)
+{
+	UpdateRange(stages[stage].Samplers, D3D11_COMMONSHADER_SAMPLER_SLOT_COUNT, startSlot, count, samplers,
+		[stage](unsigned int start, unsigned int n, ID3D11SamplerState* const* values)
+		{
+			if (stage == Vertex) context->VSSetSamplers(start, n, values);
+			else context->PSSetSamplers(start, n, values);
+		});
+}
+
+void TrackedContext::SetVertexBuffer(unsigned int slotIndex, ID3D11Buffer* buffer, UINT stride, UINT offset)
+{
+	bool changed = true;
+	if (slotIndex < MaxVertexBuffers)
+	{
+		VertexBufferSlot& slot = vertexBuffers[slotIndex];
+		changed = !slot.Known || slot.Buffer != buffer || slot.Stride != stride || slot.Offset != offset;
+		if (changed)
+			slot = { buffer, stride, offset, true };
+	}
+
+	if (Issue(changed))
+		context->IASetVertexBuffers(slotIndex, 1, &buffer, &stride, &offset);
+}
+
+void TrackedContext::SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset)
+{
+	bool changed = !indexBuffer.Known || indexBuffer.Buffer != buffer || indexBuffer.Format != format || indexBuffer.Offset != offset;
+	if (!Issue(changed))
+		return;
+
+	indexBuffer = { buffer, format, offset, true };
+	context->IASetIndexBuffer(buffer, format, offset);
+}
+
+void TrackedContext::SetRenderTargets(unsigned int count, ID3D11RenderTargetView* const* rtvs, ID3D11DepthStencilView* dsv)
+{
+	if (count > D3D11_SIMULTANEOUS_RENDER_TARGET_COUNT)
+		return;
+
+	bool changed = !renderTargets.Known || renderTargets.Count != count || renderTargets.DSV != dsv;
+	for (unsigned int i = 0; !changed && i < count; i++)
+		changed = renderTargets.RTVs[i] != rtvs[i];
+	if (!Issue(changed))
+		return;
+
+	renderTargets = {};
+	for (unsigned int i = 0; i < count; i++)
+		renderTargets.RTVs[i] = rtvs[i];
+	renderTargets.Count = count;
+	renderTargets.DSV = dsv;
+	renderTargets.Known = true;
+	context->OMSetRenderTargets(count, rtvs, dsv);
+
+	// Any shader resource that was a view of one of these is now unbound
+	// - Slots known to be empty stay that way, so unbinding a whole
+	//   range afterwards only sends the slots that held something
+	for (StageState& stage : stages)
+		for (auto& slot : stage.SRVs)
+			if (slot.Value)
+				slot.Known = false;
+}
+
+TrackedContext::FrameStats TrackedContext::LastFrameStats()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return lastFrameStats;
+}
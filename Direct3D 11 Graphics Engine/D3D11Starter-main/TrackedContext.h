@@ -0,0 +1,68 @@
+#pragma once
+
+#include <d3d11.h>
+#include <cstdint>
+
+// --------------------------------------------------------
+// A thin layer over Graphics::Context that remembers what's
+// bound & drops calls that would set the same thing again
+//
+// - Covers what changes per draw: vertex & pixel shaders,
+//   input layout, constant buffers (with their offsets),
+//   shader resources, samplers, vertex & index buffers and
+//   render targets.  Rasterizer, depth & blend states are
+//   filtered by PipelineStates::Apply().
+// - Ranged calls only send the part of the range that
+//   actually changed (or nothing at all)
+// - Anything set directly on the context behind its back
+//   makes it wrong, so it forgets everything each frame
+//   (ImGui saves & restores what it changes)
+// - Binding render targets also forgets the shader
+//   resources that were bound (empty slots stay known),
+//   since D3D unbinds any view of a resource that becomes
+//   an output
+// - Rendering thread only
+// --------------------------------------------------------
+namespace TrackedContext
+{
+	enum Stage { Vertex, Pixel, StageCount };
+
+	void Initialize(ID3D11DeviceContext* context);
+	void ShutDown();
+
+	// Is this the context being tracked?  (Shaders made for
+	// other contexts bind straight through)
+	bool Tracks(ID3D11DeviceContext* context);
+
+	// Forgets everything that's bound & starts this frame's counters
+	void BeginFrame();
+
+	// Off passes every call through (still counted), for comparison
+	void SetFiltering(bool enabled);
+	bool IsFiltering();
+
+	// Shaders & input layout
+	void SetVertexShader(ID3D11VertexShader* shader);
+	void SetPixelShader(ID3D11PixelShader* shader);
+	void SetInputLayout(ID3D11InputLayout* layout);
+
+	// A non-zero numConstants binds just that window of the buffer
+	void SetConstantBuffer(Stage stage, unsigned int slot, ID3D11Buffer* buffer, UINT firstConstant = 0, UINT numConstants = 0);
+	void SetShaderResources(Stage stage, unsigned int startSlot, unsigned int count, ID3D11ShaderResourceView* const* srvs);
+	void SetSamplers(Stage stage, unsigned int startSlot, unsigned int count, ID3D11SamplerState* const* samplers);
+
+	// Input assembler
+	void SetVertexBuffer(unsigned int slot, ID3D11Buffer* buffer, UINT stride, UINT offset);
+	void SetIndexBuffer(ID3D11Buffer* buffer, DXGI_FORMAT format, UINT offset);
+
+	// Output merger
+	void SetRenderTargets(unsigned int count, ID3D11RenderTargetView* const* rtvs, ID3D11DepthStencilView* dsv);
+
+	// Calls over the last full frame
+	struct FrameStats
+	{
+		uint64_t Issued;	// Reached the context
+		uint64_t Filtered;	// Dropped as redundant
+	};
+	FrameStats LastFrameStats();
+}
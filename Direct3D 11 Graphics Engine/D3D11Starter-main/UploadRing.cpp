@@ -0,0 +1,150 @@
+#include "UploadRing.h"
+
+#include <cstring>
+
+bool UploadRing::Initialize(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, unsigned int capacity)
+{
+	ShutDown();
+
+	// Offset binding needs an 11.1 context, and the driver has to
+	// allow both offsets & NO_OVERWRITE maps on constant buffers
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext1> context1;
+	D3D11_FEATURE_DATA_D3D11_OPTIONS options = {};
+	if (FAILED(context.As(&context1)) ||
+		FAILED(device->CheckFeatureSupport(D3D11_FEATURE_D3D11_OPTIONS, &options, sizeof(options))) ||
+		!options.ConstantBufferOffsetting ||
+		!options.MapNoOverwriteOnDynamicConstantBuffer)
+		return false;
+
+	// Bigger than a single bindable constant buffer is fine
+	// with 11.1, as only a window of it is ever bound
+	D3D11_BUFFER_DESC desc = {};
+	desc.ByteWidth = ((capacity + Alignment - 1) / Alignment) * Alignment;
+	desc.Usage = D3D11_USAGE_DYNAMIC;
+	desc.BindFlags = D3D11_BIND_CONSTANT_BUFFER;
+	desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+	if (FAILED(device->CreateBuffer(&desc, 0, buffer.GetAddressOf())))
+		return false;
+
+	// One fence per frame that can be in flight
+	D3D11_QUERY_DESC queryDesc = {};
+	queryDesc.Query = D3D11_QUERY_EVENT;
+	for (int i = 0; i < FenceCount; i++)
+	{
+		if (FAILED(device->CreateQuery(&queryDesc, fences[i].GetAddressOf())))
+		{
+			ShutDown();
+			return false;
+		}
+	}
+
+	this->context = context;
+	allocator.Reset(desc.ByteWidth);
+
+	// Discard once up front, so every later map can be NO_OVERWRITE
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (SUCCEEDED(context->Map(buffer.Get(), 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped)))
+		context->Unmap(buffer.Get(), 0);
+
+	return true;
+}
+
+void UploadRing::ShutDown()
+{
+	buffer.Reset();
+	for (int i = 0; i < FenceCount; i++)
+		fences[i].Reset();
+	context.Reset();
+
+	allocator.Reset(0);
+	frame = 1;
+	completedFrame = 0;
+}
+
+// --------------------------------------------------------
+// Frees whatever the GPU has finished with, and makes sure
+// this frame's fence isn't still in use by an old frame
+// --------------------------------------------------------
+void UploadRing::BeginFrame()
+{
+	if (!buffer)
+		return;
+
+	while (RetireOldestFrame(false)) {}
+
+	while (frame - completedFrame >= FenceCount)
+		RetireOldestFrame(true);
+}
+
+void UploadRing::EndFrame()
+{
+	if (!buffer)
+		return;
+
+	context->End(fences[frame % FenceCount].Get());
+	allocator.EndFrame(frame);
+	frame++;
+}
+
+bool UploadRing::Upload(const void* data, unsigned int size, UINT& firstConstant, UINT& numConstants)
+{
+	if (!buffer || size == 0)
+		return false;
+
+	// Whole 256 byte steps, so the bound window stays inside this allocation
+	unsigned int allocationSize = ((size + Alignment - 1) / Alignment) * Alignment;
+	uint64_t offset = allocator.Allocate(allocationSize, Alignment);
+
+	// Full - wait on older frames until it fits (or none are left)
+	while (offset == RingAllocator::Invalid && RetireOldestFrame(true))
+	{
+		stats.Stalls++;
+		offset = allocator.Allocate(allocationSize, Alignment);
+	}
+
+	if (offset == RingAllocator::Invalid)
+	{
+		stats.Failures++;
+		return false;
+	}
+
+	// The GPU may still be reading other parts of the buffer, but never this part
+	D3D11_MAPPED_SUBRESOURCE mapped = {};
+	if (FAILED(context->Map(buffer.Get(), 0, D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped)))
+	{
+		stats.Failures++;
+		return false;
+	}
+	memcpy(static_cast<unsigned char*>(mapped.pData) + offset, data, size);
+	context->Unmap(buffer.Get(), 0);
+
+	firstConstant = (UINT)(offset / 16);
+	numConstants = allocationSize / 16;
+
+	stats.Uploads++;
+	stats.BytesUploaded += size;
+	return true;
+}
+
+bool UploadRing::RetireOldestFrame(bool wait)
+{
+	// Nothing submitted that isn't already known to be done
+	uint64_t oldest = completedFrame + 1;
+	if (oldest >= frame)
+		return false;
+
+	// S_FALSE means not done yet; a failure (device removed)
+	// counts as done, since nothing will ever read the ring again
+	ID3D11Query* fence = fences[oldest % FenceCount].Get();
+	BOOL done = FALSE;
+	UINT flags = wait ? 0 : D3D11_ASYNC_GETDATA_DONOTFLUSH;
+	while (context->GetData(fence, &done, sizeof(done), flags) == S_FALSE)
+	{
+		if (!wait)
+			return false;
+	}
+
+	completedFrame = oldest;
+	allocator.Reclaim(completedFrame);
+	return true;
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <d3d11.h>
+#include <d3d11_1.h>
+#include <wrl/client.h>
+#include <cstdint>
+
+#include "RingAllocator.h"
+
+// --------------------------------------------------------
+// One large dynamic constant buffer that transient data
+// (per-draw constants) is suballocated from, instead of
+// rewriting the same small buffer between draws
+//
+// - Each upload maps with NO_OVERWRITE and is bound with
+//   a constant offset (*SetConstantBuffers1), so the
+//   driver never has to rename or copy anything
+// - Space is handed back a whole frame at a time, once an
+//   event query shows the GPU has finished that frame
+// - Needs D3D 11.1 with constant buffer offsetting; where
+//   that's missing Initialize() fails and callers keep
+//   using their own buffers
+// - Only the rendering thread may use it
+// --------------------------------------------------------
+class UploadRing
+{
+public:
+	// Offsets are bound in 16-constant (256 byte) steps
+	static constexpr unsigned int Alignment = 256;
+	static constexpr int FenceCount = RingAllocator::MaxPendingFrames;
+
+	// Counters since the last ResetStats()
+	struct Stats
+	{
+		uint64_t Uploads = 0;
+		uint64_t BytesUploaded = 0;
+		uint64_t Stalls = 0;	// Times the ring was full and had to wait for the GPU
+		uint64_t Failures = 0;	// Uploads that didn't fit even after waiting
+	};
+
+	UploadRing() = default;
+	UploadRing(const UploadRing&) = delete;
+	UploadRing& operator=(const UploadRing&) = delete;
+
+	// Returns false (and stays unusable) if the device can't bind buffer offsets
+	bool Initialize(Microsoft::WRL::ComPtr<ID3D11Device> device, Microsoft::WRL::ComPtr<ID3D11DeviceContext> context, unsigned int capacity);
+	void ShutDown();
+	bool IsInitialized() const { return buffer != 0; }
+
+	// Call at the start & end (after Present) of every frame that uses the ring
+	void BeginFrame();
+	void EndFrame();
+
+	// Copies size bytes into the ring and returns the range to bind
+	// - firstConstant & numConstants are in 16-byte constants, as
+	//   *SetConstantBuffers1 expects
+	// - False if it can't fit, in which case nothing was written
+	bool Upload(const void* data, unsigned int size, UINT& firstConstant, UINT& numConstants);
+
+	// Getters
+	ID3D11Buffer* GetBuffer() const { return buffer.Get(); }
+	uint64_t CurrentFrame() const { return frame; }
+	uint64_t Capacity() const { return allocator.Capacity(); }
+	uint64_t BytesInUse() const { return allocator.BytesInUse(); }
+	const Stats& GetStats() const { return stats; }
+	void ResetStats() { stats = {}; }
+
+private:
+	Microsoft::WRL::ComPtr<ID3D11DeviceContext> context;
+	Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+	Microsoft::WRL::ComPtr<ID3D11Query> fences[FenceCount];
+
+	RingAllocator allocator;
+	uint64_t frame = 1;				// Frame being recorded
+	uint64_t completedFrame = 0;	// Newest frame the GPU is known to have finished
+	Stats stats;
+
+	// Polls (or with wait, blocks on) the oldest unfinished frame
+	bool RetireOldestFrame(bool wait);
+};
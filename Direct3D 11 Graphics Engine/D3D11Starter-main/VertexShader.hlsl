@@ -1,16 +1,17 @@
 #include "ShaderInclude.hlsli" // Contains all necessary structs, helper functions, etc.
 
-// Constant buffer (every vertex gets/reads same data from buffer) (Name is irrevelant)
-cbuffer ExternalData : register(b0) // b0-b14 of buffer indeices
+// Constant buffer (every vertex gets/reads same data from buffer)
+// - Only the per-object data: view & projection are in PerPass and
+//   the light matrices are in PerFrame (see ShaderInclude.hlsli)
+// - The INSTANCED variant reads these from the Objects buffer instead
+#if !INSTANCED
+cbuffer PerObject : register(b0) // b0-b14 of buffer indeices
 {
 	// *NOTE: Order listed matters!
 	matrix world; //float3 offset; //matrix transform;
-	matrix view;
-	matrix projection;
 	matrix worldInvTransp;
-	matrix lightView;
-	matrix lightProj;
 }
+#endif
 
 // --------------------------------------------------------
 // The entry point (main method) for our vertex shader
@@ -19,8 +20,19 @@ cbuffer ExternalData : register(b0) // b0-b14 of buffer indeices
 // - Output is a single struct of data to pass down the pipeline
 // - Named "main" because that's the default the shader compiler looks for
 // --------------------------------------------------------
+#if INSTANCED
+VertexToPixel main( VertexShaderInput input, InstanceInput instance )
+#else
 VertexToPixel main( VertexShaderInput input )
+#endif
 {
+#if INSTANCED
+	// Same names as PerObject, so the rest reads the same either way
+	ObjectTransform object = Objects[instance.objectIndex];
+	matrix world = ObjectMatrix(object.world);
+	matrix worldInvTransp = ObjectMatrix(object.worldInvTransp);
+#endif
+
 	// Set up output struct
 	VertexToPixel output;
 	
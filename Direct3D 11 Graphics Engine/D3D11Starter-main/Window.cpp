@@ -3,7 +3,7 @@
 #include "Graphics.h"
 #include "Input.h"
 
-#include <sstream>
+#include <cstdio>
 
 // Include ImGui's Win32 backend and forward declare the window handler function
 // Note: This CANNOT be inside a namespace!
@@ -44,6 +44,11 @@ namespace Window
 		// when the window resizes
 		void (*onResize)() = 0;
 
+		// Function pointer to call just before the
+		// swap chain buffers are resized (so any
+		// in-flight rendering can finish first)
+		void (*onBeforeResize)() = 0;
+
 		// Basic FPS tracking
 		float fpsTimeElapsed = 0.0f;
 		__int64 fpsFrameCounter = 0;
@@ -69,6 +74,8 @@ bool Window::IsMinimized() { return isMinimized; }
 // titleBarText    - Window's title bar text
 // statsInTitleBar - Want debug stats (like FPS) in title bar?
 // resizeCallback  - The function to call when the window resizes
+// beforeResizeCallback - Optional function to call before any
+//                   resize work happens
 // --------------------------------------------------------
 HRESULT Window::Create(
 	HINSTANCE appInstance,
@@ -76,7 +83,8 @@ HRESULT Window::Create(
 	unsigned int height, 
 	std::wstring titleBarText,
 	bool statsInTitleBar,
-	void (*resizeCallback)())
+	void (*resizeCallback)(),
+	void (*beforeResizeCallback)())
 {
 	// Verify
 	if (windowCreated)
@@ -88,6 +96,7 @@ HRESULT Window::Create(
 	windowTitle = titleBarText;
 	windowStats = statsInTitleBar;
 	onResize = resizeCallback;
+	onBeforeResize = beforeResizeCallback;
 
 	// Start window creation by filling out the
 	// appropriate window class struct
@@ -164,6 +173,27 @@ HRESULT Window::Create(
 }
 
 
+// --------------------------------------------------------
+// Stands in for Create() on headless runs, which have no
+// OS window - only the size is recorded, so Width(),
+// Height() & AspectRatio() still work (Handle() is null)
+//
+// width  - Size to report for the (missing) window
+// height - Size to report for the (missing) window
+// --------------------------------------------------------
+HRESULT Window::CreateHeadless(unsigned int width, unsigned int height)
+{
+	// Verify
+	if (windowCreated)
+		return E_FAIL;
+
+	windowWidth = width;
+	windowHeight = height;
+	windowCreated = true;
+	return S_OK;
+}
+
+
 // --------------------------------------------------------
 // Updates the window's title bar with several stats once
 // per second, including:
@@ -185,17 +215,19 @@ void Window::UpdateStats(float totalTime)
 	float mspf = 1000.0f / (float)fpsFrameCounter;
 
 	// Quick and dirty title bar text (mostly for debugging)
-	std::wostringstream output;
-	output.precision(6);
-	output << windowTitle <<
-		"    Width: " << windowWidth <<
-		"    Height: " << windowHeight <<
-		"    FPS: " << fpsFrameCounter <<
-		"    Frame Time: " << mspf << "ms" <<
-		"    Graphics: " << Graphics::APIName();
+	// - Formatted into a fixed buffer so the frame loop stays allocation free
+	wchar_t output[256];
+	swprintf_s(output,
+		L"%s    Width: %u    Height: %u    FPS: %lld    Frame Time: %gms    Graphics: %s",
+		windowTitle.c_str(),
+		windowWidth,
+		windowHeight,
+		fpsFrameCounter,
+		mspf,
+		Graphics::APIName().c_str());
 
 	// Actually update the title bar and reset fps data
-	SetWindowText(windowHandle, output.str().c_str());
+	SetWindowText(windowHandle, output);
 	fpsFrameCounter = 0;
 	fpsTimeElapsed += elapsed;
 }
@@ -299,6 +331,10 @@ LRESULT Window::ProcessMessage(HWND hWnd, UINT uMsg, WPARAM wParam, LPARAM lPara
 		isMinimized = wParam == SIZE_MINIMIZED;
 		if (isMinimized)
 			return 0;
+
+		// Give other systems a chance to stop using the old buffers
+		if (onBeforeResize)
+			onBeforeResize();
 		
 		// Save the new client area dimensions.
 		windowWidth = LOWORD(lParam);
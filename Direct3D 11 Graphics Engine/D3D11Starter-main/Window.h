@@ -20,7 +20,9 @@ namespace Window
 		unsigned int height,
 		std::wstring titleBarText,
 		bool statsInTitleBar,
-		void (*resizeCallback)());
+		void (*resizeCallback)(),
+		void (*beforeResizeCallback)() = 0);
+	HRESULT CreateHeadless(unsigned int width, unsigned int height);
 	void UpdateStats(float totalTime);
 	void Quit();
 